@@ -0,0 +1,141 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include "bench_report.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+#include <thread>
+
+using namespace inseye::benchmark;
+
+namespace {
+std::string Quote(std::string_view text) {
+  std::string quoted = "\"";
+  for (const char character : text) {
+    switch (character) {
+      case '"':
+        quoted += "\\\"";
+        break;
+      case '\\':
+        quoted += "\\\\";
+        break;
+      case '\n':
+        quoted += "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(character) < 0x20) {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", character);
+          quoted += escaped;
+        } else {
+          quoted += character;
+        }
+    }
+  }
+  return quoted + "\"";
+}
+
+std::string Number(double value) {
+  // JSON has no representation of infinity and NaN
+  if (!std::isfinite(value))
+    return "null";
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.10g", value);
+  return text;
+}
+
+const char* PlatformName() {
+#if defined(_WIN32)
+  return "windows";
+#elif defined(__linux__)
+  return "linux";
+#elif defined(__APPLE__)
+  return "macos";
+#else
+  return "unknown";
+#endif
+}
+
+std::string CompilerName() {
+#if defined(_MSC_VER)
+  return "msvc " + std::to_string(_MSC_VER);
+#elif defined(__clang__)
+  return "clang " __clang_version__;
+#elif defined(__GNUC__)
+  return "gcc " __VERSION__;
+#else
+  return "unknown";
+#endif
+}
+}  // namespace
+
+Percentiles inseye::benchmark::ComputePercentiles(std::vector<double>& values) {
+  if (values.empty())
+    return {};
+  std::ranges::sort(values);
+  auto at = [&](double fraction) {
+    return values[static_cast<size_t>(
+        fraction * static_cast<double>(values.size() - 1))];
+  };
+  return {at(0.5),
+          at(0.9),
+          at(0.99),
+          at(0.999),
+          values.back(),
+          std::accumulate(values.begin(), values.end(), 0.0) /
+              static_cast<double>(values.size())};
+}
+
+std::vector<Metric> inseye::benchmark::ToMetrics(
+    const Percentiles& percentiles, std::string_view unit) {
+  const std::string suffix = "_" + std::string(unit);
+  return {{"p50" + suffix, percentiles.p50},   {"p90" + suffix, percentiles.p90},
+          {"p99" + suffix, percentiles.p99},   {"p999" + suffix, percentiles.p999},
+          {"max" + suffix, percentiles.max},   {"mean" + suffix, percentiles.mean}};
+}
+
+BenchReport::BenchReport(std::string suite) : suite_(std::move(suite)) {}
+
+void BenchReport::Add(std::string name, std::vector<Metric> metrics) {
+  results_.push_back({std::move(name), std::move(metrics)});
+}
+
+void BenchReport::Add(std::string name, std::initializer_list<Metric> metrics) {
+  Add(std::move(name), std::vector<Metric>(metrics));
+}
+
+void BenchReport::WriteJson(std::ostream& stream) const {
+  const auto unix_time = std::chrono::duration_cast<std::chrono::seconds>(
+                             std::chrono::system_clock::now().time_since_epoch())
+                             .count();
+  stream << "{\n  \"schema_version\": " << kReportSchemaVersion
+         << ",\n  \"suite\": " << Quote(suite_)
+         << ",\n  \"environment\": {\n    \"platform\": "
+         << Quote(PlatformName())
+         << ",\n    \"compiler\": " << Quote(CompilerName())
+#if defined(NDEBUG)
+         << ",\n    \"build_type\": \"release\""
+#else
+         << ",\n    \"build_type\": \"debug\""
+#endif
+         << ",\n    \"hardware_threads\": "
+         << std::thread::hardware_concurrency()
+         << ",\n    \"unix_time\": " << unix_time << "\n  },\n  \"results\": [";
+  for (size_t i = 0; i < results_.size(); ++i) {
+    stream << (i == 0 ? "\n" : ",\n") << "    {\"name\": "
+           << Quote(results_[i].name) << ", \"metrics\": {";
+    const auto& metrics = results_[i].metrics;
+    for (size_t j = 0; j < metrics.size(); ++j)
+      stream << (j == 0 ? "" : ", ") << Quote(metrics[j].first) << ": "
+             << Number(metrics[j].second);
+    stream << "}}";
+  }
+  stream << "\n  ]\n}\n";
+}
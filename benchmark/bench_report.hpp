@@ -0,0 +1,69 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#ifndef REMOTE_CONNECTOR_BENCHMARK_BENCH_REPORT_HPP
+#define REMOTE_CONNECTOR_BENCHMARK_BENCH_REPORT_HPP
+#include <initializer_list>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace inseye::benchmark {
+
+// Bumped whenever meaning of existing result or metric names changes, so that
+// stored reports are only compared with reports of the same schema.
+constexpr int kReportSchemaVersion = 2;
+
+using Metric = std::pair<std::string, double>;
+
+/**
+ * @brief Order statistics of measured values, in unit of the values.
+ */
+struct Percentiles {
+  double p50 = 0;
+  double p90 = 0;
+  double p99 = 0;
+  double p999 = 0;
+  double max = 0;
+  double mean = 0;
+};
+
+/**
+ * @brief Sorts values and computes their percentiles.
+ */
+Percentiles ComputePercentiles(std::vector<double>& values);
+
+/**
+ * @brief Percentiles as metrics named p50_<unit>, p90_<unit>...
+ */
+std::vector<Metric> ToMetrics(const Percentiles& percentiles,
+                              std::string_view unit);
+
+/**
+ * @brief Collects named results of benchmark run and writes them as JSON:
+ * {"schema_version": 1, "suite": ..., "environment": {...},
+ *  "results": [{"name": ..., "metrics": {"metric": value, ...}}, ...]}
+ */
+class BenchReport {
+  struct Result {
+    std::string name;
+    std::vector<Metric> metrics;
+  };
+  std::string suite_;
+  std::vector<Result> results_;
+
+ public:
+  explicit BenchReport(std::string suite);
+  void Add(std::string name, std::vector<Metric> metrics);
+  void Add(std::string name, std::initializer_list<Metric> metrics);
+  void WriteJson(std::ostream& stream) const;
+};
+
+}  // namespace inseye::benchmark
+#endif  //REMOTE_CONNECTOR_BENCHMARK_BENCH_REPORT_HPP
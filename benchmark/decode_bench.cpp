@@ -0,0 +1,151 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "columns_decoder.hpp"
+#include "eye_tracker_data_struct.hpp"
+#include "legacy_decoder.hpp"
+
+// Micro benchmark of decoding packed ring samples, needs no service and builds
+// on every platform.
+
+using clock_type = std::chrono::steady_clock;
+using decoder_type = void (*)(const std::byte*, inseye::EyeTrackerDataStruct&);
+using inseye::internal::ColumnsDecoderKernel;
+
+constexpr size_t sample_count = 4096;
+constexpr size_t packed_sample_size =
+    sizeof(inseye::internal::EyeTrackerDataStruct);
+constexpr int repetitions = 2000;
+
+std::vector<std::byte> MakePackedSamples() {
+  std::vector<std::byte> packed(sample_count * packed_sample_size);
+  for (size_t i = 0; i < sample_count; ++i) {
+    const auto value = static_cast<float>(i);
+    // every eighth sample carries event value from newer service
+    const inseye::internal::EyeTrackerDataStruct sample{
+        i, value, -value, value * 0.5f, -value * 0.5f,
+        static_cast<uint32_t>(i % 8 == 7 ? 1000 : i % 7)};
+    std::memcpy(packed.data() + i * packed_sample_size, &sample,
+                packed_sample_size);
+  }
+  return packed;
+}
+
+struct Columns {
+  std::vector<uint64_t> time = std::vector<uint64_t>(sample_count);
+  std::vector<float> left_eye_x = std::vector<float>(sample_count);
+  std::vector<float> left_eye_y = std::vector<float>(sample_count);
+  std::vector<float> right_eye_x = std::vector<float>(sample_count);
+  std::vector<float> right_eye_y = std::vector<float>(sample_count);
+  std::vector<inseye::GazeEvent> gaze_event =
+      std::vector<inseye::GazeEvent>(sample_count);
+
+  inseye::EyeTrackerDataColumns View() {
+    return {time.data(),        left_eye_x.data(),  left_eye_y.data(),
+            right_eye_x.data(), right_eye_y.data(), gaze_event.data()};
+  }
+
+  bool operator==(const Columns&) const = default;
+};
+
+template <typename DecodeAll>
+double MeasureNanosecondsPerSample(DecodeAll&& decode_all) {
+  const auto start = clock_type::now();
+  for (int repetition = 0; repetition < repetitions; ++repetition)
+    decode_all();
+  const auto elapsed = clock_type::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() /
+         (static_cast<double>(sample_count) * repetitions);
+}
+
+double MeasureRecordDecoder(const std::vector<std::byte>& packed,
+                            decoder_type decoder) {
+  std::vector<inseye::EyeTrackerDataStruct> decoded(sample_count);
+  return MeasureNanosecondsPerSample([&] {
+    const std::byte* source = packed.data();
+    for (auto& sample : decoded) {
+      decoder(source, sample);
+      source += packed_sample_size;
+    }
+  });
+}
+
+// Path consumers had before columns decoder: decode sample by sample to
+// records and transpose.
+void DecodeRecordsAndTranspose(const std::vector<std::byte>& packed,
+                               std::vector<inseye::EyeTrackerDataStruct>& records,
+                               Columns& columns) {
+  const std::byte* source = packed.data();
+  for (auto& sample : records) {
+    inseye::internal::readDataSample(source, sample);
+    source += packed_sample_size;
+  }
+  for (size_t i = 0; i < sample_count; ++i) {
+    columns.time[i] = records[i].time;
+    columns.left_eye_x[i] = records[i].left_eye_x;
+    columns.left_eye_y[i] = records[i].left_eye_y;
+    columns.right_eye_x[i] = records[i].right_eye_x;
+    columns.right_eye_y[i] = records[i].right_eye_y;
+    columns.gaze_event[i] = records[i].gaze_event;
+  }
+}
+
+double GigabytesPerSecond(double nanoseconds_per_sample) {
+  return static_cast<double>(packed_sample_size) / nanoseconds_per_sample;
+}
+
+int main() {
+  const auto packed = MakePackedSamples();
+  const double legacy = MeasureRecordDecoder(
+      packed, &inseye::benchmark::legacy::readDataSample);
+  const double current =
+      MeasureRecordDecoder(packed, &inseye::internal::readDataSample);
+  std::printf("%-44s %8.3f ns/sample\n",
+              "readDataSample (runtime endianess, 0.1.0)", legacy);
+  std::printf("%-44s %8.3f ns/sample (x%.1f)\n",
+              "readDataSample (compile time endianess)", current,
+              legacy / current);
+
+  std::vector<inseye::EyeTrackerDataStruct> records(sample_count);
+  Columns reference;
+  const double transposed = MeasureNanosecondsPerSample(
+      [&] { DecodeRecordsAndTranspose(packed, records, reference); });
+  std::printf("%-44s %8.3f ns/sample %6.2f GB/s\n",
+              "readDataSample + transpose", transposed,
+              GigabytesPerSecond(transposed));
+
+  int exit_code = 0;
+  for (const auto kernel :
+       {ColumnsDecoderKernel::kScalar, ColumnsDecoderKernel::kSse41,
+        ColumnsDecoderKernel::kAvx2}) {
+    if (!inseye::internal::IsColumnsDecoderKernelSupported(kernel)) {
+      std::printf("DecodeSampleColumns [%-6s] not supported\n",
+                  inseye::internal::ToString(kernel));
+      continue;
+    }
+    Columns columns;
+    const auto view = columns.View();
+    const double nanoseconds = MeasureNanosecondsPerSample([&] {
+      inseye::internal::DecodeSampleColumns(kernel, packed.data(),
+                                            packed_sample_size, sample_count,
+                                            view, 0);
+    });
+    const bool matches = columns == reference;
+    std::printf("DecodeSampleColumns [%-6s]%16s %8.3f ns/sample %6.2f GB/s "
+                "(x%.1f)%s\n",
+                inseye::internal::ToString(kernel), "", nanoseconds,
+                GigabytesPerSecond(nanoseconds), transposed / nanoseconds,
+                matches ? "" : " MISMATCH");
+    if (!matches)
+      exit_code = 1;
+  }
+  return exit_code;
+}
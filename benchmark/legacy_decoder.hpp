@@ -0,0 +1,74 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#ifndef REMOTE_CONNECTOR_BENCHMARK_LEGACY_DECODER_HPP
+#define REMOTE_CONNECTOR_BENCHMARK_LEGACY_DECODER_HPP
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include "eye_tracker_data_struct.hpp"
+
+// Copy of sample decoding from version 0.1.0 where endianess was checked at
+// runtime and every field was read through function local std::function.
+// Kept only as baseline for decode micro benchmark.
+namespace inseye::benchmark::legacy {
+
+inline std::endian GetEndian() {
+  volatile int i = 1;
+  return (int)*(volatile unsigned char*)&i == 1 ? std::endian::little
+                                                 : std::endian::big;
+}
+
+template <typename T>
+T byteswap(const T& ref) {
+  using arr_type = std::array<std::byte, sizeof(T)>;
+  auto value_representation = std::bit_cast<arr_type, T>(ref);
+  std::ranges::reverse(value_representation);
+  return std::bit_cast<T, arr_type>(value_representation);
+}
+
+template <typename T>
+T read_swap_endianess_if_needed(const T* arg) {
+  static const std::function<T(const T*)> implementation =
+      GetEndian() == inseye::internal::LIB_ENDIAN
+          ? [](const T* arg) -> T { return *arg; }
+          : [](const T* arg) -> T { return byteswap<T>(*arg); };
+  return implementation(arg);
+}
+
+inline void readDataSample(const std::byte* offsetedMemory,
+                           inseye::EyeTrackerDataStruct& dataStruct) {
+  using inseye::internal::EyeTrackerDataStruct;
+  using time_type = decltype(EyeTrackerDataStruct::time);
+  using pos_type = decltype(EyeTrackerDataStruct::left_eye_x);
+  dataStruct.time = read_swap_endianess_if_needed<time_type>(
+      reinterpret_cast<const time_type*>(
+          offsetedMemory + offsetof(EyeTrackerDataStruct, time)));
+  dataStruct.left_eye_x = read_swap_endianess_if_needed<pos_type>(
+      reinterpret_cast<const pos_type*>(
+          offsetedMemory + offsetof(EyeTrackerDataStruct, left_eye_x)));
+  dataStruct.left_eye_y = read_swap_endianess_if_needed<pos_type>(
+      reinterpret_cast<const pos_type*>(
+          offsetedMemory + offsetof(EyeTrackerDataStruct, left_eye_y)));
+  dataStruct.right_eye_x = read_swap_endianess_if_needed<pos_type>(
+      reinterpret_cast<const pos_type*>(
+          offsetedMemory + offsetof(EyeTrackerDataStruct, right_eye_x)));
+  dataStruct.right_eye_y = read_swap_endianess_if_needed<pos_type>(
+      reinterpret_cast<const pos_type*>(
+          offsetedMemory + offsetof(EyeTrackerDataStruct, right_eye_y)));
+  auto read_value = read_swap_endianess_if_needed<uint32_t>(
+      reinterpret_cast<const uint32_t*>(
+          offsetedMemory + offsetof(EyeTrackerDataStruct, gaze_event)));
+  if (read_value >= static_cast<uint32_t>(GazeEvent::kUnknown))
+    read_value = static_cast<uint32_t>(GazeEvent::kUnknown);
+  dataStruct.gaze_event = static_cast<GazeEvent>(read_value);
+}
+
+}  // namespace inseye::benchmark::legacy
+#endif  //REMOTE_CONNECTOR_BENCHMARK_LEGACY_DECODER_HPP
@@ -0,0 +1,1457 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <coroutine>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "bench_report.hpp"
+#include "remote_connector.h"
+#include "service_simulator.hpp"
+
+using namespace inseye::benchmark;
+using namespace inseye::simulator;
+using clock_type = std::chrono::steady_clock;
+
+constexpr uint32_t ring_sample_count = 4096;
+constexpr uint32_t samples_per_round = 1024;
+constexpr auto measurement_duration = std::chrono::milliseconds(500);
+
+void FillRing(ServiceSimulator& service) {
+  for (uint32_t i = 0; i < service.SampleCount(); ++i) {
+    const float position = static_cast<float>(i) * 1e-3f;
+    service.Write({i, position, position, -position, -position,
+                   inseye::GazeEvent::kInsGazeNone});
+  }
+}
+
+// Replays ring content round by round and returns number of samples read per
+// second by read_round.
+template <typename ReadRound>
+double MeasureSamplesPerSecond(ServiceSimulator& service,
+                               inseye::EyeTracker& tracker,
+                               ReadRound&& read_round) {
+  inseye::EyeTrackerDataStruct sample{};
+  while (tracker.TryReadNextEyeTrackerData(sample)) {}  // drain backlog
+  uint64_t samples_read = 0;
+  const auto start = clock_type::now();
+  auto elapsed = clock_type::duration::zero();
+  while (elapsed < measurement_duration) {
+    service.Publish(samples_per_round);
+    samples_read += read_round(tracker);
+    elapsed = clock_type::now() - start;
+  }
+  return static_cast<double>(samples_read) /
+         std::chrono::duration<double>(elapsed).count();
+}
+
+// Writer thread publishes samples stamped with steady clock at random
+// intervals, reader blocks in WaitForEyeTrackerData and measures time from
+// publish to the moment it holds the sample.
+void MeasureWakeUpLatency(BenchReport& report, ServiceSimulator& service,
+                          bool wake_readers) {
+  constexpr int sample_count = 2000;
+  inseye::EyeTracker tracker(1000);
+  service.SetWakeReaders(wake_readers);
+  inseye::EyeTrackerDataStruct sample{};
+  while (tracker.TryReadNextEyeTrackerData(sample)) {}
+  std::thread writer([&service] {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> interval_us(200, 500);
+    for (int i = 0; i < sample_count; ++i) {
+      std::this_thread::sleep_for(
+          std::chrono::microseconds(interval_us(generator)));
+      const auto stamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             clock_type::now().time_since_epoch())
+                             .count();
+      service.Write({static_cast<uint64_t>(stamp), 0, 0, 0, 0,
+                     inseye::GazeEvent::kInsGazeNone});
+    }
+  });
+  std::vector<double> latencies_us;
+  latencies_us.reserve(sample_count);
+  while (static_cast<int>(latencies_us.size()) < sample_count &&
+         tracker.WaitForEyeTrackerData(std::chrono::seconds(1))) {
+    while (tracker.TryReadNextEyeTrackerData(sample)) {
+      const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           clock_type::now().time_since_epoch())
+                           .count();
+      latencies_us.push_back(
+          static_cast<double>(now - static_cast<int64_t>(sample.time)) /
+          1000.0);
+    }
+  }
+  writer.join();
+  service.SetWakeReaders(true);
+  const auto latency = ComputePercentiles(latencies_us);
+  std::printf("WaitForEyeTrackerData %-11s p50 %8.1f us, p99 %8.1f us, "
+              "max %8.1f us\n",
+              wake_readers ? "(doorbell)" : "(polling)", latency.p50,
+              latency.p99, latency.max);
+  report.Add(wake_readers ? "wait_wake_up_latency_doorbell"
+                          : "wait_wake_up_latency_polling",
+             ToMetrics(latency, "us"));
+}
+
+// Every field of sample is derived from its time.
+inseye::EyeTrackerDataStruct MakeStressSample(uint64_t index) {
+  const auto value = static_cast<float>(index % 65536);
+  return {index, value, -value, value * 0.5f, value * 2.0f,
+          static_cast<inseye::GazeEvent>(index % 7)};
+}
+
+// Service produces sample every millisecond of its own clock running with
+// known drift against steady clock while reader thread reads them as they
+// arrive. Converted sample times are compared with local time at which the
+// samples were due, the error includes the smallest wake up latency.
+void RunClockModelBenchmark(BenchReport& report) {
+  constexpr uint32_t sample_count = 3000;
+  constexpr double service_drift_ppm = 200.0;
+  constexpr uint64_t service_epoch_ms = 1'700'000'000'000;
+  constexpr uint32_t conversion_batch = 1024;
+  ServiceSimulator service({.ring_sample_count = ring_sample_count});
+  inseye::EyeTracker tracker(1000);
+  std::atomic<bool> running = true;
+  std::thread reader([&] {
+    inseye::EyeTrackerDataStruct sample{};
+    while (running.load(std::memory_order_relaxed))
+      if (tracker.WaitForEyeTrackerData(std::chrono::milliseconds(10)))
+        while (tracker.TryReadNextEyeTrackerData(sample)) {}
+  });
+  std::vector<uint64_t> service_times(sample_count);
+  std::vector<int64_t> due_ns(sample_count);
+  const auto start = clock_type::now();
+  for (uint32_t i = 0; i < sample_count; ++i) {
+    // sample i is due when service clock reaches i milliseconds
+    const auto due = start + std::chrono::duration_cast<clock_type::duration>(
+                                 std::chrono::duration<double, std::milli>(
+                                     i / (1.0 + service_drift_ppm * 1e-6)));
+    std::this_thread::sleep_until(due);
+    service_times[i] = service_epoch_ms + i;
+    due_ns[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    due.time_since_epoch())
+                    .count();
+    service.Write({service_times[i], 0, 0, 0, 0,
+                   inseye::GazeEvent::kInsGazeNone});
+  }
+  running = false;
+  reader.join();
+  inseye::ClockMapping mapping{};
+  const bool mapped = tracker.GetClockMapping(mapping);
+  // the model settles within a few windows, error is checked on the last
+  // third of the run
+  std::vector<std::chrono::steady_clock::time_point> local(sample_count);
+  tracker.ConvertEyeTrackerTimesToLocal(service_times, local);
+  std::vector<double> error_us;
+  for (uint32_t i = 2 * sample_count / 3; i < sample_count; ++i)
+    error_us.push_back(
+        std::abs(static_cast<double>(
+                     std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         local[i].time_since_epoch())
+                         .count() -
+                     due_ns[i]) /
+                 1e3));
+  const auto error = ComputePercentiles(error_us);
+  const double estimated_drift_ppm =
+      (1e6 / mapping.local_ns_per_ms - 1.0) * 1e6;
+
+  std::vector<std::chrono::steady_clock::time_point> converted(
+      conversion_batch);
+  constexpr uint32_t conversion_rounds = 2000;
+  const auto conversion_start = clock_type::now();
+  for (uint32_t round = 0; round < conversion_rounds; ++round)
+    tracker.ConvertEyeTrackerTimesToLocal(
+        std::span(service_times).first(conversion_batch), converted);
+  const double conversion_ns =
+      std::chrono::duration<double, std::nano>(clock_type::now() -
+                                               conversion_start)
+          .count() /
+      (static_cast<double>(conversion_rounds) * conversion_batch);
+  std::printf("Clock model %s from %llu observations: drift %+.1f ppm "
+              "(service %+.1f ppm), conversion error p50 %6.1f us, p99 "
+              "%6.1f us, max %6.1f us, %.2f ns per converted sample\n",
+              mapped ? "fitted" : "MISSING",
+              static_cast<unsigned long long>(mapping.observation_count),
+              estimated_drift_ppm, service_drift_ppm, error.p50, error.p99,
+              error.max, conversion_ns);
+  auto metrics = ToMetrics(error, "us");
+  metrics.emplace_back("estimated_drift_ppm", estimated_drift_ppm);
+  metrics.emplace_back("service_drift_ppm", service_drift_ppm);
+  metrics.emplace_back("conversion_ns_per_sample", conversion_ns);
+  report.Add("clock_model_conversion_error", std::move(metrics));
+}
+
+// Resident set size of this process in KiB (Linux only, 0 elsewhere).
+uint64_t ReadResidentSetSizeKiB() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("VmRSS:", 0) == 0)
+      return std::strtoull(line.c_str() + 6, nullptr, 10);
+  }
+  return 0;
+}
+
+// Service writes samples at given rate while recorder drains them to file made
+// of small chunks, then recording is searched.
+void RunRecorderBenchmark(BenchReport& report, uint32_t write_rate_hz,
+                          uint32_t layout = 1) {
+  constexpr auto recording_duration = std::chrono::seconds(2);
+  constexpr uint32_t chunk_size = 64 * 1024;
+  const auto path = (std::filesystem::temp_directory_path() /
+                     std::format("inseye_recorder_bench_{}.rec",
+                                 clock_type::now().time_since_epoch().count()))
+                        .string();
+  ServiceSimulator service({.ring_sample_count = ring_sample_count,
+                            .version = {layout, 0, 0}});
+  service.SetWakeReaders(true);
+  uint64_t recorded = 0, resident_growth_kib = 0;
+  {
+    const uint64_t resident_before = ReadResidentSetSizeKiB();
+    inseye::Recorder recorder(path, 1000, {chunk_size});
+    std::atomic<bool> running = true;
+    std::thread writer([&] {
+      const auto interval = std::chrono::duration_cast<clock_type::duration>(
+          std::chrono::duration<double>(1.0 / write_rate_hz));
+      auto next_write = clock_type::now();
+      while (running.load(std::memory_order_relaxed)) {
+        service.Write(MakeStressSample(service.SamplesWritten() + 1));
+        next_write += interval;
+        std::this_thread::sleep_until(next_write);
+      }
+    });
+    std::this_thread::sleep_for(recording_duration);
+    running = false;
+    writer.join();
+    resident_growth_kib = ReadResidentSetSizeKiB() - resident_before;
+  }
+  const uint64_t written = service.SamplesWritten();
+
+  constexpr int seek_count = 100000;
+  std::mt19937_64 random(7);
+  std::uniform_int_distribution<uint64_t> times(1, written);
+  uint64_t found = 0;
+  double seek_ns = 0;
+  {
+    inseye::Recording recording(path);
+    recorded = recording.GetSampleCount();
+    const auto seek_start = clock_type::now();
+    for (int i = 0; i < seek_count; ++i) {
+      uint64_t position = 0;
+      found += recording.Seek(times(random), position) ? 1 : 0;
+    }
+    seek_ns = std::chrono::duration<double, std::nano>(clock_type::now() -
+                                                       seek_start)
+                  .count() /
+              seek_count;
+  }
+  std::filesystem::remove(path);
+  std::printf("Recorder v%u %6.1f kHz writes: %8llu recorded of %8llu "
+              "written, RSS growth %llu KiB, seek %.0f ns (%llu found)\n",
+              layout, write_rate_hz / 1000.0,
+              static_cast<unsigned long long>(recorded),
+              static_cast<unsigned long long>(written),
+              static_cast<unsigned long long>(resident_growth_kib), seek_ns,
+              static_cast<unsigned long long>(found));
+  report.Add(std::format("{}recorder_{}_hz",
+                         layout == 1 ? "" : std::format("v{}_", layout),
+                         write_rate_hz),
+             {{"samples_written", static_cast<double>(written)},
+              {"samples_recorded", static_cast<double>(recorded)},
+              {"resident_growth_kib", static_cast<double>(resident_growth_kib)},
+              {"seek_ns", seek_ns}});
+}
+
+// Cost of reading steady clock twice, subtracted from every timed call.
+double MeasureTimerOverheadNs() {
+  std::vector<double> deltas_ns(100000);
+  for (auto& delta_ns : deltas_ns) {
+    const auto start = clock_type::now();
+    delta_ns = std::chrono::duration<double, std::nano>(clock_type::now() -
+                                                        start)
+                   .count();
+  }
+  return ComputePercentiles(deltas_ns).p50;
+}
+
+// Times every call separately, prepare runs before each call outside of
+// measured time. Calls that return false are counted in failures.
+template <typename Prepare, typename Call>
+Percentiles MeasureCallLatency(double timer_overhead_ns, uint32_t iterations,
+                               Prepare&& prepare, Call&& call,
+                               uint32_t& failures) {
+  std::vector<double> latencies_ns(iterations);
+  failures = 0;
+  for (auto& latency_ns : latencies_ns) {
+    prepare();
+    const auto start = clock_type::now();
+    const bool success = call();
+    const auto end = clock_type::now();
+    failures += success ? 0 : 1;
+    latency_ns = (std::max)(
+        0.0,
+        std::chrono::duration<double, std::nano>(end - start).count() -
+            timer_overhead_ns);
+  }
+  return ComputePercentiles(latencies_ns);
+}
+
+void ReportCallLatency(BenchReport& report, const char* name,
+                       const Percentiles& latency, uint32_t iterations,
+                       uint32_t failures) {
+  std::printf("%-36s p50 %7.1f ns, p99 %7.1f ns, p99.9 %7.1f ns, "
+              "max %9.1f ns\n",
+              name, latency.p50, latency.p99, latency.p999, latency.max);
+  auto metrics = ToMetrics(latency, "ns");
+  metrics.emplace_back("success_rate",
+                       static_cast<double>(iterations - failures) / iterations);
+  report.Add(name, std::move(metrics));
+}
+
+// Latency of single read calls in states reader meets in practice: one new
+// sample, no new samples, few samples behind and rereading current sample.
+void RunCallLatencyBenchmarks(BenchReport& report, ServiceSimulator& service,
+                              double timer_overhead_ns) {
+  constexpr uint32_t iterations = 200000;
+  constexpr uint32_t latest_backlog = 8;
+  inseye::EyeTracker tracker(1000);
+  service.SetWakeReaders(false);
+  inseye::EyeTrackerDataStruct sample{};
+  while (tracker.TryReadNextEyeTrackerData(sample)) {}
+  uint32_t failures = 0;
+  auto latency = MeasureCallLatency(
+      timer_overhead_ns, iterations, [&] { service.Publish(1); },
+      [&] { return tracker.TryReadNextEyeTrackerData(sample); }, failures);
+  ReportCallLatency(report, "read_next_latency", latency, iterations,
+                    failures);
+  latency = MeasureCallLatency(
+      timer_overhead_ns, iterations, [] {},
+      [&] { return !tracker.TryReadNextEyeTrackerData(sample); }, failures);
+  ReportCallLatency(report, "read_next_no_data_latency", latency, iterations,
+                    failures);
+  latency = MeasureCallLatency(
+      timer_overhead_ns, iterations, [&] { service.Publish(latest_backlog); },
+      [&] { return tracker.TryReadLatestEyeTrackerData(sample); }, failures);
+  ReportCallLatency(report, "read_latest_latency", latency, iterations,
+                    failures);
+  latency = MeasureCallLatency(
+      timer_overhead_ns, iterations, [] {},
+      [&] { return tracker.TryReadLastEyeTrackerData(sample); }, failures);
+  ReportCallLatency(report, "read_last_latency", latency, iterations,
+                    failures);
+  service.SetWakeReaders(true);
+}
+
+// Writer laps the reader by two whole rings before every call, the call has
+// to notice the overrun and skip to the oldest intact sample. Steady state
+// batch read of the same size is measured for comparison.
+void RunOverrunRecoveryBenchmark(BenchReport& report, ServiceSimulator& service,
+                                 double timer_overhead_ns) {
+  constexpr uint32_t iterations = 20000;
+  constexpr uint32_t batch_size = 256;
+  inseye::EyeTracker tracker(1000);
+  service.SetWakeReaders(false);
+  std::vector<inseye::EyeTrackerDataStruct> buffer(batch_size);
+  inseye::EyeTrackerDataStruct sample{};
+  while (tracker.TryReadNextEyeTrackerData(sample)) {}
+  const uint32_t lap = 2 * service.SampleCount();
+  uint32_t failures = 0, count = 0;
+  const auto next = MeasureCallLatency(
+      timer_overhead_ns, iterations, [&] { service.Publish(lap); },
+      [&] { return tracker.TryReadNextEyeTrackerData(sample); }, failures);
+  ReportCallLatency(report, "overrun_recovery_next_latency", next, iterations,
+                    failures);
+  const auto batch = MeasureCallLatency(
+      timer_overhead_ns, iterations, [&] { service.Publish(lap); },
+      [&] { return tracker.TryReadEyeTrackerDataBatch(buffer, count); },
+      failures);
+  ReportCallLatency(report, "overrun_recovery_batch_latency", batch,
+                    iterations, failures);
+  // reader that keeps up, the same amount of data without overrun
+  const auto steady = MeasureCallLatency(
+      timer_overhead_ns, iterations,
+      [&] {
+        while (tracker.TryReadEyeTrackerDataBatch(buffer, count)) {}
+        service.Publish(batch_size);
+      },
+      [&] { return tracker.TryReadEyeTrackerDataBatch(buffer, count); },
+      failures);
+  ReportCallLatency(report, "steady_batch_latency", steady, iterations,
+                    failures);
+  std::printf("Overrun recovery extra cost of batch read p50 %.1f ns\n",
+              batch.p50 - steady.p50);
+  report.Add("overrun_recovery_batch_extra_cost",
+             {{"p50_ns", batch.p50 - steady.p50},
+              {"p99_ns", batch.p99 - steady.p99}});
+  inseye::ReaderStatistics statistics{};
+  if (tracker.GetReaderStatistics(statistics)) {
+    // every lap of two rings drops all but the oldest intact samples
+    std::printf("Reader statistics: %llu delivered, %llu dropped in %llu "
+                "overruns, %llu retries\n",
+                static_cast<unsigned long long>(statistics.samples_delivered),
+                static_cast<unsigned long long>(statistics.samples_dropped),
+                static_cast<unsigned long long>(statistics.overrun_count),
+                static_cast<unsigned long long>(statistics.read_retries));
+    report.Add("overrun_recovery_statistics",
+               {{"samples_delivered",
+                 static_cast<double>(statistics.samples_delivered)},
+                {"samples_dropped",
+                 static_cast<double>(statistics.samples_dropped)},
+                {"overrun_count", static_cast<double>(statistics.overrun_count)},
+                {"expected_overrun_count", 2.0 * iterations}});
+  }
+  service.SetWakeReaders(true);
+}
+
+// Ring holding one sample per millisecond, two rings were written so the
+// oldest slots are being reused. Time queries anywhere among intact samples
+// are timed.
+void RunTimeQueryBenchmark(BenchReport& report, double timer_overhead_ns) {
+  constexpr uint32_t iterations = 200000;
+  constexpr uint64_t service_epoch_ms = 1'700'000'000'000;
+  constexpr uint32_t range_length_ms = 64;
+  ServiceSimulator service({.ring_sample_count = ring_sample_count});
+  const uint32_t written = 2 * service.SampleCount();
+  for (uint32_t i = 0; i < written; ++i) {
+    const auto position = static_cast<float>(i);
+    service.Write({service_epoch_ms + i, position, -position, position,
+                   -position, inseye::GazeEvent::kInsGazeNone});
+  }
+  // OldestIntactSampleIndex of the written ring, counted from 0
+  const uint32_t oldest = written - (service.SampleCount() - 1);
+  inseye::EyeTracker tracker(1000);
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> offset_ms(oldest, written - 1);
+  double query = 0;
+  inseye::EyeTrackerDataStruct sample{};
+  const auto prepare = [&] {
+    query = static_cast<double>(service_epoch_ms) + offset_ms(generator);
+  };
+  uint32_t failures = 0;
+  const auto nearest = MeasureCallLatency(
+      timer_overhead_ns, iterations, prepare,
+      [&] {
+        return tracker.TryReadEyeTrackerDataAt(
+            query, inseye::TimeQueryMode::kInsTimeQueryNearest, sample);
+      },
+      failures);
+  ReportCallLatency(report, "read_at_nearest_latency", nearest, iterations,
+                    failures);
+  const auto interpolated = MeasureCallLatency(
+      timer_overhead_ns, iterations, prepare,
+      [&] {
+        return tracker.TryReadEyeTrackerDataAt(
+            query, inseye::TimeQueryMode::kInsTimeQueryInterpolate, sample);
+      },
+      failures);
+  ReportCallLatency(report, "read_at_interpolate_latency", interpolated,
+                    iterations, failures);
+
+  std::vector<inseye::EyeTrackerDataStruct> range(range_length_ms);
+  uint32_t count = 0;
+  uint64_t begin = 0;
+  const auto ranged = MeasureCallLatency(
+      timer_overhead_ns, iterations / 10,
+      [&] {
+        begin = service_epoch_ms +
+                static_cast<uint64_t>(offset_ms(generator)) - range_length_ms;
+        begin = (std::max)(begin, service_epoch_ms + oldest);
+      },
+      [&] {
+        return tracker.ReadEyeTrackerDataRange(begin, begin + range_length_ms,
+                                               range, count);
+      },
+      failures);
+  ReportCallLatency(report, "read_range_64_latency", ranged, iterations / 10,
+                    failures);
+}
+
+// Gaze is written sample by sample and predicted 20 ms ahead at 90 Hz frame
+// rate, prediction error is compared with holding the newest sample. Sample
+// of saccade or blink at predicted time is not counted, these can't be
+// predicted from the preceding samples.
+struct PredictionError {
+  double predicted_rms_rad;
+  double held_rms_rad;
+  double mean_confidence;
+  uint32_t predictions;
+};
+
+template <typename MakeSample>
+PredictionError MeasurePredictionError(MakeSample&& make_sample,
+                                       uint32_t sample_count) {
+  constexpr uint64_t service_epoch_ms = 1'700'000'000'000;
+  constexpr uint32_t frame_period_ms = 11;
+  constexpr uint32_t horizon_ms = 20;
+  ServiceSimulator service({.ring_sample_count = ring_sample_count});
+  inseye::EyeTracker tracker(1000);
+  std::vector<inseye::EyeTrackerDataStruct> samples(sample_count);
+  for (uint32_t i = 0; i < sample_count; ++i)
+    samples[i] = make_sample(service_epoch_ms + i);
+  double predicted_error = 0, held_error = 0, confidence = 0;
+  uint32_t predictions = 0;
+  const auto squared_distance = [](const inseye::EyeTrackerDataStruct& truth,
+                                   float left_x, float left_y, float right_x,
+                                   float right_y) {
+    const double dx0 = truth.left_eye_x - left_x;
+    const double dy0 = truth.left_eye_y - left_y;
+    const double dx1 = truth.right_eye_x - right_x;
+    const double dy1 = truth.right_eye_y - right_y;
+    return (dx0 * dx0 + dy0 * dy0 + dx1 * dx1 + dy1 * dy1) / 2;
+  };
+  for (uint32_t i = 0; i + horizon_ms < sample_count; ++i) {
+    service.Write(samples[i]);
+    if (i % frame_period_ms != 0)
+      continue;
+    inseye::GazePrediction prediction{};
+    if (!tracker.PredictGaze(
+            static_cast<double>(samples[i].time + horizon_ms), prediction))
+      continue;
+    const auto& held = samples[i];
+    const auto& truth = samples[i + horizon_ms];
+    if (truth.gaze_event != inseye::GazeEvent::kInsGazeNone ||
+        held.gaze_event != inseye::GazeEvent::kInsGazeNone)
+      continue;
+    predicted_error +=
+        squared_distance(truth, prediction.left_eye_x, prediction.left_eye_y,
+                         prediction.right_eye_x, prediction.right_eye_y);
+    held_error += squared_distance(truth, held.left_eye_x, held.left_eye_y,
+                                   held.right_eye_x, held.right_eye_y);
+    confidence += prediction.confidence;
+    ++predictions;
+  }
+  return {std::sqrt(predicted_error / predictions),
+          std::sqrt(held_error / predictions), confidence / predictions,
+          predictions};
+}
+
+void RunGazePredictionBenchmark(BenchReport& report,
+                                double timer_overhead_ns) {
+  constexpr uint32_t sample_count = 60000;
+  constexpr double radians_to_degrees = 57.29577951308232;
+  GazeModel model({});
+  const auto simulated = MeasurePredictionError(
+      [&model](uint64_t time) { return model.Next(time); }, sample_count);
+  // smooth pursuit of target moving on circle at up to 36 deg/s with the
+  // fixation noise of simulated gaze
+  std::mt19937 generator(3);
+  std::normal_distribution<float> noise(0.0f, 0.0015f);
+  const auto pursuit = MeasurePredictionError(
+      [&](uint64_t time) {
+        const double phase = static_cast<double>(time % 2000) / 2000.0 *
+                             2.0 * 3.14159265358979323846;
+        const auto x = static_cast<float>(0.2 * std::cos(phase));
+        const auto y = static_cast<float>(0.2 * std::sin(phase));
+        return inseye::EyeTrackerDataStruct{
+            time,          x + 0.03f + noise(generator), y + noise(generator),
+            x - 0.03f + noise(generator), y + noise(generator),
+            inseye::GazeEvent::kInsGazeNone};
+      },
+      sample_count);
+  for (const auto& [name, error] :
+       {std::pair{"simulated_gaze", simulated}, std::pair{"pursuit", pursuit}}) {
+    std::printf("Gaze prediction 20 ms ahead, %-14s: error %.3f deg, holding "
+                "newest sample %.3f deg, mean confidence %.2f (%u frames)\n",
+                name, error.predicted_rms_rad * radians_to_degrees,
+                error.held_rms_rad * radians_to_degrees, error.mean_confidence,
+                error.predictions);
+    report.Add(std::format("gaze_prediction_error_{}", name),
+               {{"predicted_rms_deg",
+                 error.predicted_rms_rad * radians_to_degrees},
+                {"held_rms_deg", error.held_rms_rad * radians_to_degrees},
+                {"mean_confidence", error.mean_confidence}});
+  }
+
+  // cost of the frame's first call feeding one frame of samples and of
+  // repeated calls without new samples
+  constexpr uint32_t iterations = 100000;
+  constexpr uint32_t samples_per_frame = 11;
+  ServiceSimulator service({.ring_sample_count = ring_sample_count});
+  FillRing(service);
+  inseye::EyeTracker tracker(1000);
+  inseye::GazePrediction prediction{};
+  uint32_t failures = 0;
+  const auto feeding = MeasureCallLatency(
+      timer_overhead_ns, iterations,
+      [&] { service.Publish(samples_per_frame); },
+      [&] { return tracker.PredictGaze(1e12, prediction); }, failures);
+  ReportCallLatency(report, "predict_gaze_new_frame_latency", feeding,
+                    iterations, failures);
+  const auto repeated = MeasureCallLatency(
+      timer_overhead_ns, iterations, [] {},
+      [&] { return tracker.PredictGaze(1e12, prediction); }, failures);
+  ReportCallLatency(report, "predict_gaze_repeated_latency", repeated,
+                    iterations, failures);
+}
+
+// Simulated gaze without the service's saccade flags is classified while it
+// is written, saccades found by velocity are matched with saccades the model
+// generated. Saccades shorter than the velocity window moves gaze across the
+// threshold (about 0.6 deg) are not expected to be found. Classification
+// throughput is measured on replayed ring content. Amplitude error is
+// measured on found saccades overlapping single generated one, saccades that
+// follow each other closer than the velocity window are found as one.
+void RunGazeClassificationBenchmark(BenchReport& report) {
+  constexpr uint64_t service_epoch_ms = 1'700'000'000'000;
+  constexpr uint32_t sample_count = 120000;
+  constexpr uint32_t pull_period = 256;
+  constexpr double radians_to_degrees = 57.29577951308232;
+  constexpr float minimum_amplitude = 0.01745f;
+  struct TrueSaccade {
+    uint64_t start, end;
+    float amplitude;
+    // false when cut by blink, landing is not visible
+    bool visible;
+  };
+  GazeModel model({});
+  std::vector<inseye::EyeTrackerDataStruct> samples(sample_count);
+  for (uint32_t i = 0; i < sample_count; ++i)
+    samples[i] = model.Next(service_epoch_ms + i);
+  const auto cyclopean = [](const inseye::EyeTrackerDataStruct& sample) {
+    return std::pair{(sample.left_eye_x + sample.right_eye_x) / 2,
+                     (sample.left_eye_y + sample.right_eye_y) / 2};
+  };
+  std::vector<TrueSaccade> true_saccades;
+  uint32_t true_blinks = 0;
+  for (uint32_t i = 1; i + 1 < sample_count; ++i) {
+    if (samples[i].gaze_event == inseye::GazeEvent::kInsGazeBlinkBoth &&
+        samples[i - 1].gaze_event != inseye::GazeEvent::kInsGazeBlinkBoth)
+      ++true_blinks;
+    if (samples[i].gaze_event != inseye::GazeEvent::kInsGazeSaccade ||
+        samples[i - 1].gaze_event == inseye::GazeEvent::kInsGazeSaccade)
+      continue;
+    uint32_t end = i;
+    while (end < sample_count &&
+           samples[end].gaze_event == inseye::GazeEvent::kInsGazeSaccade)
+      ++end;
+    if (end == sample_count)
+      break;
+    const auto [x0, y0] = cyclopean(samples[i - 1]);
+    const auto [x1, y1] = cyclopean(samples[end]);
+    true_saccades.push_back(
+        {samples[i].time, samples[end].time, std::hypot(x1 - x0, y1 - y0),
+         samples[i - 1].gaze_event == inseye::GazeEvent::kInsGazeNone &&
+             samples[end].gaze_event == inseye::GazeEvent::kInsGazeNone});
+  }
+
+  std::vector<inseye::GazeSegment> segments;
+  {
+    ServiceSimulator service({.ring_sample_count = ring_sample_count});
+    inseye::EyeTracker tracker(1000);
+    tracker.StartGazeClassification();
+    std::array<inseye::GazeSegment, 64> buffer{};
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < sample_count; ++i) {
+      auto sample = samples[i];
+      if (sample.gaze_event == inseye::GazeEvent::kInsGazeSaccade)
+        sample.gaze_event = inseye::GazeEvent::kInsGazeNone;
+      service.Write(sample);
+      if (i % pull_period == pull_period - 1)
+        while (tracker.TryReadGazeSegments(buffer, count))
+          segments.insert(segments.end(), buffer.begin(),
+                          buffer.begin() + count);
+    }
+  }
+  uint32_t counts[4] = {}, truncated = 0;
+  double fixation_duration = 0;
+  std::vector<const inseye::GazeSegment*> found_saccades;
+  for (const auto& segment : segments) {
+    ++counts[segment.type];
+    if (segment.flags & inseye::GazeSegmentFlags::kInsSegmentTruncated)
+      ++truncated;
+    if (segment.type == inseye::GazeSegmentType::kInsSegmentFixation)
+      fixation_duration += segment.duration_ms;
+    if (segment.type == inseye::GazeSegmentType::kInsSegmentSaccade)
+      found_saccades.push_back(&segment);
+  }
+  const auto overlapping = [&](const inseye::GazeSegment& found) {
+    const uint64_t start = found.start_time;
+    const uint64_t end = start + found.duration_ms;
+    return std::count_if(true_saccades.begin(), true_saccades.end(),
+                         [&](const TrueSaccade& saccade) {
+                           return saccade.start < end && start < saccade.end;
+                         });
+  };
+  // saccades are matched in time order, found saccade overlapping true one
+  uint32_t expected = 0, matched = 0, measured = 0, false_saccades = 0;
+  double amplitude_error = 0;
+  size_t next_found = 0;
+  std::vector<bool> used(found_saccades.size(), false);
+  for (const auto& saccade : true_saccades) {
+    while (next_found < found_saccades.size() &&
+           found_saccades[next_found]->start_time +
+                   found_saccades[next_found]->duration_ms <=
+               saccade.start)
+      ++next_found;
+    if (!saccade.visible || saccade.amplitude < minimum_amplitude)
+      continue;
+    ++expected;
+    if (next_found < found_saccades.size() &&
+        found_saccades[next_found]->start_time < saccade.end) {
+      ++matched;
+      used[next_found] = true;
+      if (overlapping(*found_saccades[next_found]) == 1) {
+        amplitude_error += std::abs(found_saccades[next_found]->amplitude -
+                                    saccade.amplitude);
+        ++measured;
+      }
+    }
+  }
+  // unmatched saccade overlapping saccade below 1 deg is not false
+  for (size_t i = 0; i < found_saccades.size(); ++i)
+    false_saccades += !used[i] && overlapping(*found_saccades[i]) == 0 ? 1 : 0;
+  const double recall = static_cast<double>(matched) / expected;
+  const double mean_amplitude_error =
+      measured == 0 ? 0 : amplitude_error / measured * radians_to_degrees;
+  const double mean_fixation_ms =
+      counts[inseye::GazeSegmentType::kInsSegmentFixation] == 0
+          ? 0
+          : fixation_duration /
+                counts[inseye::GazeSegmentType::kInsSegmentFixation];
+  std::printf("Gaze classification of %u simulated samples: %u fixations "
+              "(mean %.0f ms), %u saccades, %u blinks (%u generated), %u "
+              "unclassified, %u truncated\n",
+              sample_count,
+              counts[inseye::GazeSegmentType::kInsSegmentFixation],
+              mean_fixation_ms,
+              counts[inseye::GazeSegmentType::kInsSegmentSaccade],
+              counts[inseye::GazeSegmentType::kInsSegmentBlink], true_blinks,
+              counts[inseye::GazeSegmentType::kInsSegmentUnclassified],
+              truncated);
+  std::printf("  saccades above 1 deg found %u / %u (%.1f%%), %u false, mean "
+              "amplitude error %.3f deg (%u separate saccades)\n",
+              matched, expected, recall * 100, false_saccades,
+              mean_amplitude_error, measured);
+
+  ServiceSimulator service({.ring_sample_count = ring_sample_count});
+  for (uint32_t i = 0; i < service.SampleCount(); ++i)
+    service.Write(samples[i]);
+  inseye::EyeTracker tracker(1000);
+  tracker.StartGazeClassification();
+  const double throughput = MeasureSamplesPerSecond(
+      service, tracker, [](inseye::EyeTracker& classified) {
+        std::array<inseye::GazeSegment, 64> buffer{};
+        uint32_t count = 0;
+        while (classified.TryReadGazeSegments(buffer, count)) {}
+        return samples_per_round;
+      });
+  std::printf("  classification %.0f samples/s (%.1f ns per sample)\n",
+              throughput, 1e9 / throughput);
+  report.Add("gaze_classification",
+             {{"fixations",
+               static_cast<double>(
+                   counts[inseye::GazeSegmentType::kInsSegmentFixation])},
+              {"mean_fixation_ms", mean_fixation_ms},
+              {"saccade_recall", recall},
+              {"false_saccades", static_cast<double>(false_saccades)},
+              {"amplitude_error_deg", mean_amplitude_error},
+              {"samples_per_second", throughput}});
+}
+
+// Smooth pursuit with fixation noise and single sample spikes is read
+// through filter chains, filtered error against noiseless gaze is compared
+// with raw error. Throughput of filtered batch reads is measured on replayed
+// ring content.
+void RunFilterChainBenchmark(BenchReport& report, ServiceSimulator& service) {
+  constexpr uint32_t sample_count = 16384;
+  constexpr uint32_t warm_up = 256;
+  constexpr uint32_t spike_period = 97;
+  constexpr double radians_to_degrees = 57.29577951308232;
+  using inseye::FilterType;
+  const std::pair<const char*, std::vector<inseye::FilterStage>> chains[] = {
+      {"ema", {{.type = FilterType::kInsFilterExponentialMovingAverage,
+                .alpha = 0.2f}}},
+      {"one_euro", {{.type = FilterType::kInsFilterOneEuro,
+                     .min_cutoff_hz = 5.0f,
+                     .beta = 10.0f}}},
+      {"median_5", {{.type = FilterType::kInsFilterMedian, .window = 5}}},
+      {"outlier_median_one_euro",
+       {{.type = FilterType::kInsFilterOutlierRejection,
+         .max_jump = 0.02f,
+         .max_rejected = 2},
+        {.type = FilterType::kInsFilterMedian, .window = 3},
+        {.type = FilterType::kInsFilterOneEuro,
+         .min_cutoff_hz = 5.0f,
+         .beta = 10.0f}}}};
+  std::mt19937 generator(11);
+  std::normal_distribution<float> noise(0.0f, 0.0015f);
+  std::vector<inseye::EyeTrackerDataStruct> truth(sample_count),
+      noisy(sample_count);
+  for (uint32_t i = 0; i < sample_count; ++i) {
+    const double phase = static_cast<double>(i % 2000) / 2000.0 * 2.0 *
+                         3.14159265358979323846;
+    const auto x = static_cast<float>(0.2 * std::cos(phase));
+    const auto y = static_cast<float>(0.2 * std::sin(phase));
+    truth[i] = {i, x + 0.03f, y, x - 0.03f, y,
+                inseye::GazeEvent::kInsGazeNone};
+    noisy[i] = truth[i];
+    noisy[i].left_eye_x += noise(generator);
+    noisy[i].left_eye_y += noise(generator);
+    noisy[i].right_eye_x += noise(generator);
+    noisy[i].right_eye_y += noise(generator);
+    if (i % spike_period == 0)
+      noisy[i].left_eye_x += 0.1f;
+  }
+  const auto rms_error = [&](const std::vector<inseye::EyeTrackerDataStruct>&
+                                 samples) {
+    double sum = 0;
+    for (uint32_t i = warm_up; i < sample_count; ++i) {
+      const double dx = samples[i].left_eye_x - truth[i].left_eye_x;
+      const double dy = samples[i].left_eye_y - truth[i].left_eye_y;
+      sum += dx * dx + dy * dy;
+    }
+    return std::sqrt(sum / (sample_count - warm_up)) * radians_to_degrees;
+  };
+  const double raw_error = rms_error(noisy);
+  const auto read_round = [](inseye::EyeTracker& tracker) {
+    static std::vector<inseye::EyeTrackerDataStruct> raw_buffer(
+        samples_per_round),
+        filtered_buffer(samples_per_round);
+    uint32_t count = 0, total = 0;
+    while (tracker.TryReadFilteredEyeTrackerDataBatch(
+        raw_buffer, filtered_buffer, count))
+      total += count;
+    return total;
+  };
+  inseye::EyeTracker plain(1000);
+  const double unfiltered = MeasureSamplesPerSecond(service, plain, read_round);
+  std::printf("Filter chains, raw error %.3f deg, batch read without chain "
+              "%.0f samples/s\n",
+              raw_error, unfiltered);
+  for (const auto& [name, stages] : chains) {
+    // accuracy on samples written while the reader keeps up
+    inseye::EyeTracker tracker(1000);
+    inseye::EyeTrackerDataStruct sample{};
+    while (tracker.TryReadNextEyeTrackerData(sample)) {}
+    tracker.SetFilterChain(stages);
+    std::vector<inseye::EyeTrackerDataStruct> raw(sample_count),
+        filtered(sample_count);
+    uint32_t read = 0, count = 0;
+    for (uint32_t i = 0; i < sample_count; ++i) {
+      service.Write(noisy[i]);
+      if (i % 512 == 511 || i + 1 == sample_count)
+        while (tracker.TryReadFilteredEyeTrackerDataBatch(
+            std::span(raw).subspan(read), std::span(filtered).subspan(read),
+            count))
+          read += count;
+    }
+    const double filtered_error = rms_error(filtered);
+
+    inseye::EyeTracker replay(1000);
+    replay.SetFilterChain(stages);
+    const double throughput =
+        MeasureSamplesPerSecond(service, replay, read_round);
+    std::printf("  %-24s error %.3f deg, %.0f samples/s (%.1f ns per sample "
+                "over plain batch read)\n",
+                name, filtered_error, throughput,
+                (1e9 / throughput - 1e9 / unfiltered));
+    report.Add(std::format("filter_chain_{}", name),
+               {{"raw_rms_deg", raw_error},
+                {"filtered_rms_deg", filtered_error},
+                {"samples_per_second", throughput}});
+  }
+}
+
+// Same reads through C API and through C++ wrapper, two readers of the same
+// ring take turns so that both see identical data and cache state.
+void RunApiOverheadBenchmark(BenchReport& report, ServiceSimulator& service) {
+  constexpr uint32_t rounds = 4000;
+  constexpr uint32_t reads_per_round = 256;
+  inseye::c::InseyeEyeTracker* c_tracker = nullptr;
+  if (inseye::c::CreateEyeTrackerReader(&c_tracker, 1000) !=
+      inseye::c::InseyeInitializationStatus::kSuccess) {
+    std::printf("C API reader creation failed: %s\n",
+                inseye::c::GetLastErrorDescription());
+    return;
+  }
+  inseye::EyeTracker cpp_tracker(1000);
+  service.SetWakeReaders(false);
+  inseye::EyeTrackerDataStruct sample{};
+  while (inseye::c::TryReadNextEyeTrackerData(c_tracker, &sample)) {}
+  while (cpp_tracker.TryReadNextEyeTrackerData(sample)) {}
+  std::vector<double> c_ns, cpp_ns;
+  c_ns.reserve(rounds);
+  cpp_ns.reserve(rounds);
+  auto time_per_call = [](auto&& read) {
+    const auto start = clock_type::now();
+    for (uint32_t i = 0; i < reads_per_round; ++i)
+      read();
+    return std::chrono::duration<double, std::nano>(clock_type::now() - start)
+               .count() /
+           reads_per_round;
+  };
+  for (uint32_t round = 0; round < rounds; ++round) {
+    service.Publish(reads_per_round);
+    auto c_read = [&] {
+      inseye::c::TryReadNextEyeTrackerData(c_tracker, &sample);
+    };
+    auto cpp_read = [&] { cpp_tracker.TryReadNextEyeTrackerData(sample); };
+    if (round % 2 == 0) {
+      c_ns.push_back(time_per_call(c_read));
+      cpp_ns.push_back(time_per_call(cpp_read));
+    } else {
+      cpp_ns.push_back(time_per_call(cpp_read));
+      c_ns.push_back(time_per_call(c_read));
+    }
+  }
+  inseye::c::DestroyEyeTrackerReader(&c_tracker);
+  service.SetWakeReaders(true);
+  const double c_per_call = ComputePercentiles(c_ns).p50;
+  const double cpp_per_call = ComputePercentiles(cpp_ns).p50;
+  std::printf("TryReadNextEyeTrackerData per call: c %.2f ns, c++ %.2f ns "
+              "(%+.2f ns)\n",
+              c_per_call, cpp_per_call, cpp_per_call - c_per_call);
+  report.Add("api_overhead_read_next",
+             {{"c_ns_per_call", c_per_call},
+              {"cpp_ns_per_call", cpp_per_call},
+              {"cpp_minus_c_ns", cpp_per_call - c_per_call}});
+}
+
+// Cursor creation cost, compared with full reader creation in startup
+// benchmark.
+void RunCursorBenchmark(BenchReport& report, double timer_overhead_ns) {
+  constexpr uint32_t iterations = 100000;
+  inseye::c::InseyeEyeTracker* tracker = nullptr;
+  if (inseye::c::CreateEyeTrackerReader(&tracker, 1000) !=
+      inseye::c::InseyeInitializationStatus::kSuccess) {
+    std::printf("C API reader creation failed: %s\n",
+                inseye::c::GetLastErrorDescription());
+    return;
+  }
+  inseye::c::InseyeCursor* cursor = nullptr;
+  uint32_t failures = 0;
+  const auto create = MeasureCallLatency(
+      timer_overhead_ns, iterations,
+      [&] { inseye::c::DestroyEyeTrackerCursor(&cursor); },
+      [&] {
+        return inseye::c::CreateEyeTrackerCursor(tracker, &cursor) ==
+               inseye::c::InseyeInitializationStatus::kSuccess;
+      },
+      failures);
+  inseye::c::DestroyEyeTrackerCursor(&cursor);
+  inseye::c::DestroyEyeTrackerReader(&tracker);
+  ReportCallLatency(report, "create_cursor_latency", create, iterations,
+                    failures);
+}
+
+// Reader creation followed by destruction. Cold creation does handshake over
+// service endpoint, opens and maps shared memory and validates header, warm
+// creation reuses cached session without talking to the service.
+void MeasureReaderStartup(BenchReport& report, bool cold) {
+  constexpr uint32_t iterations = 500;
+  std::vector<double> create_us, destroy_us;
+  create_us.reserve(iterations);
+  destroy_us.reserve(iterations);
+  for (uint32_t i = 0; i < iterations; ++i) {
+    inseye::c::InseyeEyeTracker* tracker = nullptr;
+    const auto start = clock_type::now();
+    const auto status = inseye::c::CreateEyeTrackerReader(&tracker, 1000);
+    const auto created = clock_type::now();
+    if (status != inseye::c::InseyeInitializationStatus::kSuccess) {
+      std::printf("CreateEyeTrackerReader failed: %s\n",
+                  inseye::c::GetLastErrorDescription());
+      return;
+    }
+    // cold destruction releases the session with the last reader
+    if (cold)
+      inseye::c::ReleaseServiceConnectionCache();
+    inseye::c::DestroyEyeTrackerReader(&tracker);
+    const auto destroyed = clock_type::now();
+    create_us.push_back(
+        std::chrono::duration<double, std::micro>(created - start).count());
+    destroy_us.push_back(
+        std::chrono::duration<double, std::micro>(destroyed - created).count());
+  }
+  const auto create = ComputePercentiles(create_us);
+  const auto destroy = ComputePercentiles(destroy_us);
+  const char* kind = cold ? "cold" : "warm";
+  std::printf("CreateEyeTrackerReader  %s p50 %8.1f us, p99 %8.1f us, "
+              "max %8.1f us\n",
+              kind, create.p50, create.p99, create.max);
+  std::printf("DestroyEyeTrackerReader %s p50 %8.1f us, p99 %8.1f us, "
+              "max %8.1f us\n",
+              kind, destroy.p50, destroy.p99, destroy.max);
+  report.Add(std::format("create_reader_{}_latency", kind),
+             ToMetrics(create, "us"));
+  report.Add(std::format("destroy_reader_{}_latency", kind),
+             ToMetrics(destroy, "us"));
+}
+
+void RunStartupBenchmark(BenchReport& report) {
+  MeasureReaderStartup(report, true);
+  MeasureReaderStartup(report, false);
+}
+
+// Asynchronous reader creation: time the calling thread is blocked starting
+// the operation, time until reader is ready and time until cancelled
+// operation stops.
+void RunAsyncCreationBenchmark(BenchReport& report) {
+  constexpr uint32_t iterations = 200;
+  std::vector<double> start_us, complete_us, cancel_us;
+  for (uint32_t i = 0; i < iterations; ++i) {
+    // cold creation, the one that may stall on service discovery
+    inseye::c::ReleaseServiceConnectionCache();
+    inseye::c::InseyeAsyncOperation* operation = nullptr;
+    const auto start = clock_type::now();
+    if (inseye::c::CreateEyeTrackerReaderAsync(&operation, 1000) !=
+        inseye::c::InseyeInitializationStatus::kSuccess) {
+      std::printf("CreateEyeTrackerReaderAsync failed: %s\n",
+                  inseye::c::GetLastErrorDescription());
+      return;
+    }
+    const auto started = clock_type::now();
+    start_us.push_back(
+        std::chrono::duration<double, std::micro>(started - start).count());
+    if (i % 2 == 0) {
+      inseye::c::WaitForAsyncOperation(operation, 1000);
+      complete_us.push_back(std::chrono::duration<double, std::micro>(
+                                clock_type::now() - start)
+                                .count());
+      inseye::c::InseyeEyeTracker* tracker = nullptr;
+      inseye::c::GetEyeTrackerReaderAsyncResult(operation, &tracker);
+      inseye::c::DestroyEyeTrackerReader(&tracker);
+    } else {
+      // cancellation may come after the reader was already created
+      const auto cancel = clock_type::now();
+      inseye::c::CancelAsyncOperation(operation);
+      inseye::c::WaitForAsyncOperation(operation, 1000);
+      cancel_us.push_back(std::chrono::duration<double, std::micro>(
+                              clock_type::now() - cancel)
+                              .count());
+    }
+    inseye::c::DestroyAsyncOperation(&operation);
+  }
+  const auto start = ComputePercentiles(start_us);
+  const auto complete = ComputePercentiles(complete_us);
+  const auto cancel = ComputePercentiles(cancel_us);
+  std::printf("CreateEyeTrackerReaderAsync call p50 %6.1f us, p99 %6.1f us, "
+              "reader ready p50 %6.1f us, cancelled stop p50 %6.1f us\n",
+              start.p50, start.p99, complete.p50, cancel.p50);
+  report.Add("create_reader_async_call_latency", ToMetrics(start, "us"));
+  report.Add("create_reader_async_ready_latency", ToMetrics(complete, "us"));
+  report.Add("create_reader_async_cancel_latency", ToMetrics(cancel, "us"));
+}
+
+// Push delivery: time from publication to callback on dispatcher thread.
+void RunSubscriptionBenchmark(BenchReport& report, ServiceSimulator& service) {
+  constexpr uint32_t iterations = 2000;
+  inseye::EyeTracker tracker(1000);
+  // dispatcher starts at tracker position, backlog is not part of the run
+  inseye::EyeTrackerDataStruct sample{};
+  while (tracker.TryReadNextEyeTrackerData(sample)) {}
+  std::atomic<uint64_t> delivered = 0;
+  std::atomic<int64_t> delivery_time = 0;
+  inseye::Subscription subscription(
+      tracker, [&](const inseye::GazeDataBatch& batch) {
+        delivery_time.store(clock_type::now().time_since_epoch().count(),
+                            std::memory_order_relaxed);
+        delivered.fetch_add(batch.dropped_samples + batch.count,
+                            std::memory_order_release);
+      });
+  auto wait_for_delivered = [&](uint64_t expected) {
+    const auto deadline = clock_type::now() + std::chrono::seconds(1);
+    while (delivered.load(std::memory_order_acquire) < expected &&
+           clock_type::now() < deadline)
+      std::this_thread::yield();
+  };
+  std::vector<double> latency_us;
+  latency_us.reserve(iterations);
+  uint64_t published = 0;
+  for (uint32_t i = 0; i < iterations; ++i) {
+    const auto start = clock_type::now();
+    service.Publish(1);
+    wait_for_delivered(++published);
+    latency_us.push_back(std::chrono::duration<double, std::micro>(
+                             clock_type::duration(delivery_time.load()) -
+                             start.time_since_epoch())
+                             .count());
+  }
+  const auto latency = ComputePercentiles(latency_us);
+  std::printf("Subscription delivery p50 %6.1f us, p99 %6.1f us\n",
+              latency.p50, latency.p99);
+  report.Add("subscription_delivery_latency", ToMetrics(latency, "us"));
+}
+
+// Coroutine that starts at once and frees itself when it ends.
+struct DetachedTask {
+  struct promise_type {
+    DetachedTask get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+struct AwaitingConsumers {
+  std::atomic<uint64_t> consumed = 0;
+  std::atomic<int64_t> last_resume_time = 0;
+  std::atomic<uint32_t> finished = 0;
+
+  void OnSample() {
+    last_resume_time.store(clock_type::now().time_since_epoch().count(),
+                           std::memory_order_relaxed);
+    consumed.fetch_add(1, std::memory_order_release);
+  }
+};
+
+DetachedTask AwaitNextSamples(inseye::EyeTrackerCursor& cursor,
+                              AwaitingConsumers& consumers) {
+  while (const auto sample = co_await cursor.NextSample())
+    consumers.OnSample();
+  consumers.finished.fetch_add(1);
+}
+
+DetachedTask AwaitSampleStream(inseye::EyeTrackerCursor& cursor,
+                               AwaitingConsumers& consumers) {
+  auto stream = cursor.Samples();
+  while (const auto sample = co_await stream.Next())
+    consumers.OnSample();
+  consumers.finished.fetch_add(1);
+}
+
+// Coroutines suspended on their own cursors, all resumed by library watcher
+// thread: time from publication until the last of them got the sample.
+void RunAwaitableBenchmark(BenchReport& report, ServiceSimulator& service) {
+  constexpr uint32_t iterations = 2000;
+  constexpr uint32_t consumer_count = 8;
+  inseye::EyeTracker tracker(1000);
+  inseye::EyeTrackerDataStruct sample{};
+  while (tracker.TryReadNextEyeTrackerData(sample)) {}
+  std::vector<inseye::EyeTrackerCursor> cursors;
+  cursors.reserve(consumer_count);
+  AwaitingConsumers consumers;
+  for (uint32_t i = 0; i < consumer_count; ++i) {
+    cursors.emplace_back(tracker);
+    if (i % 2 == 0)
+      AwaitNextSamples(cursors.back(), consumers);
+    else
+      AwaitSampleStream(cursors.back(), consumers);
+  }
+  auto wait_for_consumed = [&](uint64_t expected) {
+    const auto deadline = clock_type::now() + std::chrono::seconds(1);
+    while (consumers.consumed.load(std::memory_order_acquire) < expected &&
+           clock_type::now() < deadline)
+      std::this_thread::yield();
+  };
+  std::vector<double> latency_us;
+  latency_us.reserve(iterations);
+  for (uint32_t i = 1; i <= iterations; ++i) {
+    const auto start = clock_type::now();
+    service.Publish(1);
+    wait_for_consumed(static_cast<uint64_t>(i) * consumer_count);
+    latency_us.push_back(
+        std::chrono::duration<double, std::micro>(
+            clock_type::duration(consumers.last_resume_time.load()) -
+            start.time_since_epoch())
+            .count());
+  }
+  // coroutines get back to suspension right after counting the sample and
+  // end when their cursors are destroyed, before consumers go out of scope
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  cursors.clear();
+  const auto deadline = clock_type::now() + std::chrono::seconds(1);
+  while (consumers.finished.load() < consumer_count &&
+         clock_type::now() < deadline)
+    std::this_thread::yield();
+  const auto latency = ComputePercentiles(latency_us);
+  std::printf("%u awaiting coroutines resumed p50 %6.1f us, p99 %6.1f us\n",
+              consumer_count, latency.p50, latency.p99);
+  auto metrics = ToMetrics(latency, "us");
+  metrics.emplace_back("coroutines", static_cast<double>(consumer_count));
+  report.Add("awaitable_resume_latency", std::move(metrics));
+}
+
+// Replays ring content as fast as the reader keeps up with it.
+void RunThroughputBenchmarks(BenchReport& report, ServiceSimulator& service) {
+  inseye::EyeTracker tracker(1000);
+
+  const double single = MeasureSamplesPerSecond(
+      service, tracker, [](inseye::EyeTracker& reader) {
+        inseye::EyeTrackerDataStruct sample{};
+        uint64_t read = 0;
+        while (reader.TryReadNextEyeTrackerData(sample))
+          ++read;
+        return read;
+      });
+  std::printf("%-32s %14.0f samples/s\n", "TryReadNextEyeTrackerData", single);
+  report.Add("throughput_read_next", {{"samples_per_second", single}});
+
+  std::vector<inseye::EyeTrackerDataStruct> buffer(samples_per_round);
+  for (const uint32_t batch_size : {16u, 64u, 256u, samples_per_round}) {
+    const double batch = MeasureSamplesPerSecond(
+        service, tracker, [&](inseye::EyeTracker& reader) {
+          uint64_t read = 0;
+          uint32_t count = 0;
+          while (reader.TryReadEyeTrackerDataBatch(
+              std::span(buffer).first(batch_size), count))
+            read += count;
+          return read;
+        });
+    std::printf("TryReadEyeTrackerDataBatch[%4u] %14.0f samples/s (x%.2f)\n",
+                batch_size, batch, batch / single);
+    report.Add(std::format("throughput_read_batch_{}", batch_size),
+               {{"samples_per_second", batch}});
+  }
+
+  std::vector<uint64_t> time(samples_per_round);
+  std::vector<float> positions(4 * samples_per_round);
+  std::vector<inseye::GazeEvent> gaze_events(samples_per_round);
+  const inseye::EyeTrackerDataColumns columns{
+      time.data(), positions.data(), positions.data() + samples_per_round,
+      positions.data() + 2 * samples_per_round,
+      positions.data() + 3 * samples_per_round, gaze_events.data()};
+  const double columnar = MeasureSamplesPerSecond(
+      service, tracker, [&](inseye::EyeTracker& reader) {
+        uint64_t read = 0;
+        uint32_t count = 0;
+        while (reader.ReadEyeTrackerDataColumns(columns, samples_per_round,
+                                                count))
+          read += count;
+        return read;
+      });
+  std::printf("ReadEyeTrackerDataColumns[%4u]  %14.0f samples/s (x%.2f)\n",
+              samples_per_round, columnar, columnar / single);
+  report.Add(std::format("throughput_read_columns_{}", samples_per_round),
+             {{"samples_per_second", columnar}});
+
+  // forwarder moving raw samples on, copied straight from leased ring memory
+  std::vector<std::byte> forwarded(samples_per_round *
+                                   sizeof(inseye::EyeTrackerDataStruct));
+  uint64_t overwritten_total = 0;
+  for (const uint32_t lease_size : {256u, samples_per_round}) {
+    const double leased = MeasureSamplesPerSecond(
+        service, tracker, [&](inseye::EyeTracker& reader) {
+          uint64_t read = 0;
+          inseye::Lease lease{};
+          while (reader.AcquireReadLease(lease_size, lease)) {
+            std::byte* destination = forwarded.data();
+            for (const auto& span : lease.spans) {
+              const size_t bytes = size_t{span.count} * lease.sample_size;
+              if (bytes != 0)
+                std::memcpy(destination, span.data, bytes);
+              destination += bytes;
+            }
+            uint32_t overwritten = 0;
+            reader.ReleaseReadLease(lease, &overwritten);
+            overwritten_total += overwritten;
+            read += lease.count - overwritten;
+          }
+          return read;
+        });
+    std::printf("AcquireReadLease[%4u] + copy    %14.0f samples/s (x%.2f)\n",
+                lease_size, leased, leased / single);
+    report.Add(std::format("throughput_read_lease_{}", lease_size),
+               {{"samples_per_second", leased}});
+  }
+  std::printf("Leased samples overwritten while held: %llu\n",
+              static_cast<unsigned long long>(overwritten_total));
+}
+
+// Read latency of InMemoryV1 (packed 28 byte samples, counter next to the
+// first slots) against InMemoryV2 (32 byte slots with sequence stamps, counter
+// on its own cache line). Contended reads race writer thread that publishes
+// a sample every microsecond, so every read fetches sample and counter lines
+// from the writer's core.
+void RunLayoutBenchmark(BenchReport& report, double timer_overhead_ns) {
+  constexpr uint32_t iterations = 200000;
+  constexpr uint32_t contended_iterations = 20000;
+  constexpr auto write_interval = std::chrono::microseconds(1);
+  for (const uint32_t layout : {1u, 2u}) {
+    ServiceSimulator service({.ring_sample_count = ring_sample_count,
+                              .wake_readers = false,
+                              .version = {layout, 0, 0}});
+    FillRing(service);
+    inseye::EyeTracker tracker(1000);
+    inseye::EyeTrackerDataStruct sample{};
+    while (tracker.TryReadNextEyeTrackerData(sample)) {}
+    uint32_t failures = 0;
+    auto latency = MeasureCallLatency(
+        timer_overhead_ns, iterations, [&] { service.Publish(1); },
+        [&] { return tracker.TryReadNextEyeTrackerData(sample); }, failures);
+    ReportCallLatency(report,
+                      std::format("v{}_read_next_latency", layout).c_str(),
+                      latency, iterations, failures);
+    latency = MeasureCallLatency(
+        timer_overhead_ns, iterations, [] {},
+        [&] { return tracker.TryReadLastEyeTrackerData(sample); }, failures);
+    ReportCallLatency(report,
+                      std::format("v{}_read_last_latency", layout).c_str(),
+                      latency, iterations, failures);
+
+    // publishing restamps V2 slots, so only reads are timed
+    std::vector<inseye::EyeTrackerDataStruct> buffer(256);
+    uint64_t samples_read = 0;
+    auto elapsed = clock_type::duration::zero();
+    while (elapsed < measurement_duration) {
+      service.Publish(samples_per_round);
+      const auto start = clock_type::now();
+      uint32_t count = 0;
+      while (tracker.TryReadEyeTrackerDataBatch(buffer, count))
+        samples_read += count;
+      elapsed += clock_type::now() - start;
+    }
+    const double batch = static_cast<double>(samples_read) /
+                         std::chrono::duration<double>(elapsed).count();
+    std::printf("v%u TryReadEyeTrackerDataBatch[256]  %14.0f samples/s\n",
+                layout, batch);
+    report.Add(std::format("v{}_throughput_read_batch_256", layout),
+               {{"samples_per_second", batch}});
+
+    std::atomic<bool> writing = true;
+    std::thread writer([&] {
+      uint64_t index = 0;
+      auto next_write = clock_type::now();
+      while (writing.load(std::memory_order_relaxed)) {
+        const float position = static_cast<float>(index % 1000) * 1e-3f;
+        service.Write({index++, position, position, -position, -position,
+                       inseye::GazeEvent::kInsGazeNone});
+        next_write += write_interval;
+        while (clock_type::now() < next_write)
+          std::this_thread::yield();
+      }
+    });
+    // every call reads sample writer published after the previous call
+    latency = MeasureCallLatency(
+        timer_overhead_ns, contended_iterations,
+        [&] {
+          while (!tracker.IsGazeDataAvailable())
+            std::this_thread::yield();
+        },
+        [&] { return tracker.TryReadLatestEyeTrackerData(sample); },
+        failures);
+    writing = false;
+    writer.join();
+    ReportCallLatency(
+        report,
+        std::format("v{}_contended_read_latest_latency", layout).c_str(),
+        latency, contended_iterations, failures);
+  }
+}
+
+// Service restarts under reader with reconnect enabled, time until reader and
+// its cursor read the first sample of the new ring.
+void RunReconnectBenchmark(BenchReport& report, double timer_overhead_ns) {
+  constexpr uint32_t iterations = 200000;
+  constexpr uint64_t restarted_time = 1000000;
+  constexpr auto restart_timeout = std::chrono::seconds(10);
+  std::optional<ServiceSimulator> service;
+  service.emplace(SimulatorOptions{.ring_sample_count = ring_sample_count});
+  FillRing(*service);
+  inseye::EyeTracker tracker(1000);
+  tracker.EnableReconnect({.check_interval_ms = 10});
+  inseye::EyeTrackerCursor cursor(tracker);
+  inseye::EyeTrackerDataStruct sample{};
+  while (tracker.TryReadNextEyeTrackerData(sample)) {}
+  while (cursor.TryReadNextEyeTrackerData(sample)) {}
+  uint32_t failures = 0;
+  const auto latency = MeasureCallLatency(
+      timer_overhead_ns, iterations, [&] { service->Publish(1); },
+      [&] { return tracker.TryReadNextEyeTrackerData(sample); }, failures);
+  ReportCallLatency(report, "reconnect_enabled_read_next_latency", latency,
+                    iterations, failures);
+  while (cursor.TryReadNextEyeTrackerData(sample)) {}
+
+  // new service is started right away, so the time also covers detection
+  service.reset();
+  const auto restart = clock_type::now();
+  service.emplace(SimulatorOptions{.ring_sample_count = ring_sample_count});
+  uint64_t time = restarted_time;
+  double tracker_switch_ms = -1, cursor_switch_ms = -1;
+  const auto check = [&](inseye::EyeTrackerCursor* reader, double& switch_ms) {
+    inseye::EyeTrackerDataStruct read{};
+    while (reader != nullptr ? reader->TryReadNextEyeTrackerData(read)
+                             : tracker.TryReadNextEyeTrackerData(read))
+      if (read.time >= restarted_time && switch_ms < 0)
+        switch_ms = std::chrono::duration<double, std::milli>(
+                        clock_type::now() - restart)
+                        .count();
+  };
+  while ((tracker_switch_ms < 0 || cursor_switch_ms < 0) &&
+         clock_type::now() - restart < restart_timeout) {
+    service->Write({time++, 0, 0, 0, 0, inseye::GazeEvent::kInsGazeNone});
+    check(nullptr, tracker_switch_ms);
+    check(&cursor, cursor_switch_ms);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::printf("Reconnect after restart: reader %.1f ms, cursor %.1f ms\n",
+              tracker_switch_ms, cursor_switch_ms);
+  report.Add("reconnect_after_restart",
+             {{"reader_ms", tracker_switch_ms},
+              {"cursor_ms", cursor_switch_ms}});
+}
+
+int main(int argc, char** argv) {
+  const char* json_path = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    if (std::string_view(argv[i]) == "--json" && i + 1 < argc) {
+      json_path = argv[++i];
+    } else {
+      std::printf("Usage: %s [--json <report file>]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  BenchReport report("remote_connector_bench");
+  const double timer_overhead_ns = MeasureTimerOverheadNs();
+  std::printf("Timer overhead %.1f ns (subtracted from call latencies)\n",
+              timer_overhead_ns);
+  report.Add("timer_overhead", {{"ns", timer_overhead_ns}});
+  {
+    ServiceSimulator service({.ring_sample_count = ring_sample_count});
+    FillRing(service);
+    RunThroughputBenchmarks(report, service);
+    MeasureWakeUpLatency(report, service, true);
+    MeasureWakeUpLatency(report, service, false);
+  }
+  {
+    // fresh simulator, the throughput runs push samples written counter far
+    ServiceSimulator service({.ring_sample_count = ring_sample_count});
+    FillRing(service);
+    RunCallLatencyBenchmarks(report, service, timer_overhead_ns);
+    RunOverrunRecoveryBenchmark(report, service, timer_overhead_ns);
+    RunApiOverheadBenchmark(report, service);
+    RunStartupBenchmark(report);
+    RunAsyncCreationBenchmark(report);
+    RunSubscriptionBenchmark(report, service);
+    RunAwaitableBenchmark(report, service);
+    RunCursorBenchmark(report, timer_overhead_ns);
+    RunFilterChainBenchmark(report, service);
+  }
+  RunLayoutBenchmark(report, timer_overhead_ns);
+  RunTimeQueryBenchmark(report, timer_overhead_ns);
+  RunClockModelBenchmark(report);
+  RunGazePredictionBenchmark(report, timer_overhead_ns);
+  RunGazeClassificationBenchmark(report);
+  RunRecorderBenchmark(report, 2000);
+  RunRecorderBenchmark(report, 20000);
+  RunRecorderBenchmark(report, 20000, 2);
+  RunReconnectBenchmark(report, timer_overhead_ns);
+  if (json_path != nullptr) {
+    std::ofstream json(json_path);
+    report.WriteJson(json);
+    if (!json) {
+      std::printf("Failed to write report to %s\n", json_path);
+      return EXIT_FAILURE;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,80 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include "allocator.hpp"
+#include <atomic>
+#include <forward_list>
+#include <mutex>
+#include "errors.hpp"
+
+namespace {
+void* DefaultAllocate(size_t size, size_t alignment, void*) {
+  return ::operator new(size, std::align_val_t(alignment), std::nothrow);
+}
+
+void DefaultDeallocate(void* pointer, size_t, size_t alignment, void*) {
+  ::operator delete(pointer, std::align_val_t(alignment));
+}
+
+constexpr inseye::c::InseyeAllocator default_allocator{
+    DefaultAllocate, DefaultDeallocate, nullptr};
+
+// Allocations read the allocator without the lock, so it's published as
+// pointer to table that never changes. Replaced tables are kept until the
+// process ends, thread that loaded one just before the swap can still use it.
+std::mutex allocator_mutex;
+std::forward_list<inseye::c::InseyeAllocator> replacement_allocators;
+std::atomic<const inseye::c::InseyeAllocator*> current_allocator =
+    &default_allocator;
+// detects misuse only, SetLibraryAllocator called while other threads
+// create objects can still race with this check
+std::atomic<size_t> live_allocation_count = 0;
+}  // namespace
+
+void* inseye::internal::Allocate(size_t size, size_t alignment) {
+  const auto* allocator = current_allocator.load(std::memory_order_acquire);
+  void* memory = allocator->allocate(size, alignment, allocator->user_data);
+  if (memory == nullptr)
+    throw std::bad_alloc();
+  live_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  return memory;
+}
+
+void inseye::internal::Deallocate(void* pointer, size_t size,
+                                  size_t alignment) noexcept {
+  if (pointer == nullptr)
+    return;
+  const auto* allocator = current_allocator.load(std::memory_order_acquire);
+  allocator->deallocate(pointer, size, alignment, allocator->user_data);
+  live_allocation_count.fetch_sub(1, std::memory_order_relaxed);
+}
+
+inseye::c::InseyeInitializationStatus inseye::c::SetLibraryAllocator(
+    const struct inseye::c::InseyeAllocator* replacement) {
+  if (replacement != nullptr &&
+      (replacement->allocate == nullptr || replacement->deallocate == nullptr)) {
+    WriteErrorMessage("Allocator must set both allocate and deallocate.");
+    return inseye::c::kFailure;
+  }
+  std::lock_guard lock(allocator_mutex);
+  if (live_allocation_count.load(std::memory_order_acquire) != 0) {
+    WriteErrorMessage(
+        "Objects allocated with the current allocator still exist.");
+    return inseye::c::kFailure;
+  }
+  const inseye::c::InseyeAllocator* published = &default_allocator;
+  if (replacement != nullptr) {
+    try {
+      published = &replacement_allocators.emplace_front(*replacement);
+    } catch (const std::bad_alloc&) {
+      WriteErrorMessage("Failed to store allocator.");
+      return inseye::c::kFailure;
+    }
+  }
+  current_allocator.store(published, std::memory_order_release);
+  return inseye::c::kSuccess;
+}
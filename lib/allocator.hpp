@@ -0,0 +1,98 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#ifndef REMOTE_CONNECTOR_LIB_ALLOCATOR_HPP
+#define REMOTE_CONNECTOR_LIB_ALLOCATOR_HPP
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+#include "remote_connector.h"
+
+// Library objects are allocated through allocator set with
+// SetLibraryAllocator. Only creation and destruction of objects allocate,
+// reads, waits and batches work in memory allocated up front.
+namespace inseye::internal {
+
+/**
+ * @brief Allocates with the library allocator.
+ * Throws std::bad_alloc when allocator returns null.
+ */
+void* Allocate(size_t size, size_t alignment);
+void Deallocate(void* pointer, size_t size, size_t alignment) noexcept;
+
+/**
+ * @brief Standard allocator over the library allocator, for shared pointers
+ * and containers owned by library objects.
+ */
+template <typename T>
+struct Allocator {
+  using value_type = T;
+
+  Allocator() noexcept = default;
+  template <typename U>
+  Allocator(const Allocator<U>&) noexcept {}
+
+  T* allocate(size_t count) {
+    if (count > (std::numeric_limits<size_t>::max)() / sizeof(T))
+      throw std::bad_array_new_length();
+    return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+  }
+  void deallocate(T* pointer, size_t count) noexcept {
+    Deallocate(pointer, count * sizeof(T), alignof(T));
+  }
+  template <typename U>
+  bool operator==(const Allocator<U>&) const noexcept {
+    return true;
+  }
+};
+
+/**
+ * @brief Creates object in memory of the library allocator.
+ * Throws std::bad_alloc or exception of the constructor.
+ */
+template <typename T, typename... Arguments>
+T* New(Arguments&&... arguments) {
+  void* memory = Allocate(sizeof(T), alignof(T));
+  try {
+    return ::new (memory) T(std::forward<Arguments>(arguments)...);
+  } catch (...) {
+    Deallocate(memory, sizeof(T), alignof(T));
+    throw;
+  }
+}
+
+template <typename T>
+void Delete(T* object) noexcept {
+  if (object == nullptr)
+    return;
+  object->~T();
+  Deallocate(object, sizeof(T), alignof(T));
+}
+
+template <typename T>
+struct Deleter {
+  void operator()(T* object) const noexcept { Delete(object); }
+};
+
+template <typename T>
+using UniquePtr = std::unique_ptr<T, Deleter<T>>;
+
+template <typename T, typename... Arguments>
+UniquePtr<T> MakeUnique(Arguments&&... arguments) {
+  return UniquePtr<T>(New<T>(std::forward<Arguments>(arguments)...));
+}
+
+template <typename T, typename... Arguments>
+std::shared_ptr<T> MakeShared(Arguments&&... arguments) {
+  return std::allocate_shared<T>(Allocator<T>(),
+                                 std::forward<Arguments>(arguments)...);
+}
+
+}  // namespace inseye::internal
+#endif  //REMOTE_CONNECTOR_LIB_ALLOCATOR_HPP
@@ -0,0 +1,257 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include "allocator.hpp"
+#include "errors.hpp"
+#include "reader_internal.hpp"
+#include "remote_connector.h"
+
+using OperationState = inseye::c::InseyeAsyncOperationState;
+
+struct inseye::c::InseyeAsyncOperation {
+  // state is written under the mutex, so that waiters don't miss the
+  // notification, and read without it by GetAsyncOperationState
+  std::mutex mutex;
+  std::condition_variable finished;
+  std::atomic<OperationState> state = OperationState::kInsAsyncCreated;
+  std::atomic<bool> cancel_requested = false;
+  // written by connecting thread before state becomes final
+  inseye::c::InseyeInitializationStatus status =
+      inseye::c::InseyeInitializationStatus::kSuccess;
+  std::string error_message;
+  inseye::c::InseyeEyeTracker* tracker = nullptr;
+  // set under the mutex by DestroyAsyncOperation that didn't wait for the
+  // connecting thread, the thread frees the operation when it finishes
+  bool abandoned = false;
+  std::thread thread;
+};
+
+namespace {
+bool IsFinal(OperationState state) {
+  return state == OperationState::kInsAsyncCancelled ||
+         state == OperationState::kInsAsyncFaulted ||
+         state == OperationState::kInsCompleted;
+}
+
+// Returns true when the operation was destroyed in the meantime and the
+// caller is responsible for freeing it.
+bool Finish(inseye::c::InseyeAsyncOperation& operation, OperationState state,
+            inseye::c::InseyeInitializationStatus status,
+            const char* error_message) {
+  bool abandoned;
+  {
+    std::lock_guard lock(operation.mutex);
+    operation.status = status;
+    operation.error_message = error_message;
+    operation.state.store(state, std::memory_order_release);
+    abandoned = operation.abandoned;
+  }
+  operation.finished.notify_all();
+  return abandoned;
+}
+
+void RunReaderCreation(inseye::c::InseyeAsyncOperation& operation,
+                       uint32_t timeout_ms) {
+  auto expected = OperationState::kInsAsyncCreated;
+  operation.state.compare_exchange_strong(expected,
+                                          OperationState::kInsAsyncRunning);
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  inseye::c::InseyeEyeTracker* tracker = nullptr;
+  const auto status = inseye::internal::CreateEyeTrackerReader(&tracker, [&] {
+    return operation.cancel_requested.load(std::memory_order_relaxed) ||
+           std::chrono::steady_clock::now() > deadline;
+  });
+  if (status == inseye::c::InseyeInitializationStatus::kSuccess) {
+    std::unique_lock lock(operation.mutex);
+    // cancellation is decided under the lock, so successful Cancel never
+    // ends with completed operation
+    if (!operation.cancel_requested.load(std::memory_order_relaxed)) {
+      operation.tracker = tracker;
+      operation.state.store(OperationState::kInsCompleted,
+                            std::memory_order_release);
+      lock.unlock();
+      operation.finished.notify_all();
+      return;
+    }
+  }
+  bool abandoned;
+  if (operation.cancel_requested.load(std::memory_order_relaxed)) {
+    // nobody is going to take the reader, free connection and mapping now
+    inseye::internal::DiscardEyeTrackerReader(&tracker);
+    abandoned =
+        Finish(operation, OperationState::kInsAsyncCancelled,
+               inseye::c::InseyeInitializationStatus::kCancelled, "Cancelled");
+  } else {
+    // the only cancellation source left is the deadline
+    abandoned = Finish(
+        operation, OperationState::kInsAsyncFaulted,
+        status == inseye::c::InseyeInitializationStatus::kCancelled
+            ? inseye::c::InseyeInitializationStatus::kTimeout
+            : status,
+        inseye::c::GetLastErrorDescription());
+  }
+  if (abandoned)
+    inseye::internal::Delete(&operation);
+}
+}  // namespace
+
+inseye::c::InseyeInitializationStatus inseye::c::CreateEyeTrackerReaderAsync(
+    struct inseye::c::InseyeAsyncOperation** pptr, uint32_t timeout_ms) {
+  if (pptr == nullptr) {
+    WriteErrorMessage("Operation pointer address is required.");
+    return inseye::c::InseyeInitializationStatus::kFailure;
+  }
+  inseye::internal::UniquePtr<inseye::c::InseyeAsyncOperation> operation;
+  try {
+    operation =
+        inseye::internal::MakeUnique<inseye::c::InseyeAsyncOperation>();
+    operation->thread =
+        std::thread(RunReaderCreation, std::ref(*operation), timeout_ms);
+  } catch (const std::system_error& error) {
+    WriteErrorMessage(error.what());
+    return inseye::c::InseyeInitializationStatus::kInternalError;
+  } catch (const std::bad_alloc&) {
+    WriteErrorMessage("Failed to allocate asynchronous operation.");
+    return inseye::c::InseyeInitializationStatus::kFailure;
+  }
+  *pptr = operation.release();
+  return inseye::c::InseyeInitializationStatus::kSuccess;
+}
+
+inseye::c::InseyeAsyncOperationState inseye::c::GetAsyncOperationState(
+    struct inseye::c::InseyeAsyncOperation* operation) {
+  if (operation == nullptr)
+    return OperationState::kInsAsyncFaulted;
+  return operation->state.load(std::memory_order_acquire);
+}
+
+bool inseye::c::CancelAsyncOperation(
+    struct inseye::c::InseyeAsyncOperation* operation) {
+  if (operation == nullptr)
+    return false;
+  std::lock_guard lock(operation->mutex);
+  const auto state = operation->state.load(std::memory_order_relaxed);
+  if (IsFinal(state))
+    return false;
+  operation->cancel_requested.store(true, std::memory_order_relaxed);
+  operation->state.store(OperationState::kInsAsyncCancelling,
+                         std::memory_order_relaxed);
+  return true;
+}
+
+bool inseye::c::WaitForAsyncOperation(
+    struct inseye::c::InseyeAsyncOperation* operation, uint32_t timeout_ms) {
+  if (operation == nullptr)
+    return false;
+  std::unique_lock lock(operation->mutex);
+  return operation->finished.wait_for(
+      lock, std::chrono::milliseconds(timeout_ms), [operation] {
+        return IsFinal(operation->state.load(std::memory_order_relaxed));
+      });
+}
+
+inseye::c::InseyeInitializationStatus inseye::c::GetEyeTrackerReaderAsyncResult(
+    struct inseye::c::InseyeAsyncOperation* operation,
+    struct inseye::c::InseyeEyeTracker** pptr) {
+  if (operation == nullptr || pptr == nullptr) {
+    WriteErrorMessage("Operation and reader pointer address are required.");
+    return inseye::c::InseyeInitializationStatus::kFailure;
+  }
+  std::lock_guard lock(operation->mutex);
+  if (!IsFinal(operation->state.load(std::memory_order_relaxed))) {
+    WriteErrorMessage("Operation has not finished yet.");
+    return inseye::c::InseyeInitializationStatus::kFailure;
+  }
+  if (operation->status != inseye::c::InseyeInitializationStatus::kSuccess) {
+    // error description was written to connecting thread buffer
+    WriteErrorMessage(operation->error_message);
+    return operation->status;
+  }
+  if (operation->tracker == nullptr) {
+    WriteErrorMessage("Reader was already taken from the operation.");
+    return inseye::c::InseyeInitializationStatus::kFailure;
+  }
+  *pptr = operation->tracker;
+  operation->tracker = nullptr;
+  return inseye::c::InseyeInitializationStatus::kSuccess;
+}
+
+void inseye::c::DestroyAsyncOperation(
+    struct inseye::c::InseyeAsyncOperation** pptr) {
+  if (pptr == nullptr || *pptr == nullptr)
+    return;
+  auto* operation = std::exchange(*pptr, nullptr);
+  {
+    std::lock_guard lock(operation->mutex);
+    if (!IsFinal(operation->state.load(std::memory_order_relaxed))) {
+      // don't wait for connecting thread, it notices cancellation at its
+      // next check and frees the operation itself
+      operation->cancel_requested.store(true, std::memory_order_relaxed);
+      operation->state.store(OperationState::kInsAsyncCancelling,
+                             std::memory_order_relaxed);
+      operation->abandoned = true;
+      operation->thread.detach();
+      return;
+    }
+  }
+  // final state is published right before the thread returns
+  if (operation->thread.joinable())
+    operation->thread.join();
+  inseye::internal::DiscardEyeTrackerReader(&operation->tracker);
+  inseye::internal::Delete(operation);
+}
+
+inseye::EyeTrackerCreation::EyeTrackerCreation(
+    EyeTrackerCreation&& other) noexcept
+    : implementation_pointer_(other.implementation_pointer_) {
+  other.implementation_pointer_ = nullptr;
+}
+
+inseye::EyeTrackerCreation::~EyeTrackerCreation() noexcept {
+  inseye::c::DestroyAsyncOperation(&implementation_pointer_);
+}
+
+inseye::AsyncOperationState inseye::EyeTrackerCreation::GetState()
+    const noexcept {
+  return inseye::c::GetAsyncOperationState(implementation_pointer_);
+}
+
+bool inseye::EyeTrackerCreation::Cancel() noexcept {
+  return inseye::c::CancelAsyncOperation(implementation_pointer_);
+}
+
+bool inseye::EyeTrackerCreation::Wait(
+    std::chrono::milliseconds timeout) noexcept {
+  const auto timeout_ms = (std::min)(
+      timeout.count(),
+      static_cast<std::chrono::milliseconds::rep>(
+          (std::numeric_limits<uint32_t>::max)()));
+  return inseye::c::WaitForAsyncOperation(
+      implementation_pointer_,
+      static_cast<uint32_t>((std::max)(timeout_ms, decltype(timeout_ms){0})));
+}
+
+inseye::EyeTracker inseye::EyeTrackerCreation::GetResult() {
+  inseye::c::InseyeEyeTracker* tracker = nullptr;
+  if (inseye::c::GetEyeTrackerReaderAsyncResult(implementation_pointer_,
+                                                &tracker) !=
+      inseye::c::InseyeInitializationStatus::kSuccess)
+    throw std::runtime_error(inseye::c::GetLastErrorDescription());
+  return EyeTracker(tracker);
+}
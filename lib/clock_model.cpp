@@ -0,0 +1,285 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include "clock_model.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define INSEYE_X86_KERNELS 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC allows intrinsics of any instruction set in every function
+#define INSEYE_TARGET_AVX2_FMA
+#else
+#define INSEYE_TARGET_AVX2_FMA __attribute__((target("avx2,fma")))
+#endif
+#else
+#define INSEYE_X86_KERNELS 0
+#endif
+
+namespace {
+constexpr int64_t ns_per_ms = 1'000'000;
+// service time has millisecond resolution, minima closer to the fit than
+// that are never rejected
+constexpr double minimum_rejection_distance_ns = 1e6;
+
+#if INSEYE_X86_KERNELS
+bool DetectAvx2Fma() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int registers[4];
+  __cpuid(registers, 0);
+  const int highest_leaf = registers[0];
+  __cpuid(registers, 1);
+  const bool fma = (registers[2] & (1 << 12)) != 0;
+  const bool os_saves_ymm = (registers[2] & (1 << 27)) != 0 &&
+                            (_xgetbv(0) & 0x6) == 0x6;
+  if (highest_leaf < 7 || !fma || !os_saves_ymm)
+    return false;
+  __cpuidex(registers, 7, 0);
+  return (registers[1] & (1 << 5)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+// Doubles and integers below 2^51 are converted by adding 1.5 * 2^52, whose
+// mantissa then holds the integer, rounding to nearest on the way back.
+INSEYE_TARGET_AVX2_FMA size_t ConvertAvx2Fma(
+    const inseye::c::InseyeClockMapping& mapping, const uint64_t* times,
+    int64_t* local_ns, size_t count) noexcept {
+  const auto reference = static_cast<int64_t>(mapping.reference_local_ns);
+  const __m256i reference_time =
+      _mm256_set1_epi64x(static_cast<int64_t>(mapping.reference_time));
+  const __m256i reference_local = _mm256_set1_epi64x(reference);
+  const __m256d slope = _mm256_set1_pd(mapping.local_ns_per_ms);
+  const __m256d reference_fraction = _mm256_set1_pd(
+      mapping.reference_local_ns - static_cast<double>(reference));
+  const __m256i magic_bits = _mm256_set1_epi64x(0x4338000000000000);
+  const __m256d magic = _mm256_castsi256_pd(magic_bits);
+  // offsets from the reference time within +-2^31 ms (24 days) keep every
+  // intermediate value in range of the conversions
+  const __m256i offset_bias = _mm256_set1_epi64x(int64_t{1} << 31);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m256i offset = _mm256_sub_epi64(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(times + i)),
+        reference_time);
+    if (!_mm256_testz_si256(
+            _mm256_srli_epi64(_mm256_add_epi64(offset, offset_bias), 32),
+            _mm256_set1_epi64x(-1)))
+      break;
+    const __m256d offset_ms =
+        _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(offset, magic_bits)),
+                      magic);
+    const __m256d local =
+        _mm256_fmadd_pd(offset_ms, slope, reference_fraction);
+    const __m256i rounded = _mm256_sub_epi64(
+        _mm256_castpd_si256(_mm256_add_pd(local, magic)), magic_bits);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(local_ns + i),
+                        _mm256_add_epi64(rounded, reference_local));
+  }
+  return i;
+}
+#endif  // INSEYE_X86_KERNELS
+}  // namespace
+
+void inseye::internal::ConvertToLocal(
+    const inseye::c::InseyeClockMapping& mapping, const uint64_t* times,
+    int64_t* local_ns, size_t count) noexcept {
+  size_t converted = 0;
+#if INSEYE_X86_KERNELS
+  static const bool avx2_fma = DetectAvx2Fma();
+  if (avx2_fma)
+    converted = ConvertAvx2Fma(mapping, times, local_ns, count);
+#endif
+  for (; converted < count; ++converted)
+    local_ns[converted] = ConvertToLocal(mapping, times[converted]);
+}
+
+void inseye::internal::ClockModel::Observe(uint64_t service_time_ms,
+                                           int64_t local_ns) noexcept {
+  if (updating_.test_and_set(std::memory_order_acquire))
+    return;
+  const WindowMinimum observation{
+      service_time_ms,
+      local_ns - static_cast<int64_t>(service_time_ms) * ns_per_ms};
+  if (fitted_ || window_open_) {
+    const double residual =
+        static_cast<double>(observation.offset_ns) -
+        PredictOffset(observation.service_time_ms);
+    // arrival before publication is possible only after clock jump
+    if (residual < -static_cast<double>(kJumpThresholdNs))
+      Reset();
+  }
+  if (window_open_ && observation.service_time_ms >= window_end_ms_)
+    CloseWindow();
+  if (!window_open_) {
+    window_open_ = true;
+    window_ = observation;
+    window_end_ms_ = observation.service_time_ms + kWindowLengthMs;
+  } else if (observation.offset_ns < window_.offset_ns) {
+    window_ = observation;
+  }
+  ++observation_count_;
+  if (!fitted_) {
+    // until the first window closes mapping follows the earliest arrival
+    const WindowMinimum& earliest = window_;
+    Publish(earliest.service_time_ms,
+            static_cast<double>(static_cast<int64_t>(earliest.service_time_ms) *
+                                    ns_per_ms +
+                                earliest.offset_ns),
+            static_cast<double>(ns_per_ms));
+  } else {
+    published_observation_count_.store(observation_count_,
+                                       std::memory_order_relaxed);
+  }
+  updating_.clear(std::memory_order_release);
+}
+
+bool inseye::internal::ClockModel::TryGetMapping(
+    inseye::c::InseyeClockMapping& mapping) const noexcept {
+  while (true) {
+    const uint32_t sequence = sequence_.load(std::memory_order_acquire);
+    if ((sequence & 1) != 0)
+      continue;
+    mapping.reference_time = reference_time_.load(std::memory_order_relaxed);
+    mapping.reference_local_ns =
+        reference_local_ns_.load(std::memory_order_relaxed);
+    mapping.local_ns_per_ms = local_ns_per_ms_.load(std::memory_order_relaxed);
+    mapping.observation_count =
+        published_observation_count_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sequence_.load(std::memory_order_relaxed) == sequence)
+      return mapping.observation_count != 0;
+  }
+}
+
+void inseye::internal::ClockModel::Reset() noexcept {
+  minima_count_ = 0;
+  newest_minimum_ = 0;
+  window_open_ = false;
+  late_windows_ = 0;
+  fitted_ = false;
+  observation_count_ = 0;
+}
+
+void inseye::internal::ClockModel::CloseWindow() noexcept {
+  window_open_ = false;
+  if (fitted_) {
+    const double residual = static_cast<double>(window_.offset_ns) -
+                            PredictOffset(window_.service_time_ms);
+    late_windows_ =
+        residual > static_cast<double>(kJumpThresholdNs) ? late_windows_ + 1
+                                                         : 0;
+    if (late_windows_ == kLateWindowsForJump) {
+      // service clock went back, keep only the newest window
+      const auto newest = window_;
+      Reset();
+      window_ = newest;
+    }
+  }
+  newest_minimum_ = (newest_minimum_ + 1) % kWindowCount;
+  minima_[newest_minimum_] = window_;
+  minima_count_ = (std::min)(minima_count_ + 1, kWindowCount);
+  Fit();
+}
+
+void inseye::internal::ClockModel::Fit() noexcept {
+  const auto& newest = minima_[newest_minimum_];
+  // coordinates relative to the newest minimum keep doubles exact
+  std::array<double, kWindowCount> x{}, y{};
+  std::array<bool, kWindowCount> used{};
+  for (uint32_t i = 0; i < minima_count_; ++i) {
+    const auto& minimum =
+        minima_[(newest_minimum_ + kWindowCount - i) % kWindowCount];
+    x[i] = static_cast<double>(
+        static_cast<int64_t>(minimum.service_time_ms - newest.service_time_ms));
+    y[i] = static_cast<double>(minimum.offset_ns - newest.offset_ns);
+    used[i] = true;
+  }
+  double offset = 0, drift = 0;
+  const auto fit_line = [&] {
+    double count = 0, sum_x = 0, sum_y = 0;
+    for (uint32_t i = 0; i < minima_count_; ++i) {
+      if (!used[i])
+        continue;
+      count += 1;
+      sum_x += x[i];
+      sum_y += y[i];
+    }
+    const double mean_x = sum_x / count, mean_y = sum_y / count;
+    double sxx = 0, sxy = 0;
+    for (uint32_t i = 0; i < minima_count_; ++i) {
+      if (!used[i])
+        continue;
+      sxx += (x[i] - mean_x) * (x[i] - mean_x);
+      sxy += (x[i] - mean_x) * (y[i] - mean_y);
+    }
+    drift = minima_count_ >= kMinimumWindowsForDrift && sxx > 0
+                ? std::clamp(sxy / sxx, -kMaximumDriftNsPerMs,
+                             kMaximumDriftNsPerMs)
+                : 0.0;
+    offset = mean_y - drift * mean_x;
+  };
+  fit_line();
+  if (minima_count_ >= kMinimumWindowsForDrift) {
+    // reject minima further than 3 median absolute residuals
+    std::array<double, kWindowCount> residuals{};
+    for (uint32_t i = 0; i < minima_count_; ++i)
+      residuals[i] = std::abs(y[i] - (offset + drift * x[i]));
+    auto sorted = residuals;
+    const auto median = sorted.begin() + minima_count_ / 2;
+    std::nth_element(sorted.begin(), median, sorted.begin() + minima_count_);
+    const double limit =
+        (std::max)(3.0 * *median, minimum_rejection_distance_ns);
+    bool rejected = false;
+    for (uint32_t i = 0; i < minima_count_; ++i)
+      if (residuals[i] > limit) {
+        used[i] = false;
+        rejected = true;
+      }
+    if (rejected)
+      fit_line();
+  }
+  fitted_ = true;
+  fit_reference_ms_ = newest.service_time_ms;
+  fit_offset_ns_ = static_cast<double>(newest.offset_ns) + offset;
+  fit_drift_ns_per_ms_ = drift;
+  Publish(fit_reference_ms_,
+          static_cast<double>(static_cast<int64_t>(fit_reference_ms_) *
+                                  ns_per_ms +
+                              newest.offset_ns) +
+              offset,
+          static_cast<double>(ns_per_ms) + drift);
+}
+
+double inseye::internal::ClockModel::PredictOffset(
+    uint64_t service_time_ms) const noexcept {
+  if (!fitted_)
+    return static_cast<double>(window_.offset_ns);
+  return fit_offset_ns_ +
+         fit_drift_ns_per_ms_ *
+             static_cast<double>(
+                 static_cast<int64_t>(service_time_ms - fit_reference_ms_));
+}
+
+void inseye::internal::ClockModel::Publish(uint64_t reference_time,
+                                           double reference_local_ns,
+                                           double local_ns_per_ms) noexcept {
+  const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+  sequence_.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  reference_time_.store(reference_time, std::memory_order_relaxed);
+  reference_local_ns_.store(reference_local_ns, std::memory_order_relaxed);
+  local_ns_per_ms_.store(local_ns_per_ms, std::memory_order_relaxed);
+  published_observation_count_.store(observation_count_,
+                                     std::memory_order_relaxed);
+  sequence_.store(sequence + 2, std::memory_order_release);
+}
@@ -0,0 +1,132 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#ifndef REMOTE_CONNECTOR_LIB_CLOCK_MODEL_HPP
+#define REMOTE_CONNECTOR_LIB_CLOCK_MODEL_HPP
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "remote_connector.h"
+
+namespace inseye::internal {
+
+/**
+ * @brief Converts service time with mapping.
+ */
+inline int64_t ConvertToLocal(const inseye::c::InseyeClockMapping& mapping,
+                              uint64_t time) noexcept {
+  // integer part of the reference is added after rounding, so that the
+  // rounded value stays small
+  const auto reference = static_cast<int64_t>(mapping.reference_local_ns);
+  const double local =
+      static_cast<double>(static_cast<int64_t>(time - mapping.reference_time)) *
+          mapping.local_ns_per_ms +
+      (mapping.reference_local_ns - static_cast<double>(reference));
+  return reference +
+         static_cast<int64_t>(local < 0 ? local - 0.5 : local + 0.5);
+}
+
+/**
+ * @brief Converts steady clock time back to service time in fractional
+ * milliseconds.
+ */
+inline double ConvertToService(const inseye::c::InseyeClockMapping& mapping,
+                               int64_t local_ns) noexcept {
+  const auto reference = static_cast<int64_t>(mapping.reference_local_ns);
+  return static_cast<double>(mapping.reference_time) +
+         (static_cast<double>(local_ns - reference) -
+          (mapping.reference_local_ns - static_cast<double>(reference))) /
+             mapping.local_ns_per_ms;
+}
+
+/**
+ * @brief Converts count times, on x86 with FMA3 four times per fused
+ * multiply-add, the kernel is selected at runtime.
+ */
+void ConvertToLocal(const inseye::c::InseyeClockMapping& mapping,
+                    const uint64_t* times, int64_t* local_ns,
+                    size_t count) noexcept;
+
+/**
+ * @brief Online estimate of offset and drift between service sample time
+ * (milliseconds since Unix Epoch) and local steady clock.
+ * Every observation pairs sample time with local time at which the sample was
+ * seen, which is never earlier than the sample was published, so queueing and
+ * scheduling delays only push observations up. Observations are grouped in
+ * windows of service time and only the earliest arrival of each window is
+ * kept, line is least squares fitted to the last kWindowCount window minima
+ * and refitted without minima that lie far from the first fit.
+ * Observe may be called from many threads, observation that finds model being
+ * updated by other thread is dropped. Mapping is published with sequence lock
+ * and read without blocking.
+ */
+class ClockModel {
+ public:
+  static constexpr uint64_t kWindowLengthMs = 250;
+  static constexpr uint32_t kWindowCount = 32;
+  // fewer window minima keep drift at zero
+  static constexpr uint32_t kMinimumWindowsForDrift = 4;
+  // drift of two quartz clocks stays far below, larger fitted drift is noise
+  static constexpr double kMaximumDriftNsPerMs = 500.0;
+  // arrival earlier than the mapping allows or this many consecutive window
+  // minima later than kJumpThresholdNs mean that service clock jumped
+  static constexpr int64_t kJumpThresholdNs = 100'000'000;
+  static constexpr uint32_t kLateWindowsForJump = 4;
+
+  /**
+   * @brief Records sample with service time seen at local time.
+   */
+  void Observe(uint64_t service_time_ms, int64_t local_ns) noexcept;
+  /**
+   * @brief Copies published mapping.
+   * @return false before the first observation
+   */
+  bool TryGetMapping(inseye::c::InseyeClockMapping& mapping) const noexcept;
+
+ private:
+  struct WindowMinimum {
+    uint64_t service_time_ms;
+    // local time minus service time in nanoseconds, arrival delay plus clock
+    // offset
+    int64_t offset_ns;
+  };
+
+  void Reset() noexcept;
+  void CloseWindow() noexcept;
+  void Fit() noexcept;
+  void Publish(uint64_t reference_time, double reference_local_ns,
+               double local_ns_per_ms) noexcept;
+  [[nodiscard]] double PredictOffset(uint64_t service_time_ms) const noexcept;
+
+  std::atomic_flag updating_;
+  // state below is touched only while updating_ is set
+  std::array<WindowMinimum, kWindowCount> minima_{};
+  uint32_t minima_count_ = 0;
+  uint32_t newest_minimum_ = 0;
+  bool window_open_ = false;
+  WindowMinimum window_{};
+  uint64_t window_end_ms_ = 0;
+  uint32_t late_windows_ = 0;
+  // fitted offset at fit_reference_ms_ and its slope (drift)
+  bool fitted_ = false;
+  uint64_t fit_reference_ms_ = 0;
+  double fit_offset_ns_ = 0;
+  double fit_drift_ns_per_ms_ = 0;
+  uint64_t observation_count_ = 0;
+
+  // published mapping, odd sequence while it's being written, nothing was
+  // published while observation count is 0
+  std::atomic<uint32_t> sequence_ = 0;
+  std::atomic<uint64_t> reference_time_ = 0;
+  std::atomic<double> reference_local_ns_ = 0;
+  std::atomic<double> local_ns_per_ms_ = 0;
+  std::atomic<uint64_t> published_observation_count_ = 0;
+};
+
+}  // namespace inseye::internal
+#endif  //REMOTE_CONNECTOR_LIB_CLOCK_MODEL_HPP
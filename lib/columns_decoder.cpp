@@ -0,0 +1,303 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include "columns_decoder.hpp"
+#include <cstring>
+#include <limits>
+#include "endianess_helpers.hpp"
+#include "eye_tracker_data_struct.hpp"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+#define INSEYE_X86_KERNELS 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC allows intrinsics of any instruction set in every function
+#define INSEYE_TARGET_SSE41
+#define INSEYE_TARGET_AVX2
+#else
+#define INSEYE_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define INSEYE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define INSEYE_X86_KERNELS 0
+#endif
+
+using inseye::c::InseyeEyeTrackerDataColumns;
+using inseye::internal::ColumnsDecoderKernel;
+using inseye::internal::EyeTrackerDataStruct;
+
+namespace {
+constexpr size_t time_offset = offsetof(EyeTrackerDataStruct, time);
+constexpr size_t left_eye_x_offset = offsetof(EyeTrackerDataStruct, left_eye_x);
+constexpr size_t gaze_event_offset = offsetof(EyeTrackerDataStruct, gaze_event);
+constexpr uint32_t unknown_gaze_event =
+    static_cast<uint32_t>(inseye::c::InseyeGazeEvent::kUnknown);
+// vector kernels load four position floats of a sample with one 16 byte load
+static_assert(offsetof(EyeTrackerDataStruct, left_eye_y) ==
+                  left_eye_x_offset + 4 &&
+              offsetof(EyeTrackerDataStruct, right_eye_x) ==
+                  left_eye_x_offset + 8 &&
+              offsetof(EyeTrackerDataStruct, right_eye_y) ==
+                  left_eye_x_offset + 12,
+              "Eye positions must be stored next to each other");
+
+void DecodeScalar(const std::byte* source, size_t sample_size, uint32_t count,
+                  const InseyeEyeTrackerDataColumns& columns,
+                  size_t column_offset) noexcept {
+  using inseye::internal::read_swap_endianess_if_needed;
+  for (uint32_t i = 0; i < count; ++i, source += sample_size) {
+    const size_t column = column_offset + i;
+    columns.time[column] = read_swap_endianess_if_needed(
+        reinterpret_cast<const uint64_t*>(source + time_offset));
+    columns.left_eye_x[column] = read_swap_endianess_if_needed(
+        reinterpret_cast<const float*>(source + left_eye_x_offset));
+    columns.left_eye_y[column] = read_swap_endianess_if_needed(
+        reinterpret_cast<const float*>(source + left_eye_x_offset + 4));
+    columns.right_eye_x[column] = read_swap_endianess_if_needed(
+        reinterpret_cast<const float*>(source + left_eye_x_offset + 8));
+    columns.right_eye_y[column] = read_swap_endianess_if_needed(
+        reinterpret_cast<const float*>(source + left_eye_x_offset + 12));
+    const auto gaze_event = read_swap_endianess_if_needed(
+        reinterpret_cast<const uint32_t*>(source + gaze_event_offset));
+    columns.gaze_event[column] = static_cast<inseye::c::InseyeGazeEvent>(
+        gaze_event < unknown_gaze_event ? gaze_event : unknown_gaze_event);
+  }
+}
+
+#if INSEYE_X86_KERNELS
+
+inline int32_t LoadInt32(const std::byte* source) noexcept {
+  int32_t value;
+  std::memcpy(&value, source, sizeof(value));
+  return value;
+}
+
+// Four samples per iteration. Eye positions of each sample are loaded as one
+// row and transposed into columns, time and gaze event are assembled from
+// scalar loads.
+INSEYE_TARGET_SSE41 void DecodeSse41(const std::byte* source,
+                                     size_t sample_size, uint32_t count,
+                                     const InseyeEyeTrackerDataColumns& columns,
+                                     size_t column_offset) noexcept {
+  const __m128i maximum_event =
+      _mm_set1_epi32(static_cast<int32_t>(unknown_gaze_event));
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const std::byte* s0 = source + i * sample_size;
+    const std::byte* s1 = s0 + sample_size;
+    const std::byte* s2 = s1 + sample_size;
+    const std::byte* s3 = s2 + sample_size;
+    const size_t column = column_offset + i;
+
+    __m128 row0 = _mm_loadu_ps(reinterpret_cast<const float*>(s0 + left_eye_x_offset));
+    __m128 row1 = _mm_loadu_ps(reinterpret_cast<const float*>(s1 + left_eye_x_offset));
+    __m128 row2 = _mm_loadu_ps(reinterpret_cast<const float*>(s2 + left_eye_x_offset));
+    __m128 row3 = _mm_loadu_ps(reinterpret_cast<const float*>(s3 + left_eye_x_offset));
+    _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+    _mm_storeu_ps(columns.left_eye_x + column, row0);
+    _mm_storeu_ps(columns.left_eye_y + column, row1);
+    _mm_storeu_ps(columns.right_eye_x + column, row2);
+    _mm_storeu_ps(columns.right_eye_y + column, row3);
+
+    const __m128i time01 = _mm_unpacklo_epi64(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(s0 + time_offset)),
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(s1 + time_offset)));
+    const __m128i time23 = _mm_unpacklo_epi64(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(s2 + time_offset)),
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(s3 + time_offset)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(columns.time + column), time01);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(columns.time + column + 2),
+                     time23);
+
+    __m128i events = _mm_cvtsi32_si128(LoadInt32(s0 + gaze_event_offset));
+    events = _mm_insert_epi32(events, LoadInt32(s1 + gaze_event_offset), 1);
+    events = _mm_insert_epi32(events, LoadInt32(s2 + gaze_event_offset), 2);
+    events = _mm_insert_epi32(events, LoadInt32(s3 + gaze_event_offset), 3);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(columns.gaze_event + column),
+                     _mm_min_epu32(events, maximum_event));
+  }
+  DecodeScalar(source + i * sample_size, sample_size, count - i, columns,
+               column_offset + i);
+}
+
+// Eight samples per iteration. Rows of samples i and i + 4 share one register
+// so in lane 4x4 transpose yields columns in sample order, time and gaze event
+// are gathered with stride of the sample size.
+INSEYE_TARGET_AVX2 void DecodeAvx2(const std::byte* source, size_t sample_size,
+                                   uint32_t count,
+                                   const InseyeEyeTrackerDataColumns& columns,
+                                   size_t column_offset) noexcept {
+  const auto stride = static_cast<int32_t>(sample_size);
+  const __m128i time_indexes =
+      _mm_setr_epi32(0, stride, 2 * stride, 3 * stride);
+  const __m256i event_indexes =
+      _mm256_setr_epi32(0, stride, 2 * stride, 3 * stride, 4 * stride,
+                        5 * stride, 6 * stride, 7 * stride);
+  const __m256i maximum_event =
+      _mm256_set1_epi32(static_cast<int32_t>(unknown_gaze_event));
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const std::byte* first = source + i * sample_size;
+    const size_t column = column_offset + i;
+
+    __m256 rows[4];
+    for (int row = 0; row < 4; ++row) {
+      const std::byte* low = first + row * sample_size + left_eye_x_offset;
+      const std::byte* high = low + 4 * sample_size;
+      rows[row] = _mm256_insertf128_ps(
+          _mm256_castps128_ps256(_mm_loadu_ps(reinterpret_cast<const float*>(low))),
+          _mm_loadu_ps(reinterpret_cast<const float*>(high)), 1);
+    }
+    const __m256 t0 = _mm256_unpacklo_ps(rows[0], rows[1]);
+    const __m256 t1 = _mm256_unpackhi_ps(rows[0], rows[1]);
+    const __m256 t2 = _mm256_unpacklo_ps(rows[2], rows[3]);
+    const __m256 t3 = _mm256_unpackhi_ps(rows[2], rows[3]);
+    _mm256_storeu_ps(columns.left_eye_x + column,
+                     _mm256_castpd_ps(_mm256_unpacklo_pd(
+                         _mm256_castps_pd(t0), _mm256_castps_pd(t2))));
+    _mm256_storeu_ps(columns.left_eye_y + column,
+                     _mm256_castpd_ps(_mm256_unpackhi_pd(
+                         _mm256_castps_pd(t0), _mm256_castps_pd(t2))));
+    _mm256_storeu_ps(columns.right_eye_x + column,
+                     _mm256_castpd_ps(_mm256_unpacklo_pd(
+                         _mm256_castps_pd(t1), _mm256_castps_pd(t3))));
+    _mm256_storeu_ps(columns.right_eye_y + column,
+                     _mm256_castpd_ps(_mm256_unpackhi_pd(
+                         _mm256_castps_pd(t1), _mm256_castps_pd(t3))));
+
+    const auto* time_base =
+        reinterpret_cast<const long long*>(first + time_offset);
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(columns.time + column),
+        _mm256_i32gather_epi64(time_base, time_indexes, 1));
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(columns.time + column + 4),
+        _mm256_i32gather_epi64(reinterpret_cast<const long long*>(
+                                   first + 4 * sample_size + time_offset),
+                               time_indexes, 1));
+
+    const __m256i events = _mm256_i32gather_epi32(
+        reinterpret_cast<const int*>(first + gaze_event_offset), event_indexes,
+        1);
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(columns.gaze_event + column),
+        _mm256_min_epu32(events, maximum_event));
+  }
+  DecodeSse41(source + i * sample_size, sample_size, count - i, columns,
+              column_offset + i);
+}
+
+struct CpuFeatures {
+  bool sse41 = false;
+  bool avx2 = false;
+};
+
+CpuFeatures DetectCpuFeatures() noexcept {
+  CpuFeatures features;
+#if defined(_MSC_VER) && !defined(__clang__)
+  int registers[4];
+  __cpuid(registers, 0);
+  const int highest_leaf = registers[0];
+  __cpuid(registers, 1);
+  features.sse41 = (registers[2] & (1 << 19)) != 0;
+  const bool os_saves_ymm = (registers[2] & (1 << 27)) != 0 &&
+                            (_xgetbv(0) & 0x6) == 0x6;
+  if (highest_leaf >= 7 && os_saves_ymm) {
+    __cpuidex(registers, 7, 0);
+    features.avx2 = (registers[1] & (1 << 5)) != 0;
+  }
+#else
+  __builtin_cpu_init();
+  features.sse41 = __builtin_cpu_supports("sse4.1");
+  features.avx2 = __builtin_cpu_supports("avx2");
+#endif
+  return features;
+}
+
+const CpuFeatures& GetCpuFeatures() noexcept {
+  static const CpuFeatures features = DetectCpuFeatures();
+  return features;
+}
+
+#endif  // INSEYE_X86_KERNELS
+}  // namespace
+
+bool inseye::internal::IsColumnsDecoderKernelSupported(
+    ColumnsDecoderKernel kernel) noexcept {
+  if (kernel == ColumnsDecoderKernel::kScalar)
+    return true;
+#if INSEYE_X86_KERNELS
+  // vector kernels don't swap bytes
+  if constexpr (!kNativeIsLibEndian)
+    return false;
+  const auto& features = GetCpuFeatures();
+  switch (kernel) {
+    case ColumnsDecoderKernel::kSse41:
+      return features.sse41;
+    case ColumnsDecoderKernel::kAvx2:
+      return features.avx2 && features.sse41;
+    default:
+      return false;
+  }
+#else
+  return false;
+#endif
+}
+
+ColumnsDecoderKernel inseye::internal::SelectColumnsDecoderKernel() noexcept {
+  static const ColumnsDecoderKernel kernel = [] {
+    for (auto candidate :
+         {ColumnsDecoderKernel::kAvx2, ColumnsDecoderKernel::kSse41}) {
+      if (IsColumnsDecoderKernelSupported(candidate))
+        return candidate;
+    }
+    return ColumnsDecoderKernel::kScalar;
+  }();
+  return kernel;
+}
+
+const char* inseye::internal::ToString(ColumnsDecoderKernel kernel) noexcept {
+  switch (kernel) {
+    case ColumnsDecoderKernel::kScalar:
+      return "scalar";
+    case ColumnsDecoderKernel::kSse41:
+      return "sse4.1";
+    case ColumnsDecoderKernel::kAvx2:
+      return "avx2";
+  }
+  return "unknown";
+}
+
+void inseye::internal::DecodeSampleColumns(
+    ColumnsDecoderKernel kernel, const std::byte* source, size_t sample_size,
+    uint32_t count, const InseyeEyeTrackerDataColumns& columns,
+    size_t column_offset) noexcept {
+#if INSEYE_X86_KERNELS
+  // gather indexes of eight samples must fit in int32
+  if (kernel == ColumnsDecoderKernel::kAvx2 &&
+      sample_size <= (std::numeric_limits<int32_t>::max)() / 8) {
+    DecodeAvx2(source, sample_size, count, columns, column_offset);
+    return;
+  }
+  if (kernel != ColumnsDecoderKernel::kScalar) {
+    DecodeSse41(source, sample_size, count, columns, column_offset);
+    return;
+  }
+#else
+  (void)kernel;
+#endif
+  DecodeScalar(source, sample_size, count, columns, column_offset);
+}
+
+void inseye::internal::DecodeSampleColumns(
+    const std::byte* source, size_t sample_size, uint32_t count,
+    const InseyeEyeTrackerDataColumns& columns, size_t column_offset) noexcept {
+  DecodeSampleColumns(SelectColumnsDecoderKernel(), source, sample_size, count,
+                      columns, column_offset);
+}
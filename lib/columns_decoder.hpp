@@ -0,0 +1,53 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#ifndef REMOTE_CONNECTOR_LIB_COLUMNS_DECODER_HPP
+#define REMOTE_CONNECTOR_LIB_COLUMNS_DECODER_HPP
+#include <cstddef>
+#include <cstdint>
+#include "remote_connector.h"
+
+// Decoding of packed ring samples (EyeTrackerDataStruct) straight into
+// structure of arrays. On x86 kernels using AVX2 and SSE4.1 are selected at
+// runtime, other targets and big endian hosts use scalar kernel.
+namespace inseye::internal {
+
+enum class ColumnsDecoderKernel { kScalar, kSse41, kAvx2 };
+
+/**
+ * @brief Checks if kernel can run on this machine.
+ */
+bool IsColumnsDecoderKernelSupported(ColumnsDecoderKernel kernel) noexcept;
+
+/**
+ * @brief Returns fastest kernel supported by this machine, detected once.
+ */
+ColumnsDecoderKernel SelectColumnsDecoderKernel() noexcept;
+
+const char* ToString(ColumnsDecoderKernel kernel) noexcept;
+
+/**
+ * @brief Decodes count samples laid out every sample_size bytes starting at
+ * source and stores them in columns at positions
+ * [column_offset, column_offset + count).
+ * Kernel must be supported on this machine.
+ */
+void DecodeSampleColumns(ColumnsDecoderKernel kernel, const std::byte* source,
+                         size_t sample_size, uint32_t count,
+                         const inseye::c::InseyeEyeTrackerDataColumns& columns,
+                         size_t column_offset) noexcept;
+
+/**
+ * @brief Decodes samples with kernel returned from SelectColumnsDecoderKernel.
+ */
+void DecodeSampleColumns(const std::byte* source, size_t sample_size,
+                         uint32_t count,
+                         const inseye::c::InseyeEyeTrackerDataColumns& columns,
+                         size_t column_offset) noexcept;
+
+}  // namespace inseye::internal
+#endif  //REMOTE_CONNECTOR_LIB_COLUMNS_DECODER_HPP
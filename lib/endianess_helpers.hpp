@@ -8,54 +8,57 @@
 
 #ifndef ENDIANESS_HELPERS_HPP_
 #define ENDIANESS_HELPERS_HPP_
-#include <algorithm>
-#include <array>
 #include <bit>
-#include <functional>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
 
 namespace inseye::internal {
 constexpr std::endian LIB_ENDIAN = std::endian::little;
-#pragma optimize("", off)
-// make sure that this function is not cut off during compilation
-inline std::endian GetEndian() {
-  int i = 1;
-  return (int)*(unsigned char*)&i == 1 ? std::endian::little : std::endian::big;
-}
-#pragma optimize("", on)
+constexpr bool kNativeIsLibEndian = std::endian::native == LIB_ENDIAN;
+
+template <typename T>
+using same_size_unsigned_t = std::conditional_t<
+    sizeof(T) == 1, uint8_t,
+    std::conditional_t<sizeof(T) == 2, uint16_t,
+                       std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
 
 template <typename T>
-T byteswap(const T& ref) {
-  using arr_type = std::array<std::byte, sizeof(T)>;
-  static_assert(sizeof(T) == sizeof(arr_type), "Mismatched size.");
-  auto value_representation = std::bit_cast<arr_type, T>(ref);
-  std::ranges::reverse(value_representation);
-  return std::bit_cast<T, arr_type>(value_representation);
+constexpr T byteswap(const T& ref) {
+  static_assert(std::is_trivially_copyable_v<T> &&
+                    (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 ||
+                     sizeof(T) == 8),
+                "Only scalar values can be byte swapped, swap aggregates "
+                "field by field.");
+  if constexpr (std::is_integral_v<T>) {
+    return std::byteswap(ref);
+  } else {
+    using unsigned_type = same_size_unsigned_t<T>;
+    return std::bit_cast<T>(std::byteswap(std::bit_cast<unsigned_type>(ref)));
+  }
 }
 
+// Values in shared memory and pipe messages are not aligned to their size,
+// memcpy compiles to single (unaligned) load/store on every supported target.
 template <typename T>
 T read_swap_endianess_if_needed(const T* arg) {
-  static const std::function<T(const T*)> implementation =
-      GetEndian() == LIB_ENDIAN ? [](const T* arg) -> T {
-    return *arg;
+  T value;
+  std::memcpy(&value, arg, sizeof(T));
+  if constexpr (kNativeIsLibEndian) {
+    return value;
+  } else {
+    return byteswap<T>(value);
   }
-  : [](const T* arg) -> T {
-      return byteswap<T>(*arg);
-    };
-
-  return implementation(arg);
 }
 
 template <typename T>
 void write_swap_endianess_if_needed(T* destination, const T* source) {
-  static const std::function<void(T*, const T*)> implementation =
-      GetEndian() == LIB_ENDIAN ? [](T*, const T*) -> void {
-    return;
+  if constexpr (kNativeIsLibEndian) {
+    std::memcpy(destination, source, sizeof(T));
+  } else {
+    const T swapped = byteswap<T>(*source);
+    std::memcpy(destination, &swapped, sizeof(T));
   }
-  : [](T* destination, const T* source) -> void {
-      *destination = byteswap<T>(*source);
-      return;
-    };
-  return implementation(destination, source);
 }
 }
 #endif
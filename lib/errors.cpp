@@ -20,12 +20,21 @@ void WriteErrorMessage(const std::string& message) {
   if (message.length() >= message_buffer_size) {
     length = message_buffer_size - 1;
   }
-  for (int i = 0; i < length; ++i) {
+  for (size_t i = 0; i < length; ++i) {
     messageBuffer[i] = message[i];
   }
   messageBuffer[length] = '\0';
 }
 
+void WriteErrorMessage(const char* message) {
+  size_t length = 0;
+  while (length < message_buffer_size - 1 && message[length] != '\0') {
+    messageBuffer[length] = message[length];
+    ++length;
+  }
+  messageBuffer[length] = '\0';
+}
+
 inseye::c::InseyeInitializationStatus ThrowInitialization(
     std::array<char, message_buffer_size> message,
     inseye::c::InseyeInitializationStatus status) {
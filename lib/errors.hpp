@@ -22,6 +22,8 @@ class InitializationException : public std::exception {
 
 void WriteErrorMessage(std::array<char, 1024> message);
 void WriteErrorMessage(const std::string& message);
+// doesn't allocate, used by reads
+void WriteErrorMessage(const char* message);
 inseye::c::InseyeInitializationStatus ThrowInitialization(std::array<char, 1024> message, inseye::c::InseyeInitializationStatus status);
 inseye::c::InseyeInitializationStatus ThrowInitialization(const std::string &message, inseye::c::InseyeInitializationStatus status);
 void ThrowIfCancellationRequested(const std::function<bool ()> &is_cancellation_requested);
@@ -8,6 +8,7 @@
 
 #ifndef EYE_TRACKER_DATA_STRUCT_HPP
 #define EYE_TRACKER_DATA_STRUCT_HPP
+#include <cstddef>
 #include "remote_connector.h"
 #include "endianess_helpers.hpp"
 
@@ -24,36 +25,60 @@ typedef struct EyeTrackerDataStruct {
 } EyeTrackerDataStruct;
 #pragma pack(pop)
 
-inline void readDataSample(LPBYTE offsetedMemory, inseye::EyeTrackerDataStruct& dataStruct) {
+inline void readDataSample(const std::byte* offsetedMemory, inseye::EyeTrackerDataStruct& dataStruct) {
   using time_type = decltype(EyeTrackerDataStruct::time);
   using pos_type = decltype(EyeTrackerDataStruct::left_eye_x);
   dataStruct.time =
       read_swap_endianess_if_needed<time_type>(
-      reinterpret_cast<time_type*>(offsetedMemory + offsetof(
+      reinterpret_cast<const time_type*>(offsetedMemory + offsetof(
                                                      EyeTrackerDataStruct, time)));
   dataStruct.left_eye_x =
       read_swap_endianess_if_needed<pos_type>(
-      reinterpret_cast<pos_type*>(offsetedMemory + offsetof(
+      reinterpret_cast<const pos_type*>(offsetedMemory + offsetof(
                                                     EyeTrackerDataStruct, left_eye_x)));
   dataStruct.left_eye_y =
       read_swap_endianess_if_needed<pos_type>(
-      reinterpret_cast<pos_type*>(offsetedMemory + offsetof(
+      reinterpret_cast<const pos_type*>(offsetedMemory + offsetof(
                                                     EyeTrackerDataStruct, left_eye_y)));
   dataStruct.right_eye_x =
       read_swap_endianess_if_needed<pos_type>(
-      reinterpret_cast<pos_type*>(offsetedMemory + offsetof(
+      reinterpret_cast<const pos_type*>(offsetedMemory + offsetof(
                                                     EyeTrackerDataStruct, right_eye_x)));
   dataStruct.right_eye_y =
       read_swap_endianess_if_needed<pos_type>(
-      reinterpret_cast<pos_type*>(offsetedMemory + offsetof(
+      reinterpret_cast<const pos_type*>(offsetedMemory + offsetof(
                                                     EyeTrackerDataStruct, right_eye_y)));
   auto read_value =
       read_swap_endianess_if_needed<uint32_t>(
-    reinterpret_cast<uint32_t *>(offsetedMemory + offsetof(inseye::EyeTrackerDataStruct, gaze_event)));
+    reinterpret_cast<const uint32_t *>(offsetedMemory + offsetof(inseye::EyeTrackerDataStruct, gaze_event)));
   if (read_value >= static_cast<uint32_t>(GazeEvent::kUnknown)) // last value in enum
     read_value = static_cast<uint32_t>(GazeEvent::kUnknown);
   dataStruct.gaze_event = static_cast<GazeEvent>(read_value);
 }
 
+inline void writeDataSample(std::byte* offsetedMemory, const inseye::EyeTrackerDataStruct& dataStruct) {
+  using time_type = decltype(EyeTrackerDataStruct::time);
+  using pos_type = decltype(EyeTrackerDataStruct::left_eye_x);
+  write_swap_endianess_if_needed<time_type>(
+      reinterpret_cast<time_type*>(offsetedMemory + offsetof(EyeTrackerDataStruct, time)),
+      &dataStruct.time);
+  write_swap_endianess_if_needed<pos_type>(
+      reinterpret_cast<pos_type*>(offsetedMemory + offsetof(EyeTrackerDataStruct, left_eye_x)),
+      &dataStruct.left_eye_x);
+  write_swap_endianess_if_needed<pos_type>(
+      reinterpret_cast<pos_type*>(offsetedMemory + offsetof(EyeTrackerDataStruct, left_eye_y)),
+      &dataStruct.left_eye_y);
+  write_swap_endianess_if_needed<pos_type>(
+      reinterpret_cast<pos_type*>(offsetedMemory + offsetof(EyeTrackerDataStruct, right_eye_x)),
+      &dataStruct.right_eye_x);
+  write_swap_endianess_if_needed<pos_type>(
+      reinterpret_cast<pos_type*>(offsetedMemory + offsetof(EyeTrackerDataStruct, right_eye_y)),
+      &dataStruct.right_eye_y);
+  const auto gaze_event = static_cast<uint32_t>(dataStruct.gaze_event);
+  write_swap_endianess_if_needed<uint32_t>(
+      reinterpret_cast<uint32_t*>(offsetedMemory + offsetof(EyeTrackerDataStruct, gaze_event)),
+      &gaze_event);
+}
+
 }
 #endif //EYE_TRACKER_DATA_STRUCT_HPP
\ No newline at end of file
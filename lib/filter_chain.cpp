@@ -0,0 +1,419 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include "filter_chain.hpp"
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define INSEYE_SSE2_LANES 1
+#include <emmintrin.h>
+#else
+#define INSEYE_SSE2_LANES 0
+#endif
+
+static_assert(offsetof(inseye::c::InseyeEyeTrackerDataStruct, left_eye_y) ==
+                      offsetof(inseye::c::InseyeEyeTrackerDataStruct,
+                               left_eye_x) + sizeof(float) &&
+                  offsetof(inseye::c::InseyeEyeTrackerDataStruct,
+                           right_eye_x) ==
+                      offsetof(inseye::c::InseyeEyeTrackerDataStruct,
+                               left_eye_x) + 2 * sizeof(float) &&
+                  offsetof(inseye::c::InseyeEyeTrackerDataStruct,
+                           right_eye_y) ==
+                      offsetof(inseye::c::InseyeEyeTrackerDataStruct,
+                               left_eye_x) + 3 * sizeof(float),
+              "eye positions are loaded as single vector");
+
+namespace {
+constexpr float two_pi = 6.28318530717958647692f;
+constexpr float default_derivative_cutoff_hz = 1.0f;
+
+// Four lanes (left x, left y, right x, right y) and lane masks.
+#if INSEYE_SSE2_LANES
+struct Vector {
+  __m128 lanes;
+};
+struct Mask {
+  __m128 lanes;
+};
+
+inline Vector Load(const float* source) { return {_mm_loadu_ps(source)}; }
+inline void Store(float* destination, Vector value) {
+  _mm_storeu_ps(destination, value.lanes);
+}
+inline Vector Splat(float value) { return {_mm_set1_ps(value)}; }
+inline Vector operator+(Vector a, Vector b) {
+  return {_mm_add_ps(a.lanes, b.lanes)};
+}
+inline Vector operator-(Vector a, Vector b) {
+  return {_mm_sub_ps(a.lanes, b.lanes)};
+}
+inline Vector operator*(Vector a, Vector b) {
+  return {_mm_mul_ps(a.lanes, b.lanes)};
+}
+inline Vector operator/(Vector a, Vector b) {
+  return {_mm_div_ps(a.lanes, b.lanes)};
+}
+inline Vector Min(Vector a, Vector b) { return {_mm_min_ps(a.lanes, b.lanes)}; }
+inline Vector Max(Vector a, Vector b) { return {_mm_max_ps(a.lanes, b.lanes)}; }
+inline Vector Abs(Vector a) {
+  return {_mm_andnot_ps(_mm_set1_ps(-0.0f), a.lanes)};
+}
+// sum of squares of eye's two lanes in both lanes of the eye
+inline Vector SumEyeLanes(Vector a) {
+  return {_mm_add_ps(a.lanes, _mm_shuffle_ps(a.lanes, a.lanes,
+                                             _MM_SHUFFLE(2, 3, 0, 1)))};
+}
+inline Mask Greater(Vector a, Vector b) {
+  return {_mm_cmpgt_ps(a.lanes, b.lanes)};
+}
+inline Mask operator&(Mask a, Mask b) { return {_mm_and_ps(a.lanes, b.lanes)}; }
+inline Mask EyeMask(bool left, bool right) {
+  const int l = left ? -1 : 0, r = right ? -1 : 0;
+  return {_mm_castsi128_ps(_mm_set_epi32(r, r, l, l))};
+}
+// lanes of a where mask is set, lanes of b elsewhere
+inline Vector Select(Mask mask, Vector a, Vector b) {
+  return {_mm_or_ps(_mm_and_ps(mask.lanes, a.lanes),
+                    _mm_andnot_ps(mask.lanes, b.lanes))};
+}
+#else
+struct Vector {
+  float lanes[4];
+};
+struct Mask {
+  bool lanes[4];
+};
+
+template <typename Operation>
+inline Vector Map(Vector a, Vector b, Operation&& operation) {
+  Vector result;
+  for (int i = 0; i < 4; ++i)
+    result.lanes[i] = operation(a.lanes[i], b.lanes[i]);
+  return result;
+}
+inline Vector Load(const float* source) {
+  return {{source[0], source[1], source[2], source[3]}};
+}
+inline void Store(float* destination, Vector value) {
+  for (int i = 0; i < 4; ++i)
+    destination[i] = value.lanes[i];
+}
+inline Vector Splat(float value) { return {{value, value, value, value}}; }
+inline Vector operator+(Vector a, Vector b) {
+  return Map(a, b, [](float x, float y) { return x + y; });
+}
+inline Vector operator-(Vector a, Vector b) {
+  return Map(a, b, [](float x, float y) { return x - y; });
+}
+inline Vector operator*(Vector a, Vector b) {
+  return Map(a, b, [](float x, float y) { return x * y; });
+}
+inline Vector operator/(Vector a, Vector b) {
+  return Map(a, b, [](float x, float y) { return x / y; });
+}
+inline Vector Min(Vector a, Vector b) {
+  return Map(a, b, [](float x, float y) { return y < x ? y : x; });
+}
+inline Vector Max(Vector a, Vector b) {
+  return Map(a, b, [](float x, float y) { return x < y ? y : x; });
+}
+inline Vector Abs(Vector a) {
+  return Map(a, a, [](float x, float) { return x < 0 ? -x : x; });
+}
+inline Vector SumEyeLanes(Vector a) {
+  return {{a.lanes[0] + a.lanes[1], a.lanes[0] + a.lanes[1],
+           a.lanes[2] + a.lanes[3], a.lanes[2] + a.lanes[3]}};
+}
+inline Mask Greater(Vector a, Vector b) {
+  Mask result;
+  for (int i = 0; i < 4; ++i)
+    result.lanes[i] = a.lanes[i] > b.lanes[i];
+  return result;
+}
+inline Mask operator&(Mask a, Mask b) {
+  Mask result;
+  for (int i = 0; i < 4; ++i)
+    result.lanes[i] = a.lanes[i] && b.lanes[i];
+  return result;
+}
+inline Mask EyeMask(bool left, bool right) {
+  return {{left, left, right, right}};
+}
+inline Vector Select(Mask mask, Vector a, Vector b) {
+  Vector result;
+  for (int i = 0; i < 4; ++i)
+    result.lanes[i] = mask.lanes[i] ? a.lanes[i] : b.lanes[i];
+  return result;
+}
+#endif
+
+inline Mask ClosedEyes(inseye::c::InseyeGazeEvent gaze_event) {
+  const auto event = static_cast<uint32_t>(gaze_event);
+  constexpr uint32_t both =
+      inseye::c::kInsGazeBlinkBoth | inseye::c::kInsGazeHeadsetDismount;
+  return EyeMask((event & (inseye::c::kInsGazeBlinkLeft | both)) != 0,
+                 (event & (inseye::c::kInsGazeBlinkRight | both)) != 0);
+}
+
+// Smoothing factor of exponential filter with cutoff at given frequency.
+inline float SmoothingFactor(float cutoff_hz, float interval_s) {
+  const float r = two_pi * cutoff_hz * interval_s;
+  return r / (r + 1.0f);
+}
+
+// Odd-even transposition sort of Count vectors, lane by lane. Count is
+// constant so that the network is unrolled and stays in registers.
+template <uint32_t Count>
+inline void SortLanes(Vector* values) {
+  for (uint32_t pass = 0; pass < Count; ++pass)
+    for (uint32_t i = pass & 1; i + 1 < Count; i += 2) {
+      const Vector low = Min(values[i], values[i + 1]);
+      values[i + 1] = Max(values[i], values[i + 1]);
+      values[i] = low;
+    }
+}
+
+// Interval is time since the previous sample, samples with the same time keep
+// the previous interval.
+inline void AdvanceClock(uint64_t& time, float& interval_s,
+                         uint64_t sample_time) {
+  const auto elapsed_ms = static_cast<int64_t>(sample_time - time);
+  if (elapsed_ms > 0)
+    interval_s = static_cast<float>(elapsed_ms) * 1e-3f;
+  time = sample_time;
+}
+
+// Replaces eye positions of every sample with step(positions, closed eyes,
+// interval).
+template <typename Step>
+inline void ForEachSample(inseye::c::InseyeEyeTrackerDataStruct* samples,
+                          uint32_t count, uint64_t time, float interval_s,
+                          Step&& step) {
+  for (uint32_t i = 0; i < count; ++i) {
+    auto& sample = samples[i];
+    AdvanceClock(time, interval_s, sample.time);
+    Store(&sample.left_eye_x, step(Load(&sample.left_eye_x),
+                                   ClosedEyes(sample.gaze_event), interval_s));
+  }
+}
+
+// Median stage with window of Window samples stored oldest first, returns
+// the last output.
+template <uint32_t Window, typename Lanes>
+Vector RunMedian(Lanes* stored_window, Vector output,
+                 inseye::c::InseyeEyeTrackerDataStruct* samples,
+                 uint32_t count, uint64_t time, float interval_s) {
+  Vector window[Window];
+  for (uint32_t w = 0; w < Window; ++w)
+    window[w] = Load(stored_window[w].values);
+  ForEachSample(samples, count, time, interval_s,
+                [&](Vector position, Mask closed, float) {
+                  for (uint32_t w = 0; w + 1 < Window; ++w)
+                    window[w] = window[w + 1];
+                  // closed eye pushes its held output so that window stays
+                  // full
+                  window[Window - 1] = Select(closed, output, position);
+                  Vector sorted[Window];
+                  for (uint32_t w = 0; w < Window; ++w)
+                    sorted[w] = window[w];
+                  SortLanes<Window>(sorted);
+                  output = Select(closed, output, sorted[Window / 2]);
+                  return output;
+                });
+  for (uint32_t w = 0; w < Window; ++w)
+    Store(stored_window[w].values, window[w]);
+  return output;
+}
+}  // namespace
+
+const char* inseye::internal::FilterChain::Validate(
+    const inseye::c::InseyeFilterStage* stages, uint32_t stage_count) noexcept {
+  if (stage_count > kMaximumStageCount)
+    return "Filter chain has more than 8 stages.";
+  if (stage_count != 0 && stages == nullptr)
+    return "Filter stages must not be null.";
+  for (uint32_t i = 0; i < stage_count; ++i) {
+    const auto& stage = stages[i];
+    switch (stage.type) {
+      case inseye::c::kInsFilterExponentialMovingAverage:
+        if (!(stage.alpha > 0.0f && stage.alpha <= 1.0f))
+          return "Exponential moving average alpha must be in (0, 1].";
+        break;
+      case inseye::c::kInsFilterOneEuro:
+        if (!(stage.min_cutoff_hz > 0.0f) || !(stage.beta >= 0.0f) ||
+            !(stage.derivative_cutoff_hz >= 0.0f))
+          return "One Euro filter requires positive min_cutoff_hz and "
+                 "non negative beta and derivative_cutoff_hz.";
+        break;
+      case inseye::c::kInsFilterMedian:
+        if (stage.window < 3 || stage.window > kMaximumMedianWindow ||
+            stage.window % 2 == 0)
+          return "Median filter window must be odd number from 3 to 15.";
+        break;
+      case inseye::c::kInsFilterOutlierRejection:
+        if (!(stage.max_jump > 0.0f) || stage.max_rejected == 0)
+          return "Outlier rejection requires positive max_jump and "
+                 "max_rejected.";
+        break;
+      default:
+        return "Unknown filter stage type.";
+    }
+  }
+  return nullptr;
+}
+
+inseye::internal::FilterChain::FilterChain(
+    const inseye::c::InseyeFilterStage* stages, uint32_t stage_count) noexcept
+    : stage_count_(stage_count) {
+  for (uint32_t i = 0; i < stage_count; ++i) {
+    stages_[i].configuration = stages[i];
+    if (stages[i].type == inseye::c::kInsFilterOneEuro &&
+        stages[i].derivative_cutoff_hz == 0.0f)
+      stages_[i].configuration.derivative_cutoff_hz =
+          default_derivative_cutoff_hz;
+  }
+}
+
+void inseye::internal::FilterChain::Start(
+    const inseye::c::InseyeEyeTrackerDataStruct& sample) noexcept {
+  const Vector position = Load(&sample.left_eye_x);
+  for (uint32_t i = 0; i < stage_count_; ++i) {
+    auto& stage = stages_[i];
+    Store(stage.output.values, position);
+    Store(stage.derivative.values, Splat(0.0f));
+    Store(stage.rejected.values, Splat(0.0f));
+    // window starts full of the first sample
+    for (auto& lanes : stage.window)
+      Store(lanes.values, position);
+  }
+  time_ = sample.time;
+  started_ = true;
+}
+
+void inseye::internal::FilterChain::RunStage(
+    Stage& stage, inseye::c::InseyeEyeTrackerDataStruct* samples,
+    uint32_t count, uint64_t time, float interval_s) noexcept {
+  const auto& configuration = stage.configuration;
+  Vector output = Load(stage.output.values);
+  switch (configuration.type) {
+    case inseye::c::kInsFilterExponentialMovingAverage: {
+      const Vector alpha = Splat(configuration.alpha);
+      ForEachSample(samples, count, time, interval_s,
+                    [&](Vector position, Mask closed, float) {
+                      output = Select(closed, output,
+                                      output + alpha * (position - output));
+                      return output;
+                    });
+      break;
+    }
+    case inseye::c::kInsFilterOneEuro: {
+      Vector derivative = Load(stage.derivative.values);
+      const Vector min_cutoff = Splat(configuration.min_cutoff_hz);
+      const Vector beta = Splat(configuration.beta);
+      // factors depending on interval change only with sample rate
+      float factors_interval = 0;
+      Vector rate{}, derivative_factor{}, cutoff_scale{};
+      ForEachSample(
+          samples, count, time, interval_s,
+          [&](Vector position, Mask closed, float interval) {
+            if (interval != factors_interval) {
+              factors_interval = interval;
+              rate = Splat(1.0f / interval);
+              derivative_factor = Splat(SmoothingFactor(
+                  configuration.derivative_cutoff_hz, interval));
+              cutoff_scale = Splat(two_pi * interval);
+            }
+            const Vector speed = (position - output) * rate;
+            const Vector filtered_speed =
+                derivative + derivative_factor * (speed - derivative);
+            const Vector r =
+                cutoff_scale * (min_cutoff + beta * Abs(filtered_speed));
+            const Vector next =
+                output + r / (r + Splat(1.0f)) * (position - output);
+            derivative = Select(closed, derivative, filtered_speed);
+            output = Select(closed, output, next);
+            return output;
+          });
+      Store(stage.derivative.values, derivative);
+      break;
+    }
+    case inseye::c::kInsFilterMedian:
+      switch (configuration.window) {
+        case 3:
+          output = RunMedian<3>(stage.window.data(), output, samples, count,
+                                time, interval_s);
+          break;
+        case 5:
+          output = RunMedian<5>(stage.window.data(), output, samples, count,
+                                time, interval_s);
+          break;
+        case 7:
+          output = RunMedian<7>(stage.window.data(), output, samples, count,
+                                time, interval_s);
+          break;
+        case 9:
+          output = RunMedian<9>(stage.window.data(), output, samples, count,
+                                time, interval_s);
+          break;
+        case 11:
+          output = RunMedian<11>(stage.window.data(), output, samples, count,
+                                 time, interval_s);
+          break;
+        case 13:
+          output = RunMedian<13>(stage.window.data(), output, samples, count,
+                                 time, interval_s);
+          break;
+        default:
+          output = RunMedian<15>(stage.window.data(), output, samples, count,
+                                 time, interval_s);
+          break;
+      }
+      break;
+    case inseye::c::kInsFilterOutlierRejection: {
+      Vector rejected = Load(stage.rejected.values);
+      const Vector max_jump_squared =
+          Splat(configuration.max_jump * configuration.max_jump);
+      const Vector max_rejected =
+          Splat(static_cast<float>(configuration.max_rejected) + 0.5f);
+      ForEachSample(samples, count, time, interval_s,
+                    [&](Vector position, Mask closed, float) {
+                      const Vector jump = position - output;
+                      const Vector jumps = rejected + Splat(1.0f);
+                      const Mask reject =
+                          Greater(SumEyeLanes(jump * jump), max_jump_squared) &
+                          Greater(max_rejected, jumps);
+                      rejected = Select(closed, rejected,
+                                        Select(reject, jumps, Splat(0.0f)));
+                      output = Select(closed, output,
+                                      Select(reject, output, position));
+                      return output;
+                    });
+      Store(stage.rejected.values, rejected);
+      break;
+    }
+  }
+  Store(stage.output.values, output);
+}
+
+void inseye::internal::FilterChain::Process(
+    inseye::c::InseyeEyeTrackerDataStruct* samples, uint32_t count) noexcept {
+  if (count == 0)
+    return;
+  if (!started_) {
+    // the first sample passes unchanged and starts every stage
+    Start(samples[0]);
+    ++samples;
+    --count;
+  }
+  // stage by stage over the whole batch, stage state stays in registers
+  for (uint32_t s = 0; s < stage_count_; ++s)
+    RunStage(stages_[s], samples, count, time_, interval_s_);
+  for (uint32_t i = 0; i < count; ++i)
+    AdvanceClock(time_, interval_s_, samples[i].time);
+}
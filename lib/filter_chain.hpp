@@ -0,0 +1,76 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#ifndef REMOTE_CONNECTOR_LIB_FILTER_CHAIN_HPP
+#define REMOTE_CONNECTOR_LIB_FILTER_CHAIN_HPP
+#include <array>
+#include <cstdint>
+#include "remote_connector.h"
+
+namespace inseye::internal {
+
+/**
+ * @brief Fixed size filter chain applied in place to batches of samples.
+ * Recursive stages depend on their previous output, so instead of running
+ * along time they process the four position angles of a sample (left x,
+ * left y, right x, right y, contiguous in the sample) as a single 128-bit
+ * vector, with scalar fallback on other architectures.
+ */
+class FilterChain {
+ public:
+  static constexpr uint32_t kMaximumStageCount = 8;
+  static constexpr uint32_t kMaximumMedianWindow = 15;
+
+  /**
+   * @brief Returns description of the first invalid stage, null when all
+   * stages are valid.
+   */
+  static const char* Validate(const inseye::c::InseyeFilterStage* stages,
+                              uint32_t stage_count) noexcept;
+  /**
+   * @brief Stages must be valid.
+   */
+  FilterChain(const inseye::c::InseyeFilterStage* stages,
+              uint32_t stage_count) noexcept;
+  void Process(inseye::c::InseyeEyeTrackerDataStruct* samples,
+               uint32_t count) noexcept;
+  // next processed sample starts every stage again, like the first one
+  void Restart() noexcept { started_ = false; }
+
+ private:
+  // left x, left y, right x, right y
+  struct alignas(16) Lanes {
+    float values[4];
+  };
+
+  struct Stage {
+    inseye::c::InseyeFilterStage configuration;
+    Lanes output;
+    // kInsFilterOneEuro filtered speed in radians per second
+    Lanes derivative;
+    // kInsFilterOutlierRejection consecutive rejections per eye
+    Lanes rejected;
+    // kInsFilterMedian window of the last inputs, oldest first
+    std::array<Lanes, kMaximumMedianWindow> window;
+  };
+
+  void Start(const inseye::c::InseyeEyeTrackerDataStruct& sample) noexcept;
+  static void RunStage(Stage& stage,
+                       inseye::c::InseyeEyeTrackerDataStruct* samples,
+                       uint32_t count, uint64_t time,
+                       float interval_s) noexcept;
+
+  std::array<Stage, kMaximumStageCount> stages_{};
+  uint32_t stage_count_ = 0;
+  bool started_ = false;
+  uint64_t time_ = 0;
+  // interval used for samples with the same time as the previous one
+  float interval_s_ = 1e-3f;
+};
+
+}  // namespace inseye::internal
+#endif  //REMOTE_CONNECTOR_LIB_FILTER_CHAIN_HPP
@@ -0,0 +1,367 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "reader_internal.hpp"
+#include "remote_connector.h"
+#include "transport.hpp"
+
+namespace {
+// longest sleep between checks of writers that don't wake readers up and of
+// cancelled waiters
+constexpr auto watcher_wait_slice = std::chrono::milliseconds(1);
+
+enum class WaiterState {
+  // watcher checks the reader
+  kWaiting,
+  // continuation was resumed or scheduled on executor, await_resume didn't
+  // start yet
+  kScheduled,
+  // await_resume reads from the reader
+  kResuming
+};
+
+struct Waiter {
+  inseye::GazeDataAwaiter* awaiter;
+  // keeps the mapping alive while the watcher sleeps on it
+  std::shared_ptr<const uint32_t> samples_written;
+  WaiterState state = WaiterState::kWaiting;
+};
+
+struct Resumption {
+  std::coroutine_handle<> continuation;
+  inseye::Executor* executor;
+};
+}  // namespace
+
+// Single thread resumes every suspended coroutine. It is started by the
+// first waiter, sleeps on samples written counter of the oldest waiting
+// waiter, readers of the same service share the counter, and parks when
+// nothing waits. Parked thread and kept capacity of the vectors let later
+// awaits run without allocation.
+// Waiter stays registered after its continuation is handed off until
+// await_resume finished reading, so that destroyed reader cancels scheduled
+// continuations too and its destruction waits for reads in flight.
+struct inseye::internal::GazeDataWatcher {
+  std::mutex mutex;
+  std::condition_variable waiter_added;
+  std::condition_variable resume_finished;
+  std::vector<Waiter> waiters;
+  bool started = false;
+
+  static GazeDataWatcher& Instance() {
+    // never destroyed, watcher thread may outlive static destructors
+    static auto* watcher = new GazeDataWatcher();
+    return *watcher;
+  }
+
+  static bool IsDataAvailable(const GazeDataAwaiter& awaiter) {
+    return awaiter.cursor_ != nullptr
+               ? inseye::c::IsCursorGazeDataAvailable(awaiter.cursor_)
+               : inseye::c::IsGazeDataAvailable(awaiter.tracker_);
+  }
+
+  // Returns false when coroutine should not be suspended.
+  bool Register(GazeDataAwaiter& awaiter) noexcept {
+    std::lock_guard lock(mutex);
+    if (IsDataAvailable(awaiter))
+      return false;
+    try {
+      waiters.push_back(
+          {&awaiter, awaiter.cursor_ != nullptr
+                         ? internal::GetSamplesWrittenCounter(*awaiter.cursor_)
+                         : internal::GetSamplesWrittenCounter(
+                               *awaiter.tracker_)});
+      if (!started) {
+        std::thread(&GazeDataWatcher::Run, this).detach();
+        started = true;
+      } else {
+        waiter_added.notify_one();
+      }
+    } catch (const std::exception&) {
+      // resumed at once with empty result
+      if (!waiters.empty() && waiters.back().awaiter == &awaiter)
+        waiters.pop_back();
+      awaiter.cancelled_ = true;
+      return false;
+    }
+    // awaiter may be resumed and destroyed as soon as the lock is released
+    return true;
+  }
+
+  static bool IsWaiterOf(const Waiter& waiter, const void* reader) {
+    return waiter.awaiter->tracker_ == reader ||
+           waiter.awaiter->cursor_ == reader;
+  }
+
+  // Returns after no await_resume reads from the reader.
+  void Cancel(const void* reader) noexcept {
+    std::unique_lock lock(mutex);
+    for (auto& waiter : waiters)
+      if (IsWaiterOf(waiter, reader))
+        waiter.awaiter->cancelled_ = true;
+    resume_finished.wait(lock, [this, reader] {
+      return std::none_of(
+          waiters.begin(), waiters.end(), [reader](const Waiter& waiter) {
+            return waiter.state == WaiterState::kResuming &&
+                   IsWaiterOf(waiter, reader);
+          });
+    });
+  }
+
+  // Called by await_resume, returns false when it must not read because the
+  // reader was destroyed. Awaiter that was not suspended isn't registered.
+  bool BeginResume(GazeDataAwaiter& awaiter) noexcept {
+    std::lock_guard lock(mutex);
+    const auto waiter = FindWaiter(awaiter);
+    if (waiter == waiters.end())
+      return !awaiter.cancelled_;
+    if (awaiter.cancelled_) {
+      waiters.erase(waiter);
+      return false;
+    }
+    waiter->state = WaiterState::kResuming;
+    return true;
+  }
+
+  // Called when await_resume finished and by destructor of awaiter whose
+  // coroutine was destroyed while suspended. Forgets the continuation, so
+  // that destructor of resumed awaiter doesn't lock.
+  void Deregister(GazeDataAwaiter& awaiter) noexcept {
+    {
+      std::lock_guard lock(mutex);
+      awaiter.continuation_ = nullptr;
+      const auto waiter = FindWaiter(awaiter);
+      if (waiter == waiters.end())
+        return;
+      waiters.erase(waiter);
+    }
+    resume_finished.notify_all();
+  }
+
+  std::vector<Waiter>::iterator FindWaiter(const GazeDataAwaiter& awaiter) {
+    return std::find_if(waiters.begin(), waiters.end(),
+                        [&awaiter](const Waiter& waiter) {
+                          return waiter.awaiter == &awaiter;
+                        });
+  }
+
+  [[nodiscard]] bool HasWaiting() const noexcept {
+    return std::any_of(waiters.begin(), waiters.end(),
+                       [](const Waiter& waiter) {
+                         return waiter.state == WaiterState::kWaiting;
+                       });
+  }
+
+  void Run() noexcept {
+    std::vector<Resumption> ready;
+    std::shared_ptr<const uint32_t> samples_written;
+    while (true) {
+      ready.clear();
+      uint32_t observed_value = 0;
+      {
+        std::unique_lock lock(mutex);
+        if (!HasWaiting()) {
+          // mapping is not held while parked
+          samples_written.reset();
+          waiter_added.wait(lock, [this] { return HasWaiting(); });
+        }
+        samples_written =
+            std::find_if(waiters.begin(), waiters.end(),
+                         [](const Waiter& waiter) {
+                           return waiter.state == WaiterState::kWaiting;
+                         })
+                ->samples_written;
+        // loaded before the checks, so that publication after them ends
+        // the sleep at once
+        observed_value = std::atomic_ref<uint32_t>(
+                             *const_cast<uint32_t*>(samples_written.get()))
+                             .load(std::memory_order_relaxed);
+        for (auto& waiter : waiters) {
+          auto& awaiter = *waiter.awaiter;
+          if (waiter.state != WaiterState::kWaiting ||
+              (!awaiter.cancelled_ && !IsDataAvailable(awaiter)))
+            continue;
+          waiter.state = WaiterState::kScheduled;
+          ready.push_back(
+              {std::coroutine_handle<>::from_address(awaiter.continuation_),
+               awaiter.executor_});
+        }
+      }
+      if (ready.empty()) {
+        inseye::internal::WaitForSharedValueChange(
+            samples_written.get(), observed_value, watcher_wait_slice);
+        continue;
+      }
+      // awaiters are gone once their coroutines run, only copies are used
+      for (const auto& resumption : ready) {
+        if (resumption.executor != nullptr)
+          resumption.executor->Schedule(resumption.continuation);
+        else
+          resumption.continuation.resume();
+      }
+    }
+  }
+};
+
+void inseye::internal::CancelGazeDataWaiters(const void* reader) noexcept {
+  GazeDataWatcher::Instance().Cancel(reader);
+}
+
+namespace {
+// Keeps reader of resumed awaiter alive while await_resume reads.
+class ResumeScope {
+  inseye::GazeDataAwaiter& awaiter_;
+  bool readable_;
+
+ public:
+  explicit ResumeScope(inseye::GazeDataAwaiter& awaiter) noexcept
+      : awaiter_(awaiter),
+        readable_(inseye::internal::GazeDataWatcher::Instance().BeginResume(
+            awaiter)) {}
+  ResumeScope(const ResumeScope&) = delete;
+  ResumeScope& operator=(const ResumeScope&) = delete;
+  ~ResumeScope() {
+    inseye::internal::GazeDataWatcher::Instance().Deregister(awaiter_);
+  }
+  [[nodiscard]] bool IsReadable() const noexcept { return readable_; }
+};
+}  // namespace
+
+inseye::GazeDataAwaiter::GazeDataAwaiter(inseye::c::InseyeEyeTracker* tracker,
+                                         inseye::c::InseyeCursor* cursor,
+                                         Executor* executor) noexcept
+    : tracker_(tracker), cursor_(cursor), executor_(executor) {}
+
+inseye::GazeDataAwaiter::~GazeDataAwaiter() {
+  // continuation is kept only while coroutine is suspended
+  if (continuation_ != nullptr)
+    internal::GazeDataWatcher::Instance().Deregister(*this);
+}
+
+bool inseye::GazeDataAwaiter::await_ready() const noexcept {
+  return internal::GazeDataWatcher::IsDataAvailable(*this);
+}
+
+bool inseye::GazeDataAwaiter::await_suspend(
+    std::coroutine_handle<> continuation) noexcept {
+  continuation_ = continuation.address();
+  return internal::GazeDataWatcher::Instance().Register(*this);
+}
+
+std::optional<inseye::EyeTrackerDataStruct>
+inseye::NextSampleAwaiter::await_resume() noexcept {
+  const ResumeScope scope(*this);
+  if (!scope.IsReadable())
+    return std::nullopt;
+  inseye::EyeTrackerDataStruct sample{};
+  const bool read =
+      cursor_ != nullptr
+          ? inseye::c::TryReadNextCursorData(cursor_, &sample)
+          : inseye::c::TryReadNextEyeTrackerData(tracker_, &sample);
+  if (!read)
+    return std::nullopt;
+  return sample;
+}
+
+inseye::NextBatchAwaiter::NextBatchAwaiter(
+    inseye::c::InseyeEyeTracker* tracker, inseye::c::InseyeCursor* cursor,
+    Executor* executor, std::span<EyeTrackerDataStruct> out_data) noexcept
+    : GazeDataAwaiter(tracker, cursor, executor),
+      out_data_(out_data.data()),
+      capacity_(static_cast<uint32_t>(out_data.size())) {}
+
+uint32_t inseye::NextBatchAwaiter::await_resume() noexcept {
+  const ResumeScope scope(*this);
+  if (!scope.IsReadable())
+    return 0;
+  uint32_t count = 0;
+  const bool read =
+      cursor_ != nullptr
+          ? inseye::c::TryReadCursorDataBatch(cursor_, out_data_, capacity_,
+                                              &count)
+          : inseye::c::TryReadEyeTrackerDataBatch(tracker_, out_data_,
+                                                  capacity_, &count);
+  return read ? count : 0;
+}
+
+inseye::SampleStream::SampleStream(inseye::c::InseyeEyeTracker* tracker,
+                                   inseye::c::InseyeCursor* cursor,
+                                   Executor* executor) noexcept
+    : tracker_(tracker), cursor_(cursor), executor_(executor) {}
+
+inseye::SampleStream::NextAwaiter inseye::SampleStream::Next() noexcept {
+  return NextAwaiter(this);
+}
+
+inseye::SampleStream::NextAwaiter::NextAwaiter(SampleStream* stream) noexcept
+    : GazeDataAwaiter(stream->tracker_, stream->cursor_, stream->executor_),
+      stream_(stream) {}
+
+bool inseye::SampleStream::NextAwaiter::await_ready() const noexcept {
+  return stream_->position_ != stream_->count_ ||
+         GazeDataAwaiter::await_ready();
+}
+
+std::optional<inseye::EyeTrackerDataStruct>
+inseye::SampleStream::NextAwaiter::await_resume() noexcept {
+  auto& stream = *stream_;
+  const ResumeScope scope(*this);
+  if (stream.position_ == stream.count_) {
+    if (!scope.IsReadable())
+      return std::nullopt;
+    stream.position_ = 0;
+    stream.count_ = 0;
+    const bool read =
+        cursor_ != nullptr
+            ? inseye::c::TryReadCursorDataBatch(
+                  cursor_, stream.buffer_, kBufferSize, &stream.count_)
+            : inseye::c::TryReadEyeTrackerDataBatch(
+                  tracker_, stream.buffer_, kBufferSize, &stream.count_);
+    if (!read || stream.count_ == 0)
+      return std::nullopt;
+  }
+  return stream.buffer_[stream.position_++];
+}
+
+inseye::NextSampleAwaiter inseye::EyeTracker::NextSample(
+    Executor* executor) noexcept {
+  return {implementation_pointer_, nullptr, executor};
+}
+
+inseye::NextBatchAwaiter inseye::EyeTracker::NextBatch(
+    std::span<EyeTrackerDataStruct> out_data, Executor* executor) noexcept {
+  return {implementation_pointer_, nullptr, executor, out_data};
+}
+
+inseye::SampleStream inseye::EyeTracker::Samples(Executor* executor) noexcept {
+  return {implementation_pointer_, nullptr, executor};
+}
+
+inseye::NextSampleAwaiter inseye::EyeTrackerCursor::NextSample(
+    Executor* executor) noexcept {
+  return {nullptr, implementation_pointer_, executor};
+}
+
+inseye::NextBatchAwaiter inseye::EyeTrackerCursor::NextBatch(
+    std::span<EyeTrackerDataStruct> out_data, Executor* executor) noexcept {
+  return {nullptr, implementation_pointer_, executor, out_data};
+}
+
+inseye::SampleStream inseye::EyeTrackerCursor::Samples(
+    Executor* executor) noexcept {
+  return {nullptr, implementation_pointer_, executor};
+}
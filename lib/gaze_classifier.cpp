@@ -0,0 +1,236 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include "gaze_classifier.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+constexpr uint32_t left_closed_events = inseye::c::kInsGazeBlinkLeft |
+                                        inseye::c::kInsGazeBlinkBoth |
+                                        inseye::c::kInsGazeHeadsetDismount;
+constexpr uint32_t right_closed_events = inseye::c::kInsGazeBlinkRight |
+                                         inseye::c::kInsGazeBlinkBoth |
+                                         inseye::c::kInsGazeHeadsetDismount;
+constexpr uint32_t left_eye_open = 1;
+constexpr uint32_t right_eye_open = 2;
+
+bool IsFiniteNonNegative(float value) {
+  return value >= 0.0f && value <= (std::numeric_limits<float>::max)();
+}
+}  // namespace
+
+const char* inseye::internal::GazeClassifier::Validate(
+    const inseye::c::InseyeGazeClassifierOptions& options) noexcept {
+  if (!IsFiniteNonNegative(options.saccade_velocity_threshold))
+    return "Saccade velocity threshold must be finite and non negative.";
+  if (!IsFiniteNonNegative(options.fixation_dispersion_threshold))
+    return "Fixation dispersion threshold must be finite and non negative.";
+  if (options.velocity_window_ms > kMaximumVelocityWindowMs)
+    return "Velocity window must be at most 100 ms.";
+  return nullptr;
+}
+
+inseye::internal::GazeClassifier::GazeClassifier(
+    const inseye::c::InseyeGazeClassifierOptions& options) noexcept
+    : saccade_velocity_threshold_(options.saccade_velocity_threshold != 0.0f
+                                      ? options.saccade_velocity_threshold
+                                      : kDefaultSaccadeVelocityThreshold),
+      fixation_dispersion_threshold_(
+          options.fixation_dispersion_threshold != 0.0f
+              ? options.fixation_dispersion_threshold
+              : kDefaultFixationDispersionThreshold),
+      min_fixation_duration_ms_(options.min_fixation_duration_ms != 0
+                                    ? options.min_fixation_duration_ms
+                                    : kDefaultMinimumFixationDurationMs),
+      velocity_window_ms_(options.velocity_window_ms != 0
+                              ? options.velocity_window_ms
+                              : kDefaultVelocityWindowMs) {}
+
+void inseye::internal::GazeClassifier::Add(
+    const inseye::c::InseyeEyeTrackerDataStruct& sample) noexcept {
+  if (started_ &&
+      (sample.time < time_ || sample.time - time_ > kMaximumSampleGapMs))
+    Interrupt();
+  started_ = true;
+  time_ = sample.time;
+  const auto event = static_cast<uint32_t>(sample.gaze_event);
+  uint32_t open_eyes = 0;
+  if ((event & left_closed_events) == 0)
+    open_eyes |= left_eye_open;
+  if ((event & right_closed_events) == 0)
+    open_eyes |= right_eye_open;
+  if (open_eyes != open_eyes_)
+    // blink, or position switches between cyclopean and single eye
+    Flush();
+  if (open_eyes == 0) {
+    Classify(sample.time, false, 0, 0, 0);
+    return;
+  }
+  open_eyes_ = open_eyes;
+  float x = sample.left_eye_x, y = sample.left_eye_y;
+  if (open_eyes == right_eye_open) {
+    x = sample.right_eye_x;
+    y = sample.right_eye_y;
+  } else if (open_eyes == (left_eye_open | right_eye_open)) {
+    x = (x + sample.right_eye_x) / 2;
+    y = (y + sample.right_eye_y) / 2;
+  }
+
+  if (window_end_ - window_begin_ == kWindowCapacity) {
+    if (window_pending_ == window_begin_) {
+      const auto& oldest = window_[window_pending_ % kWindowCapacity];
+      Classify(oldest.time, true, oldest.x, oldest.y, velocity_);
+      ++window_pending_;
+    }
+    ++window_begin_;
+  }
+  window_[window_end_++ % kWindowCapacity] = {sample.time, x, y};
+  // oldest sample stays at least window length back, samples waiting for
+  // classification are kept
+  while (window_begin_ < window_pending_ &&
+         window_[(window_begin_ + 1) % kWindowCapacity].time +
+                 velocity_window_ms_ <=
+             sample.time)
+    ++window_begin_;
+  const auto& oldest = window_[window_begin_ % kWindowCapacity];
+  if (sample.time > oldest.time)
+    velocity_ = std::hypot(x - oldest.x, y - oldest.y) /
+                (static_cast<float>(sample.time - oldest.time) * 1e-3f);
+  // velocity belongs to the middle of the window
+  const uint64_t half_window = velocity_window_ms_ / 2;
+  while (window_pending_ != window_end_) {
+    const auto& pending = window_[window_pending_ % kWindowCapacity];
+    if (pending.time + half_window > sample.time)
+      break;
+    Classify(pending.time, true, pending.x, pending.y, velocity_);
+    ++window_pending_;
+  }
+}
+
+void inseye::internal::GazeClassifier::Interrupt() noexcept {
+  Flush();
+  if (segment_open_)
+    Close(segment_last_time_, false, 0, 0, true);
+  has_position_ = false;
+  started_ = false;
+}
+
+uint32_t inseye::internal::GazeClassifier::Pop(
+    inseye::c::InseyeGazeSegment* segments, uint32_t capacity) noexcept {
+  const uint32_t count = (std::min)(capacity, queue_end_ - queue_begin_);
+  for (uint32_t i = 0; i < count; ++i)
+    segments[i] = queue_[queue_begin_++ % kSegmentQueueCapacity];
+  return count;
+}
+
+void inseye::internal::GazeClassifier::Flush() noexcept {
+  while (window_pending_ != window_end_) {
+    const auto& pending = window_[window_pending_ % kWindowCapacity];
+    Classify(pending.time, true, pending.x, pending.y, velocity_);
+    ++window_pending_;
+  }
+  window_begin_ = window_end_;
+  open_eyes_ = 0;
+  velocity_ = 0;
+}
+
+void inseye::internal::GazeClassifier::Classify(uint64_t time, bool open,
+                                                float x, float y,
+                                                float velocity) noexcept {
+  const auto type = !open ? inseye::c::kInsSegmentBlink
+                    : velocity > saccade_velocity_threshold_
+                        ? inseye::c::kInsSegmentSaccade
+                        : inseye::c::kInsSegmentFixation;
+  bool ends_segment = !segment_open_ || type != segment_type_;
+  if (!ends_segment && type == inseye::c::kInsSegmentFixation) {
+    const auto count = static_cast<double>(segment_sample_count_);
+    const double dx = x - sum_x_ / count;
+    const double dy = y - sum_y_ / count;
+    const double threshold = fixation_dispersion_threshold_;
+    ends_segment = dx * dx + dy * dy > threshold * threshold;
+  }
+  if (ends_segment) {
+    if (segment_open_)
+      Close(time, open, x, y, false);
+    Begin(type, time, open, x, y, velocity);
+  } else {
+    ++segment_sample_count_;
+    segment_last_time_ = time;
+    peak_velocity_ = (std::max)(peak_velocity_, velocity);
+    if (type == inseye::c::kInsSegmentFixation) {
+      sum_x_ += x;
+      sum_y_ += y;
+      min_x_ = (std::min)(min_x_, x);
+      min_y_ = (std::min)(min_y_, y);
+      max_x_ = (std::max)(max_x_, x);
+      max_y_ = (std::max)(max_y_, y);
+    }
+  }
+  if (open) {
+    has_position_ = true;
+    x_ = x;
+    y_ = y;
+  }
+}
+
+void inseye::internal::GazeClassifier::Begin(
+    inseye::c::InseyeGazeSegmentType type, uint64_t time, bool open, float x,
+    float y, float velocity) noexcept {
+  segment_open_ = true;
+  segment_type_ = type;
+  segment_start_time_ = segment_last_time_ = time;
+  segment_sample_count_ = 1;
+  peak_velocity_ = velocity;
+  sum_x_ = x;
+  sum_y_ = y;
+  min_x_ = max_x_ = x;
+  min_y_ = max_y_ = y;
+  // saccade starts where the previous segment ended, blink holds position
+  // the eyes closed at
+  start_x_ = has_position_ ? x_ : open ? x : 0;
+  start_y_ = has_position_ ? y_ : open ? y : 0;
+}
+
+void inseye::internal::GazeClassifier::Close(uint64_t end_time,
+                                             bool has_next_position,
+                                             float next_x, float next_y,
+                                             bool truncated) noexcept {
+  auto& segment = queue_[queue_end_++ % kSegmentQueueCapacity];
+  segment.start_time = segment_start_time_;
+  segment.duration_ms = static_cast<uint32_t>(end_time - segment_start_time_);
+  segment.sample_count = segment_sample_count_;
+  segment.type = segment_type_;
+  segment.flags = truncated ? inseye::c::kInsSegmentTruncated : 0;
+  segment.peak_velocity = peak_velocity_;
+  switch (segment_type_) {
+    case inseye::c::kInsSegmentFixation: {
+      const auto count = static_cast<double>(segment_sample_count_);
+      segment.x = static_cast<float>(sum_x_ / count);
+      segment.y = static_cast<float>(sum_y_ / count);
+      segment.amplitude = (max_x_ - min_x_) + (max_y_ - min_y_);
+      if (segment.duration_ms < min_fixation_duration_ms_)
+        segment.type = inseye::c::kInsSegmentUnclassified;
+      break;
+    }
+    case inseye::c::kInsSegmentSaccade:
+      // landing is the first sample after saccade, the last saccade sample
+      // when eyes close or stream ends
+      segment.x = has_next_position ? next_x : x_;
+      segment.y = has_next_position ? next_y : y_;
+      segment.amplitude =
+          std::hypot(segment.x - start_x_, segment.y - start_y_);
+      break;
+    default:
+      segment.x = start_x_;
+      segment.y = start_y_;
+      segment.amplitude = 0;
+      break;
+  }
+  segment_open_ = false;
+}
@@ -0,0 +1,132 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#ifndef REMOTE_CONNECTOR_LIB_GAZE_CLASSIFIER_HPP
+#define REMOTE_CONNECTOR_LIB_GAZE_CLASSIFIER_HPP
+#include <array>
+#include <cstdint>
+#include "remote_connector.h"
+
+namespace inseye::internal {
+
+/**
+ * @brief Online fixation, saccade and blink classifier with fixed memory.
+ * Sample velocity is cyclopean gaze displacement across velocity window
+ * centred on the sample (I-VT), so sample is classified once the window
+ * passes it, half a window later. Samples at or below the velocity threshold
+ * form fixations, fixation ends when sample lands further than dispersion
+ * threshold from its running centroid (I-DT). Both eyes closed or headset
+ * dismounted is blink, window restarts after it as the eyes may have moved.
+ * Finished segments wait in fixed size queue until they are popped.
+ */
+class GazeClassifier {
+ public:
+  // 30 deg/s
+  static constexpr float kDefaultSaccadeVelocityThreshold = 0.5236f;
+  // 1 deg
+  static constexpr float kDefaultFixationDispersionThreshold = 0.01745f;
+  static constexpr uint32_t kDefaultMinimumFixationDurationMs = 60;
+  static constexpr uint32_t kDefaultVelocityWindowMs = 20;
+  static constexpr uint32_t kMaximumVelocityWindowMs = 100;
+  // samples further apart don't belong to the same segment
+  static constexpr uint64_t kMaximumSampleGapMs = 50;
+  // window covers fewer samples at very high sample rates
+  static constexpr uint32_t kWindowCapacity = 64;
+  static constexpr uint32_t kSegmentQueueCapacity = 256;
+
+  /**
+   * @brief Returns description of the first invalid option, null when
+   * options are valid.
+   */
+  static const char* Validate(
+      const inseye::c::InseyeGazeClassifierOptions& options) noexcept;
+  /**
+   * @brief Options must be valid, zero fields select defaults.
+   */
+  explicit GazeClassifier(
+      const inseye::c::InseyeGazeClassifierOptions& options) noexcept;
+  /**
+   * @brief True when the queue has room for every segment single sample may
+   * end.
+   */
+  bool CanAdd() const noexcept {
+    return kSegmentQueueCapacity - (queue_end_ - queue_begin_) >=
+           kWindowCapacity + 2;
+  }
+  /**
+   * @brief Classifies next sample of the stream, CanAdd must be true.
+   */
+  void Add(const inseye::c::InseyeEyeTrackerDataStruct& sample) noexcept;
+  /**
+   * @brief Ends the stream at a gap, samples waiting for the window are
+   * classified and open segment is queued as truncated. CanAdd must be true.
+   */
+  void Interrupt() noexcept;
+  /**
+   * @brief Moves at most capacity oldest finished segments to segments.
+   * @return number of moved segments
+   */
+  uint32_t Pop(inseye::c::InseyeGazeSegment* segments,
+               uint32_t capacity) noexcept;
+
+ private:
+  struct WindowSample {
+    uint64_t time;
+    float x, y;
+  };
+
+  // clears window after classifying samples waiting for it
+  void Flush() noexcept;
+  void Classify(uint64_t time, bool open, float x, float y,
+                float velocity) noexcept;
+  void Begin(inseye::c::InseyeGazeSegmentType type, uint64_t time, bool open,
+             float x, float y, float velocity) noexcept;
+  void Close(uint64_t end_time, bool has_next_position, float next_x,
+             float next_y, bool truncated) noexcept;
+
+  float saccade_velocity_threshold_;
+  float fixation_dispersion_threshold_;
+  uint32_t min_fixation_duration_ms_;
+  uint32_t velocity_window_ms_;
+
+  // window ring, indices grow and wrap, samples from window_pending_ to
+  // window_end_ wait for classification
+  std::array<WindowSample, kWindowCapacity> window_{};
+  uint32_t window_begin_ = 0;
+  uint32_t window_pending_ = 0;
+  uint32_t window_end_ = 0;
+  // bit 0 left eye, bit 1 right eye of samples in window
+  uint32_t open_eyes_ = 0;
+  float velocity_ = 0;
+  bool started_ = false;
+  uint64_t time_ = 0;
+
+  // position of the last classified sample with open eyes
+  bool has_position_ = false;
+  float x_ = 0, y_ = 0;
+
+  // open segment
+  bool segment_open_ = false;
+  inseye::c::InseyeGazeSegmentType segment_type_ =
+      inseye::c::kInsSegmentFixation;
+  uint64_t segment_start_time_ = 0;
+  uint64_t segment_last_time_ = 0;
+  uint32_t segment_sample_count_ = 0;
+  float peak_velocity_ = 0;
+  // fixation running sums and extent
+  double sum_x_ = 0, sum_y_ = 0;
+  float min_x_ = 0, min_y_ = 0, max_x_ = 0, max_y_ = 0;
+  // position saccade starts from and blink holds
+  float start_x_ = 0, start_y_ = 0;
+
+  std::array<inseye::c::InseyeGazeSegment, kSegmentQueueCapacity> queue_{};
+  uint32_t queue_begin_ = 0;
+  uint32_t queue_end_ = 0;
+};
+
+}  // namespace inseye::internal
+#endif  //REMOTE_CONNECTOR_LIB_GAZE_CLASSIFIER_HPP
@@ -0,0 +1,126 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include "gaze_predictor.hpp"
+#include <algorithm>
+
+namespace {
+constexpr uint32_t left_blink_events =
+    inseye::c::kInsGazeBlinkLeft | inseye::c::kInsGazeBlinkBoth;
+constexpr uint32_t right_blink_events =
+    inseye::c::kInsGazeBlinkRight | inseye::c::kInsGazeBlinkBoth;
+}  // namespace
+
+void inseye::internal::GazePredictor::Update(
+    const inseye::c::InseyeEyeTrackerDataStruct& sample) noexcept {
+  const auto event = static_cast<uint32_t>(sample.gaze_event);
+  const double dt =
+      static_cast<double>(static_cast<int64_t>(sample.time - time_));
+  // service stall or clock jump, nothing is known about the time between
+  const bool continuous = started_ && dt >= 0 && dt <= kMaximumSampleGapMs;
+  const bool restart = !continuous ||
+                       (event & (inseye::c::kInsGazeSaccade |
+                                 inseye::c::kInsGazeHeadsetMount)) != 0;
+  const double restart_variance = (event & inseye::c::kInsGazeSaccade) != 0
+                                      ? kSaccadePositionVariance
+                                      : kMeasurementVariance;
+  const float positions[2][2] = {{sample.left_eye_x, sample.left_eye_y},
+                                 {sample.right_eye_x, sample.right_eye_y}};
+  const uint32_t blink_events[2] = {left_blink_events, right_blink_events};
+  for (size_t i = 0; i < eyes_.size(); ++i) {
+    auto& eye = eyes_[i];
+    const bool closed =
+        (event & (blink_events[i] | inseye::c::kInsGazeHeadsetDismount)) != 0;
+    if (closed) {
+      // position before the eye closed is held, it's restarted once the eye
+      // opens as it may have moved meanwhile
+      if (!continuous)
+        Restart(eye, positions[i][0], positions[i][1], kMeasurementVariance);
+      eye.measured = false;
+      eye.velocity_x = eye.velocity_y = 0;
+    } else if (restart || !eye.measured) {
+      Restart(eye, positions[i][0], positions[i][1], restart_variance);
+    } else {
+      Advance(eye, dt);
+      Correct(eye, positions[i][0], positions[i][1]);
+    }
+  }
+  time_ = sample.time;
+  gaze_event_ = sample.gaze_event;
+  started_ = true;
+}
+
+bool inseye::internal::GazePredictor::Predict(
+    double target_time,
+    inseye::c::InseyeGazePrediction& prediction) const noexcept {
+  if (!started_)
+    return false;
+  const double horizon = std::clamp(target_time - static_cast<double>(time_),
+                                    -kMaximumHorizonMs, kMaximumHorizonMs);
+  const double distance = horizon < 0 ? -horizon : horizon;
+  float* outputs[2][2] = {{&prediction.left_eye_x, &prediction.left_eye_y},
+                          {&prediction.right_eye_x, &prediction.right_eye_y}};
+  double confidence = 0;
+  for (size_t i = 0; i < eyes_.size(); ++i) {
+    const auto& eye = eyes_[i];
+    *outputs[i][0] = static_cast<float>(eye.x + eye.velocity_x * horizon);
+    *outputs[i][1] = static_cast<float>(eye.y + eye.velocity_y * horizon);
+    if (!eye.measured)
+      continue;
+    const double variance =
+        eye.position_variance + 2 * horizon * eye.covariance +
+        horizon * horizon * eye.velocity_variance +
+        kAccelerationVariance * distance * distance * distance / 3;
+    confidence += kMeasurementVariance / (kMeasurementVariance + variance);
+  }
+  prediction.sample_time = time_;
+  prediction.confidence = static_cast<float>(confidence / 2);
+  prediction.gaze_event = gaze_event_;
+  return true;
+}
+
+void inseye::internal::GazePredictor::Restart(
+    EyeFilter& eye, float x, float y, double position_variance) noexcept {
+  eye.x = x;
+  eye.y = y;
+  eye.velocity_x = eye.velocity_y = 0;
+  eye.position_variance = position_variance;
+  eye.covariance = 0;
+  eye.velocity_variance = kInitialVelocityVariance;
+  eye.measured = true;
+}
+
+void inseye::internal::GazePredictor::Advance(EyeFilter& eye,
+                                              double dt) noexcept {
+  eye.x += eye.velocity_x * dt;
+  eye.y += eye.velocity_y * dt;
+  // P = F P F' + Q with F = [1 dt; 0 1] and white acceleration Q
+  const double q = kAccelerationVariance;
+  eye.position_variance +=
+      dt * (2 * eye.covariance + dt * eye.velocity_variance) +
+      q * dt * dt * dt / 3;
+  eye.covariance += dt * eye.velocity_variance + q * dt * dt / 2;
+  eye.velocity_variance += q * dt;
+}
+
+void inseye::internal::GazePredictor::Correct(EyeFilter& eye, float x,
+                                              float y) noexcept {
+  const double innovation_variance =
+      eye.position_variance + kMeasurementVariance;
+  const double position_gain = eye.position_variance / innovation_variance;
+  const double velocity_gain = eye.covariance / innovation_variance;
+  const double innovation_x = x - eye.x;
+  const double innovation_y = y - eye.y;
+  eye.x += position_gain * innovation_x;
+  eye.y += position_gain * innovation_y;
+  eye.velocity_x += velocity_gain * innovation_x;
+  eye.velocity_y += velocity_gain * innovation_y;
+  // P = (I - K H) P
+  eye.velocity_variance -= velocity_gain * eye.covariance;
+  eye.covariance -= position_gain * eye.covariance;
+  eye.position_variance -= position_gain * eye.position_variance;
+}
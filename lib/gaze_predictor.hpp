@@ -0,0 +1,72 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#ifndef REMOTE_CONNECTOR_LIB_GAZE_PREDICTOR_HPP
+#define REMOTE_CONNECTOR_LIB_GAZE_PREDICTOR_HPP
+#include <array>
+#include <cstdint>
+#include "remote_connector.h"
+
+namespace inseye::internal {
+
+/**
+ * @brief Constant velocity Kalman filter per eye, horizontal and vertical
+ * angle share covariance since both are measured at the same time with the
+ * same noise. Process noise is white acceleration, time unit is millisecond
+ * and angles are in radians.
+ * Saccade is too fast and too short to be extrapolated, filters are restarted
+ * at every saccade sample and track the landing position once it ends.
+ * Blinking eye is not measured and keeps its last position.
+ */
+class GazePredictor {
+ public:
+  // fixation noise of the tracker
+  static constexpr double kMeasurementVariance = 3e-3 * 3e-3;
+  // smooth pursuit accelerates up to about 1000 deg/s^2
+  static constexpr double kAccelerationVariance = 3e-10;
+  // velocity of restarted filter is zero, smooth pursuit stays below 30 deg/s
+  static constexpr double kInitialVelocityVariance = 5e-4 * 5e-4;
+  // eye moves about a degree between two samples of saccade
+  static constexpr double kSaccadePositionVariance = 2e-2 * 2e-2;
+  // samples further apart don't belong to the same movement
+  static constexpr double kMaximumSampleGapMs = 50.0;
+  // prediction doesn't extrapolate further
+  static constexpr double kMaximumHorizonMs = 100.0;
+
+  void Update(const inseye::c::InseyeEyeTrackerDataStruct& sample) noexcept;
+  /**
+   * @brief Extrapolates filtered gaze to target time.
+   * @return false before the first update
+   */
+  bool Predict(double target_time,
+               inseye::c::InseyeGazePrediction& prediction) const noexcept;
+  void Reset() noexcept { started_ = false; }
+
+ private:
+  struct EyeFilter {
+    double x = 0, y = 0;
+    double velocity_x = 0, velocity_y = 0;
+    double position_variance = 0;
+    double covariance = 0;
+    double velocity_variance = 0;
+    // false while the eye is closed or headset is off
+    bool measured = false;
+  };
+
+  static void Restart(EyeFilter& eye, float x, float y,
+                      double position_variance) noexcept;
+  static void Advance(EyeFilter& eye, double dt) noexcept;
+  static void Correct(EyeFilter& eye, float x, float y) noexcept;
+
+  std::array<EyeFilter, 2> eyes_{};
+  uint64_t time_ = 0;
+  inseye::c::InseyeGazeEvent gaze_event_ = inseye::c::kInsGazeNone;
+  bool started_ = false;
+};
+
+}  // namespace inseye::internal
+#endif  //REMOTE_CONNECTOR_LIB_GAZE_PREDICTOR_HPP
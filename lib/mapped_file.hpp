@@ -0,0 +1,82 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#ifndef REMOTE_CONNECTOR_LIB_MAPPED_FILE_HPP
+#define REMOTE_CONNECTOR_LIB_MAPPED_FILE_HPP
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "transport.hpp"
+
+// Regular file accessed through memory mapped views, used by recordings.
+// Implementations live in mapped_file_win32.cpp and mapped_file_posix.cpp.
+namespace inseye::internal {
+
+// Offsets of views must be multiple of this value on every platform
+// (allocation granularity on Windows, page size is smaller everywhere).
+constexpr uint32_t kMappedFileAlignment = 64 * 1024;
+
+class MappedFileView {
+  std::byte* data_ = nullptr;
+  size_t size_ = 0;
+
+ public:
+  MappedFileView() noexcept = default;
+  MappedFileView(std::byte* data, size_t size) noexcept;
+  MappedFileView(const MappedFileView&) = delete;
+  MappedFileView& operator=(const MappedFileView&) = delete;
+  MappedFileView(MappedFileView&& other) noexcept;
+  MappedFileView& operator=(MappedFileView&& other) noexcept;
+  ~MappedFileView();
+  [[nodiscard]] std::byte* data() const noexcept { return data_; }
+  [[nodiscard]] size_t size() const noexcept { return size_; }
+  /**
+   * @brief Starts asynchronous write back of modified pages.
+   * Data written to the view survives crash of the process without it, this
+   * only bounds amount of dirty memory and data lost on power failure.
+   */
+  void Flush() const noexcept;
+};
+
+class MappedFile {
+  NativeHandle handle_;
+  explicit MappedFile(NativeHandle handle) noexcept;
+
+ public:
+  /**
+   * @brief Creates (or truncates) file for reading and writing.
+   * Throws InitializationException on failure.
+   */
+  static MappedFile Create(const std::string& path);
+  /**
+   * @brief Opens existing file for reading.
+   * Throws InitializationException on failure.
+   */
+  static MappedFile Open(const std::string& path);
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  ~MappedFile();
+  [[nodiscard]] uint64_t Size() const noexcept;
+  /**
+   * @brief Grows file to size bytes and reserves disk space for it, so that
+   * writes through views can't fail on full disk.
+   * @return true on success
+   */
+  bool Extend(uint64_t size) noexcept;
+  /**
+   * @brief Maps size bytes starting at offset, offset must be multiple of
+   * kMappedFileAlignment.
+   * Throws InitializationException on failure.
+   */
+  [[nodiscard]] MappedFileView Map(uint64_t offset, size_t size,
+                                   bool writable) const;
+};
+
+}  // namespace inseye::internal
+#endif  //REMOTE_CONNECTOR_LIB_MAPPED_FILE_HPP
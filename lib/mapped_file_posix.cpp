@@ -0,0 +1,116 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include "mapped_file.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <utility>
+#include "errors.hpp"
+
+using namespace inseye::internal;
+
+constexpr NativeHandle invalid_handle = -1;
+
+MappedFileView::MappedFileView(std::byte* data, size_t size) noexcept
+    : data_(data), size_(size) {}
+
+MappedFileView::MappedFileView(MappedFileView&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+MappedFileView& MappedFileView::operator=(MappedFileView&& other) noexcept {
+  std::swap(data_, other.data_);
+  std::swap(size_, other.size_);
+  return *this;
+}
+
+MappedFileView::~MappedFileView() {
+  if (data_ != nullptr)
+    munmap(data_, size_);
+}
+
+void MappedFileView::Flush() const noexcept {
+  if (data_ != nullptr)
+    msync(data_, size_, MS_ASYNC);
+}
+
+MappedFile::MappedFile(NativeHandle handle) noexcept : handle_(handle) {}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : handle_(std::exchange(other.handle_, invalid_handle)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  std::swap(handle_, other.handle_);
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  if (handle_ != invalid_handle)
+    close(handle_);
+}
+
+MappedFile MappedFile::Create(const std::string& path) {
+  MappedFile file(open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                       0644));
+  if (file.handle_ == invalid_handle) {
+    ThrowInitialization(
+        std::format("Could not create file '{}', errno={} ({}).", path, errno,
+                    std::strerror(errno)),
+        inseye::c::InseyeInitializationStatus::kInsFailedToAccessRecordingFile);
+  }
+  return file;
+}
+
+MappedFile MappedFile::Open(const std::string& path) {
+  MappedFile file(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+  if (file.handle_ == invalid_handle) {
+    ThrowInitialization(
+        std::format("Could not open file '{}', errno={} ({}).", path, errno,
+                    std::strerror(errno)),
+        inseye::c::InseyeInitializationStatus::kInsFailedToAccessRecordingFile);
+  }
+  return file;
+}
+
+uint64_t MappedFile::Size() const noexcept {
+  struct stat file_stat {};
+  if (fstat(handle_, &file_stat) != 0)
+    return 0;
+  return static_cast<uint64_t>(file_stat.st_size);
+}
+
+bool MappedFile::Extend(uint64_t size) noexcept {
+  const uint64_t current_size = Size();
+  if (size <= current_size)
+    return true;
+#if defined(__linux__)
+  // writes to sparse mapped pages end with SIGBUS when disk is full
+  return posix_fallocate(handle_, static_cast<off_t>(current_size),
+                         static_cast<off_t>(size - current_size)) == 0;
+#else
+  return ftruncate(handle_, static_cast<off_t>(size)) == 0;
+#endif
+}
+
+MappedFileView MappedFile::Map(uint64_t offset, size_t size,
+                               bool writable) const {
+  const int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+  auto memory = mmap(nullptr, size, protection, MAP_SHARED, handle_,
+                     static_cast<off_t>(offset));
+  if (memory == MAP_FAILED) {
+    ThrowInitialization(
+        std::format("Could not map file view, errno={} ({}).", errno,
+                    std::strerror(errno)),
+        inseye::c::InseyeInitializationStatus::kInsFailedToAccessRecordingFile);
+  }
+  return {static_cast<std::byte*>(memory), size};
+}
@@ -0,0 +1,123 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include "mapped_file.hpp"
+#include <windows.h>
+#include <format>
+#include <utility>
+#include "errors.hpp"
+
+using namespace inseye::internal;
+
+MappedFileView::MappedFileView(std::byte* data, size_t size) noexcept
+    : data_(data), size_(size) {}
+
+MappedFileView::MappedFileView(MappedFileView&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+MappedFileView& MappedFileView::operator=(MappedFileView&& other) noexcept {
+  std::swap(data_, other.data_);
+  std::swap(size_, other.size_);
+  return *this;
+}
+
+MappedFileView::~MappedFileView() {
+  if (data_ != nullptr)
+    UnmapViewOfFile(data_);
+}
+
+void MappedFileView::Flush() const noexcept {
+  // FlushViewOfFile only queues the write back, it doesn't wait for the disk
+  if (data_ != nullptr)
+    FlushViewOfFile(data_, size_);
+}
+
+MappedFile::MappedFile(NativeHandle handle) noexcept : handle_(handle) {}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : handle_(std::exchange(other.handle_, INVALID_HANDLE_VALUE)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  std::swap(handle_, other.handle_);
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  if (handle_ != INVALID_HANDLE_VALUE)
+    CloseHandle(handle_);
+}
+
+MappedFile MappedFile::Create(const std::string& path) {
+  MappedFile file(CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr));
+  if (file.handle_ == INVALID_HANDLE_VALUE) {
+    ThrowInitialization(
+        std::format("Could not create file '{}', GLE={}.", path,
+                    GetLastError()),
+        inseye::c::InseyeInitializationStatus::kInsFailedToAccessRecordingFile);
+  }
+  return file;
+}
+
+MappedFile MappedFile::Open(const std::string& path) {
+  // recording may be still written by recorder
+  MappedFile file(CreateFileA(path.c_str(), GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+  if (file.handle_ == INVALID_HANDLE_VALUE) {
+    ThrowInitialization(
+        std::format("Could not open file '{}', GLE={}.", path, GetLastError()),
+        inseye::c::InseyeInitializationStatus::kInsFailedToAccessRecordingFile);
+  }
+  return file;
+}
+
+uint64_t MappedFile::Size() const noexcept {
+  LARGE_INTEGER size{};
+  if (!GetFileSizeEx(handle_, &size))
+    return 0;
+  return static_cast<uint64_t>(size.QuadPart);
+}
+
+bool MappedFile::Extend(uint64_t size) noexcept {
+  if (size <= Size())
+    return true;
+  LARGE_INTEGER distance{};
+  distance.QuadPart = static_cast<LONGLONG>(size);
+  // NTFS allocates clusters for the new end of file
+  return SetFilePointerEx(handle_, distance, nullptr, FILE_BEGIN) &&
+         SetEndOfFile(handle_);
+}
+
+MappedFileView MappedFile::Map(uint64_t offset, size_t size,
+                               bool writable) const {
+  const uint64_t mapping_size = offset + size;
+  // view keeps mapping object alive after its handle is closed
+  HANDLE mapping = CreateFileMappingA(
+      handle_, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+      static_cast<DWORD>(mapping_size >> 32), static_cast<DWORD>(mapping_size),
+      nullptr);
+  if (mapping == nullptr) {
+    ThrowInitialization(
+        std::format("Could not create file mapping, GLE={}.", GetLastError()),
+        inseye::c::InseyeInitializationStatus::kInsFailedToAccessRecordingFile);
+  }
+  auto memory = MapViewOfFile(mapping,
+                              writable ? FILE_MAP_WRITE : FILE_MAP_READ,
+                              static_cast<DWORD>(offset >> 32),
+                              static_cast<DWORD>(offset), size);
+  const auto error = GetLastError();
+  CloseHandle(mapping);
+  if (memory == nullptr) {
+    ThrowInitialization(
+        std::format("Could not map file view, GLE={}.", error),
+        inseye::c::InseyeInitializationStatus::kInsFailedToAccessRecordingFile);
+  }
+  return {static_cast<std::byte*>(memory), size};
+}
@@ -7,8 +7,8 @@
 // All other rights reserved.
 
 #include "named_pipe_communicator.hpp"
-#include <windows.h>
-#include <filesystem>
+#include <chrono>
+#include <cstddef>
 #include <format>
 #include <memory>
 #include "endianess_helpers.hpp"
@@ -16,9 +16,9 @@
 #include "remote_connector.h"
 #include "version.hpp"
 constexpr int maximum_pipe_message_length = 1024;
-using buffer_t = std::array<byte, maximum_pipe_message_length>;
-TCHAR named_pipe_name[] = TEXT("\\\\.\\pipe\\inseye.desktop-service");
-DWORD pipe_mode = PIPE_READMODE_MESSAGE;
+// service answers right away, anything longer means it hangs
+constexpr auto service_response_timeout = std::chrono::seconds(2);
+using buffer_t = std::array<std::byte, maximum_pipe_message_length>;
 
 using namespace inseye::internal;
 
@@ -50,11 +50,11 @@ typedef struct ServiceInfoResponse {
       NamedPipeMessageType::ServiceInfoResponse;
   void ReadFrom(const buffer_t& buffer) {
     auto naked_pointer =
-        buffer.data() + offsetof(ServiceInfoResponse, message_type);
+        buffer.data() + offsetof(ServiceInfoResponse, version);
     version = read_swap_endianess_if_needed((PackedVersion*)naked_pointer);
     naked_pointer =
         buffer.data() + offsetof(ServiceInfoResponse, shared_memory_path);
-    for (int i = 0; i < shared_memory_path.size(); ++i) {
+    for (size_t i = 0; i < shared_memory_path.size(); ++i) {
       shared_memory_path[i] = *((char*)naked_pointer + i);
     }
   }
@@ -80,31 +80,22 @@ typedef struct ServiceInfoRequest {
 #pragma pack(pop)
 
 template <WritableMessage T>
-bool WriteMessage(HANDLE fileHandle, T& message, int64_t& bytes_written) {
+bool WriteMessage(ServiceConnection& connection, T& message,
+                  std::chrono::steady_clock::time_point deadline,
+                  const std::function<bool()>& should_cancel_function) {
   buffer_t buffer{};
-  DWORD bytes_to_write = message.WriteTo(buffer);
-  return WriteFile((HANDLE)fileHandle, (LPCVOID)buffer.data(),
-                   (DWORD)bytes_to_write, (LPDWORD)&bytes_written, nullptr);
+  const auto bytes_to_write = message.WriteTo(buffer);
+  return connection.Write(buffer.data(), bytes_to_write, deadline,
+                          should_cancel_function);
 }
 
 template <ReadableMessage T>
-auto ReadSpecificMessage(HANDLE fileHandle, T& reference) {
+auto ReadSpecificMessage(ServiceConnection& connection, T& reference,
+                         std::chrono::steady_clock::time_point deadline,
+                         const std::function<bool()>& should_cancel_function) {
   buffer_t buffer{};
-  DWORD bytes_read = 0;
-  auto operation_successful =
-      ReadFile(fileHandle, buffer.data(),
-               (DWORD)(sizeof(byte) * maximum_pipe_message_length), &bytes_read,
-               nullptr);
-  if (!operation_successful) {
-    auto error = GetLastError();
-    if (error == ERROR_MORE_DATA)
-      while (ReadFile(fileHandle,  // drain the pipe
-                      buffer.data(),
-                      (DWORD)(sizeof(byte) * maximum_pipe_message_length),
-                      &bytes_read, nullptr)) {}
-    throw NamedPipeException(
-        std::format("NP:: Failed to read message. GLE={}\n", error));
-  }
+  const auto bytes_read = connection.Read(buffer.data(), buffer.size(),
+                                          deadline, should_cancel_function);
   if (bytes_read < sizeof(NamedPipeMessageType))
     throw NamedPipeException("NP:: Not enough bytes written by server");
 
@@ -117,78 +108,35 @@ auto ReadSpecificMessage(HANDLE fileHandle, T& reference) {
   return reference.ReadFrom(buffer);
 }
 
-bool NamedPipeExists(const std::filesystem::path& pipePath) {
-  std::wstring pipeName = pipePath;
-  if ((pipeName.size() < 10) ||
-      (pipeName.compare(0, 9, L"\\\\.\\pipe\\") != 0) ||
-      (pipeName.find(L'\\', 9) != std::string::npos)) {
-    // This can't be a pipe, so it also can't exist
-    return false;
-  }
-  pipeName.erase(0, 9);
-  WIN32_FIND_DATAW fd;
-  HANDLE hFind = FindFirstFileW(L"\\\\.\\pipe\\*", &fd);
-  do {
-    if (pipeName == fd.cFileName) {
-      FindClose(hFind);
-      return true;
-    }
-  } while (FindNextFileW(hFind, &fd));
-  FindClose(hFind);
-  return false;
-}
-
 NamedPipeCommunicator NamedPipeCommunicator::Create(
     const std::function<bool()>& should_cancel_function) {
-  auto pipe_handle = std::unique_ptr<void, std::function<void(void*)>>(
-      CreateFile(named_pipe_name,               // lpFileName
-                 GENERIC_READ | GENERIC_WRITE,  // dwDesiredAccess
-                 0,                             //dwShareMode
-                 nullptr,                       //lpSecurityAttributes
-                 OPEN_EXISTING,                 // dwCreatin\disposition
-                 0,                             // dwFlagsAndAttributes
-                 nullptr                        // hTemplateFile
-                 ),
-      [](auto ptr) {
-        if (ptr != INVALID_HANDLE_VALUE)
-          CloseHandle(ptr);
-      });
-  ThrowIfCancellationRequested(should_cancel_function);
-  if (pipe_handle.get() == INVALID_HANDLE_VALUE) {
-    auto gle = GetLastError();
-    if (gle == ERROR_PIPE_BUSY)
-      ThrowInitialization("All desktop pipe instances are busy.",
-                          inseye::c::InseyeInitializationStatus::
-                              kInsAllServiceNamedPipesAreBusy);
-    ThrowInitialization(
-        std::format("Invalid named pipe handle, GLE={0}", gle),
-        inseye::c::InseyeInitializationStatus::kInsFailedToInitializeNamedPipe);
-  }
-  //  if (!SetNamedPipeHandleState(pipe_handle.get(), &pipe_mode, nullptr, nullptr))
-  //    throw_initialization(std::format("Failed to configure pipe, GLE={}", GetLastError()),
-  //                         inseye::c::InseyeInitializationStatus::kInternalError);
-  NamedPipeCommunicator namedPipeCommunicator(std::move(pipe_handle));
-  return std::move(namedPipeCommunicator);
+  NamedPipeCommunicator namedPipeCommunicator(
+      ServiceConnection::Connect(should_cancel_function));
+  return namedPipeCommunicator;
 }
 
 inseye::internal::NamedPipeCommunicator::NamedPipeCommunicator(
-    std::unique_ptr<void, std::function<void(void*)>>&& pipe_handle)
-    : mutex(), pipe_handle(std::move(pipe_handle)) {}
+    ServiceConnection&& connection)
+    : mutex(), connection(std::move(connection)) {}
 
 inseye::internal::NamedPipeCommunicator::NamedPipeCommunicator(
     inseye::internal::NamedPipeCommunicator&& other) noexcept
-    : mutex(), pipe_handle(std::move(other.pipe_handle)) {}
+    : mutex(), connection(std::move(other.connection)) {}
 
-ServiceInfo inseye::internal::NamedPipeCommunicator::GetServiceInfo() {
+ServiceInfo inseye::internal::NamedPipeCommunicator::GetServiceInfo(
+    const std::function<bool()>& should_cancel_function) {
   std::lock_guard lock(this->mutex);
-  int64_t bytes_written = 0;
+  const auto deadline =
+      std::chrono::steady_clock::now() + service_response_timeout;
   ServiceInfoRequestMessage msg;
-  bool operation_success = WriteMessage(pipe_handle.get(), msg, bytes_written);
+  bool operation_success =
+      WriteMessage(connection, msg, deadline, should_cancel_function);
   if (!operation_success)
     throw NamedPipeException("Failed to send request for service info.");
   ServiceInfoResponseMessage response;
-  ReadSpecificMessage(pipe_handle.get(), response);
-  int string_terminator_index = 0;
+  ReadSpecificMessage(connection, response, deadline,
+                      should_cancel_function);
+  size_t string_terminator_index = 0;
   for (; string_terminator_index < response.shared_memory_path.size();
        ++string_terminator_index) {
     if (response.shared_memory_path[string_terminator_index] == '\0')
@@ -203,6 +151,11 @@ ServiceInfo inseye::internal::NamedPipeCommunicator::GetServiceInfo() {
       .shared_buffer_path{response.shared_memory_path.data()}};
 }
 
+bool inseye::internal::NamedPipeCommunicator::IsConnected() {
+  std::lock_guard lock(this->mutex);
+  return connection.IsPeerConnected();
+}
+
 bool inseye::c::IsServiceAvailable() {
-  return NamedPipeExists(named_pipe_name);
+  return ServiceConnection::EndpointExists();
 }
\ No newline at end of file
@@ -16,6 +16,7 @@
 #include <exception>
 #include <mutex>
 #include "remote_connector.h"
+#include "transport.hpp"
 namespace inseye::internal {
 
 
@@ -34,13 +35,16 @@ class NamedPipeException : public std::exception {
 
 class NamedPipeCommunicator {
   std::mutex mutex;
-  std::unique_ptr<void, std::function<void(void*)>> pipe_handle;
-  explicit NamedPipeCommunicator(std::unique_ptr<void, std::function<void(void*)>> &&pipe_handle);
+  ServiceConnection connection;
+  explicit NamedPipeCommunicator(ServiceConnection &&connection);
  public:
   static NamedPipeCommunicator Create(const std::function<bool()>& should_cancel_function);
   NamedPipeCommunicator(NamedPipeCommunicator &) = delete;
   NamedPipeCommunicator(NamedPipeCommunicator &&other) noexcept;
-  ServiceInfo GetServiceInfo();
+  // gives up when the service doesn't answer in time or when cancelled
+  ServiceInfo GetServiceInfo(const std::function<bool()>& should_cancel_function);
+  // true until the service closes the connection, doesn't send anything
+  bool IsConnected();
 };
 
 }
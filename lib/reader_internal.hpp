@@ -0,0 +1,58 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#ifndef REMOTE_CONNECTOR_LIB_READER_INTERNAL_HPP
+#define REMOTE_CONNECTOR_LIB_READER_INTERNAL_HPP
+#include <functional>
+#include <memory>
+#include "remote_connector.h"
+
+// Reader entry points for other parts of the library, implemented
+// in remote_connector.cpp.
+namespace inseye::internal {
+
+/**
+ * @brief CreateEyeTrackerReader stopping when is_cancellation_requested
+ * returns true (status kCancelled). Error description is written to calling
+ * thread buffer.
+ */
+inseye::c::InseyeInitializationStatus CreateEyeTrackerReader(
+    inseye::c::InseyeEyeTracker** pptr,
+    const std::function<bool()>& is_cancellation_requested);
+
+/**
+ * @brief Destroys reader that was never handed out and releases its service
+ * session from the cache unless other readers use it.
+ */
+void DiscardEyeTrackerReader(inseye::c::InseyeEyeTracker** pptr);
+
+/**
+ * @brief TryReadCursorDataBatch that also returns number of samples lost to
+ * overrun right before the first returned sample.
+ */
+bool TryReadCursorDataBatch(inseye::c::InseyeCursor& cursor,
+                            inseye::c::InseyeEyeTrackerDataStruct* data_structs,
+                            uint32_t capacity, uint32_t& count,
+                            uint32_t& dropped);
+
+/**
+ * @brief Samples written counter in reader mapping, the pointer keeps the
+ * mapping alive after reader is destroyed.
+ */
+std::shared_ptr<const uint32_t> GetSamplesWrittenCounter(
+    const inseye::c::InseyeEyeTracker& tracker);
+std::shared_ptr<const uint32_t> GetSamplesWrittenCounter(
+    const inseye::c::InseyeCursor& cursor);
+
+/**
+ * @brief Resumes coroutines awaiting gaze data on reader or cursor that is
+ * being destroyed, implemented in gaze_awaitable.cpp.
+ */
+void CancelGazeDataWaiters(const void* reader) noexcept;
+
+}  // namespace inseye::internal
+#endif  //REMOTE_CONNECTOR_LIB_READER_INTERNAL_HPP
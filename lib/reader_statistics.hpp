@@ -0,0 +1,131 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#ifndef REMOTE_CONNECTOR_LIB_READER_STATISTICS_HPP
+#define REMOTE_CONNECTOR_LIB_READER_STATISTICS_HPP
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include "remote_connector.h"
+
+// INSEYE_READER_STATISTICS is set by CMake option of the same name, when it's
+// 0 every counter update compiles to nothing.
+#if !defined(INSEYE_READER_STATISTICS)
+#define INSEYE_READER_STATISTICS 1
+#endif
+
+namespace inseye::internal {
+
+// Log-linear (HDR style) histogram buckets: values below
+// 2^kLagHistogramSubBucketBits have own bucket, every following power of two
+// range is split into 2^(kLagHistogramSubBucketBits - 1) equal buckets, so
+// bucket width is at most 1/8 of the values it holds.
+constexpr uint32_t kLagHistogramSubBucketBits = 4;
+constexpr uint32_t kLagHistogramLinearBuckets = 1u << kLagHistogramSubBucketBits;
+constexpr uint32_t kLagHistogramSubBuckets = kLagHistogramLinearBuckets / 2;
+constexpr uint32_t kLagHistogramBucketCount =
+    kLagHistogramLinearBuckets +
+    (32 - kLagHistogramSubBucketBits) * kLagHistogramSubBuckets;
+static_assert(kLagHistogramBucketCount ==
+                  inseye::c::kInsSampleLagHistogramBucketCount,
+              "Public histogram size doesn't match bucket layout");
+
+constexpr uint32_t LagHistogramBucket(uint32_t lag) noexcept {
+  if (lag < kLagHistogramLinearBuckets)
+    return lag;
+  const auto exponent = static_cast<uint32_t>(std::bit_width(lag)) - 1;
+  const uint32_t sub_bucket =
+      (lag >> (exponent - (kLagHistogramSubBucketBits - 1))) &
+      (kLagHistogramSubBuckets - 1);
+  return kLagHistogramLinearBuckets +
+         (exponent - kLagHistogramSubBucketBits) * kLagHistogramSubBuckets +
+         sub_bucket;
+}
+
+constexpr uint32_t LagHistogramBucketLowerBound(uint32_t bucket) noexcept {
+  if (bucket < kLagHistogramLinearBuckets)
+    return bucket;
+  const uint32_t exponent =
+      kLagHistogramSubBucketBits +
+      (bucket - kLagHistogramLinearBuckets) / kLagHistogramSubBuckets;
+  const uint32_t sub_bucket =
+      (bucket - kLagHistogramLinearBuckets) % kLagHistogramSubBuckets;
+  return (kLagHistogramSubBuckets + sub_bucket)
+         << (exponent - (kLagHistogramSubBucketBits - 1));
+}
+static_assert(LagHistogramBucket(LagHistogramBucketLowerBound(100)) == 100);
+static_assert(LagHistogramBucket(UINT32_MAX) == kLagHistogramBucketCount - 1);
+
+/**
+ * @brief Counters updated by the thread that reads samples and read by any
+ * thread. Counters have single writer so updates are plain relaxed load and
+ * store instead of read-modify-write.
+ */
+class ReaderStatistics {
+#if INSEYE_READER_STATISTICS
+  std::atomic<uint64_t> samples_delivered_ = 0;
+  std::atomic<uint64_t> samples_dropped_ = 0;
+  std::atomic<uint64_t> overrun_count_ = 0;
+  std::atomic<uint64_t> retry_limit_failures_ = 0;
+  std::array<std::atomic<uint64_t>, kLagHistogramBucketCount> lag_histogram_{};
+
+  static void Add(std::atomic<uint64_t>& counter, uint64_t value) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
+  }
+#endif
+
+ public:
+  /**
+   * @brief Records successful read.
+   * @param dropped samples skipped since previous read because service
+   * overwrote them
+   * @param delivered samples returned to caller
+   * @param lag number of samples published after the oldest returned one
+   */
+  void RecordRead([[maybe_unused]] uint32_t dropped,
+                  [[maybe_unused]] uint32_t delivered,
+                  [[maybe_unused]] uint32_t lag) noexcept {
+#if INSEYE_READER_STATISTICS
+    Add(samples_delivered_, delivered);
+    if (dropped != 0) {
+      Add(samples_dropped_, dropped);
+      Add(overrun_count_, 1);
+    }
+    Add(lag_histogram_[LagHistogramBucket(lag)], 1);
+#endif
+  }
+
+  void RecordRetryLimitFailure() noexcept {
+#if INSEYE_READER_STATISTICS
+    Add(retry_limit_failures_, 1);
+#endif
+  }
+
+  /**
+   * @brief Copies counters, counters are not captured at single moment when
+   * reader is reading at the same time.
+   */
+  void CopyTo([[maybe_unused]] inseye::c::InseyeReaderStatistics& statistics)
+      const noexcept {
+#if INSEYE_READER_STATISTICS
+    statistics.samples_delivered =
+        samples_delivered_.load(std::memory_order_relaxed);
+    statistics.samples_dropped = samples_dropped_.load(std::memory_order_relaxed);
+    statistics.overrun_count = overrun_count_.load(std::memory_order_relaxed);
+    statistics.retry_limit_failures =
+        retry_limit_failures_.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < kLagHistogramBucketCount; ++i)
+      statistics.sample_lag_histogram[i] =
+          lag_histogram_[i].load(std::memory_order_relaxed);
+#endif
+  }
+};
+
+}  // namespace inseye::internal
+#endif  //REMOTE_CONNECTOR_LIB_READER_STATISTICS_HPP
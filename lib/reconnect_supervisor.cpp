@@ -0,0 +1,201 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include "reconnect_supervisor.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include "errors.hpp"
+
+using inseye::internal::ReconnectSupervisor;
+
+namespace {
+// samples written value of ring that service has not written to yet
+constexpr uint32_t unwritten_sample_index =
+    (std::numeric_limits<uint32_t>::max)();
+}  // namespace
+
+ReconnectSupervisor::ReconnectSupervisor(
+    std::shared_ptr<const ServiceSession> session,
+    const inseye::c::InseyeReconnectOptions& options)
+    : stall_timeout_(options.stall_timeout_ms != 0
+                         ? std::chrono::milliseconds(options.stall_timeout_ms)
+                         : kDefaultStallTimeout),
+      check_interval_(options.check_interval_ms != 0
+                          ? std::chrono::milliseconds(options.check_interval_ms)
+                          : kDefaultCheckInterval),
+      session_(session),
+      connection_(session),
+      ring_(session->shared_memory_header.MakeRingState(
+          session->in_memory_buffer)),
+      observed_samples_written_(ring_.LoadSamplesWritten()),
+      last_progress_(std::chrono::steady_clock::now()) {
+  generations_.push_back(
+      std::make_unique<Generation>(Generation{std::move(session)}));
+  current_.store(generations_.back().get(), std::memory_order_seq_cst);
+  thread_ = std::thread(&ReconnectSupervisor::Run, this);
+}
+
+ReconnectSupervisor::~ReconnectSupervisor() {
+  Stop();
+}
+
+const ReconnectSupervisor::Generation* ReconnectSupervisor::Protect(
+    Hazard& hazard) const noexcept {
+  // classic hazard pointer handshake: generation read again after the hazard
+  // store is either still current, or it was replaced and the thread may
+  // have missed the hazard, so the newer one is protected instead
+  const Generation* generation = current_.load(std::memory_order_seq_cst);
+  for (;;) {
+    hazard.store(generation, std::memory_order_seq_cst);
+    const Generation* current = current_.load(std::memory_order_seq_cst);
+    if (current == generation)
+      return generation;
+    generation = current;
+  }
+}
+
+void ReconnectSupervisor::Register(Hazard& hazard) {
+  std::lock_guard lock(mutex_);
+  hazards_.push_back(&hazard);
+}
+
+void ReconnectSupervisor::Unregister(Hazard& hazard) noexcept {
+  std::lock_guard lock(mutex_);
+  std::erase(hazards_, &hazard);
+}
+
+void ReconnectSupervisor::Stop() noexcept {
+  {
+    std::lock_guard lock(mutex_);
+    stop_requested_.store(true, std::memory_order_relaxed);
+  }
+  stop_condition_.notify_all();
+  if (thread_.joinable())
+    thread_.join();
+}
+
+void ReconnectSupervisor::Run() {
+  std::vector<std::shared_ptr<const ServiceSession>> released;
+  std::unique_lock lock(mutex_);
+  while (!stop_condition_.wait_for(lock, check_interval_, [this] {
+    return stop_requested_.load(std::memory_order_relaxed);
+  })) {
+    lock.unlock();
+    try {
+      Check();
+    } catch (const std::exception&) {
+      // allocation failed, the service is checked again after next interval
+    }
+    lock.lock();
+    Reclaim(released);
+    // connection and mapping are torn down without the lock
+    lock.unlock();
+    released.clear();
+    lock.lock();
+  }
+}
+
+void ReconnectSupervisor::Check() {
+  const auto now = std::chrono::steady_clock::now();
+  if (!lost_) {
+    const uint32_t samples_written = ring_.LoadSamplesWritten();
+    if (samples_written != observed_samples_written_) {
+      observed_samples_written_ = samples_written;
+      last_progress_ = now;
+    }
+    if (connection_->named_pipe_communicator.IsConnected()) {
+      if (now - last_progress_ < stall_timeout_)
+        return;
+      // stalled service is asked again only after another stall timeout
+      last_progress_ = now;
+    } else {
+      lost_ = true;
+    }
+  }
+  std::shared_ptr<const ServiceSession> fresh;
+  try {
+    fresh = ReplaceServiceSession(connection_, [this] {
+      return stop_requested_.load(std::memory_order_relaxed);
+    });
+  } catch (const InitializationException&) {
+    return;  // service is not back yet
+  } catch (const NamedPipeException&) {
+    return;
+  }
+  if (IsSameRing(*fresh)) {
+    connection_ = std::move(fresh);
+    lost_ = false;
+    return;
+  }
+  Publish(std::move(fresh));
+}
+
+bool ReconnectSupervisor::IsSameRing(
+    const ServiceSession& fresh) const noexcept {
+  const RingState ring =
+      fresh.shared_memory_header.MakeRingState(fresh.in_memory_buffer);
+  if (ring.sample_size != ring_.sample_size ||
+      ring.sample_count != ring_.sample_count)
+    return false;
+  // counter of the same ring loaded in between two loads of the published
+  // one can only lie between them, restarted service counts from the start
+  const uint32_t before = ring_.LoadSamplesWritten();
+  const uint32_t samples_written = ring.LoadSamplesWritten();
+  const uint32_t after = ring_.LoadSamplesWritten();
+  if (samples_written - before > after - before)
+    return false;
+  if (samples_written == unwritten_sample_index)
+    return true;
+  // equal counters of different rings still hold different samples
+  return std::memcmp(ring.SampleAddress(samples_written),
+                     ring_.SampleAddress(samples_written),
+                     ring.sample_size) == 0;
+}
+
+void ReconnectSupervisor::Publish(
+    std::shared_ptr<const ServiceSession> session) {
+  auto generation = std::make_unique<Generation>(Generation{session});
+  ring_ =
+      session->shared_memory_header.MakeRingState(session->in_memory_buffer);
+  observed_samples_written_ = ring_.LoadSamplesWritten();
+  last_progress_ = std::chrono::steady_clock::now();
+  lost_ = false;
+  connection_ = session;
+  session_ = std::move(session);
+  std::lock_guard lock(mutex_);
+  generations_.push_back(std::move(generation));
+  current_.store(generations_.back().get(), std::memory_order_seq_cst);
+}
+
+void ReconnectSupervisor::Reclaim(
+    std::vector<std::shared_ptr<const ServiceSession>>& released) {
+  for (auto generation = generations_.begin();
+       generation + 1 != generations_.end();) {
+    const bool protected_by_reader = std::any_of(
+        hazards_.begin(), hazards_.end(), [&](const Hazard* hazard) {
+          return hazard->load(std::memory_order_seq_cst) == generation->get();
+        });
+    if (protected_by_reader) {
+      ++generation;
+      continue;
+    }
+    retired_sessions_.push_back(std::move((*generation)->session));
+    generation = generations_.erase(generation);
+  }
+  // reader that adopted newer generation may still hold the previous
+  // session, the last reference is always dropped here
+  for (auto session = retired_sessions_.begin();
+       session != retired_sessions_.end();) {
+    if (session->use_count() == 1) {
+      released.push_back(std::move(*session));
+      session = retired_sessions_.erase(session);
+    } else {
+      ++session;
+    }
+  }
+}
@@ -0,0 +1,111 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#ifndef REMOTE_CONNECTOR_LIB_RECONNECT_SUPERVISOR_HPP
+#define REMOTE_CONNECTOR_LIB_RECONNECT_SUPERVISOR_HPP
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "remote_connector.h"
+#include "service_session.hpp"
+#include "shared_memory_header.hpp"
+
+namespace inseye::internal {
+
+/**
+ * @brief Background thread that watches service session of a reader and
+ * replaces it when the service goes away.
+ * Service is lost when its connection is closed, or when samples written
+ * counter doesn't move for stall timeout and service connected to again
+ * serves different ring. The thread builds the new session (connection,
+ * mapping) and publishes it as new generation with single pointer store.
+ * Readers compare the pointer on every read and adopt the generation on
+ * their own thread, they never take a lock. Generation is freed once no
+ * reader's hazard pointer holds it, sessions it owned are released by the
+ * thread when nobody else holds them, so unmapping never happens on reading
+ * thread.
+ */
+class ReconnectSupervisor {
+ public:
+  static constexpr std::chrono::milliseconds kDefaultStallTimeout{1000};
+  static constexpr std::chrono::milliseconds kDefaultCheckInterval{100};
+
+  struct Generation {
+    std::shared_ptr<const ServiceSession> session;
+  };
+  // generation used by single reader or cursor, written by its owner only
+  using Hazard = std::atomic<const Generation*>;
+
+  /**
+   * @brief Starts watching the session.
+   * Throws std::system_error when the thread can't be started.
+   */
+  ReconnectSupervisor(std::shared_ptr<const ServiceSession> session,
+                      const inseye::c::InseyeReconnectOptions& options);
+  ReconnectSupervisor(const ReconnectSupervisor&) = delete;
+  ReconnectSupervisor& operator=(const ReconnectSupervisor&) = delete;
+  ~ReconnectSupervisor();
+
+  [[nodiscard]] const Generation* Current() const noexcept {
+    return current_.load(std::memory_order_acquire);
+  }
+  /**
+   * @brief Publishes current generation in hazard and returns it, the
+   * generation stays alive until the hazard changes.
+   */
+  const Generation* Protect(Hazard& hazard) const noexcept;
+  /**
+   * @brief Adds hazard of new reader or cursor, it must already hold
+   * protected generation. Throws std::bad_alloc.
+   */
+  void Register(Hazard& hazard);
+  void Unregister(Hazard& hazard) noexcept;
+  /**
+   * @brief Stops and joins the thread, current generation stays published.
+   */
+  void Stop() noexcept;
+
+ private:
+  void Run();
+  // one connection check, reconnects and publishes when service is lost
+  void Check();
+  // true when fresh session maps the ring that is already published
+  [[nodiscard]] bool IsSameRing(const ServiceSession& fresh) const noexcept;
+  void Publish(std::shared_ptr<const ServiceSession> session);
+  // frees generations without hazards, returns sessions nobody else holds
+  void Reclaim(std::vector<std::shared_ptr<const ServiceSession>>& released);
+
+  const std::chrono::milliseconds stall_timeout_;
+  const std::chrono::milliseconds check_interval_;
+  std::atomic<const Generation*> current_{nullptr};
+
+  // touched only by the thread
+  std::shared_ptr<const ServiceSession> session_;
+  // connection that is watched, may be newer than session_ when the service
+  // dropped the connection but kept serving the same ring
+  std::shared_ptr<const ServiceSession> connection_;
+  RingState ring_{};
+  uint32_t observed_samples_written_ = 0;
+  std::chrono::steady_clock::time_point last_progress_{};
+  bool lost_ = false;
+
+  std::mutex mutex_;
+  std::condition_variable stop_condition_;
+  std::atomic<bool> stop_requested_ = false;
+  // guarded by mutex_, published generation is the last one
+  std::vector<Hazard*> hazards_;
+  std::vector<std::unique_ptr<Generation>> generations_;
+  std::vector<std::shared_ptr<const ServiceSession>> retired_sessions_;
+  std::thread thread_;
+};
+
+}  // namespace inseye::internal
+#endif  //REMOTE_CONNECTOR_LIB_RECONNECT_SUPERVISOR_HPP
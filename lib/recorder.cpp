@@ -0,0 +1,317 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include "allocator.hpp"
+#include "errors.hpp"
+#include "recording_file.hpp"
+#include "remote_connector.h"
+
+// samples leased from the reader at once
+constexpr uint32_t recorder_batch_size = 512;
+constexpr auto recorder_wait_slice = std::chrono::milliseconds(10);
+
+struct inseye::c::InseyeRecorder {
+  inseye::c::InseyeEyeTracker* tracker = nullptr;
+  inseye::internal::RecordingWriter writer;
+  std::atomic<bool> stop_requested = false;
+  std::atomic<inseye::c::InseyeRecorderState> state =
+      inseye::c::InseyeRecorderState::kInsRecorderRunning;
+  std::atomic<uint64_t> sample_count = 0;
+  // written by recording thread before state changes to faulted, fixed size
+  // so that failure is reported without allocation
+  std::array<char, 1024> error_message{};
+  std::thread thread;
+
+  InseyeRecorder(inseye::c::InseyeEyeTracker* tracker, const std::string& path,
+                 uint32_t chunk_size)
+      : tracker(tracker), writer(path, chunk_size) {}
+
+  ~InseyeRecorder() { inseye::c::DestroyEyeTrackerReader(&tracker); }
+};
+
+struct inseye::c::InseyeRecording {
+  inseye::internal::RecordingReader reader;
+};
+
+namespace {
+// Recording stores samples in service ring layout, only ring slots may be
+// larger than the sample.
+std::byte* CopyLeasedSamples(const inseye::c::InseyeLeaseSpan& span,
+                             uint32_t sample_size, std::byte* destination) {
+  constexpr uint32_t size = inseye::internal::kRecordingSampleSize;
+  const auto* source = static_cast<const std::byte*>(span.data);
+  if (sample_size == size) {
+    std::memcpy(destination, source, size_t{span.count} * size);
+    return destination + size_t{span.count} * size;
+  }
+  for (uint32_t i = 0; i < span.count;
+       ++i, source += sample_size, destination += size)
+    std::memcpy(destination, source, size);
+  return destination;
+}
+
+// Stores description of the failure of recording thread, truncated.
+void SetErrorMessage(inseye::c::InseyeRecorder& recorder,
+                     const char* message) noexcept {
+  const size_t length =
+      strnlen(message, recorder.error_message.size() - 1);
+  std::memcpy(recorder.error_message.data(), message, length);
+  recorder.error_message[length] = '\0';
+}
+
+// Drains everything the reader has, returns false when writing failed.
+// Samples are leased and copied from the service ring straight into the
+// recording chunk, then committed unless service overwrote them meanwhile.
+bool DrainReader(inseye::c::InseyeRecorder& recorder) {
+  constexpr uint32_t size = inseye::internal::kRecordingSampleSize;
+  inseye::c::InseyeLease lease{};
+  bool leased = false;
+  try {
+    while (inseye::c::AcquireEyeTrackerReadLease(
+        recorder.tracker,
+        (std::min)(recorder_batch_size, recorder.writer.GetReservableCount()),
+        &lease)) {
+      leased = true;
+      std::byte* destination = recorder.writer.Reserve();
+      CopyLeasedSamples(lease.spans[1], lease.sample_size,
+                        CopyLeasedSamples(lease.spans[0], lease.sample_size,
+                                          destination));
+      uint32_t overwritten = 0;
+      leased = false;
+      if (!inseye::c::ReleaseEyeTrackerReadLease(recorder.tracker, &lease,
+                                                 &overwritten))
+        // overwritten samples form prefix, like in batch reads they are lost
+        std::memmove(destination, destination + size_t{overwritten} * size,
+                     size_t{lease.count - overwritten} * size);
+      recorder.writer.Commit(lease.count - overwritten);
+      recorder.sample_count.store(recorder.writer.GetSampleCount(),
+                                  std::memory_order_relaxed);
+    }
+    return true;
+  } catch (const InitializationException&) {
+    // ThrowInitialization stored description in this thread's buffer
+    SetErrorMessage(recorder, inseye::c::GetLastErrorDescription());
+  } catch (const std::exception&) {
+    // error path allocates (formatted message, mapping), nothing more is
+    // allocated to report it
+    WriteErrorMessage("Failed to write recording.");
+    SetErrorMessage(recorder, inseye::c::GetLastErrorDescription());
+  }
+  // every acquired lease is released
+  if (leased)
+    inseye::c::ReleaseEyeTrackerReadLease(recorder.tracker, &lease, nullptr);
+  return false;
+}
+
+bool RecordUntilStopped(inseye::c::InseyeRecorder& recorder) {
+  const uint64_t wait_slice_ns =
+      std::chrono::nanoseconds(recorder_wait_slice).count();
+  while (!recorder.stop_requested.load(std::memory_order_relaxed)) {
+    if (!inseye::c::WaitForEyeTrackerData(recorder.tracker, wait_slice_ns))
+      continue;
+    if (!DrainReader(recorder))
+      return false;
+  }
+  // samples published before stop was requested are part of recording
+  return DrainReader(recorder);
+}
+
+// Exception must not leave the thread, it would terminate the host process.
+void RunRecorder(inseye::c::InseyeRecorder& recorder) noexcept {
+  bool stopped = false;
+  try {
+    stopped = RecordUntilStopped(recorder);
+  } catch (...) {
+    WriteErrorMessage("Recording thread failed.");
+    SetErrorMessage(recorder, inseye::c::GetLastErrorDescription());
+  }
+  recorder.state.store(
+      stopped ? inseye::c::InseyeRecorderState::kInsRecorderStopped
+              : inseye::c::InseyeRecorderState::kInsRecorderFaulted,
+      std::memory_order_release);
+}
+
+template <typename Function>
+inseye::c::InseyeInitializationStatus TranslateInitializationErrors(
+    Function&& function) {
+  try {
+    function();
+    return inseye::c::InseyeInitializationStatus::kSuccess;
+  } catch (const InitializationException& initializationException) {
+    return initializationException.status;
+  } catch (const std::exception& exception) {
+    WriteErrorMessage(exception.what());
+    return inseye::c::InseyeInitializationStatus::kInternalError;
+  }
+}
+}  // namespace
+
+inseye::c::InseyeInitializationStatus inseye::c::CreateEyeTrackerRecorder(
+    struct inseye::c::InseyeRecorder** pptr, const char* file_path,
+    const struct inseye::c::InseyeRecorderOptions* options,
+    uint32_t timeout_ms) {
+  if (pptr == nullptr || file_path == nullptr) {
+    WriteErrorMessage("Recorder pointer address and file path are required.");
+    return inseye::c::InseyeInitializationStatus::kFailure;
+  }
+  const uint32_t chunk_size =
+      options == nullptr || options->chunk_size == 0
+          ? inseye::internal::kDefaultRecordingChunkSize
+          : options->chunk_size;
+  if (chunk_size % inseye::internal::kMappedFileAlignment != 0) {
+    WriteErrorMessage(
+        std::format("Recording chunk size must be multiple of {} bytes.",
+                    inseye::internal::kMappedFileAlignment));
+    return inseye::c::InseyeInitializationStatus::kFailure;
+  }
+  inseye::c::InseyeEyeTracker* tracker = nullptr;
+  const auto status = inseye::c::CreateEyeTrackerReader(&tracker, timeout_ms);
+  if (status != inseye::c::InseyeInitializationStatus::kSuccess)
+    return status;
+  return TranslateInitializationErrors([&] {
+    inseye::internal::UniquePtr<inseye::c::InseyeRecorder> recorder;
+    try {
+      recorder = inseye::internal::MakeUnique<inseye::c::InseyeRecorder>(
+          tracker, file_path, chunk_size);
+    } catch (...) {
+      inseye::c::DestroyEyeTrackerReader(&tracker);
+      throw;
+    }
+    recorder->thread = std::thread(RunRecorder, std::ref(*recorder));
+    *pptr = recorder.release();
+  });
+}
+
+void inseye::c::DestroyEyeTrackerRecorder(
+    struct inseye::c::InseyeRecorder** pptr) {
+  if (pptr == nullptr || *pptr == nullptr)
+    return;
+  (*pptr)->stop_requested.store(true, std::memory_order_relaxed);
+  (*pptr)->thread.join();
+  inseye::internal::Delete(*pptr);
+  *pptr = nullptr;
+}
+
+inseye::c::InseyeRecorderState inseye::c::GetEyeTrackerRecorderState(
+    struct inseye::c::InseyeRecorder* recorder) {
+  if (recorder == nullptr)
+    return inseye::c::InseyeRecorderState::kInsRecorderStopped;
+  const auto state = recorder->state.load(std::memory_order_acquire);
+  if (state == inseye::c::InseyeRecorderState::kInsRecorderFaulted)
+    WriteErrorMessage(recorder->error_message);
+  return state;
+}
+
+uint64_t inseye::c::GetEyeTrackerRecorderSampleCount(
+    struct inseye::c::InseyeRecorder* recorder) {
+  if (recorder == nullptr)
+    return 0;
+  return recorder->sample_count.load(std::memory_order_relaxed);
+}
+
+inseye::c::InseyeInitializationStatus inseye::c::OpenEyeTrackerRecording(
+    struct inseye::c::InseyeRecording** pptr, const char* file_path) {
+  if (pptr == nullptr || file_path == nullptr) {
+    WriteErrorMessage("Recording pointer address and file path are required.");
+    return inseye::c::InseyeInitializationStatus::kFailure;
+  }
+  return TranslateInitializationErrors([&] {
+    *pptr = inseye::internal::New<inseye::c::InseyeRecording>(
+        inseye::internal::RecordingReader(file_path));
+  });
+}
+
+void inseye::c::CloseEyeTrackerRecording(
+    struct inseye::c::InseyeRecording** pptr) {
+  if (pptr == nullptr || *pptr == nullptr)
+    return;
+  inseye::internal::Delete(*pptr);
+  *pptr = nullptr;
+}
+
+uint64_t inseye::c::GetEyeTrackerRecordingSampleCount(
+    struct inseye::c::InseyeRecording* recording) {
+  if (recording == nullptr)
+    return 0;
+  return recording->reader.GetSampleCount();
+}
+
+bool inseye::c::ReadEyeTrackerRecordingData(
+    struct inseye::c::InseyeRecording* recording, uint64_t sample_position,
+    struct inseye::c::InseyeEyeTrackerDataStruct* out_data, uint32_t capacity,
+    uint32_t* count) {
+  if (count != nullptr)
+    *count = 0;
+  if (recording == nullptr || out_data == nullptr || count == nullptr)
+    return false;
+  *count = recording->reader.Read(sample_position, out_data, capacity);
+  return *count > 0;
+}
+
+bool inseye::c::SeekEyeTrackerRecording(
+    struct inseye::c::InseyeRecording* recording, uint64_t time,
+    uint64_t* sample_position) {
+  if (recording == nullptr || sample_position == nullptr)
+    return false;
+  return recording->reader.Seek(time, *sample_position);
+}
+
+inseye::Recorder::Recorder(Recorder&& other) noexcept
+    : implementation_pointer_(other.implementation_pointer_) {
+  other.implementation_pointer_ = nullptr;
+}
+
+inseye::Recorder::~Recorder() noexcept {
+  inseye::c::DestroyEyeTrackerRecorder(&implementation_pointer_);
+}
+
+inseye::RecorderState inseye::Recorder::GetState() const noexcept {
+  return inseye::c::GetEyeTrackerRecorderState(implementation_pointer_);
+}
+
+uint64_t inseye::Recorder::GetRecordedSampleCount() const noexcept {
+  return inseye::c::GetEyeTrackerRecorderSampleCount(implementation_pointer_);
+}
+
+inseye::Recording::Recording(Recording&& other) noexcept
+    : implementation_pointer_(other.implementation_pointer_) {
+  other.implementation_pointer_ = nullptr;
+}
+
+inseye::Recording::~Recording() noexcept {
+  inseye::c::CloseEyeTrackerRecording(&implementation_pointer_);
+}
+
+uint64_t inseye::Recording::GetSampleCount() const noexcept {
+  return inseye::c::GetEyeTrackerRecordingSampleCount(implementation_pointer_);
+}
+
+bool inseye::Recording::Read(uint64_t sample_position,
+                             std::span<EyeTrackerDataStruct> out_data,
+                             uint32_t& count) const noexcept {
+  const auto capacity = static_cast<uint32_t>((std::min)(
+      out_data.size(), size_t{(std::numeric_limits<uint32_t>::max)()}));
+  return inseye::c::ReadEyeTrackerRecordingData(
+      implementation_pointer_, sample_position, out_data.data(), capacity,
+      &count);
+}
+
+bool inseye::Recording::Seek(uint64_t time,
+                             uint64_t& sample_position) const noexcept {
+  return inseye::c::SeekEyeTrackerRecording(implementation_pointer_, time,
+                                            &sample_position);
+}
@@ -0,0 +1,263 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include "recording_file.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <format>
+#include "errors.hpp"
+
+using namespace inseye::internal;
+
+namespace {
+template <typename T>
+void WriteField(std::byte* destination, size_t offset, const T& value) {
+  write_swap_endianess_if_needed<T>(reinterpret_cast<T*>(destination + offset),
+                                    &value);
+}
+
+template <typename T>
+T ReadField(const std::byte* source, size_t offset) {
+  return read_swap_endianess_if_needed<T>(
+      reinterpret_cast<const T*>(source + offset));
+}
+
+std::atomic_ref<uint32_t> CommittedSampleCount(const std::byte* chunk) {
+  // views are aligned to kMappedFileAlignment so the field is aligned too
+  return std::atomic_ref<uint32_t>(*reinterpret_cast<uint32_t*>(
+      const_cast<std::byte*>(chunk) +
+      offsetof(RecordingChunkHeader, committed_sample_count)));
+}
+
+uint32_t SamplesPerChunk(uint32_t chunk_size) {
+  return (chunk_size - kRecordingChunkHeaderSize) / kRecordingSampleSize;
+}
+
+uint64_t ChunkOffset(uint32_t chunk_index, uint32_t chunk_size) {
+  return kRecordingHeaderRegionSize + uint64_t{chunk_index} * chunk_size;
+}
+
+[[noreturn]] void ThrowRecording(const std::string& message) {
+  WriteErrorMessage(message);
+  throw InitializationException(
+      inseye::c::InseyeInitializationStatus::kInsFailedToAccessRecordingFile);
+}
+}  // namespace
+
+RecordingWriter::RecordingWriter(const std::string& path, uint32_t chunk_size)
+    : file_(MappedFile::Create(path)),
+      chunk_size_(chunk_size),
+      samples_per_chunk_(SamplesPerChunk(chunk_size)) {
+  if (chunk_size_ == 0 || chunk_size_ % kMappedFileAlignment != 0)
+    ThrowRecording(std::format(
+        "Recording chunk size must be non zero multiple of {} bytes.",
+        kMappedFileAlignment));
+  if (!file_.Extend(kRecordingHeaderRegionSize))
+    ThrowRecording("Failed to reserve space for recording header.");
+  {
+    const auto header = file_.Map(0, kRecordingHeaderRegionSize, true);
+    std::byte* data = header.data();
+    WriteField(data, offsetof(RecordingFileHeader, format_version),
+               kRecordingFormatVersion);
+    WriteField(data, offsetof(RecordingFileHeader, header_region_size),
+               kRecordingHeaderRegionSize);
+    WriteField(data, offsetof(RecordingFileHeader, chunk_size), chunk_size_);
+    WriteField(data, offsetof(RecordingFileHeader, chunk_header_size),
+               kRecordingChunkHeaderSize);
+    WriteField(data, offsetof(RecordingFileHeader, sample_size),
+               kRecordingSampleSize);
+    // magic goes last, file without it is not a recording
+    std::memcpy(data + offsetof(RecordingFileHeader, magic), kRecordingMagic,
+                sizeof(kRecordingMagic));
+    header.Flush();
+  }
+  OpenChunk(0);
+}
+
+RecordingWriter::~RecordingWriter() {
+  chunk_.Flush();
+}
+
+void RecordingWriter::OpenChunk(uint32_t chunk_index) {
+  // previous chunk is complete, hand it over to the page cache so that
+  // resident memory stays bounded by single chunk
+  chunk_.Flush();
+  chunk_ = MappedFileView();
+  const uint64_t offset = ChunkOffset(chunk_index, chunk_size_);
+  if (!file_.Extend(offset + chunk_size_))
+    ThrowRecording(std::format(
+        "Failed to reserve {} bytes for recording chunk {}, disk may be full.",
+        chunk_size_, chunk_index));
+  chunk_ = file_.Map(offset, chunk_size_, true);
+  std::byte* data = chunk_.data();
+  WriteField(data, offsetof(RecordingChunkHeader, chunk_index), chunk_index);
+  WriteField(data, offsetof(RecordingChunkHeader, first_sample_position),
+             sample_count_);
+  CommittedSampleCount(data).store(0, std::memory_order_relaxed);
+  WriteField(data, offsetof(RecordingChunkHeader, magic),
+             kRecordingChunkMagic);
+  chunk_index_ = chunk_index;
+  chunk_sample_count_ = 0;
+}
+
+void RecordingWriter::Append(const inseye::EyeTrackerDataStruct* samples,
+                             uint32_t count) {
+  while (count > 0) {
+    const uint32_t stored = (std::min)(count, GetReservableCount());
+    std::byte* destination = Reserve();
+    for (uint32_t i = 0; i < stored; ++i, destination += kRecordingSampleSize)
+      writeDataSample(destination, samples[i]);
+    Commit(stored);
+    samples += stored;
+    count -= stored;
+  }
+}
+
+std::byte* RecordingWriter::Reserve() {
+  if (chunk_sample_count_ == samples_per_chunk_)
+    OpenChunk(chunk_index_ + 1);
+  return chunk_.data() + kRecordingChunkHeaderSize +
+         size_t{chunk_sample_count_} * kRecordingSampleSize;
+}
+
+void RecordingWriter::Commit(uint32_t count) {
+  if (count == 0)
+    return;
+  std::byte* data = chunk_.data();
+  const std::byte* first = data + kRecordingChunkHeaderSize +
+                           size_t{chunk_sample_count_} * kRecordingSampleSize;
+  const std::byte* last = first + size_t{count - 1} * kRecordingSampleSize;
+  // sample and chunk header times are both stored in LIB_ENDIAN
+  if (chunk_sample_count_ == 0)
+    std::memcpy(data + offsetof(RecordingChunkHeader, first_time),
+                first + offsetof(EyeTrackerDataStruct, time), sizeof(uint64_t));
+  std::memcpy(data + offsetof(RecordingChunkHeader, last_time),
+              last + offsetof(EyeTrackerDataStruct, time), sizeof(uint64_t));
+  chunk_sample_count_ += count;
+  uint32_t committed = chunk_sample_count_;
+  write_swap_endianess_if_needed(&committed, &chunk_sample_count_);
+  CommittedSampleCount(data).store(committed, std::memory_order_release);
+  sample_count_ += count;
+}
+
+RecordingReader::RecordingReader(const std::string& path)
+    : file_(MappedFile::Open(path)) {
+  const uint64_t file_size = file_.Size();
+  if (file_size < kRecordingHeaderRegionSize)
+    ThrowRecording(std::format("File '{}' is not a gaze recording.", path));
+  view_ = file_.Map(0, static_cast<size_t>(file_size), false);
+  const std::byte* header = view_.data();
+  if (std::memcmp(header + offsetof(RecordingFileHeader, magic),
+                  kRecordingMagic, sizeof(kRecordingMagic)) != 0)
+    ThrowRecording(std::format("File '{}' is not a gaze recording.", path));
+  const auto format_version = ReadField<uint32_t>(
+      header, offsetof(RecordingFileHeader, format_version));
+  chunk_size_ =
+      ReadField<uint32_t>(header, offsetof(RecordingFileHeader, chunk_size));
+  if (format_version != kRecordingFormatVersion ||
+      ReadField<uint32_t>(header, offsetof(RecordingFileHeader,
+                                           header_region_size)) !=
+          kRecordingHeaderRegionSize ||
+      ReadField<uint32_t>(header, offsetof(RecordingFileHeader,
+                                           chunk_header_size)) !=
+          kRecordingChunkHeaderSize ||
+      ReadField<uint32_t>(header, offsetof(RecordingFileHeader,
+                                           sample_size)) !=
+          kRecordingSampleSize ||
+      chunk_size_ == 0 || chunk_size_ % kMappedFileAlignment != 0)
+    ThrowRecording(std::format(
+        "Recording '{}' was written in unsupported format (version {}).", path,
+        format_version));
+  samples_per_chunk_ = SamplesPerChunk(chunk_size_);
+  // recording ends at first chunk that is missing, corrupted or not full
+  const uint64_t chunks_in_file =
+      (file_size - kRecordingHeaderRegionSize) / chunk_size_;
+  while (chunk_count_ < chunks_in_file) {
+    const std::byte* chunk = ChunkAddress(chunk_count_);
+    if (ReadField<uint32_t>(chunk, offsetof(RecordingChunkHeader, magic)) !=
+            kRecordingChunkMagic ||
+        ReadField<uint32_t>(chunk,
+                            offsetof(RecordingChunkHeader, chunk_index)) !=
+            chunk_count_)
+      break;
+    uint32_t committed =
+        CommittedSampleCount(chunk).load(std::memory_order_acquire);
+    committed = read_swap_endianess_if_needed(&committed);
+    committed = (std::min)(committed, samples_per_chunk_);
+    if (committed == 0)
+      break;
+    ++chunk_count_;
+    sample_count_ += committed;
+    if (committed != samples_per_chunk_)
+      break;
+  }
+}
+
+const std::byte* RecordingReader::ChunkAddress(uint32_t chunk_index) const {
+  return view_.data() + ChunkOffset(chunk_index, chunk_size_);
+}
+
+uint64_t RecordingReader::SampleTime(uint64_t sample_position) const {
+  const std::byte* chunk =
+      ChunkAddress(static_cast<uint32_t>(sample_position / samples_per_chunk_));
+  return ReadField<uint64_t>(
+      chunk + kRecordingChunkHeaderSize +
+          (sample_position % samples_per_chunk_) * kRecordingSampleSize,
+      offsetof(EyeTrackerDataStruct, time));
+}
+
+uint32_t RecordingReader::Read(uint64_t sample_position,
+                               inseye::EyeTrackerDataStruct* samples,
+                               uint32_t capacity) const {
+  if (sample_position >= sample_count_)
+    return 0;
+  const auto count = static_cast<uint32_t>(
+      (std::min)(uint64_t{capacity}, sample_count_ - sample_position));
+  for (uint32_t read = 0; read < count;) {
+    const uint64_t position = sample_position + read;
+    const auto in_chunk = static_cast<uint32_t>(position % samples_per_chunk_);
+    const uint32_t contiguous =
+        (std::min)(count - read, samples_per_chunk_ - in_chunk);
+    const std::byte* source =
+        ChunkAddress(static_cast<uint32_t>(position / samples_per_chunk_)) +
+        kRecordingChunkHeaderSize + size_t{in_chunk} * kRecordingSampleSize;
+    for (uint32_t i = 0; i < contiguous; ++i, source += kRecordingSampleSize)
+      readDataSample(source, samples[read + i]);
+    read += contiguous;
+  }
+  return count;
+}
+
+bool RecordingReader::Seek(uint64_t time, uint64_t& sample_position) const {
+  if (sample_count_ == 0)
+    return false;
+  // last chunk whose first sample is not later than time
+  uint32_t low = 0, high = chunk_count_;
+  while (high - low > 1) {
+    const uint32_t middle = low + (high - low) / 2;
+    if (ReadField<uint64_t>(ChunkAddress(middle),
+                            offsetof(RecordingChunkHeader, first_time)) <= time)
+      low = middle;
+    else
+      high = middle;
+  }
+  // first sample not earlier than time, it may be first sample of next chunk
+  uint64_t first = uint64_t{low} * samples_per_chunk_;
+  uint64_t last = (std::min)(first + samples_per_chunk_, sample_count_);
+  while (first < last) {
+    const uint64_t middle = first + (last - first) / 2;
+    if (SampleTime(middle) < time)
+      first = middle + 1;
+    else
+      last = middle;
+  }
+  if (first == sample_count_)
+    return false;
+  sample_position = first;
+  return true;
+}
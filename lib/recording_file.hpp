@@ -0,0 +1,149 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#ifndef REMOTE_CONNECTOR_LIB_RECORDING_FILE_HPP
+#define REMOTE_CONNECTOR_LIB_RECORDING_FILE_HPP
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "eye_tracker_data_struct.hpp"
+#include "mapped_file.hpp"
+
+// Recording file layout, all values are stored in LIB_ENDIAN.
+//
+// [file header region, 64 KiB][chunk 0][chunk 1]...[chunk n - 1]
+//
+// Every chunk has the same size (multiple of 64 KiB) and starts with chunk
+// header followed by packed samples in the same format as in service ring
+// buffer. Chunks are filled one after another, only the last one may be
+// partially filled. Samples are ordered by time, so position of a sample is
+// found with binary search over first times of chunks and then over samples
+// of single chunk.
+//
+// Crash safety: file is extended (with disk space reserved) before new chunk
+// is mapped, samples are stored before committed sample count of the chunk is
+// published with release store. After crash of the recording process every
+// sample below committed count is intact, chunk with invalid header ends the
+// recording.
+namespace inseye::internal {
+
+constexpr char kRecordingMagic[8] = {'I', 'N', 'S', 'Y', 'R', 'E', 'C', '\0'};
+constexpr uint32_t kRecordingFormatVersion = 1;
+constexpr uint32_t kRecordingChunkMagic = 0x4B484349;  // "ICHK"
+constexpr uint32_t kRecordingHeaderRegionSize = kMappedFileAlignment;
+constexpr uint32_t kRecordingChunkHeaderSize = 64;
+constexpr uint32_t kDefaultRecordingChunkSize = 1024 * 1024;
+constexpr uint32_t kRecordingSampleSize = sizeof(EyeTrackerDataStruct);
+
+#pragma pack(push, 1)
+struct RecordingFileHeader {
+  char magic[8];
+  uint32_t format_version;
+  uint32_t header_region_size;
+  uint32_t chunk_size;
+  uint32_t chunk_header_size;
+  uint32_t sample_size;
+};
+
+struct RecordingChunkHeader {
+  uint32_t magic;
+  uint32_t chunk_index;
+  // published with release semantics after samples and last_time are stored
+  uint32_t committed_sample_count;
+  uint32_t reserved;
+  uint64_t first_sample_position;
+  uint64_t first_time;
+  uint64_t last_time;
+};
+#pragma pack(pop)
+static_assert(sizeof(RecordingChunkHeader) <= kRecordingChunkHeaderSize,
+              "Chunk header doesn't fit in reserved space");
+static_assert(offsetof(RecordingChunkHeader, committed_sample_count) % 4 == 0,
+              "committed_sample_count must be naturally aligned");
+
+/**
+ * @brief Appends samples to recording file keeping single chunk mapped.
+ */
+class RecordingWriter {
+  MappedFile file_;
+  MappedFileView chunk_;
+  uint32_t chunk_size_;
+  uint32_t samples_per_chunk_;
+  uint32_t chunk_index_ = 0;
+  uint32_t chunk_sample_count_ = 0;
+  uint64_t sample_count_ = 0;
+
+  void OpenChunk(uint32_t chunk_index);
+
+ public:
+  /**
+   * @brief Creates recording file with first empty chunk.
+   * Throws InitializationException on failure.
+   */
+  RecordingWriter(const std::string& path, uint32_t chunk_size);
+  RecordingWriter(const RecordingWriter&) = delete;
+  RecordingWriter& operator=(const RecordingWriter&) = delete;
+  ~RecordingWriter();
+  /**
+   * @brief Stores and commits samples, opens new chunks when needed.
+   * Throws InitializationException when file can't be extended or mapped.
+   */
+  void Append(const inseye::EyeTrackerDataStruct* samples, uint32_t count);
+  /**
+   * @brief Number of samples that fit into space returned by Reserve.
+   */
+  [[nodiscard]] uint32_t GetReservableCount() const noexcept {
+    return chunk_sample_count_ == samples_per_chunk_
+               ? samples_per_chunk_
+               : samples_per_chunk_ - chunk_sample_count_;
+  }
+  /**
+   * @brief Space for GetReservableCount samples in recording layout right
+   * after committed samples, opens new chunk when the current one is full.
+   * Throws InitializationException when file can't be extended or mapped.
+   */
+  std::byte* Reserve();
+  /**
+   * @brief Commits count samples stored at the beginning of reserved space.
+   */
+  void Commit(uint32_t count);
+  [[nodiscard]] uint64_t GetSampleCount() const noexcept {
+    return sample_count_;
+  }
+};
+
+/**
+ * @brief Read only view of recording, captures samples committed when opened.
+ */
+class RecordingReader {
+  MappedFile file_;
+  MappedFileView view_;
+  uint32_t chunk_size_ = 0;
+  uint32_t samples_per_chunk_ = 0;
+  uint32_t chunk_count_ = 0;
+  uint64_t sample_count_ = 0;
+
+  [[nodiscard]] const std::byte* ChunkAddress(uint32_t chunk_index) const;
+  [[nodiscard]] uint64_t SampleTime(uint64_t sample_position) const;
+
+ public:
+  /**
+   * @brief Opens and validates recording.
+   * Throws InitializationException on failure.
+   */
+  explicit RecordingReader(const std::string& path);
+  [[nodiscard]] uint64_t GetSampleCount() const noexcept {
+    return sample_count_;
+  }
+  uint32_t Read(uint64_t sample_position,
+                inseye::EyeTrackerDataStruct* samples,
+                uint32_t capacity) const;
+  bool Seek(uint64_t time, uint64_t& sample_position) const;
+};
+
+}  // namespace inseye::internal
+#endif  //REMOTE_CONNECTOR_LIB_RECORDING_FILE_HPP
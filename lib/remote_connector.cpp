@@ -7,16 +7,29 @@
 // All other rights reserved.
 
 #include "remote_connector.h"
-#include <windows.h>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cmath>
-#include <format>
+#include <cstring>
+#include <memory>
 #include <thread>
 
+#include "allocator.hpp"
+#include "clock_model.hpp"
+#include "columns_decoder.hpp"
 #include "errors.hpp"
 #include "eye_tracker_data_struct.hpp"
+#include "filter_chain.hpp"
+#include "gaze_classifier.hpp"
+#include "gaze_predictor.hpp"
 #include "named_pipe_communicator.hpp"
+#include "reader_internal.hpp"
+#include "reader_statistics.hpp"
+#include "reconnect_supervisor.hpp"
+#include "service_session.hpp"
 #include "shared_memory_header.hpp"
+#include "transport.hpp"
 
 
 constexpr uint32_t UNREAD_SAMPLE_INDEX = 0;
@@ -28,76 +41,867 @@ static_assert(sizeof(enum inseye::c::InseyeGazeEvent) == sizeof(uint32_t),
 static_assert((inseye::c::kInsGazeBlinkLeft ^ ((uint32_t)1)) == 0,
               "Incompatible binary layout");
 
-struct inseye::c::InseyeEyeTracker {
-  std::unique_ptr<void, std::function<void(void*)>> mapped_file_handle;
-  std::unique_ptr<byte, std::function<void(void*)>> in_memory_buffer_pointer;
+// Read position of single consumer of the ring. Reader has one and every
+// cursor created from it has its own, all of them read the same mapping.
+struct ReadCursor {
+  // first cache line holds ring geometry and addresses, second one reader
+  // position
+  inseye::internal::RingState ring;
   uint32_t lastSampleIndex = UNREAD_SAMPLE_INDEX;
-  inseye::internal::NamedPipeCommunicator named_pipe_communicator;
-  std::unique_ptr<inseye::internal::SharedMemoryHeader> shared_memory_header =
-      nullptr;
+  // set after writer woke up waiting reader at least once
+  bool writer_rings_doorbell = false;
+  // set when reconnect switched the ring, cleared by the next returned sample
+  bool discontinuity = false;
+  // clock model of the session, fed with arrivals of freshly read samples
+  inseye::internal::ClockModel* clock_model = nullptr;
+  // null unless reconnect is enabled, reads switch to the ring of supervisor
+  // generation once it differs from reconnect_generation
+  std::shared_ptr<inseye::internal::ReconnectSupervisor> reconnect{};
+  const inseye::internal::ReconnectSupervisor::Generation*
+      reconnect_generation = nullptr;
+  uint32_t next_clock_observation_index = UNREAD_SAMPLE_INDEX;
+  // number of reads repeated because sample was overwritten during copy,
+  // atomic so that statistics can be read from other thread
+  std::atomic<uint64_t> read_retry_count = 0;
+  // not touched by reads when compiled out
+  inseye::internal::ReaderStatistics statistics{};
+  // fed by predictions only, up to predicted_sample_index
+  inseye::internal::GazePredictor gaze_predictor{};
+  uint32_t predicted_sample_index = UNREAD_SAMPLE_INDEX;
+  // applied only by filtered reads, null without stages
+  inseye::internal::UniquePtr<inseye::internal::FilterChain> filter_chain{};
+  // fed by segment reads only, up to classified_sample_index, null when
+  // classification is stopped
+  inseye::internal::UniquePtr<inseye::internal::GazeClassifier>
+      gaze_classifier{};
+  uint32_t classified_sample_index = UNREAD_SAMPLE_INDEX;
+  // reader and its cursors share process wide service session
+  std::shared_ptr<const inseye::internal::ServiceSession> session{};
+  // session read before reconnect, keeps lease taken from it readable
+  std::shared_ptr<const inseye::internal::ServiceSession> previous_session{};
+  // keeps reconnect_generation alive, registered in reconnect supervisor
+  inseye::internal::ReconnectSupervisor::Hazard reconnect_hazard{nullptr};
 };
 
-inline uint32_t CalculateEyeTrackerDataMemoryOffset(
-    uint32_t headerSize, uint32_t single_eye_tracker_sample_size,
-    uint32_t sample_index, uint32_t number_of_samples) {
-  const int64_t as_long = sample_index;
-  const auto wholes = static_cast<int32_t>(as_long % number_of_samples);
-  return headerSize + single_eye_tracker_sample_size * wholes;
+struct inseye::c::InseyeEyeTracker : ReadCursor {};
+
+struct inseye::c::InseyeCursor : ReadCursor {};
+
+// Read protocol.
+// Service stores sample with index n (counted from 1) in slot n % N of the
+// ring and then publishes it with release store of samples written = n.
+// Slot of sample k is reused by sample k + N which the service starts writing
+// while samples written is still k + N - 1, so copy of sample k is intact when
+// samples written loaded after the copy (behind acquire fence) is smaller than
+// k + N - 1. Samples are validated after copy and on failure the read is
+// retried from the oldest intact sample at most maxReadRetryCount times.
+// In layouts with sequence stamps (V2) service also sets stamp of the slot to 0
+// before rewriting it and to sample index after the sample is stored, single
+// sample reads check the stamp, ranges are still validated with one load of
+// samples written.
+constexpr int maxReadRetryCount = 10;
+
+// Number of samples in range [first_sample_index, first_sample_index + count)
+// that could have been overwritten, these always form prefix of the range.
+inline uint32_t CountOverwrittenSamples(uint32_t samples_written,
+                                        uint32_t first_sample_index,
+                                        uint32_t count,
+                                        uint32_t total_samples_in_buffer) {
+  const uint32_t distance = samples_written - first_sample_index;
+  if (distance < total_samples_in_buffer - 1)
+    return 0;
+  return (std::min)(count, distance - (total_samples_in_buffer - 2));
+}
+
+// Oldest sample index that is safe to read when service wrote samples_written.
+inline uint32_t OldestIntactSampleIndex(uint32_t samples_written,
+                                        uint32_t total_samples_in_buffer) {
+  return samples_written - (total_samples_in_buffer - 2);
+}
+
+// Samples skipped between previous read and first_sample_index, the first
+// read of new reader starts at the oldest sample which is not a drop.
+inline uint32_t CountDroppedSamples(uint32_t last_sample_index,
+                                    uint32_t first_sample_index) {
+  return last_sample_index == UNREAD_SAMPLE_INDEX
+             ? 0
+             : first_sample_index - last_sample_index - 1;
+}
+
+inline void IncrementReadRetryCount(ReadCursor& commonData) {
+  // single writer, no need for read-modify-write
+  commonData.read_retry_count.store(
+      commonData.read_retry_count.load(std::memory_order_relaxed) + 1,
+      std::memory_order_relaxed);
+}
+
+// Every few samples arrival of the newest returned sample is paired with local
+// time, only when nothing newer was published yet, backlog arrival time says
+// nothing about the service clock.
+constexpr uint32_t clock_observation_stride = 8;
+constexpr uint32_t clock_observation_maximum_lag = 1;
+
+inline void ObserveSampleArrival(ReadCursor& commonData, uint64_t sample_time) {
+  if (commonData.next_clock_observation_index != UNREAD_SAMPLE_INDEX &&
+      static_cast<int32_t>(commonData.lastSampleIndex -
+                           commonData.next_clock_observation_index) < 0)
+    return;
+  if (commonData.ring.LoadSamplesWritten() - commonData.lastSampleIndex >
+      clock_observation_maximum_lag)
+    return;
+  commonData.next_clock_observation_index =
+      commonData.lastSampleIndex + clock_observation_stride;
+  commonData.clock_model->Observe(
+      sample_time, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                       .count());
+}
+
+inline uint32_t LoadSamplesWrittenAfterRead(
+    const inseye::internal::RingState& ring) {
+  // orders sample loads before the samples written load
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return ring.LoadSamplesWritten();
+}
+
+// Reconnect.
+// Supervisor thread publishes generation with session of restarted service,
+// reads that move the position compare it with the adopted one and switch to
+// its ring on the reading thread. Position, clock observations and filters
+// restart on the new ring and the first sample returned from it is marked.
+// Reads never wait for the supervisor and never free mapping, the supervisor
+// drops the last reference to sessions it replaced.
+
+void AdoptReconnectGeneration(ReadCursor& commonData) {
+  const auto* generation =
+      commonData.reconnect->Protect(commonData.reconnect_hazard);
+  commonData.reconnect_generation = generation;
+  commonData.previous_session =
+      std::exchange(commonData.session, generation->session);
+  const auto& session = *commonData.session;
+  commonData.ring =
+      session.shared_memory_header.MakeRingState(session.in_memory_buffer);
+  commonData.clock_model = &session.clock_model;
+  commonData.lastSampleIndex = UNREAD_SAMPLE_INDEX;
+  commonData.writer_rings_doorbell = false;
+  commonData.next_clock_observation_index = UNREAD_SAMPLE_INDEX;
+  commonData.gaze_predictor.Reset();
+  commonData.predicted_sample_index = UNREAD_SAMPLE_INDEX;
+  if (commonData.filter_chain != nullptr)
+    commonData.filter_chain->Restart();
+  if (commonData.gaze_classifier != nullptr &&
+      commonData.gaze_classifier->CanAdd())
+    commonData.gaze_classifier->Interrupt();
+  commonData.classified_sample_index = UNREAD_SAMPLE_INDEX;
+  commonData.discontinuity = true;
+}
+
+inline bool IsReconnectPending(const ReadCursor& commonData) {
+  return commonData.reconnect != nullptr &&
+         commonData.reconnect->Current() != commonData.reconnect_generation;
+}
+
+inline void FollowReconnect(ReadCursor& commonData) {
+  if (IsReconnectPending(commonData))
+    AdoptReconnectGeneration(commonData);
+}
+
+inline void MarkDiscontinuity(ReadCursor& commonData,
+                              inseye::c::InseyeGazeEvent& gaze_event) {
+  if (!commonData.discontinuity)
+    return;
+  commonData.discontinuity = false;
+  gaze_event = static_cast<inseye::c::InseyeGazeEvent>(
+      gaze_event | inseye::c::kInsGazeDiscontinuity);
 }
 
-inline void ReadDataSampleInternal(const inseye::c::InseyeEyeTracker& commonData, inseye::c::InseyeEyeTrackerDataStruct& data_struct) {
-  const uint32_t sampleSize =
-      commonData.shared_memory_header->GetDataSampleSize();
-  auto offset = CalculateEyeTrackerDataMemoryOffset(
-      commonData.shared_memory_header->GetHeaderSize(), sampleSize,
-      commonData.lastSampleIndex,
-      commonData.shared_memory_header->GetSampleCount());
-  assert(offset + sampleSize <=
-         commonData.shared_memory_header->GetBufferSize());
-  inseye::internal::readDataSample(
-      commonData.in_memory_buffer_pointer.get() + offset, data_struct);
+inline void ReadDataSampleInternal(const ReadCursor& commonData,
+                                   uint32_t sample_index,
+                                   inseye::c::InseyeEyeTrackerDataStruct& data_struct) {
+  const auto& ring = commonData.ring;
+  assert(ring.header_size + static_cast<size_t>(ring.SlotOf(sample_index) + 1) *
+             ring.sample_size <=
+         ring.buffer_size);
+  inseye::internal::readDataSample(ring.SampleAddress(sample_index),
+                                   data_struct);
+}
+
+// Copies published sample and checks that it was not overwritten during the
+// copy. Slots with sequence stamp are validated by the stamp that shares cache
+// line with the sample instead of loading samples written counter again from
+// the line service keeps writing to.
+inline bool ReadIntactDataSampleInternal(
+    const ReadCursor& commonData, uint32_t sample_index,
+    inseye::c::InseyeEyeTrackerDataStruct& data_struct) {
+  const auto& ring = commonData.ring;
+  if (!ring.HasSequenceStamps()) {
+    ReadDataSampleInternal(commonData, sample_index, data_struct);
+    return CountOverwrittenSamples(LoadSamplesWrittenAfterRead(ring),
+                                   sample_index, 1, ring.sample_count) == 0;
+  }
+  const std::byte* slot = ring.SampleAddress(sample_index);
+  if (ring.LoadSequenceStamp(slot, std::memory_order_acquire) != sample_index)
+    return false;
+  ReadDataSampleInternal(commonData, sample_index, data_struct);
+  // orders sample loads before the stamp load
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return ring.LoadSequenceStamp(slot, std::memory_order_relaxed) ==
+         sample_index;
 }
 
 bool TryReadNextDataSampleInternal(
-    inseye::c::InseyeEyeTracker& commonData,  // NOLINT(*-no-recursion)
-    inseye::c::InseyeEyeTrackerDataStruct& dataStruct, int recursionCount) {
-  constexpr int maxRecursionCount = 10;
-  if (recursionCount > maxRecursionCount)
+    ReadCursor& commonData,
+    inseye::c::InseyeEyeTrackerDataStruct& dataStruct) {
+  FollowReconnect(commonData);
+  const auto& ring = commonData.ring;
+  const uint32_t total_samples_in_buffer = ring.sample_count;
+  for (int retry = 0; retry <= maxReadRetryCount; ++retry) {
+    const auto currentDataSample = ring.LoadSamplesWritten();
+    if (currentDataSample == UNWRITTEN_SAMPLE_INDEX)
+      return false;  // service has not written any data to shared memory
+    if (currentDataSample == commonData.lastSampleIndex)
+      return false;  // no new data since last call
+    uint32_t sample_index = commonData.lastSampleIndex + 1;
+    if (CountOverwrittenSamples(currentDataSample, sample_index, 1,
+                                total_samples_in_buffer) != 0) {
+      // fallback to most 'old' data sample if service overwriten buffer
+      // at least once since last call
+      sample_index =
+          OldestIntactSampleIndex(currentDataSample, total_samples_in_buffer);
+    }
+    if (ReadIntactDataSampleInternal(commonData, sample_index, dataStruct)) {
+      commonData.statistics.RecordRead(
+          CountDroppedSamples(commonData.lastSampleIndex, sample_index), 1,
+          currentDataSample - sample_index);
+      commonData.lastSampleIndex = sample_index;
+      ObserveSampleArrival(commonData, dataStruct.time);
+      MarkDiscontinuity(commonData, dataStruct.gaze_event);
+      return true;
+    }
+    IncrementReadRetryCount(commonData);
+  }
+  commonData.statistics.RecordRetryLimitFailure();
+  return false;
+}
+
+bool TryReadLatestDataSampleInternal(
+    ReadCursor& implementation,
+    inseye::c::InseyeEyeTrackerDataStruct& data_struct) {
+  FollowReconnect(implementation);
+  auto latest_written = implementation.ring.LoadSamplesWritten();
+  implementation.lastSampleIndex =
+      (std::max)(implementation.lastSampleIndex, latest_written - 1);
+  return TryReadNextDataSampleInternal(implementation, data_struct);
+}
+
+inline void ReadDataSamplesInternal(
+    const ReadCursor& commonData, uint32_t first_sample_index,
+    uint32_t count, inseye::c::InseyeEyeTrackerDataStruct* data_structs) {
+  const auto& ring = commonData.ring;
+  const uint32_t sample_size = ring.sample_size;
+  uint32_t slot = ring.SlotOf(first_sample_index);
+  // samples are stored contiguously up to the end of the ring, so the whole
+  // range is decoded in at most two linear passes (before and after wrap)
+  while (count > 0) {
+    const uint32_t contiguous = (std::min)(count, ring.sample_count - slot);
+    const std::byte* source =
+        ring.samples + static_cast<size_t>(slot) * sample_size;
+    for (uint32_t i = 0; i < contiguous; ++i, source += sample_size)
+      inseye::internal::readDataSample(source, *data_structs++);
+    count -= contiguous;
+    slot = 0;
+  }
+}
+
+inline void ReadDataSampleColumnsInternal(
+    const ReadCursor& commonData, uint32_t first_sample_index,
+    uint32_t count, const inseye::c::InseyeEyeTrackerDataColumns& columns) {
+  const auto& ring = commonData.ring;
+  const uint32_t slot = ring.SlotOf(first_sample_index);
+  const uint32_t contiguous = (std::min)(count, ring.sample_count - slot);
+  inseye::internal::DecodeSampleColumns(
+      ring.samples + static_cast<size_t>(slot) * ring.sample_size,
+      ring.sample_size, contiguous, columns, 0);
+  if (contiguous < count)
+    inseye::internal::DecodeSampleColumns(ring.samples, ring.sample_size,
+                                          count - contiguous, columns,
+                                          contiguous);
+}
+
+// Reads up to capacity unread samples in one pass.
+// read_range(first_sample_index, count) copies samples to the destination,
+// drop_prefix(dropped, kept) removes samples that turned out to be overwritten
+// during the copy from the beginning of the destination.
+template <typename RangeReader, typename PrefixDropper>
+bool TryReadDataSampleRangeInternal(ReadCursor& commonData,
+                                    uint32_t capacity, uint32_t& count,
+                                    RangeReader&& read_range,
+                                    PrefixDropper&& drop_prefix) {
+  count = 0;
+  if (capacity == 0)
+    return false;
+  FollowReconnect(commonData);
+  const auto& ring = commonData.ring;
+  const uint32_t total_samples_in_buffer = ring.sample_count;
+  for (int retry = 0; retry <= maxReadRetryCount; ++retry) {
+    const auto currentDataSample = ring.LoadSamplesWritten();
+    if (currentDataSample == UNWRITTEN_SAMPLE_INDEX)
+      return false;  // service has not written any data to shared memory
+    if (currentDataSample == commonData.lastSampleIndex)
+      return false;  // no new data since last call
+    uint32_t first_sample_index = commonData.lastSampleIndex + 1;
+    if (CountOverwrittenSamples(currentDataSample, first_sample_index, 1,
+                                total_samples_in_buffer) != 0) {
+      // fallback to most 'old' data sample if service overwriten buffer
+      // at least once since last call
+      first_sample_index =
+          OldestIntactSampleIndex(currentDataSample, total_samples_in_buffer);
+    }
+    const uint32_t read_count = (std::min)(
+        capacity, currentDataSample - first_sample_index + 1);
+    read_range(first_sample_index, read_count);
+    // validate the whole range at once, samples overwritten during the copy
+    // form a prefix of the range and are dropped
+    const uint32_t overwritten_count = CountOverwrittenSamples(
+        LoadSamplesWrittenAfterRead(ring), first_sample_index, read_count,
+        total_samples_in_buffer);
+    if (overwritten_count == read_count) {
+      IncrementReadRetryCount(commonData);
+      continue;
+    }
+    if (overwritten_count > 0)
+      drop_prefix(overwritten_count, read_count - overwritten_count);
+    count = read_count - overwritten_count;
+    commonData.statistics.RecordRead(
+        CountDroppedSamples(commonData.lastSampleIndex, first_sample_index) +
+            overwritten_count,
+        count, currentDataSample - (first_sample_index + overwritten_count));
+    commonData.lastSampleIndex = first_sample_index + read_count - 1;
+    return true;
+  }
+  commonData.statistics.RecordRetryLimitFailure();
+  return false;
+}
+
+bool TryReadDataSampleBatchInternal(
+    ReadCursor& commonData,
+    inseye::c::InseyeEyeTrackerDataStruct* data_structs, uint32_t capacity,
+    uint32_t& count) {
+  if (!TryReadDataSampleRangeInternal(
+          commonData, capacity, count,
+          [&](uint32_t first_sample_index, uint32_t read_count) {
+            ReadDataSamplesInternal(commonData, first_sample_index, read_count,
+                                    data_structs);
+          },
+          [&](uint32_t dropped, uint32_t kept) {
+            std::memmove(data_structs, data_structs + dropped,
+                         kept * sizeof(*data_structs));
+          }))
     return false;
-  auto currentDataSample =
-      commonData.shared_memory_header->ReadSamplesWrittenCount();
+  ObserveSampleArrival(commonData, data_structs[count - 1].time);
+  MarkDiscontinuity(commonData, data_structs[0].gaze_event);
+  return true;
+}
+
+template <typename T>
+inline void DropColumnPrefix(T* column, uint32_t dropped, uint32_t kept) {
+  std::memmove(column, column + dropped, kept * sizeof(T));
+}
+
+bool TryReadDataSampleColumnsInternal(
+    ReadCursor& commonData,
+    const inseye::c::InseyeEyeTrackerDataColumns& columns, uint32_t capacity,
+    uint32_t& count) {
+  if (!TryReadDataSampleRangeInternal(
+          commonData, capacity, count,
+          [&](uint32_t first_sample_index, uint32_t read_count) {
+            ReadDataSampleColumnsInternal(commonData, first_sample_index,
+                                          read_count, columns);
+          },
+          [&](uint32_t dropped, uint32_t kept) {
+            DropColumnPrefix(columns.time, dropped, kept);
+            DropColumnPrefix(columns.left_eye_x, dropped, kept);
+            DropColumnPrefix(columns.left_eye_y, dropped, kept);
+            DropColumnPrefix(columns.right_eye_x, dropped, kept);
+            DropColumnPrefix(columns.right_eye_y, dropped, kept);
+            DropColumnPrefix(columns.gaze_event, dropped, kept);
+          }))
+    return false;
+  ObserveSampleArrival(commonData, columns.time[count - 1]);
+  MarkDiscontinuity(commonData, columns.gaze_event[0]);
+  return true;
+}
+
+bool WaitForDataInternal(ReadCursor& commonData,
+                         std::chrono::nanoseconds timeout) {
+  // Writers that don't wake readers up are polled in short slices, once writer
+  // is known to wake readers up the whole remaining timeout is slept through.
+  constexpr std::chrono::nanoseconds polling_slice =
+      std::chrono::milliseconds(1);
+  // service that is gone doesn't ring, waits are cut short to notice reconnect
+  constexpr std::chrono::nanoseconds reconnect_slice =
+      std::chrono::milliseconds(10);
+  const auto& ring = commonData.ring;
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  bool slept_without_wake_up = false;
+  while (true) {
+    FollowReconnect(commonData);
+    const uint32_t* samples_written_address = ring.samples_written;
+    const uint32_t observed_raw_value =
+        std::atomic_ref<uint32_t>(*const_cast<uint32_t*>(samples_written_address))
+            .load(std::memory_order_relaxed);
+    const auto currentDataSample = ring.LoadSamplesWritten();
+    if (currentDataSample != UNWRITTEN_SAMPLE_INDEX &&
+        currentDataSample != commonData.lastSampleIndex) {
+      // data was published but nobody woke us up, writer stopped ringing
+      if (slept_without_wake_up)
+        commonData.writer_rings_doorbell = false;
+      return true;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= deadline)
+      return false;
+    const std::chrono::nanoseconds remaining = deadline - now;
+    auto slice = commonData.writer_rings_doorbell
+                     ? remaining
+                     : (std::min)(remaining, polling_slice);
+    if (commonData.reconnect != nullptr)
+      slice = (std::min)(slice, reconnect_slice);
+    const auto result = inseye::internal::WaitForSharedValueChange(
+        samples_written_address, observed_raw_value, slice);
+    if (result == inseye::internal::SharedValueWaitResult::kWokenUp)
+      commonData.writer_rings_doorbell = true;
+    slept_without_wake_up =
+        result == inseye::internal::SharedValueWaitResult::kTimeout;
+  }
+}
+
+// Time queries.
+// Sample times never decrease, so samples held by the ring are binary searched
+// by time reading only the time field of probed samples. Queries don't touch
+// read position, they validate the lowest sample index they read against
+// samples written loaded after the reads and start over when it was
+// overwritten.
+
+inline uint64_t ReadSampleTimeInternal(const ReadCursor& commonData,
+                                       uint32_t sample_index) {
+  return inseye::internal::read_swap_endianess_if_needed<uint64_t>(
+      reinterpret_cast<const uint64_t*>(
+          commonData.ring.SampleAddress(sample_index) +
+          offsetof(inseye::internal::EyeTrackerDataStruct, time)));
+}
+
+// Range of sample indexes held by the ring when service wrote samples_written.
+struct HeldSamples {
+  uint32_t first_sample_index;
+  uint32_t count;
+};
+
+inline HeldSamples GetHeldSamples(uint32_t samples_written,
+                                  uint32_t total_samples_in_buffer) {
+  // sample indexes are counted from 1
+  const uint32_t first_sample_index =
+      samples_written < total_samples_in_buffer - 1
+          ? 1
+          : OldestIntactSampleIndex(samples_written, total_samples_in_buffer);
+  return {first_sample_index, samples_written - first_sample_index + 1};
+}
+
+// Returns offset from held.first_sample_index of the first sample in
+// [begin, end) offsets for which is_before(time) is false, end when there is
+// none. lowest_read is lowered to the lowest offset read.
+template <typename IsBefore>
+uint32_t PartitionSamplesByTime(const ReadCursor& commonData,
+                                const HeldSamples& held, uint32_t begin,
+                                uint32_t end, IsBefore&& is_before,
+                                uint32_t& lowest_read) {
+  uint32_t size = end - begin;
+  while (size > 0) {
+    const uint32_t half = size / 2;
+    const uint32_t probe = begin + half;
+    lowest_read = (std::min)(lowest_read, probe);
+    if (is_before(
+            ReadSampleTimeInternal(commonData, held.first_sample_index + probe))) {
+      begin = probe + 1;
+      size -= half + 1;
+    } else {
+      size = half;
+    }
+  }
+  return begin;
+}
+
+inline bool IsHeldSampleIntact(const ReadCursor& commonData,
+                               const HeldSamples& held, uint32_t offset) {
+  return CountOverwrittenSamples(LoadSamplesWrittenAfterRead(commonData.ring),
+                                 held.first_sample_index + offset, 1,
+                                 commonData.ring.sample_count) == 0;
+}
+
+void InterpolateSample(const inseye::c::InseyeEyeTrackerDataStruct& before,
+                       const inseye::c::InseyeEyeTrackerDataStruct& after,
+                       double time, inseye::c::InseyeTimeQueryMode mode,
+                       inseye::c::InseyeEyeTrackerDataStruct& data_struct) {
+  const auto before_time = static_cast<double>(before.time);
+  const auto after_time = static_cast<double>(after.time);
+  data_struct = time - before_time <= after_time - time ? before : after;
+  if (mode != inseye::c::InseyeTimeQueryMode::kInsTimeQueryInterpolate)
+    return;
+  data_struct.time = static_cast<uint64_t>(time + 0.5);
+  // positions on the other side of blink or saccade boundary don't belong to
+  // the same movement
+  if (before.gaze_event != after.gaze_event)
+    return;
+  const auto weight =
+      static_cast<float>((time - before_time) / (after_time - before_time));
+  const auto lerp = [weight](float from, float to) {
+    return from + (to - from) * weight;
+  };
+  data_struct.left_eye_x = lerp(before.left_eye_x, after.left_eye_x);
+  data_struct.left_eye_y = lerp(before.left_eye_y, after.left_eye_y);
+  data_struct.right_eye_x = lerp(before.right_eye_x, after.right_eye_x);
+  data_struct.right_eye_y = lerp(before.right_eye_y, after.right_eye_y);
+}
+
+bool TryReadDataSampleAtInternal(
+    ReadCursor& commonData, double time, inseye::c::InseyeTimeQueryMode mode,
+    inseye::c::InseyeEyeTrackerDataStruct& data_struct) {
+  FollowReconnect(commonData);
+  const auto& ring = commonData.ring;
+  for (int retry = 0; retry <= maxReadRetryCount; ++retry) {
+    const auto currentDataSample = ring.LoadSamplesWritten();
+    if (currentDataSample == UNWRITTEN_SAMPLE_INDEX ||
+        currentDataSample == UNREAD_SAMPLE_INDEX)
+      return false;  // service has not written any data to shared memory
+    const auto held = GetHeldSamples(currentDataSample, ring.sample_count);
+    uint32_t lowest_read = held.count;
+    const uint32_t after = PartitionSamplesByTime(
+        commonData, held, 0, held.count,
+        [time](uint64_t sample_time) {
+          return static_cast<double>(sample_time) <= time;
+        },
+        lowest_read);
+    if (after == 0) {
+      // time is older than the oldest sample, unless the search was torn
+      if (IsHeldSampleIntact(commonData, held, lowest_read))
+        return false;
+      continue;
+    }
+    inseye::c::InseyeEyeTrackerDataStruct before_sample{};
+    ReadDataSampleInternal(commonData, held.first_sample_index + after - 1,
+                           before_sample);
+    if (after == held.count) {
+      // nothing newer, no extrapolation
+      if (IsHeldSampleIntact(commonData, held,
+                             (std::min)(lowest_read, after - 1))) {
+        data_struct = before_sample;
+        return true;
+      }
+      continue;
+    }
+    inseye::c::InseyeEyeTrackerDataStruct after_sample{};
+    ReadDataSampleInternal(commonData, held.first_sample_index + after,
+                           after_sample);
+    if (IsHeldSampleIntact(commonData, held,
+                           (std::min)(lowest_read, after - 1))) {
+      InterpolateSample(before_sample, after_sample, time, mode, data_struct);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ReadDataSampleRangeInternal(
+    ReadCursor& commonData, uint64_t begin_time, uint64_t end_time,
+    inseye::c::InseyeEyeTrackerDataStruct* data_structs, uint32_t capacity,
+    uint32_t& count) {
+  count = 0;
+  if (capacity == 0 || begin_time >= end_time)
+    return false;
+  FollowReconnect(commonData);
+  const auto& ring = commonData.ring;
+  for (int retry = 0; retry <= maxReadRetryCount; ++retry) {
+    const auto currentDataSample = ring.LoadSamplesWritten();
+    if (currentDataSample == UNWRITTEN_SAMPLE_INDEX ||
+        currentDataSample == UNREAD_SAMPLE_INDEX)
+      return false;  // service has not written any data to shared memory
+    const auto held = GetHeldSamples(currentDataSample, ring.sample_count);
+    uint32_t lowest_read = held.count;
+    const uint32_t begin = PartitionSamplesByTime(
+        commonData, held, 0, held.count,
+        [begin_time](uint64_t sample_time) { return sample_time < begin_time; },
+        lowest_read);
+    const uint32_t end = PartitionSamplesByTime(
+        commonData, held, begin, held.count,
+        [end_time](uint64_t sample_time) { return sample_time < end_time; },
+        lowest_read);
+    const uint32_t read_count = (std::min)(end - begin, capacity);
+    if (read_count != 0) {
+      ReadDataSamplesInternal(commonData, held.first_sample_index + begin,
+                              read_count, data_structs);
+      lowest_read = (std::min)(lowest_read, begin);
+    }
+    if (!IsHeldSampleIntact(commonData, held, lowest_read))
+      continue;
+    count = read_count;
+    return count != 0;
+  }
+  return false;
+}
+
+// Read leases.
+// Lease hands out ring memory instead of copies. Read position moves past
+// leased samples when the lease is acquired and the leased range is checked
+// when it's released, after the caller is done reading it.
+
+bool AcquireReadLeaseInternal(ReadCursor& commonData, uint32_t max_count,
+                              inseye::c::InseyeLease& lease) {
+  lease = {};
+  if (max_count == 0)
+    return false;
+  FollowReconnect(commonData);
+  const auto& ring = commonData.ring;
+  const uint32_t total_samples_in_buffer = ring.sample_count;
+  const auto currentDataSample = ring.LoadSamplesWritten();
   if (currentDataSample == UNWRITTEN_SAMPLE_INDEX)
     return false;  // service has not written any data to shared memory
   if (currentDataSample == commonData.lastSampleIndex)
     return false;  // no new data since last call
-  const uint32_t total_samples_in_buffer =
-      commonData.shared_memory_header->GetSampleCount();
-  if (currentDataSample - commonData.lastSampleIndex >
-      total_samples_in_buffer) {
-    // fallback to most 'old' data sample if service overwriten buffer
-    // at least once since last call
-    commonData.lastSampleIndex = currentDataSample - total_samples_in_buffer;
+  uint32_t first_sample_index = commonData.lastSampleIndex + 1;
+  if (CountOverwrittenSamples(currentDataSample, first_sample_index, 1,
+                              total_samples_in_buffer) != 0)
+    first_sample_index =
+        OldestIntactSampleIndex(currentDataSample, total_samples_in_buffer);
+  const uint32_t count =
+      (std::min)(max_count, currentDataSample - first_sample_index + 1);
+  const uint32_t slot = ring.SlotOf(first_sample_index);
+  const uint32_t contiguous = (std::min)(count, total_samples_in_buffer - slot);
+  lease.spans[0] = {
+      ring.samples + static_cast<size_t>(slot) * ring.sample_size, contiguous};
+  if (contiguous < count)
+    lease.spans[1] = {ring.samples, count - contiguous};
+  lease.count = count;
+  lease.sample_size = ring.sample_size;
+  lease.first_sample_index = first_sample_index;
+  if (commonData.discontinuity) {
+    commonData.discontinuity = false;
+    lease.flags = inseye::c::kInsGazeDiscontinuity;
+  }
+  commonData.statistics.RecordRead(
+      CountDroppedSamples(commonData.lastSampleIndex, first_sample_index),
+      count, currentDataSample - first_sample_index);
+  commonData.lastSampleIndex = first_sample_index + count - 1;
+  // the newest leased sample is the last one to be overwritten
+  const uint64_t newest_time =
+      ReadSampleTimeInternal(commonData, commonData.lastSampleIndex);
+  if (CountOverwrittenSamples(LoadSamplesWrittenAfterRead(ring),
+                              commonData.lastSampleIndex, 1,
+                              total_samples_in_buffer) == 0)
+    ObserveSampleArrival(commonData, newest_time);
+  return true;
+}
+
+uint32_t CountOverwrittenLeasedSamples(const ReadCursor& commonData,
+                                       const inseye::c::InseyeLease& lease) {
+  if (lease.count == 0)
+    return 0;
+  const auto& ring = commonData.ring;
+  if (reinterpret_cast<uintptr_t>(lease.spans[0].data) -
+          reinterpret_cast<uintptr_t>(ring.samples) >=
+      static_cast<uintptr_t>(ring.sample_count) * ring.sample_size)
+    return lease.count;  // taken from the ring replaced by reconnect
+  return CountOverwrittenSamples(LoadSamplesWrittenAfterRead(commonData.ring),
+                                 lease.first_sample_index, lease.count,
+                                 commonData.ring.sample_count);
+}
+
+// Gaze prediction.
+// Filters are fed when prediction is requested, so reads don't pay for them.
+// Samples published since the previous prediction are fed in chunks validated
+// like batch reads, predictor that fell further behind than
+// prediction_history_length samples or than the ring restarts on the newest
+// samples.
+constexpr uint32_t prediction_history_length = 64;
+constexpr uint32_t prediction_chunk_length = 16;
+
+void FeedGazePredictorInternal(ReadCursor& commonData) {
+  const auto& ring = commonData.ring;
+  inseye::c::InseyeEyeTrackerDataStruct samples[prediction_chunk_length];
+  for (int retry = 0; retry <= maxReadRetryCount; ++retry) {
+    const auto currentDataSample = ring.LoadSamplesWritten();
+    if (currentDataSample == UNWRITTEN_SAMPLE_INDEX ||
+        currentDataSample == UNREAD_SAMPLE_INDEX)
+      return;  // service has not written any data to shared memory
+    uint32_t pending = currentDataSample - commonData.predicted_sample_index;
+    const uint32_t held =
+        (std::min)(currentDataSample, ring.sample_count - 1);
+    if (pending > (std::min)(held, prediction_history_length)) {
+      // also taken when service restarted and samples written went back
+      pending = (std::min)(held, prediction_history_length);
+      commonData.gaze_predictor.Reset();
+    }
+    uint32_t first_sample_index = currentDataSample - pending + 1;
+    while (pending > 0) {
+      const uint32_t count = (std::min)(pending, prediction_chunk_length);
+      ReadDataSamplesInternal(commonData, first_sample_index, count, samples);
+      if (CountOverwrittenSamples(LoadSamplesWrittenAfterRead(ring),
+                                  first_sample_index, count,
+                                  ring.sample_count) != 0)
+        break;
+      for (uint32_t i = 0; i < count; ++i)
+        commonData.gaze_predictor.Update(samples[i]);
+      commonData.predicted_sample_index = first_sample_index + count - 1;
+      first_sample_index += count;
+      pending -= count;
+    }
+    if (pending == 0)
+      return;
+  }
+}
+
+bool PredictGazeInternal(ReadCursor& commonData, double target_time,
+                         inseye::c::InseyeGazePrediction& prediction) {
+  FollowReconnect(commonData);
+  FeedGazePredictorInternal(commonData);
+  return commonData.gaze_predictor.Predict(target_time, prediction);
+}
+
+// Filtering.
+// Chain is applied in place to batch read straight into filtered samples,
+// raw samples are copies made before filtering.
+
+inseye::c::InseyeInitializationStatus SetFilterChainInternal(
+    ReadCursor& commonData, const inseye::c::InseyeFilterStage* stages,
+    uint32_t stage_count) {
+  if (const char* error =
+          inseye::internal::FilterChain::Validate(stages, stage_count)) {
+    WriteErrorMessage(error);
+    return inseye::c::kFailure;
+  }
+  if (stage_count == 0) {
+    commonData.filter_chain.reset();
+    return inseye::c::kSuccess;
   }
-  commonData.lastSampleIndex++;
-  ReadDataSampleInternal(commonData, dataStruct);
-  // check post read if data just read was not overwritten
-  if (commonData.shared_memory_header->ReadSamplesWrittenCount() -
-          commonData.lastSampleIndex >
-      total_samples_in_buffer) {
-    return TryReadNextDataSampleInternal(commonData, dataStruct,
-                                         ++recursionCount);
+  try {
+    commonData.filter_chain =
+        inseye::internal::MakeUnique<inseye::internal::FilterChain>(
+            stages, stage_count);
+  } catch (const std::bad_alloc&) {
+    WriteErrorMessage("Failed to allocate filter chain.");
+    return inseye::c::kFailure;
   }
+  return inseye::c::kSuccess;
+}
+
+bool TryReadFilteredDataSampleBatchInternal(
+    ReadCursor& commonData, inseye::c::InseyeEyeTrackerDataStruct* raw_data,
+    inseye::c::InseyeEyeTrackerDataStruct* filtered_data, uint32_t capacity,
+    uint32_t& count) {
+  if (!TryReadDataSampleBatchInternal(commonData, filtered_data, capacity,
+                                      count))
+    return false;
+  if (raw_data != nullptr)
+    std::memcpy(raw_data, filtered_data,
+                static_cast<size_t>(count) * sizeof(*filtered_data));
+  if (commonData.filter_chain != nullptr)
+    commonData.filter_chain->Process(filtered_data, count);
   return true;
 }
 
-bool TryReadLatestDataSampleInternal(
-    inseye::c::InseyeEyeTracker& implementation,
-    inseye::c::InseyeEyeTrackerDataStruct& data_struct) {
-  auto latest_written =
-      implementation.shared_memory_header->ReadSamplesWrittenCount();
-  implementation.lastSampleIndex =
-      (std::max)(implementation.lastSampleIndex, latest_written - 1);
-  return TryReadNextDataSampleInternal(implementation, data_struct, 0);
+// Gaze classification.
+// Classifier is fed when segments are read, like gaze predictor, but it must
+// see every sample, so it's fed with all samples published since the previous
+// read until its segment queue fills up. Classifier that fell behind the ring
+// is interrupted and continues at the oldest held sample.
+constexpr uint32_t classification_chunk_length = 32;
+
+inseye::c::InseyeInitializationStatus StartGazeClassificationInternal(
+    ReadCursor& commonData,
+    const inseye::c::InseyeGazeClassifierOptions* options) {
+  const inseye::c::InseyeGazeClassifierOptions resolved =
+      options != nullptr ? *options
+                         : inseye::c::InseyeGazeClassifierOptions{};
+  if (const char* error =
+          inseye::internal::GazeClassifier::Validate(resolved)) {
+    WriteErrorMessage(error);
+    return inseye::c::kFailure;
+  }
+  try {
+    commonData.gaze_classifier =
+        inseye::internal::MakeUnique<inseye::internal::GazeClassifier>(
+            resolved);
+  } catch (const std::bad_alloc&) {
+    WriteErrorMessage("Failed to allocate gaze classifier.");
+    return inseye::c::kFailure;
+  }
+  const auto currentDataSample = commonData.ring.LoadSamplesWritten();
+  commonData.classified_sample_index =
+      currentDataSample == UNWRITTEN_SAMPLE_INDEX ? UNREAD_SAMPLE_INDEX
+                                                  : currentDataSample;
+  return inseye::c::kSuccess;
+}
+
+void FeedGazeClassifierInternal(ReadCursor& commonData) {
+  const auto& ring = commonData.ring;
+  auto& classifier = *commonData.gaze_classifier;
+  inseye::c::InseyeEyeTrackerDataStruct samples[classification_chunk_length];
+  for (int retry = 0; retry <= maxReadRetryCount; ++retry) {
+    const auto currentDataSample = ring.LoadSamplesWritten();
+    if (currentDataSample == UNWRITTEN_SAMPLE_INDEX ||
+        currentDataSample == UNREAD_SAMPLE_INDEX)
+      return;  // service has not written any data to shared memory
+    uint32_t pending = currentDataSample - commonData.classified_sample_index;
+    const uint32_t held =
+        (std::min)(currentDataSample, ring.sample_count - 1);
+    if (pending > held) {
+      // also taken when service restarted and samples written went back
+      if (!classifier.CanAdd())
+        return;
+      classifier.Interrupt();
+      pending = held;
+      commonData.classified_sample_index = currentDataSample - pending;
+    }
+    uint32_t first_sample_index = currentDataSample - pending + 1;
+    while (pending > 0) {
+      if (!classifier.CanAdd())
+        return;
+      const uint32_t count =
+          (std::min)(pending, classification_chunk_length);
+      ReadDataSamplesInternal(commonData, first_sample_index, count, samples);
+      if (CountOverwrittenSamples(LoadSamplesWrittenAfterRead(ring),
+                                  first_sample_index, count,
+                                  ring.sample_count) != 0)
+        break;
+      uint32_t fed = 0;
+      while (fed < count && classifier.CanAdd())
+        classifier.Add(samples[fed++]);
+      commonData.classified_sample_index = first_sample_index + fed - 1;
+      first_sample_index += fed;
+      pending -= fed;
+    }
+    if (pending == 0)
+      return;
+  }
+}
+
+bool TryReadGazeSegmentsInternal(ReadCursor& commonData,
+                                 inseye::c::InseyeGazeSegment* segments,
+                                 uint32_t capacity, uint32_t& count) {
+  count = 0;
+  if (commonData.gaze_classifier == nullptr)
+    return false;
+  FollowReconnect(commonData);
+  auto& classifier = *commonData.gaze_classifier;
+  count = classifier.Pop(segments, capacity);
+  while (count < capacity) {
+    FeedGazeClassifierInternal(commonData);
+    const uint32_t popped =
+        classifier.Pop(segments + count, capacity - count);
+    if (popped == 0)
+      break;
+    count += popped;
+  }
+  return count != 0;
 }
 
 /**
@@ -109,40 +913,209 @@ bool TryReadLatestDataSampleInternal(
 void CreateEyeTrackerReaderInternal(
     inseye::c::InseyeEyeTracker** pptr,
     const std::function<bool()>& is_cancellation_requested) {
-  auto named_pipe_communicator =
-      inseye::internal::NamedPipeCommunicator::Create(
-          is_cancellation_requested);
-  ThrowIfCancellationRequested(is_cancellation_requested);
-  auto serviceInfo = named_pipe_communicator.GetServiceInfo();
-
-  std::unique_ptr<void, std::function<void(void*)>> memory_mapped_file{
-      OpenFileMapping(FILE_MAP_READ,  // use paging file
-                      FALSE, serviceInfo.shared_buffer_path.c_str()),
-      CloseHandle};
-  if (memory_mapped_file == nullptr) {
-    ThrowInitialization(
-        std::format("Could not open file mapping object, GLE={}.\n",
-                    GetLastError()),
-        inseye::c::InseyeInitializationStatus::kFailedToAccessSharedResources);
+  auto session = inseye::internal::AcquireServiceSession(
+      is_cancellation_requested);
+  const auto ring =
+      session->shared_memory_header.MakeRingState(session->in_memory_buffer);
+  auto* const clock_model = &session->clock_model;
+  void* memory = inseye::internal::Allocate(
+      sizeof(inseye::c::InseyeEyeTracker), alignof(inseye::c::InseyeEyeTracker));
+  *pptr = ::new (memory) inseye::c::InseyeEyeTracker{
+      {.ring = ring, .clock_model = clock_model, .session = std::move(session)}};
+}
+
+// Entry points shared by readers and cursors, validate C API arguments.
+
+bool IsDataAvailable(const ReadCursor* cursor) {
+  if (cursor == nullptr)
+    return false;
+  if (IsReconnectPending(*cursor))
+    return true;  // the next read switches to restarted service
+  auto samples_written_count = cursor->ring.LoadSamplesWritten();
+  if (samples_written_count == UNWRITTEN_SAMPLE_INDEX)
+    return false;  // service has not written any data to shared memory
+  return cursor->ring.LoadSamplesWritten() > cursor->lastSampleIndex;
+}
+
+bool TryReadNextData(ReadCursor* cursor,
+                     inseye::c::InseyeEyeTrackerDataStruct* data_struct) {
+  if (cursor == nullptr || data_struct == nullptr)
+    return false;
+  return TryReadNextDataSampleInternal(*cursor, *data_struct);
+}
+
+bool TryReadLatestData(ReadCursor* cursor,
+                       inseye::c::InseyeEyeTrackerDataStruct* data_struct) {
+  if (cursor == nullptr || data_struct == nullptr)
+    return false;
+  return TryReadLatestDataSampleInternal(*cursor, *data_struct);
+}
+
+bool TryReadDataBatch(ReadCursor* cursor,
+                      inseye::c::InseyeEyeTrackerDataStruct* data_structs,
+                      uint32_t capacity, uint32_t* count) {
+  if (count != nullptr)
+    *count = 0;
+  if (cursor == nullptr || data_structs == nullptr || count == nullptr)
+    return false;
+  return TryReadDataSampleBatchInternal(*cursor, data_structs, capacity,
+                                        *count);
+}
+
+bool ReadDataColumns(ReadCursor* cursor,
+                     const inseye::c::InseyeEyeTrackerDataColumns* columns,
+                     uint32_t capacity, uint32_t* count) {
+  if (count != nullptr)
+    *count = 0;
+  if (cursor == nullptr || columns == nullptr || count == nullptr)
+    return false;
+  if (columns->time == nullptr || columns->left_eye_x == nullptr ||
+      columns->left_eye_y == nullptr || columns->right_eye_x == nullptr ||
+      columns->right_eye_y == nullptr || columns->gaze_event == nullptr)
+    return false;
+  return TryReadDataSampleColumnsInternal(*cursor, *columns, capacity, *count);
+}
+
+bool AcquireReadLease(ReadCursor* cursor, uint32_t max_count,
+                      inseye::c::InseyeLease* lease) {
+  if (lease != nullptr)
+    *lease = {};
+  if (cursor == nullptr || lease == nullptr)
+    return false;
+  return AcquireReadLeaseInternal(*cursor, max_count, *lease);
+}
+
+bool ReleaseReadLease(const ReadCursor* cursor,
+                      const inseye::c::InseyeLease* lease,
+                      uint32_t* overwritten_count) {
+  if (overwritten_count != nullptr)
+    *overwritten_count = 0;
+  if (cursor == nullptr || lease == nullptr)
+    return false;
+  const uint32_t overwritten = CountOverwrittenLeasedSamples(*cursor, *lease);
+  if (overwritten_count != nullptr)
+    *overwritten_count = overwritten;
+  return overwritten == 0;
+}
+
+bool WaitForData(ReadCursor* cursor, uint64_t timeout_ns) {
+  if (cursor == nullptr)
+    return false;
+  // clamp so that deadline computation can't overflow steady clock
+  constexpr uint64_t maximum_timeout_ns = uint64_t{1} << 62;
+  return WaitForDataInternal(
+      *cursor,
+      std::chrono::nanoseconds((std::min)(timeout_ns, maximum_timeout_ns)));
+}
+
+bool TryReadLastData(ReadCursor* cursor,
+                     inseye::c::InseyeEyeTrackerDataStruct* data_struct) {
+  if (cursor == nullptr || data_struct == nullptr)
+    return false;
+  // nothing was read from the ring of restarted service yet
+  FollowReconnect(*cursor);
+  const auto latest_read = cursor->lastSampleIndex;
+  if (latest_read == UNREAD_SAMPLE_INDEX)
+    return false;
+  return ReadIntactDataSampleInternal(*cursor, latest_read, *data_struct);
+}
+
+bool TryReadDataAt(ReadCursor* cursor, double time,
+                   inseye::c::InseyeTimeQueryMode mode,
+                   inseye::c::InseyeEyeTrackerDataStruct* data_struct) {
+  if (cursor == nullptr || data_struct == nullptr)
+    return false;
+  return TryReadDataSampleAtInternal(*cursor, time, mode, *data_struct);
+}
+
+bool ReadDataRange(ReadCursor* cursor, uint64_t begin_time,
+                   uint64_t end_time,
+                   inseye::c::InseyeEyeTrackerDataStruct* data_structs,
+                   uint32_t capacity, uint32_t* count) {
+  if (count != nullptr)
+    *count = 0;
+  if (cursor == nullptr || data_structs == nullptr || count == nullptr)
+    return false;
+  return ReadDataSampleRangeInternal(*cursor, begin_time, end_time,
+                                     data_structs, capacity, *count);
+}
+
+inseye::c::InseyeInitializationStatus SetFilterChain(
+    ReadCursor* cursor, const inseye::c::InseyeFilterStage* stages,
+    uint32_t stage_count) {
+  if (cursor == nullptr) {
+    WriteErrorMessage("Eye tracker reader must not be null.");
+    return inseye::c::kFailure;
   }
-  std::unique_ptr<inseye::internal::SharedMemoryHeader> shared_memory_header{
-      inseye::internal::ReadHeaderInternal(memory_mapped_file.get())};
-  std::unique_ptr<byte, std::function<void(void*)>> file_view{
-      (byte*)MapViewOfFile(memory_mapped_file.get(),  // handle to map object
-                           FILE_MAP_READ,             // read/write permission
-                           0, 0, shared_memory_header->GetBufferSize()),
-      UnmapViewOfFile};
-
-  if (file_view == nullptr) {
-    ThrowInitialization(
-        std::format("Could not map view of file ({}).", GetLastError()),
-        inseye::c::InseyeInitializationStatus::kFailedToMapSharedResources);
+  return SetFilterChainInternal(*cursor, stages, stage_count);
+}
+
+bool TryReadFilteredDataBatch(
+    ReadCursor* cursor, inseye::c::InseyeEyeTrackerDataStruct* raw_data,
+    inseye::c::InseyeEyeTrackerDataStruct* filtered_data, uint32_t capacity,
+    uint32_t* count) {
+  if (count != nullptr)
+    *count = 0;
+  if (cursor == nullptr || filtered_data == nullptr || count == nullptr)
+    return false;
+  return TryReadFilteredDataSampleBatchInternal(*cursor, raw_data,
+                                                filtered_data, capacity, *count);
+}
+
+inseye::c::InseyeInitializationStatus StartGazeClassification(
+    ReadCursor* cursor, const inseye::c::InseyeGazeClassifierOptions* options) {
+  if (cursor == nullptr) {
+    WriteErrorMessage("Eye tracker reader must not be null.");
+    return inseye::c::kFailure;
   }
+  return StartGazeClassificationInternal(*cursor, options);
+}
+
+void StopGazeClassification(ReadCursor* cursor) {
+  if (cursor != nullptr)
+    cursor->gaze_classifier.reset();
+}
+
+bool TryReadGazeSegments(ReadCursor* cursor,
+                         inseye::c::InseyeGazeSegment* segments,
+                         uint32_t capacity, uint32_t* count) {
+  if (count != nullptr)
+    *count = 0;
+  if (cursor == nullptr || segments == nullptr || count == nullptr)
+    return false;
+  return TryReadGazeSegmentsInternal(*cursor, segments, capacity, *count);
+}
+
+bool PredictGazeAt(ReadCursor* cursor, double target_time,
+                   inseye::c::InseyeGazePrediction* prediction) {
+  if (cursor == nullptr || prediction == nullptr)
+    return false;
+  return PredictGazeInternal(*cursor, target_time, *prediction);
+}
+
+bool GetStatistics(const ReadCursor* cursor,
+                   inseye::c::InseyeReaderStatistics* statistics) {
+  if (cursor == nullptr || statistics == nullptr)
+    return false;
+  *statistics = {};
+  statistics->read_retries =
+      cursor->read_retry_count.load(std::memory_order_relaxed);
+#if INSEYE_READER_STATISTICS
+  cursor->statistics.CopyTo(*statistics);
+  return true;
+#else
+  WriteErrorMessage("Library was built without reader statistics.");
+  return false;
+#endif
+}
 
-  *pptr = new inseye::c::InseyeEyeTracker{
-      std::move(memory_mapped_file), std::move(file_view), UNREAD_SAMPLE_INDEX,
-      std::move(named_pipe_communicator), std::move(shared_memory_header)};
+bool GetClockMapping(const ReadCursor* cursor,
+                     inseye::c::InseyeClockMapping* mapping) {
+  if (cursor == nullptr || mapping == nullptr)
+    return false;
+  return cursor->clock_model->TryGetMapping(*mapping);
 }
+
 namespace inseye {
 std::ostream& operator<<(std::ostream& os, const inseye::Version& p) {
   os << (long)p.major << "." << (long)p.minor << "." << (long)p.patch;
@@ -150,6 +1123,11 @@ std::ostream& operator<<(std::ostream& os, const inseye::Version& p) {
 }
 
 std::ostream& operator<<(std::ostream& os, GazeEvent event) {
+  const auto value = static_cast<uint32_t>(event);
+  if ((value & inseye::c::kInsGazeDiscontinuity) != 0)
+    return os << static_cast<GazeEvent>(value & ~static_cast<uint32_t>(
+                                            inseye::c::kInsGazeDiscontinuity))
+              << " (Discontinuity)";
   switch (event) {
     case GazeEvent::kInsGazeNone:
       os << "None";
@@ -186,6 +1164,10 @@ inseye::EyeTracker::EyeTracker(EyeTracker&& other) noexcept
   other.implementation_pointer_ = nullptr;
 }
 
+inseye::EyeTracker::EyeTracker(
+    inseye::c::InseyeEyeTracker* implementation) noexcept
+    : implementation_pointer_(implementation) {}
+
 inseye::EyeTracker::~EyeTracker() noexcept {
   inseye::c::DestroyEyeTrackerReader(&implementation_pointer_);
 }
@@ -203,13 +1185,303 @@ bool inseye::EyeTracker::TryReadLatestEyeTrackerData(
 bool inseye::EyeTracker::TryReadNextEyeTrackerData(
     inseye::EyeTrackerDataStruct& eye_tracker_data_struct) noexcept {
   return TryReadNextDataSampleInternal(*implementation_pointer_,
-                                       eye_tracker_data_struct, 0);
+                                       eye_tracker_data_struct);
+}
+
+bool inseye::EyeTracker::TryReadEyeTrackerDataBatch(
+    std::span<inseye::EyeTrackerDataStruct> out_data,
+    uint32_t& count) noexcept {
+  const auto capacity = static_cast<uint32_t>((std::min)(
+      out_data.size(), size_t{(std::numeric_limits<uint32_t>::max)()}));
+  return TryReadDataSampleBatchInternal(*implementation_pointer_,
+                                        out_data.data(), capacity, count);
+}
+
+bool inseye::EyeTracker::AcquireReadLease(uint32_t max_count,
+                                          Lease& lease) noexcept {
+  return AcquireReadLeaseInternal(*implementation_pointer_, max_count, lease);
+}
+
+bool inseye::EyeTracker::ReleaseReadLease(
+    const Lease& lease, uint32_t* overwritten_count) noexcept {
+  return ::ReleaseReadLease(implementation_pointer_, &lease,
+                            overwritten_count);
+}
+
+bool inseye::EyeTracker::ReadEyeTrackerDataColumns(
+    const inseye::EyeTrackerDataColumns& columns, uint32_t capacity,
+    uint32_t& count) noexcept {
+  return inseye::c::ReadEyeTrackerDataColumns(implementation_pointer_,
+                                              &columns, capacity, &count);
+}
+
+bool inseye::EyeTracker::WaitForEyeTrackerData(
+    std::chrono::nanoseconds timeout) noexcept {
+  return WaitForDataInternal(*implementation_pointer_, timeout);
 }
 
 bool inseye::EyeTracker::TryReadLastEyeTrackerData(inseye::EyeTrackerDataStruct& out_data) const noexcept {
   return inseye::c::TryReadLastEyeTrackerData(implementation_pointer_, &out_data);
 }
 
+bool inseye::EyeTracker::TryReadEyeTrackerDataAt(
+    double time, TimeQueryMode mode,
+    EyeTrackerDataStruct& out_data) const noexcept {
+  return TryReadDataAt(implementation_pointer_, time, mode, &out_data);
+}
+
+bool inseye::EyeTracker::ReadEyeTrackerDataRange(
+    uint64_t begin_time, uint64_t end_time,
+    std::span<EyeTrackerDataStruct> out_data, uint32_t& count) const noexcept {
+  const auto capacity = static_cast<uint32_t>((std::min)(
+      out_data.size(), size_t{(std::numeric_limits<uint32_t>::max)()}));
+  return ReadDataRange(implementation_pointer_, begin_time, end_time,
+                       out_data.data(), capacity, &count);
+}
+
+uint64_t inseye::EyeTracker::GetReadRetryCount() const noexcept {
+  return inseye::c::GetEyeTrackerReadRetryCount(implementation_pointer_);
+}
+
+bool inseye::EyeTracker::GetReaderStatistics(
+    ReaderStatistics& statistics) const noexcept {
+  return inseye::c::GetEyeTrackerReaderStatistics(implementation_pointer_,
+                                                  &statistics);
+}
+
+bool inseye::EyeTracker::GetClockMapping(
+    inseye::ClockMapping& mapping) const noexcept {
+  return ::GetClockMapping(implementation_pointer_, &mapping);
+}
+
+bool inseye::EyeTracker::ConvertEyeTrackerTimeToLocal(
+    uint64_t time,
+    std::chrono::steady_clock::time_point& local) const noexcept {
+  inseye::ClockMapping mapping{};
+  if (!::GetClockMapping(implementation_pointer_, &mapping))
+    return false;
+  local = std::chrono::steady_clock::time_point(
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::nanoseconds(
+              inseye::internal::ConvertToLocal(mapping, time))));
+  return true;
+}
+
+bool inseye::EyeTracker::ConvertEyeTrackerTimesToLocal(
+    std::span<const uint64_t> times,
+    std::span<std::chrono::steady_clock::time_point> local) const noexcept {
+  inseye::ClockMapping mapping{};
+  if (local.size() < times.size() ||
+      !::GetClockMapping(implementation_pointer_, &mapping))
+    return false;
+  // converted in chunks on stack, time point representation is not fixed
+  constexpr size_t chunk_size = 256;
+  int64_t local_ns[chunk_size];
+  for (size_t first = 0; first < times.size(); first += chunk_size) {
+    const size_t count = (std::min)(chunk_size, times.size() - first);
+    inseye::internal::ConvertToLocal(mapping, times.data() + first, local_ns,
+                                     count);
+    for (size_t i = 0; i < count; ++i)
+      local[first + i] = std::chrono::steady_clock::time_point(
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              std::chrono::nanoseconds(local_ns[i])));
+  }
+  return true;
+}
+
+void inseye::EyeTracker::SetFilterChain(std::span<const FilterStage> stages) {
+  if (::SetFilterChain(implementation_pointer_, stages.data(),
+                       static_cast<uint32_t>(stages.size())) !=
+      inseye::c::kSuccess)
+    throw std::runtime_error(inseye::c::GetLastErrorDescription());
+}
+
+bool inseye::EyeTracker::TryReadFilteredEyeTrackerDataBatch(
+    std::span<EyeTrackerDataStruct> raw_data,
+    std::span<EyeTrackerDataStruct> filtered_data, uint32_t& count) noexcept {
+  size_t capacity = filtered_data.size();
+  if (!raw_data.empty())
+    capacity = (std::min)(capacity, raw_data.size());
+  capacity =
+      (std::min)(capacity, size_t{(std::numeric_limits<uint32_t>::max)()});
+  return TryReadFilteredDataSampleBatchInternal(
+      *implementation_pointer_, raw_data.empty() ? nullptr : raw_data.data(),
+      filtered_data.data(), static_cast<uint32_t>(capacity), count);
+}
+
+void inseye::EyeTracker::StartGazeClassification(
+    const GazeClassifierOptions& options) {
+  if (::StartGazeClassification(implementation_pointer_, &options) !=
+      inseye::c::kSuccess)
+    throw std::runtime_error(inseye::c::GetLastErrorDescription());
+}
+
+void inseye::EyeTracker::StopGazeClassification() noexcept {
+  ::StopGazeClassification(implementation_pointer_);
+}
+
+void inseye::EyeTracker::EnableReconnect(const ReconnectOptions& options) {
+  if (inseye::c::EnableEyeTrackerReconnect(implementation_pointer_,
+                                           &options) != inseye::c::kSuccess)
+    throw std::runtime_error(inseye::c::GetLastErrorDescription());
+}
+
+void inseye::EyeTracker::DisableReconnect() noexcept {
+  inseye::c::DisableEyeTrackerReconnect(implementation_pointer_);
+}
+
+bool inseye::EyeTracker::TryReadGazeSegments(std::span<GazeSegment> segments,
+                                             uint32_t& count) noexcept {
+  const auto capacity = static_cast<uint32_t>((std::min)(
+      segments.size(), size_t{(std::numeric_limits<uint32_t>::max)()}));
+  return TryReadGazeSegmentsInternal(*implementation_pointer_,
+                                     segments.data(), capacity, count);
+}
+
+bool inseye::EyeTracker::PredictGaze(double target_time,
+                                     GazePrediction& prediction) noexcept {
+  return PredictGazeAt(implementation_pointer_, target_time, &prediction);
+}
+
+bool inseye::EyeTracker::PredictGaze(
+    std::chrono::steady_clock::time_point target_time,
+    GazePrediction& prediction) noexcept {
+  inseye::ClockMapping mapping{};
+  if (!::GetClockMapping(implementation_pointer_, &mapping))
+    return false;
+  return PredictGazeAt(
+      implementation_pointer_,
+      inseye::internal::ConvertToService(
+          mapping, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       target_time.time_since_epoch())
+                       .count()),
+      &prediction);
+}
+
+inseye::EyeTrackerCursor::EyeTrackerCursor(EyeTrackerCursor&& other) noexcept
+    : implementation_pointer_(other.implementation_pointer_) {
+  other.implementation_pointer_ = nullptr;
+}
+
+inseye::EyeTrackerCursor::~EyeTrackerCursor() noexcept {
+  inseye::c::DestroyEyeTrackerCursor(&implementation_pointer_);
+}
+
+bool inseye::EyeTrackerCursor::IsGazeDataAvailable() const noexcept {
+  return IsDataAvailable(implementation_pointer_);
+}
+
+bool inseye::EyeTrackerCursor::TryReadLatestEyeTrackerData(
+    EyeTrackerDataStruct& eye_tracker_data_struct) noexcept {
+  return TryReadLatestDataSampleInternal(*implementation_pointer_,
+                                         eye_tracker_data_struct);
+}
+
+bool inseye::EyeTrackerCursor::TryReadNextEyeTrackerData(
+    EyeTrackerDataStruct& eye_tracker_data_struct) noexcept {
+  return TryReadNextDataSampleInternal(*implementation_pointer_,
+                                       eye_tracker_data_struct);
+}
+
+bool inseye::EyeTrackerCursor::TryReadEyeTrackerDataBatch(
+    std::span<EyeTrackerDataStruct> out_data, uint32_t& count) noexcept {
+  const auto capacity = static_cast<uint32_t>((std::min)(
+      out_data.size(), size_t{(std::numeric_limits<uint32_t>::max)()}));
+  return TryReadDataSampleBatchInternal(*implementation_pointer_,
+                                        out_data.data(), capacity, count);
+}
+
+bool inseye::EyeTrackerCursor::AcquireReadLease(uint32_t max_count,
+                                                Lease& lease) noexcept {
+  return AcquireReadLeaseInternal(*implementation_pointer_, max_count, lease);
+}
+
+bool inseye::EyeTrackerCursor::ReleaseReadLease(
+    const Lease& lease, uint32_t* overwritten_count) noexcept {
+  return ::ReleaseReadLease(implementation_pointer_, &lease,
+                            overwritten_count);
+}
+
+bool inseye::EyeTrackerCursor::ReadEyeTrackerDataColumns(
+    const EyeTrackerDataColumns& columns, uint32_t capacity,
+    uint32_t& count) noexcept {
+  return ReadDataColumns(implementation_pointer_, &columns, capacity, &count);
+}
+
+bool inseye::EyeTrackerCursor::WaitForEyeTrackerData(
+    std::chrono::nanoseconds timeout) noexcept {
+  return WaitForDataInternal(*implementation_pointer_, timeout);
+}
+
+bool inseye::EyeTrackerCursor::TryReadLastEyeTrackerData(
+    EyeTrackerDataStruct& out_data) const noexcept {
+  return TryReadLastData(implementation_pointer_, &out_data);
+}
+
+bool inseye::EyeTrackerCursor::TryReadEyeTrackerDataAt(
+    double time, TimeQueryMode mode,
+    EyeTrackerDataStruct& out_data) const noexcept {
+  return TryReadDataAt(implementation_pointer_, time, mode, &out_data);
+}
+
+bool inseye::EyeTrackerCursor::ReadEyeTrackerDataRange(
+    uint64_t begin_time, uint64_t end_time,
+    std::span<EyeTrackerDataStruct> out_data, uint32_t& count) const noexcept {
+  const auto capacity = static_cast<uint32_t>((std::min)(
+      out_data.size(), size_t{(std::numeric_limits<uint32_t>::max)()}));
+  return ReadDataRange(implementation_pointer_, begin_time, end_time,
+                       out_data.data(), capacity, &count);
+}
+
+void inseye::EyeTrackerCursor::SetFilterChain(std::span<const FilterStage> stages) {
+  if (::SetFilterChain(implementation_pointer_, stages.data(),
+                       static_cast<uint32_t>(stages.size())) !=
+      inseye::c::kSuccess)
+    throw std::runtime_error(inseye::c::GetLastErrorDescription());
+}
+
+bool inseye::EyeTrackerCursor::TryReadFilteredEyeTrackerDataBatch(
+    std::span<EyeTrackerDataStruct> raw_data,
+    std::span<EyeTrackerDataStruct> filtered_data, uint32_t& count) noexcept {
+  size_t capacity = filtered_data.size();
+  if (!raw_data.empty())
+    capacity = (std::min)(capacity, raw_data.size());
+  capacity =
+      (std::min)(capacity, size_t{(std::numeric_limits<uint32_t>::max)()});
+  return TryReadFilteredDataBatch(
+      implementation_pointer_, raw_data.empty() ? nullptr : raw_data.data(),
+      filtered_data.data(), static_cast<uint32_t>(capacity), &count);
+}
+
+void inseye::EyeTrackerCursor::StartGazeClassification(
+    const GazeClassifierOptions& options) {
+  if (::StartGazeClassification(implementation_pointer_, &options) !=
+      inseye::c::kSuccess)
+    throw std::runtime_error(inseye::c::GetLastErrorDescription());
+}
+
+void inseye::EyeTrackerCursor::StopGazeClassification() noexcept {
+  ::StopGazeClassification(implementation_pointer_);
+}
+
+bool inseye::EyeTrackerCursor::TryReadGazeSegments(
+    std::span<GazeSegment> segments, uint32_t& count) noexcept {
+  const auto capacity = static_cast<uint32_t>((std::min)(
+      segments.size(), size_t{(std::numeric_limits<uint32_t>::max)()}));
+  return ::TryReadGazeSegments(implementation_pointer_, segments.data(),
+                               capacity, &count);
+}
+
+bool inseye::EyeTrackerCursor::PredictGaze(
+    double target_time, GazePrediction& prediction) noexcept {
+  return PredictGazeAt(implementation_pointer_, target_time, &prediction);
+}
+
+bool inseye::EyeTrackerCursor::GetReaderStatistics(
+    ReaderStatistics& statistics) const noexcept {
+  return GetStatistics(implementation_pointer_, &statistics);
+}
+
 bool inseye::Version::operator==(const inseye::Version& other) const {
   return !(*this != other);
 }
@@ -247,81 +1519,447 @@ bool inseye::Version::operator<=(const inseye::Version& other) const {
 
 inseye::c::InseyeInitializationStatus inseye::c::CreateEyeTrackerReader(
     inseye::c::InseyeEyeTracker** pptr, uint32_t timeout_ms) {
+  return inseye::internal::CreateEyeTrackerReader(
+      pptr, [start_time = std::chrono::system_clock::now(), timeout_ms]() {
+        if (duration_cast<std::chrono::milliseconds>(
+                (std::chrono::system_clock::now() - start_time)) >
+            std::chrono::milliseconds(timeout_ms)) {
+          return true;
+        }
+        return false;
+      });
+}
+
+inseye::c::InseyeInitializationStatus inseye::internal::CreateEyeTrackerReader(
+    inseye::c::InseyeEyeTracker** pptr,
+    const std::function<bool()>& is_cancellation_requested) {
   try {
-    CreateEyeTrackerReaderInternal(
-        pptr, [start_time = std::chrono::system_clock::now(), timeout_ms]() {
-          if (duration_cast<std::chrono::milliseconds>(
-                  (std::chrono::system_clock::now() - start_time)) >
-              std::chrono::milliseconds(timeout_ms)) {
-            return true;
-          }
-          return false;
-        });
+    CreateEyeTrackerReaderInternal(pptr, is_cancellation_requested);
     return inseye::c::InseyeInitializationStatus::kSuccess;
   } catch (const InitializationException& initializationException) {
     return initializationException.status;
   } catch (const inseye::internal::NamedPipeException& named_pipe_exception) {
     WriteErrorMessage(named_pipe_exception.error_message);
     return inseye::c::kInsFailedToInitializeNamedPipe;
+  } catch (const std::bad_alloc&) {
+    WriteErrorMessage("Failed to allocate eye tracker reader.");
+    return inseye::c::kFailure;
   }
 }
 
+void inseye::internal::DiscardEyeTrackerReader(
+    inseye::c::InseyeEyeTracker** pptr) {
+  if (pptr == nullptr || *pptr == nullptr)
+    return;
+  auto session = std::move((*pptr)->session);
+  inseye::c::DestroyEyeTrackerReader(pptr);
+  inseye::internal::ReleaseServiceSession(std::move(session));
+}
+
+std::shared_ptr<const uint32_t> inseye::internal::GetSamplesWrittenCounter(
+    const inseye::c::InseyeEyeTracker& tracker) {
+  return {tracker.session, tracker.ring.samples_written};
+}
+
+std::shared_ptr<const uint32_t> inseye::internal::GetSamplesWrittenCounter(
+    const inseye::c::InseyeCursor& cursor) {
+  return {cursor.session, cursor.ring.samples_written};
+}
+
+void inseye::c::ReleaseServiceConnectionCache() {
+  inseye::internal::ReleaseCachedServiceSession();
+}
+
 void inseye::c::DestroyEyeTrackerReader(inseye::c::InseyeEyeTracker** pptr) {
   if (pptr == nullptr)
     return;
   if (*pptr == nullptr)
     return;
-  delete *pptr;
+  inseye::internal::CancelGazeDataWaiters(*pptr);
+  // supervisor keeps running for cursors and stops with the last of them
+  if ((*pptr)->reconnect != nullptr)
+    (*pptr)->reconnect->Unregister((*pptr)->reconnect_hazard);
+  inseye::internal::Delete(*pptr);
   *pptr = nullptr;
 }
 
 bool inseye::c::IsGazeDataAvailable(
     struct inseye::c::InseyeEyeTracker* pointer) {
-  if (pointer == nullptr)
-    return false;
-  auto samples_written_count = pointer->shared_memory_header->ReadSamplesWrittenCount();
-  if (samples_written_count == UNWRITTEN_SAMPLE_INDEX)
-    return false;  // service has not written any data to shared memory
-  return pointer->shared_memory_header->ReadSamplesWrittenCount() >
-         pointer->lastSampleIndex;
+  return IsDataAvailable(pointer);
 }
 
 bool inseye::c::TryReadNextEyeTrackerData(
     inseye::c::InseyeEyeTracker* pImpl,
     inseye::c::InseyeEyeTrackerDataStruct* pDataStruct) {
-  if (pImpl == nullptr || pDataStruct == nullptr)
-    return false;
-  return TryReadNextDataSampleInternal(*pImpl, *pDataStruct, 0);
+  return TryReadNextData(pImpl, pDataStruct);
 }
 
 bool inseye::c::TryReadLatestEyeTrackerData(
     inseye::c::InseyeEyeTracker* implementation,
     inseye::c::InseyeEyeTrackerDataStruct* data_struct) {
-  if (implementation == nullptr || data_struct == nullptr)
-    return false;
-  auto latest_written =
-      implementation->shared_memory_header->ReadSamplesWrittenCount();
-  implementation->lastSampleIndex =
-      (std::max)(implementation->lastSampleIndex, latest_written - 1);
-  return TryReadNextDataSampleInternal(*implementation, *data_struct, 0);
+  return TryReadLatestData(implementation, data_struct);
+}
+
+bool inseye::c::TryReadEyeTrackerDataBatch(
+    struct inseye::c::InseyeEyeTracker* implementation,
+    struct inseye::c::InseyeEyeTrackerDataStruct* data_structs,
+    uint32_t capacity, uint32_t* count) {
+  return TryReadDataBatch(implementation, data_structs, capacity, count);
+}
+
+bool inseye::c::AcquireEyeTrackerReadLease(
+    struct inseye::c::InseyeEyeTracker* implementation, uint32_t max_count,
+    struct inseye::c::InseyeLease* lease) {
+  return AcquireReadLease(implementation, max_count, lease);
+}
+
+bool inseye::c::ReleaseEyeTrackerReadLease(
+    struct inseye::c::InseyeEyeTracker* implementation,
+    const struct inseye::c::InseyeLease* lease, uint32_t* overwritten_count) {
+  return ReleaseReadLease(implementation, lease, overwritten_count);
+}
+
+bool inseye::c::ReadEyeTrackerDataColumns(
+    struct inseye::c::InseyeEyeTracker* implementation,
+    const struct inseye::c::InseyeEyeTrackerDataColumns* columns,
+    uint32_t capacity, uint32_t* count) {
+  return ReadDataColumns(implementation, columns, capacity, count);
+}
+
+bool inseye::c::WaitForEyeTrackerData(
+    struct inseye::c::InseyeEyeTracker* implementation, uint64_t timeout_ns) {
+  return WaitForData(implementation, timeout_ns);
 }
 
 bool inseye::c::TryReadLastEyeTrackerData(
     struct inseye::c::InseyeEyeTracker* implementation,
     struct inseye::c::InseyeEyeTrackerDataStruct* data_struct) {
-  if (implementation == nullptr || data_struct == nullptr)
-    return false;
-  auto header = implementation->shared_memory_header.get();
-  auto latest_written = header->ReadSamplesWrittenCount();
-  auto latest_read = implementation->lastSampleIndex;
-  auto samples = header->GetSampleCount();
-  if ((latest_written - latest_read) > samples)
-    return false;
-  ReadDataSampleInternal(*implementation, *data_struct);
-  latest_written = header->ReadSamplesWrittenCount();
-  if ((latest_written - latest_read) > samples)
-    return false; // check if what we read was not overwritten
+  return TryReadLastData(implementation, data_struct);
+}
+
+bool inseye::c::TryReadEyeTrackerDataAt(
+    struct inseye::c::InseyeEyeTracker* implementation, double time,
+    inseye::c::InseyeTimeQueryMode mode,
+    struct inseye::c::InseyeEyeTrackerDataStruct* data_struct) {
+  return TryReadDataAt(implementation, time, mode, data_struct);
+}
+
+bool inseye::c::ReadEyeTrackerDataRange(
+    struct inseye::c::InseyeEyeTracker* implementation, uint64_t begin_time,
+    uint64_t end_time, struct inseye::c::InseyeEyeTrackerDataStruct* data_structs,
+    uint32_t capacity, uint32_t* count) {
+  return ReadDataRange(implementation, begin_time, end_time, data_structs,
+                       capacity, count);
+}
+
+uint64_t inseye::c::GetEyeTrackerReadRetryCount(
+    struct inseye::c::InseyeEyeTracker* implementation) {
+  if (implementation == nullptr)
+    return 0;
+  return implementation->read_retry_count.load(std::memory_order_relaxed);
+}
+
+bool inseye::c::GetEyeTrackerReaderStatistics(
+    struct inseye::c::InseyeEyeTracker* implementation,
+    struct inseye::c::InseyeReaderStatistics* statistics) {
+  return GetStatistics(implementation, statistics);
+}
+
+bool inseye::c::GetEyeTrackerClockMapping(
+    struct inseye::c::InseyeEyeTracker* implementation,
+    struct inseye::c::InseyeClockMapping* mapping) {
+  return GetClockMapping(implementation, mapping);
+}
+
+bool inseye::c::ConvertEyeTrackerTimeToLocal(
+    struct inseye::c::InseyeEyeTracker* implementation, uint64_t time,
+    int64_t* local_ns) {
+  inseye::c::InseyeClockMapping mapping{};
+  if (local_ns == nullptr || !GetClockMapping(implementation, &mapping))
+    return false;
+  *local_ns = inseye::internal::ConvertToLocal(mapping, time);
+  return true;
+}
+
+bool inseye::c::ConvertEyeTrackerTimesToLocal(
+    struct inseye::c::InseyeEyeTracker* implementation, const uint64_t* times,
+    int64_t* local_ns, uint32_t count) {
+  inseye::c::InseyeClockMapping mapping{};
+  if (times == nullptr || local_ns == nullptr ||
+      !GetClockMapping(implementation, &mapping))
+    return false;
+  inseye::internal::ConvertToLocal(mapping, times, local_ns, count);
+  return true;
+}
+
+inseye::c::InseyeInitializationStatus inseye::c::SetEyeTrackerFilterChain(
+    struct inseye::c::InseyeEyeTracker* implementation,
+    const struct inseye::c::InseyeFilterStage* stages, uint32_t stage_count) {
+  return SetFilterChain(implementation, stages, stage_count);
+}
+
+bool inseye::c::TryReadFilteredEyeTrackerDataBatch(
+    struct inseye::c::InseyeEyeTracker* implementation,
+    struct inseye::c::InseyeEyeTrackerDataStruct* raw_data,
+    struct inseye::c::InseyeEyeTrackerDataStruct* filtered_data,
+    uint32_t capacity, uint32_t* count) {
+  return TryReadFilteredDataBatch(implementation, raw_data, filtered_data,
+                                  capacity, count);
+}
+
+inseye::c::InseyeInitializationStatus
+inseye::c::StartEyeTrackerGazeClassification(
+    struct inseye::c::InseyeEyeTracker* implementation,
+    const struct inseye::c::InseyeGazeClassifierOptions* options) {
+  return StartGazeClassification(implementation, options);
+}
+
+void inseye::c::StopEyeTrackerGazeClassification(
+    struct inseye::c::InseyeEyeTracker* implementation) {
+  StopGazeClassification(implementation);
+}
+
+inseye::c::InseyeInitializationStatus inseye::c::EnableEyeTrackerReconnect(
+    struct inseye::c::InseyeEyeTracker* implementation,
+    const struct inseye::c::InseyeReconnectOptions* options) {
+  if (implementation == nullptr) {
+    WriteErrorMessage("Eye tracker reader must not be null.");
+    return inseye::c::kFailure;
+  }
+  if (implementation->reconnect != nullptr) {
+    WriteErrorMessage("Reconnect is already enabled.");
+    return inseye::c::kFailure;
+  }
+  const inseye::c::InseyeReconnectOptions resolved =
+      options != nullptr ? *options : inseye::c::InseyeReconnectOptions{};
+  std::shared_ptr<inseye::internal::ReconnectSupervisor> supervisor;
+  try {
+    supervisor = inseye::internal::MakeShared<
+        inseye::internal::ReconnectSupervisor>(
+        implementation->session, resolved);
+    supervisor->Register(implementation->reconnect_hazard);
+  } catch (const std::exception&) {
+    WriteErrorMessage("Failed to start reconnect supervisor.");
+    return inseye::c::kFailure;
+  }
+  implementation->reconnect_generation =
+      supervisor->Protect(implementation->reconnect_hazard);
+  implementation->reconnect = std::move(supervisor);
+  return inseye::c::kSuccess;
+}
+
+void inseye::c::DisableEyeTrackerReconnect(
+    struct inseye::c::InseyeEyeTracker* implementation) {
+  if (implementation == nullptr || implementation->reconnect == nullptr)
+    return;
+  // cursors keep the supervisor, but it no longer publishes generations
+  implementation->reconnect->Stop();
+  implementation->reconnect->Unregister(implementation->reconnect_hazard);
+  implementation->reconnect.reset();
+  implementation->reconnect_generation = nullptr;
+  implementation->reconnect_hazard.store(nullptr, std::memory_order_relaxed);
+}
+
+bool inseye::c::TryReadGazeSegments(
+    struct inseye::c::InseyeEyeTracker* implementation,
+    struct inseye::c::InseyeGazeSegment* segments, uint32_t capacity,
+    uint32_t* count) {
+  return ::TryReadGazeSegments(implementation, segments, capacity, count);
+}
+
+bool inseye::c::PredictGaze(
+    struct inseye::c::InseyeEyeTracker* implementation, double target_time,
+    struct inseye::c::InseyeGazePrediction* prediction) {
+  return PredictGazeAt(implementation, target_time, prediction);
+}
+
+inseye::c::InseyeInitializationStatus inseye::c::CreateEyeTrackerCursor(
+    struct inseye::c::InseyeEyeTracker* tracker,
+    struct inseye::c::InseyeCursor** pointer_address) {
+  if (tracker == nullptr || pointer_address == nullptr) {
+    WriteErrorMessage("Eye tracker reader and cursor address must not be null.");
+    return inseye::c::kFailure;
+  }
+  void* memory;
+  try {
+    memory = inseye::internal::Allocate(sizeof(inseye::c::InseyeCursor),
+                                        alignof(inseye::c::InseyeCursor));
+  } catch (const std::bad_alloc&) {
+    WriteErrorMessage("Failed to allocate cursor.");
+    return inseye::c::kFailure;
+  }
+  auto* cursor = ::new (memory) inseye::c::InseyeCursor{
+      {.ring = tracker->ring,
+       .lastSampleIndex = tracker->lastSampleIndex,
+       .writer_rings_doorbell = tracker->writer_rings_doorbell,
+       .discontinuity = tracker->discontinuity,
+       .clock_model = tracker->clock_model,
+       .reconnect = tracker->reconnect,
+       .reconnect_generation = tracker->reconnect_generation,
+       .session = tracker->session,
+       .reconnect_hazard{tracker->reconnect_generation}}};
+  if (cursor->reconnect != nullptr) {
+    // generation is kept alive by reader's hazard until cursor's is added
+    try {
+      cursor->reconnect->Register(cursor->reconnect_hazard);
+    } catch (const std::bad_alloc&) {
+      inseye::internal::Delete(cursor);
+      WriteErrorMessage("Failed to register cursor for reconnect.");
+      return inseye::c::kFailure;
+    }
+  }
+  *pointer_address = cursor;
+  return inseye::c::kSuccess;
+}
+
+void inseye::c::DestroyEyeTrackerCursor(
+    struct inseye::c::InseyeCursor** pointer_address) {
+  if (pointer_address == nullptr)
+    return;
+  if (*pointer_address == nullptr)
+    return;
+  inseye::internal::CancelGazeDataWaiters(*pointer_address);
+  if ((*pointer_address)->reconnect != nullptr)
+    (*pointer_address)->reconnect->Unregister(
+        (*pointer_address)->reconnect_hazard);
+  inseye::internal::Delete(*pointer_address);
+  *pointer_address = nullptr;
+}
+
+bool inseye::c::IsCursorGazeDataAvailable(
+    struct inseye::c::InseyeCursor* cursor) {
+  return IsDataAvailable(cursor);
+}
+
+bool inseye::c::TryReadNextCursorData(
+    struct inseye::c::InseyeCursor* cursor,
+    struct inseye::c::InseyeEyeTrackerDataStruct* data_struct) {
+  return TryReadNextData(cursor, data_struct);
+}
+
+bool inseye::c::TryReadLatestCursorData(
+    struct inseye::c::InseyeCursor* cursor,
+    struct inseye::c::InseyeEyeTrackerDataStruct* data_struct) {
+  return TryReadLatestData(cursor, data_struct);
+}
+
+bool inseye::internal::TryReadCursorDataBatch(
+    inseye::c::InseyeCursor& cursor,
+    inseye::c::InseyeEyeTrackerDataStruct* data_structs, uint32_t capacity,
+    uint32_t& count, uint32_t& dropped) {
+  FollowReconnect(cursor);
+  const uint32_t previous_sample_index = cursor.lastSampleIndex;
+  dropped = 0;
+  if (!TryReadDataSampleBatchInternal(cursor, data_structs, capacity, count))
+    return false;
+  // the cursor moved over returned samples and the ones lost to overrun
+  if (previous_sample_index != UNREAD_SAMPLE_INDEX)
+    dropped = cursor.lastSampleIndex - previous_sample_index - count;
   return true;
 }
 
+bool inseye::c::TryReadCursorDataBatch(
+    struct inseye::c::InseyeCursor* cursor,
+    struct inseye::c::InseyeEyeTrackerDataStruct* data_structs,
+    uint32_t capacity, uint32_t* count) {
+  return TryReadDataBatch(cursor, data_structs, capacity, count);
+}
+
+bool inseye::c::AcquireCursorReadLease(struct inseye::c::InseyeCursor* cursor,
+                                       uint32_t max_count,
+                                       struct inseye::c::InseyeLease* lease) {
+  return AcquireReadLease(cursor, max_count, lease);
+}
+
+bool inseye::c::ReleaseCursorReadLease(
+    struct inseye::c::InseyeCursor* cursor,
+    const struct inseye::c::InseyeLease* lease, uint32_t* overwritten_count) {
+  return ReleaseReadLease(cursor, lease, overwritten_count);
+}
+
+bool inseye::c::ReadCursorDataColumns(
+    struct inseye::c::InseyeCursor* cursor,
+    const struct inseye::c::InseyeEyeTrackerDataColumns* columns,
+    uint32_t capacity, uint32_t* count) {
+  return ReadDataColumns(cursor, columns, capacity, count);
+}
+
+bool inseye::c::WaitForCursorData(struct inseye::c::InseyeCursor* cursor,
+                                  uint64_t timeout_ns) {
+  return WaitForData(cursor, timeout_ns);
+}
+
+bool inseye::c::TryReadLastCursorData(
+    struct inseye::c::InseyeCursor* cursor,
+    struct inseye::c::InseyeEyeTrackerDataStruct* data_struct) {
+  return TryReadLastData(cursor, data_struct);
+}
+
+bool inseye::c::TryReadCursorDataAt(
+    struct inseye::c::InseyeCursor* cursor, double time,
+    inseye::c::InseyeTimeQueryMode mode,
+    struct inseye::c::InseyeEyeTrackerDataStruct* data_struct) {
+  return TryReadDataAt(cursor, time, mode, data_struct);
+}
+
+bool inseye::c::ReadCursorDataRange(
+    struct inseye::c::InseyeCursor* cursor, uint64_t begin_time,
+    uint64_t end_time, struct inseye::c::InseyeEyeTrackerDataStruct* data_structs,
+    uint32_t capacity, uint32_t* count) {
+  return ReadDataRange(cursor, begin_time, end_time, data_structs, capacity,
+                       count);
+}
+
+inseye::c::InseyeInitializationStatus inseye::c::SetCursorFilterChain(
+    struct inseye::c::InseyeCursor* cursor,
+    const struct inseye::c::InseyeFilterStage* stages, uint32_t stage_count) {
+  return SetFilterChain(cursor, stages, stage_count);
+}
+
+bool inseye::c::TryReadFilteredCursorDataBatch(
+    struct inseye::c::InseyeCursor* cursor,
+    struct inseye::c::InseyeEyeTrackerDataStruct* raw_data,
+    struct inseye::c::InseyeEyeTrackerDataStruct* filtered_data,
+    uint32_t capacity, uint32_t* count) {
+  return TryReadFilteredDataBatch(cursor, raw_data, filtered_data, capacity,
+                                  count);
+}
+
+inseye::c::InseyeInitializationStatus inseye::c::StartCursorGazeClassification(
+    struct inseye::c::InseyeCursor* cursor,
+    const struct inseye::c::InseyeGazeClassifierOptions* options) {
+  return StartGazeClassification(cursor, options);
+}
+
+void inseye::c::StopCursorGazeClassification(
+    struct inseye::c::InseyeCursor* cursor) {
+  StopGazeClassification(cursor);
+}
+
+bool inseye::c::TryReadCursorGazeSegments(
+    struct inseye::c::InseyeCursor* cursor,
+    struct inseye::c::InseyeGazeSegment* segments, uint32_t capacity,
+    uint32_t* count) {
+  return ::TryReadGazeSegments(cursor, segments, capacity, count);
+}
+
+bool inseye::c::PredictCursorGaze(
+    struct inseye::c::InseyeCursor* cursor, double target_time,
+    struct inseye::c::InseyeGazePrediction* prediction) {
+  return PredictGazeAt(cursor, target_time, prediction);
+}
+
+bool inseye::c::GetCursorReaderStatistics(
+    struct inseye::c::InseyeCursor* cursor,
+    struct inseye::c::InseyeReaderStatistics* statistics) {
+  return GetStatistics(cursor, statistics);
+}
+
+uint32_t inseye::c::GetSampleLagHistogramBucketLowerBound(
+    uint32_t bucket_index) {
+  if (bucket_index >= inseye::internal::kLagHistogramBucketCount)
+    return (std::numeric_limits<uint32_t>::max)();
+  return inseye::internal::LagHistogramBucketLowerBound(bucket_index);
+}
+
 }  // namespace inseye
\ No newline at end of file
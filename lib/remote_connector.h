@@ -32,23 +32,32 @@
 #if !defined(CALL_CONV)
 #if defined(WIN32) || defined(WIN64)
 #define CALL_CONV __cdecl
-#else
+#elif defined(__i386__)
 #define CALL_CONV __attribute__((__cdecl__))
+#else
+#define CALL_CONV /* NOTHING, single calling convention on the platform */
 #endif  // defined(WIN32) || defined(WIN64)
 #endif  // !defined(CALL_CONV)
 
 // C only header part
 #ifdef __cplusplus
 #include <string>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <coroutine>
 #include <iostream>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
 namespace inseye::c {
   extern "C" {
 #endif
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
   enum InseyeInitializationStatus {
@@ -62,7 +71,8 @@ namespace inseye::c {
     kServiceVersionToHigh,
     kCancelled,
     kTimeout,
-    kFailure
+    kFailure,
+    kInsFailedToAccessRecordingFile
   };
 
   enum InseyeGazeEvent { //: uint32_t
@@ -97,7 +107,15 @@ namespace inseye::c {
     /**
    * Unknown event that was introduced in later version of service
    */
-    kUnknown = kInsGazeHeadsetDismount << 1
+    kUnknown = kInsGazeHeadsetDismount << 1,
+    /**
+   * Set by the library, never by the service, on the first sample read after
+   * reader switched to restarted service (see EnableEyeTrackerReconnect),
+   * combined with the event of the sample. Samples before and after it come
+   * from different service sessions, so filters and time deltas should not
+   * span it.
+   */
+    kInsGazeDiscontinuity = 1 << 30
   };
   struct InseyeEyeTracker;
 
@@ -108,6 +126,10 @@ namespace inseye::c {
   };
 
   extern const LIB_EXPORT struct InseyeVersion kLowestSupportedServiceVersion;
+  /**
+   * @brief Services with the same major version and any minor or patch version
+   * are supported as well.
+   */
   extern const LIB_EXPORT struct InseyeVersion kHighestSupportedServiceVersion;
 
   struct InseyeEyeTrackerDataStruct {
@@ -162,14 +184,477 @@ namespace inseye::c {
     enum InseyeGazeEvent gaze_event;
   };
 
+  /**
+   * @brief Caller owned destination arrays for samples decoded as columns
+   * (structure of arrays). Every array must hold at least as many elements as
+   * capacity passed to ReadEyeTrackerDataColumns, n-th sample is stored at
+   * n-th position of every array. Field meaning is the same as in
+   * InseyeEyeTrackerDataStruct.
+   */
+  struct InseyeEyeTrackerDataColumns {
+    uint64_t* time;
+    float* left_eye_x;
+    float* left_eye_y;
+    float* right_eye_x;
+    float* right_eye_y;
+    enum InseyeGazeEvent* gaze_event;
+  };
+
+  /**
+   * @brief Contiguous part of the service ring buffer.
+   */
+  struct InseyeLeaseSpan {
+    const void* data;
+    uint32_t count;
+  };
+
+  /**
+   * @brief Samples lent straight from the service ring buffer by
+   * AcquireEyeTrackerReadLease.
+   * Every sample takes sample_size bytes and starts with packed
+   * InseyeEyeTrackerDataStruct fields (28 bytes, no padding) stored in little
+   * endian, gaze event may hold flags unknown to this library.
+   */
+  struct InseyeLease {
+    /**
+     * @brief Leased samples, oldest first. The second span is not empty only
+     * when the lease wraps around the end of the ring.
+     */
+    struct InseyeLeaseSpan spans[2];
+    /**
+     * @brief Number of samples in both spans.
+     */
+    uint32_t count;
+    /**
+     * @brief Distance between samples in bytes.
+     */
+    uint32_t sample_size;
+    /**
+     * @brief Index of the first leased sample, checked on release.
+     */
+    uint32_t first_sample_index;
+    /**
+     * @brief kInsGazeDiscontinuity when the first leased sample is the first
+     * one after reconnect, otherwise 0.
+     */
+    uint32_t flags;
+  };
+
   struct InseyeEyeTracker;
 
+  struct InseyeCursor;
+
+  enum {
+    /**
+     * Number of buckets in InseyeReaderStatistics::sample_lag_histogram
+     */
+    kInsSampleLagHistogramBucketCount = 240
+  };
+
+  enum InseyeTimeQueryMode {
+    /**
+     * Sample with time closest to queried time
+     */
+    kInsTimeQueryNearest = 0,
+    /**
+     * Eye positions linearly interpolated between samples around queried
+     * time
+     */
+    kInsTimeQueryInterpolate = 1
+  };
+
+  /**
+   * @brief Counters of single reader collected since its creation.
+   */
+  struct InseyeReaderStatistics {
+    /**
+     * @brief Samples returned by TryReadNextEyeTrackerData,
+     * TryReadLatestEyeTrackerData, TryReadEyeTrackerDataBatch and
+     * ReadEyeTrackerDataColumns.
+     */
+    uint64_t samples_delivered;
+    /**
+     * @brief Samples that were skipped because service overwrote them before
+     * they were read.
+     */
+    uint64_t samples_dropped;
+    /**
+     * @brief Number of reads that found that service lapped the reader.
+     */
+    uint64_t overrun_count;
+    /**
+     * @brief Reads repeated because sample was overwritten by the service while
+     * it was being copied, the same value as GetEyeTrackerReadRetryCount.
+     */
+    uint64_t read_retries;
+    /**
+     * @brief Reads that failed because sample was overwritten during every
+     * retry.
+     */
+    uint64_t retry_limit_failures;
+    /**
+     * @brief Histogram of sample lag, one entry per successful read. Lag is the
+     * number of samples service published after the oldest sample returned by
+     * the read, multiplied by sample period it gives sample age at read time.
+     * Bucket i counts lags from GetSampleLagHistogramBucketLowerBound(i) up to
+     * lower bound of bucket i + 1, buckets are exact below 16 and at most 1/8
+     * of their lower bound wide above.
+     */
+    uint64_t sample_lag_histogram[kInsSampleLagHistogramBucketCount];
+  };
+
+  /**
+   * @brief Linear mapping from service sample time to local steady clock
+   * (std::chrono::steady_clock, CLOCK_MONOTONIC on Linux):
+   * local_ns = fma((double)(int64_t)(time - reference_time), local_ns_per_ms,
+   *                reference_local_ns)
+   */
+  struct InseyeClockMapping {
+    /**
+     * @brief Service time in milliseconds since Unix Epoch the mapping is
+     * anchored at.
+     */
+    uint64_t reference_time;
+    /**
+     * @brief Steady clock time in nanoseconds at reference_time.
+     */
+    double reference_local_ns;
+    /**
+     * @brief Local nanoseconds per service millisecond, 1e6 corrected by
+     * estimated drift between the clocks.
+     */
+    double local_ns_per_ms;
+    /**
+     * @brief Arrival observations the mapping was estimated from.
+     */
+    uint64_t observation_count;
+  };
+
+  /**
+   * @brief Gaze extrapolated to requested time by PredictGaze.
+   */
+  struct InseyeGazePrediction {
+    /**
+     * @brief Time of the newest sample the prediction is based on,
+     * milliseconds since Unix Epoch.
+     */
+    uint64_t sample_time;
+    float left_eye_x;
+    float left_eye_y;
+    float right_eye_x;
+    float right_eye_y;
+    /**
+     * @brief Average of both eyes, 0 - 1. Eye confidence is measurement noise
+     * variance over variance of the predicted position, it drops with
+     * prediction horizon and is low right after saccade and zero for eye
+     * that is closed.
+     */
+    float confidence;
+    /**
+     * @brief Gaze event of the newest sample.
+     */
+    enum InseyeGazeEvent gaze_event;
+  };
+
+  enum InseyeFilterType {
+    /**
+     * y += alpha * (x - y)
+     */
+    kInsFilterExponentialMovingAverage = 0,
+    /**
+     * One Euro filter (Casiez et al.), low pass whose cutoff rises with speed
+     */
+    kInsFilterOneEuro = 1,
+    /**
+     * Median of the last window samples
+     */
+    kInsFilterMedian = 2,
+    /**
+     * Eye position jumping further than max_jump from the previous output is
+     * replaced by the previous output, until max_rejected consecutive
+     * samples jump, which is then taken as real eye movement
+     */
+    kInsFilterOutlierRejection = 3
+  };
+
+  /**
+   * @brief Stage of filter chain, only fields of its type are used.
+   * Every stage filters the four eye position angles of each sample
+   * independently. Positions of closed eye (kInsGazeBlinkLeft,
+   * kInsGazeBlinkRight, kInsGazeBlinkBoth, kInsGazeHeadsetDismount) keep the
+   * previous output and don't update stage state.
+   */
+  struct InseyeFilterStage {
+    enum InseyeFilterType type;
+    /**
+     * @brief kInsFilterExponentialMovingAverage weight of new sample, (0, 1].
+     */
+    float alpha;
+    /**
+     * @brief kInsFilterOneEuro cutoff frequency at rest in Hz, > 0.
+     */
+    float min_cutoff_hz;
+    /**
+     * @brief kInsFilterOneEuro cutoff increase per radian per second of
+     * speed, >= 0.
+     */
+    float beta;
+    /**
+     * @brief kInsFilterOneEuro cutoff frequency of speed estimate in Hz,
+     * zero selects 1 Hz.
+     */
+    float derivative_cutoff_hz;
+    /**
+     * @brief kInsFilterMedian odd window length, 3 - 15 samples.
+     */
+    uint32_t window;
+    /**
+     * @brief kInsFilterOutlierRejection largest accepted jump of eye
+     * position between samples in radians, > 0.
+     */
+    float max_jump;
+    /**
+     * @brief kInsFilterOutlierRejection consecutive samples that are
+     * rejected at most, >= 1.
+     */
+    uint32_t max_rejected;
+  };
+
+  enum InseyeGazeSegmentType {
+    /**
+     * Gaze stayed within dispersion threshold of its centroid for at least
+     * minimum fixation duration
+     */
+    kInsSegmentFixation = 0,
+    /**
+     * Gaze moved faster than saccade velocity threshold
+     */
+    kInsSegmentSaccade = 1,
+    /**
+     * Both eyes closed or headset dismounted
+     */
+    kInsSegmentBlink = 2,
+    /**
+     * Slow gaze that is too short to be fixation, usually settling after
+     * saccade
+     */
+    kInsSegmentUnclassified = 3
+  };
+
+  enum InseyeGazeSegmentFlags {
+    /**
+     * Segment was cut short by gap in the stream (service stall, classifier
+     * falling behind the ring), its real duration is unknown
+     */
+    kInsSegmentTruncated = 1
+  };
+
+  /**
+   * @brief Consecutive samples of the same kind found by gaze classifier,
+   * positions are cyclopean (average of both eyes, or the open eye while
+   * the other one blinks) angles in radians.
+   */
+  struct InseyeGazeSegment {
+    /**
+     * @brief Time of the first sample, milliseconds since Unix Epoch.
+     */
+    uint64_t start_time;
+    /**
+     * @brief Time from the first sample to the first sample of the next
+     * segment, to the last sample for truncated segment.
+     */
+    uint32_t duration_ms;
+    uint32_t sample_count;
+    enum InseyeGazeSegmentType type;
+    /**
+     * @brief Bitwise or of InseyeGazeSegmentFlags.
+     */
+    uint32_t flags;
+    /**
+     * @brief Fixation centroid, saccade landing position or position the
+     * eyes closed at.
+     */
+    float x;
+    float y;
+    /**
+     * @brief Saccade distance from the position it started at to the
+     * landing, fixation horizontal plus vertical extent, zero for blink.
+     */
+    float amplitude;
+    /**
+     * @brief Highest sample velocity in radians per second. Velocity is
+     * measured across velocity window, so saccades shorter than the window
+     * have lower peak than they really reach.
+     */
+    float peak_velocity;
+  };
+
+  /**
+   * @brief Gaze classifier configuration, zero fields select defaults.
+   */
+  struct InseyeGazeClassifierOptions {
+    /**
+     * @brief Samples faster than this in radians per second are saccade,
+     * zero selects 0.5236 (30 deg/s).
+     */
+    float saccade_velocity_threshold;
+    /**
+     * @brief Fixation ends at sample further than this from its centroid in
+     * radians, zero selects 0.01745 (1 deg).
+     */
+    float fixation_dispersion_threshold;
+    /**
+     * @brief Shorter fixations are reported as kInsSegmentUnclassified,
+     * zero selects 60 ms.
+     */
+    uint32_t min_fixation_duration_ms;
+    /**
+     * @brief Time sample velocity is measured over, centred on the sample,
+     * at most 100 ms, zero selects 20 ms. Segments are found half of the
+     * window after their last sample.
+     */
+    uint32_t velocity_window_ms;
+  };
+
+  /**
+   * @brief Automatic reconnect configuration, zero fields select defaults.
+   */
+  struct InseyeReconnectOptions {
+    /**
+     * @brief Service that doesn't publish new sample for this long is
+     * connected to again, zero selects 1000 ms. Reader keeps its mapping when
+     * the service still serves the same ring.
+     */
+    uint32_t stall_timeout_ms;
+    /**
+     * @brief Interval of connection checks and of reconnect attempts while
+     * the service is gone, zero selects 100 ms.
+     */
+    uint32_t check_interval_ms;
+  };
+
+  /**
+   * @brief Memory functions for objects created by the library (readers,
+   * cursors, service sessions, filter chains, gaze classifiers, reconnect
+   * supervisors, subscriptions, recorders). Called only while such objects
+   * are created and destroyed, never by reads and waits.
+   */
+  struct InseyeAllocator {
+    /**
+     * @brief Returns size bytes aligned to alignment (power of two), NULL
+     * when memory is exhausted.
+     */
+    void* (*allocate)(size_t size, size_t alignment, void* user_data);
+    /**
+     * @brief Frees memory returned by allocate with the same size and
+     * alignment.
+     */
+    void (*deallocate)(void* pointer, size_t size, size_t alignment,
+                       void* user_data);
+    void* user_data;
+  };
+
+  struct InseyeRecorder;
+
+  struct InseyeRecording;
+
+  enum InseyeRecorderState {
+    /**
+     * Recorder thread is draining gaze data to the file
+     */
+    kInsRecorderRunning = 0,
+    /**
+     * Recorder was stopped, file holds complete recording
+     */
+    kInsRecorderStopped = 1,
+    /**
+     * Recorder stopped on error (e.g. disk is full), file holds samples
+     * recorded before the error
+     */
+    kInsRecorderFaulted = 2
+  };
+
+  struct InseyeRecorderOptions {
+    /**
+     * @brief Size of single recording chunk in bytes, must be multiple of
+     * 65536. Zero selects default size of 1 MiB. Recorder keeps only one
+     * chunk mapped in memory.
+     */
+    uint32_t chunk_size;
+  };
+
+  struct InseyeAsyncOperation;
+
+  struct InseyeSubscription;
+
+  /**
+   * @brief Contiguous samples delivered by subscription dispatcher.
+   */
+  struct InseyeGazeDataBatch {
+    /**
+     * @brief Samples in order, valid only during the callback.
+     */
+    const struct InseyeEyeTrackerDataStruct* samples;
+    uint32_t count;
+    /**
+     * @brief Samples lost to overrun right before the first sample of the
+     * batch, non zero value is the overrun notification.
+     */
+    uint32_t dropped_samples;
+  };
+
+  typedef void(CALL_CONV* InseyeGazeDataCallback)(
+      const struct InseyeGazeDataBatch* batch, void* user_data);
+
+  struct InseyeSubscriptionOptions {
+    /**
+     * @brief Maximum number of samples in single batch, zero selects 64.
+     */
+    uint32_t max_batch_size;
+    /**
+     * @brief Maximum time the oldest sample waits for the batch to fill up
+     * in microseconds, zero delivers samples as soon as they are read.
+     */
+    uint32_t max_latency_us;
+    /**
+     * @brief CPUs the dispatcher thread may run on, bit n is CPU n, zero
+     * leaves affinity unchanged.
+     */
+    uint64_t cpu_affinity_mask;
+    /**
+     * @brief Zero keeps normal priority, otherwise dispatcher thread runs
+     * with SCHED_FIFO and this priority on Linux (usually 1 - 99, requires
+     * CAP_SYS_NICE) and with time critical priority on Windows.
+     */
+    int32_t realtime_priority;
+  };
+
   enum InseyeAsyncOperationState {
+    /**
+     * Operation was started, connecting thread hasn't picked it up yet
+     */
     kInsAsyncCreated = 0,
+    /**
+     * Connecting to the service
+     */
     kInsAsyncRunning = 1,
+    /**
+     * Cancellation was requested, connecting thread is going to stop at next
+     * cancellation point
+     */
     kInsAsyncCancelling = 2,
+    /**
+     * Operation was cancelled, it holds no resources
+     */
     kInsAsyncCancelled = 3,
+    /**
+     * Operation failed, status and description are returned by
+     * GetEyeTrackerReaderAsyncResult
+     */
     kInsAsyncFaulted = 4,
+    /**
+     * Reader is ready to be taken with GetEyeTrackerReaderAsyncResult
+     */
     kInsCompleted = 5
   };
   /**
@@ -181,6 +666,10 @@ namespace inseye::c {
   /**
     * @brief Initializes eye tracker reader and writes memory location of
     * SharedMemoryEyeTrackerReader to dereference pointer_address.
+    * Connection to the service and shared memory mapping are cached for the
+    * whole process and shared by all readers, so following calls only check
+    * without talking to the service that its connection is still open and
+    * shared buffer holds the same version, and reconnect when it doesn't.
     * @param pointer_address address of pointer which will hold information about created
     * shared memory tracker reader memory
     * @param timeout_ms maximum time the function can wait until aborts and returns unsuccessfully
@@ -189,6 +678,104 @@ namespace inseye::c {
     */
   LIB_EXPORT enum InseyeInitializationStatus CALL_CONV
   CreateEyeTrackerReader(struct InseyeEyeTracker** pointer_address, uint32_t timeout_ms);
+  /**
+   * @brief Releases cached service connection and shared memory mapping.
+   * Existing readers keep using them, resources are freed with the last of
+   * them and next CreateEyeTrackerReader connects to the service again.
+   */
+  LIB_EXPORT void CALL_CONV ReleaseServiceConnectionCache();
+  /**
+   * @brief Replaces allocator of library objects, see InseyeAllocator.
+   * Strings, threads and exceptions made while objects are created still
+   * use the global heap.
+   * Call it before any other library function (or after every library
+   * object was released) and never while other threads use the library,
+   * memory is always freed with the allocator that is current at the time.
+   * @param allocator NULL restores the default (global operator new), both
+   * functions must be set otherwise
+   * @returns kSuccess, or kFailure when function is missing or objects
+   * allocated with the previous allocator still exist (release them and the
+   * service connection cache first)
+   */
+  LIB_EXPORT enum InseyeInitializationStatus CALL_CONV
+  SetLibraryAllocator(const struct InseyeAllocator* allocator);
+  /**
+   * @brief Starts creation of eye tracker reader on internal connecting
+   * thread and returns immediately.
+   * Operation state is polled with GetAsyncOperationState, awaited with
+   * WaitForAsyncOperation and the reader is taken with
+   * GetEyeTrackerReaderAsyncResult. Timeout ends the operation in
+   * kInsAsyncFaulted state with kTimeout status.
+   * @param pointer_address address of pointer which will hold the operation
+   * @param timeout_ms maximum time of connecting to the service
+   * @returns kSuccess when operation was started, pointer at input address is
+   * only populated then.
+   */
+  LIB_EXPORT enum InseyeInitializationStatus CALL_CONV
+  CreateEyeTrackerReaderAsync(struct InseyeAsyncOperation** pointer_address,
+                              uint32_t timeout_ms);
+  /**
+   * @brief Returns current state of the operation without blocking.
+   */
+  LIB_EXPORT enum InseyeAsyncOperationState CALL_CONV
+  GetAsyncOperationState(struct InseyeAsyncOperation*);
+  /**
+   * @brief Requests cancellation. Connecting thread stops at next cancellation
+   * point (between connection attempts and handshake steps), reader created
+   * in the meantime is destroyed together with its connection and mapping
+   * unless other readers share them.
+   * @return true when operation hasn't finished yet, it then always ends in
+   * kInsAsyncCancelled state
+   */
+  LIB_EXPORT bool CALL_CONV
+  CancelAsyncOperation(struct InseyeAsyncOperation*);
+  /**
+   * @brief Blocks until operation is finished (cancelled, faulted or
+   * completed) or timeout elapses.
+   * @return true when operation is finished
+   */
+  LIB_EXPORT bool CALL_CONV
+  WaitForAsyncOperation(struct InseyeAsyncOperation*, uint32_t timeout_ms);
+  /**
+   * @brief Takes reader created by finished operation, reader can be taken
+   * only once and is then owned by caller.
+   * @returns kSuccess when reader was written to pointer_address, status of
+   * failed or cancelled operation, or kFailure when operation hasn't finished
+   * or reader was already taken
+   */
+  LIB_EXPORT enum InseyeInitializationStatus CALL_CONV
+  GetEyeTrackerReaderAsyncResult(struct InseyeAsyncOperation*,
+                                 struct InseyeEyeTracker** pointer_address);
+  /**
+   * @brief Cancels unfinished operation, destroys reader that wasn't taken
+   * and zeroes pointer. Doesn't wait for connecting thread, unfinished
+   * operation is freed by the thread once it stops, which takes at most few
+   * milliseconds after cancellation.
+   */
+  LIB_EXPORT void CALL_CONV
+  DestroyAsyncOperation(struct InseyeAsyncOperation** pointer_address);
+  /**
+   * @brief Starts dispatcher thread that reads samples with its own cursor
+   * over tracker's mapping (see CreateEyeTrackerCursor) and delivers them to
+   * callback in contiguous batches, so tracker's read position isn't
+   * affected. Dispatcher sleeps in WaitForEyeTrackerData between batches.
+   * Callback is called only from the dispatcher thread and must not throw.
+   * @param options dispatcher options or NULL for defaults
+   * @param pointer_address address of pointer which will hold subscription
+   * @returns kSuccess when dispatcher was started, kFailure when arguments
+   * are invalid or thread affinity or priority couldn't be applied.
+   */
+  LIB_EXPORT enum InseyeInitializationStatus CALL_CONV SubscribeEyeTrackerData(
+      struct InseyeEyeTracker* tracker, InseyeGazeDataCallback callback,
+      void* user_data, const struct InseyeSubscriptionOptions* options,
+      struct InseyeSubscription** pointer_address);
+  /**
+   * @brief Stops dispatcher thread after it delivers samples read so far,
+   * frees subscription and zeroes pointer. Callback is not called after
+   * this function returns. Must not be called from the callback.
+   */
+  LIB_EXPORT void CALL_CONV
+  UnsubscribeEyeTrackerData(struct InseyeSubscription** pointer_address);
   /**
     * @brief Frees all resources allocated during call to CreateEyeTrackerReader
     * and zeroes pointer.
@@ -221,6 +808,70 @@ namespace inseye::c {
    */
   LIB_EXPORT bool CALL_CONV TryReadLatestEyeTrackerData(
       struct InseyeEyeTracker*, struct InseyeEyeTrackerDataStruct*);
+  /**
+   * @brief Reads up to capacity unread samples in one call.
+   * Works like repeated calls to TryReadNextEyeTrackerData but loads samples
+   * written count once before and once after the copy and copies contiguous
+   * parts of the service buffer in bulk. If service overwrote part of the
+   * range during the copy, only samples that are still valid are returned.
+   * @param out_data array of at least capacity elements
+   * @param capacity maximum number of samples to read
+   * @param count number of samples written to out_data
+   * @return true when at least one sample was read, otherwise false
+   */
+  LIB_EXPORT bool CALL_CONV TryReadEyeTrackerDataBatch(
+      struct InseyeEyeTracker*, struct InseyeEyeTrackerDataStruct* out_data,
+      uint32_t capacity, uint32_t* count);
+  /**
+   * @brief Lends up to max_count unread samples without copying them.
+   * Lease points into the mapped service buffer, internal iterator moves past
+   * leased samples like after TryReadEyeTrackerDataBatch. Service keeps
+   * writing while the lease is held, so leased bytes are only trustworthy
+   * once ReleaseEyeTrackerReadLease confirms that none of them was
+   * overwritten. Lease must be released before the reader is destroyed.
+   * @param lease zeroed when no sample is leased
+   * @return true when at least one sample was leased, otherwise false
+   */
+  LIB_EXPORT bool CALL_CONV AcquireEyeTrackerReadLease(
+      struct InseyeEyeTracker*, uint32_t max_count, struct InseyeLease* lease);
+  /**
+   * @brief Ends lease and checks it with samples written count loaded after
+   * the caller's reads of leased memory, the same check reads make after
+   * copying.
+   * @param overwritten_count NULL or number of leading leased samples the
+   * service may have overwritten while the lease was held, overwritten
+   * samples always form prefix of the lease
+   * @return true when no leased sample was overwritten
+   */
+  LIB_EXPORT bool CALL_CONV ReleaseEyeTrackerReadLease(
+      struct InseyeEyeTracker*, const struct InseyeLease* lease,
+      uint32_t* overwritten_count);
+  /**
+   * @brief Reads up to capacity unread samples in one call and stores them as
+   * columns.
+   * Works like TryReadEyeTrackerDataBatch, but samples are decoded from
+   * service buffer straight into separate arrays. Decoding uses AVX2 or SSE4.1
+   * when processor supports them.
+   * @param columns destination arrays, each of at least capacity elements
+   * @param capacity maximum number of samples to read
+   * @param count number of samples written to every column
+   * @return true when at least one sample was read, otherwise false
+   */
+  LIB_EXPORT bool CALL_CONV ReadEyeTrackerDataColumns(
+      struct InseyeEyeTracker*,
+      const struct InseyeEyeTrackerDataColumns* columns, uint32_t capacity,
+      uint32_t* count);
+  /**
+   * @brief Blocks calling thread until there is unread gaze data available or
+   * timeout elapses.
+   * On Linux the thread sleeps on futex placed on shared samples written
+   * counter, service that wakes the futex after writing wakes the reader
+   * immediately, otherwise the counter is checked every millisecond.
+   * @param timeout_ns maximum wait time in nanoseconds
+   * @return true when unread data is in memory buffer, false on timeout
+   */
+  LIB_EXPORT bool CALL_CONV WaitForEyeTrackerData(struct InseyeEyeTracker*,
+                                                  uint64_t timeout_ns);
   /**
    * @brief Reads eye tracker data stored at current internal iterator position
    * (previously returned with TryReadNextEyeTrackerData or
@@ -235,10 +886,401 @@ namespace inseye::c {
   LIB_EXPORT bool CALL_CONV TryReadLastEyeTrackerData(
       struct InseyeEyeTracker*, struct InseyeEyeTrackerDataStruct*);
   /**
-   * @brief Returns last error description. It's thread local null terminated
-   * ANSI string up to 1024 bytes length.
-   * Do not free memory returned from this function.
-   * @return Address of first string character.
+   * @brief Finds gaze at given time among samples held by the ring, without
+   * changing internal iterator position. Ring is binary searched by sample
+   * time and only the samples around the time are copied.
+   * Time after the newest sample gives the newest sample, time halfway
+   * between two samples gives the older one. Interpolated gaze
+   * has the queried time (rounded) and gaze event of the nearest sample,
+   * positions are interpolated only between samples with the same gaze event,
+   * otherwise they are taken from the nearest sample.
+   * @param time milliseconds since Unix Epoch, fraction is used by
+   * interpolation
+   * @return false when service has not written any sample or time is older
+   * than the oldest sample still held by the ring
+   */
+  LIB_EXPORT bool CALL_CONV TryReadEyeTrackerDataAt(
+      struct InseyeEyeTracker*, double time, enum InseyeTimeQueryMode mode,
+      struct InseyeEyeTrackerDataStruct* data_struct);
+  /**
+   * @brief Copies samples with time in [begin_time, end_time) held by the
+   * ring, oldest first, without changing internal iterator position.
+   * Range bounds are binary searched, samples older than the oldest one held
+   * by the ring are not returned.
+   * @param capacity maximum number of samples, the oldest ones are returned
+   * when range holds more
+   * @param count number of samples written to data_structs
+   * @return true when at least one sample was copied
+   */
+  LIB_EXPORT bool CALL_CONV ReadEyeTrackerDataRange(
+      struct InseyeEyeTracker*, uint64_t begin_time, uint64_t end_time,
+      struct InseyeEyeTrackerDataStruct* data_structs, uint32_t capacity,
+      uint32_t* count);
+  /**
+   * @brief Returns number of reads that were repeated because sample was
+   * overwritten by the service while it was being copied (torn read).
+   * @return total retry count since reader creation
+   */
+  LIB_EXPORT uint64_t CALL_CONV
+  GetEyeTrackerReadRetryCount(struct InseyeEyeTracker*);
+  /**
+   * @brief Copies reader statistics, may be called from other thread than the
+   * one reading samples. Counters are updated independently, so snapshot taken
+   * during read may be off by single read between counters.
+   * @return true on success, false when library was built without reader
+   * statistics (INSEYE_READER_STATISTICS=OFF), statistics are then zeroed
+   * except read_retries
+   */
+  LIB_EXPORT bool CALL_CONV GetEyeTrackerReaderStatistics(
+      struct InseyeEyeTracker*, struct InseyeReaderStatistics* statistics);
+  /**
+   * @brief Returns smallest lag counted in given bucket of
+   * InseyeReaderStatistics::sample_lag_histogram.
+   */
+  LIB_EXPORT uint32_t CALL_CONV
+  GetSampleLagHistogramBucketLowerBound(uint32_t bucket_index);
+  /**
+   * @brief Copies current estimate of service clock. Reads of the reader and
+   * of its cursors record (sample time, local arrival time) observations,
+   * offset and drift are fitted to the earliest arrivals, so the mapping
+   * includes the smallest observed service to reader latency. Service clock
+   * jumps reset the estimate. May be called from any thread.
+   * @return false when no sample was read yet
+   */
+  LIB_EXPORT bool CALL_CONV GetEyeTrackerClockMapping(
+      struct InseyeEyeTracker*, struct InseyeClockMapping* mapping);
+  /**
+   * @brief Converts service sample time to steady clock time with current
+   * clock mapping, see GetEyeTrackerClockMapping.
+   * @param time sample time in milliseconds since Unix Epoch
+   * @param local_ns steady clock time in nanoseconds
+   * @return false when no sample was read yet
+   */
+  LIB_EXPORT bool CALL_CONV ConvertEyeTrackerTimeToLocal(
+      struct InseyeEyeTracker*, uint64_t time, int64_t* local_ns);
+  /**
+   * @brief ConvertEyeTrackerTimeToLocal for count samples with single mapping
+   * snapshot, costs single multiply-add per sample, on x86 with AVX2 and
+   * FMA3 four samples are converted by single fused multiply-add.
+   */
+  LIB_EXPORT bool CALL_CONV ConvertEyeTrackerTimesToLocal(
+      struct InseyeEyeTracker*, const uint64_t* times, int64_t* local_ns,
+      uint32_t count);
+  /**
+   * @brief Extrapolates gaze of both eyes to target time for latency
+   * compensation.
+   * Every reader and cursor keeps constant velocity Kalman filter per eye.
+   * The call feeds it with samples published since the previous call, at most
+   * the newest 64, and extrapolates filtered position with filtered velocity
+   * for at most 100 ms. Blinking eye keeps its last position with zero
+   * confidence, saccade and headset mount restart filters at the newest
+   * position without velocity. Feeding doesn't change internal iterator
+   * position, so prediction may be called concurrently with reads, but not
+   * concurrently with other prediction on the same reader.
+   * Repeated calls without new samples only extrapolate, so prediction may be
+   * requested several times per frame.
+   * @param target_time milliseconds since Unix Epoch, e.g. display time
+   * converted to service time
+   * @return false when service has not written any sample
+   */
+  LIB_EXPORT bool CALL_CONV PredictGaze(
+      struct InseyeEyeTracker*, double target_time,
+      struct InseyeGazePrediction* prediction);
+  /**
+   * @brief Replaces filter chain of the reader, stages are applied in order
+   * by TryReadFilteredEyeTrackerDataBatch. Stage state is allocated here and
+   * has fixed size, filtering doesn't allocate. State starts at the next
+   * filtered sample. Must not be called while other thread reads with the
+   * reader.
+   * @param stages at most 8 stages, may be NULL when stage_count is 0 which
+   * removes the chain
+   * @returns kSuccess, or kFailure when reader is null or stage is invalid
+   */
+  LIB_EXPORT enum InseyeInitializationStatus CALL_CONV
+  SetEyeTrackerFilterChain(struct InseyeEyeTracker*,
+                           const struct InseyeFilterStage* stages,
+                           uint32_t stage_count);
+  /**
+   * @brief TryReadEyeTrackerDataBatch that also passes read samples through
+   * reader's filter chain. Raw and filtered samples of the same read are
+   * returned side by side, without filter chain filtered samples are equal to
+   * raw ones. Samples not read through this function don't reach the chain.
+   * @param raw_data NULL or capacity raw samples
+   * @param filtered_data capacity filtered samples
+   */
+  LIB_EXPORT bool CALL_CONV TryReadFilteredEyeTrackerDataBatch(
+      struct InseyeEyeTracker*, struct InseyeEyeTrackerDataStruct* raw_data,
+      struct InseyeEyeTrackerDataStruct* filtered_data, uint32_t capacity,
+      uint32_t* count);
+  /**
+   * @brief Starts classifying samples published from now on into fixations,
+   * saccades and blinks, restarts classification that is running.
+   * Classifier is allocated here and has fixed size, classification doesn't
+   * allocate. It is fed when segments are pulled with TryReadGazeSegments,
+   * so it sees every sample regardless of how (and whether) raw samples are
+   * read, and reads don't pay for it. Must not be called while other thread
+   * reads with the reader.
+   * @param options NULL selects defaults
+   * @returns kSuccess, or kFailure when reader is null or option is invalid
+   */
+  LIB_EXPORT enum InseyeInitializationStatus CALL_CONV
+  StartEyeTrackerGazeClassification(
+      struct InseyeEyeTracker*,
+      const struct InseyeGazeClassifierOptions* options);
+  /**
+   * @brief Stops classification and frees classifier, segments not read yet
+   * are discarded.
+   */
+  LIB_EXPORT void CALL_CONV
+  StopEyeTrackerGazeClassification(struct InseyeEyeTracker*);
+  /**
+   * @brief Classifies samples published since the previous call and copies
+   * finished segments, oldest first.
+   * Work is constant per sample and classifier holds at most 256 finished
+   * segments, samples not classified yet wait in the ring for the next call.
+   * Calls must come more often than the ring fills up, otherwise oldest
+   * samples are lost and segment open at the gap is kInsSegmentTruncated.
+   * Doesn't change internal iterator position, so it may be called
+   * concurrently with reads, but not concurrently with other classification
+   * call on the same reader.
+   * @return false when classification is not running or no segment ended
+   */
+  LIB_EXPORT bool CALL_CONV TryReadGazeSegments(
+      struct InseyeEyeTracker*, struct InseyeGazeSegment* segments,
+      uint32_t capacity, uint32_t* count);
+  /**
+   * @brief Starts background thread that watches the service and switches the
+   * reader and its cursors to restarted service.
+   * Service is lost when it closes the connection or stops publishing
+   * samples for stall timeout. The thread connects to the service again,
+   * maps the new ring and publishes it, reads pick it up with single pointer
+   * comparison and never wait for the thread. First sample read from the new
+   * ring carries kInsGazeDiscontinuity. Queries that don't move the read
+   * position (TryReadLastEyeTrackerData, TryReadEyeTrackerDataAt,
+   * ReadEyeTrackerDataRange) switch too, so they never answer from the ring
+   * of the lost service. Must not be called while other thread reads with
+   * the reader.
+   * @param options NULL selects defaults
+   * @returns kSuccess, or kFailure when reader is null, reconnect is already
+   * enabled or the thread can't be started
+   */
+  LIB_EXPORT enum InseyeInitializationStatus CALL_CONV
+  EnableEyeTrackerReconnect(struct InseyeEyeTracker*,
+                            const struct InseyeReconnectOptions* options);
+  /**
+   * @brief Stops watching the service, reader and its cursors keep the ring
+   * they read at the moment. Must not be called while other thread reads
+   * with the reader.
+   */
+  LIB_EXPORT void CALL_CONV
+  DisableEyeTrackerReconnect(struct InseyeEyeTracker*);
+  /**
+   * @brief Creates cursor, independent read position over reader's shared
+   * memory mapping.
+   * Cursor doesn't connect to the service and doesn't map memory, it only
+   * copies ring geometry and keeps the mapping alive, so creation is cheap and
+   * any number of consumers (renderer, logger, UI...) can read every sample at
+   * their own pace. Cursor starts at reader's current position and has its
+   * own statistics. Reader can be destroyed before its cursors. Single cursor
+   * must be used by one thread at a time, different cursors and the reader
+   * may be used from different threads concurrently. Must not be called
+   * while other thread reads with the reader.
+   * @param tracker reader created with CreateEyeTrackerReader
+   * @param pointer_address address of pointer which will hold created cursor
+   * @returns kSuccess, or kFailure when any argument is null.
+   */
+  LIB_EXPORT enum InseyeInitializationStatus CALL_CONV CreateEyeTrackerCursor(
+      struct InseyeEyeTracker* tracker, struct InseyeCursor** pointer_address);
+  /**
+   * @brief Frees cursor and zeroes pointer. Shared memory is unmapped when
+   * reader and all its cursors are destroyed.
+   */
+  LIB_EXPORT void CALL_CONV
+  DestroyEyeTrackerCursor(struct InseyeCursor** pointer_address);
+  /**
+   * @brief IsGazeDataAvailable for cursor.
+   */
+  LIB_EXPORT bool CALL_CONV IsCursorGazeDataAvailable(struct InseyeCursor*);
+  /**
+   * @brief TryReadNextEyeTrackerData for cursor.
+   */
+  LIB_EXPORT bool CALL_CONV TryReadNextCursorData(
+      struct InseyeCursor*, struct InseyeEyeTrackerDataStruct*);
+  /**
+   * @brief TryReadLatestEyeTrackerData for cursor.
+   */
+  LIB_EXPORT bool CALL_CONV TryReadLatestCursorData(
+      struct InseyeCursor*, struct InseyeEyeTrackerDataStruct*);
+  /**
+   * @brief TryReadEyeTrackerDataBatch for cursor.
+   */
+  LIB_EXPORT bool CALL_CONV TryReadCursorDataBatch(
+      struct InseyeCursor*, struct InseyeEyeTrackerDataStruct* out_data,
+      uint32_t capacity, uint32_t* count);
+  /**
+   * @brief AcquireEyeTrackerReadLease for cursor.
+   */
+  LIB_EXPORT bool CALL_CONV AcquireCursorReadLease(struct InseyeCursor*,
+                                                   uint32_t max_count,
+                                                   struct InseyeLease* lease);
+  /**
+   * @brief ReleaseEyeTrackerReadLease for cursor.
+   */
+  LIB_EXPORT bool CALL_CONV ReleaseCursorReadLease(
+      struct InseyeCursor*, const struct InseyeLease* lease,
+      uint32_t* overwritten_count);
+  /**
+   * @brief ReadEyeTrackerDataColumns for cursor.
+   */
+  LIB_EXPORT bool CALL_CONV ReadCursorDataColumns(
+      struct InseyeCursor*, const struct InseyeEyeTrackerDataColumns* columns,
+      uint32_t capacity, uint32_t* count);
+  /**
+   * @brief SetEyeTrackerFilterChain for cursor, cursor starts without filter
+   * chain.
+   */
+  LIB_EXPORT enum InseyeInitializationStatus CALL_CONV
+  SetCursorFilterChain(struct InseyeCursor*,
+                       const struct InseyeFilterStage* stages,
+                       uint32_t stage_count);
+  /**
+   * @brief TryReadFilteredEyeTrackerDataBatch for cursor.
+   */
+  LIB_EXPORT bool CALL_CONV TryReadFilteredCursorDataBatch(
+      struct InseyeCursor*, struct InseyeEyeTrackerDataStruct* raw_data,
+      struct InseyeEyeTrackerDataStruct* filtered_data, uint32_t capacity,
+      uint32_t* count);
+  /**
+   * @brief StartEyeTrackerGazeClassification for cursor, cursor has its own
+   * classifier.
+   */
+  LIB_EXPORT enum InseyeInitializationStatus CALL_CONV
+  StartCursorGazeClassification(
+      struct InseyeCursor*, const struct InseyeGazeClassifierOptions* options);
+  /**
+   * @brief StopEyeTrackerGazeClassification for cursor.
+   */
+  LIB_EXPORT void CALL_CONV
+  StopCursorGazeClassification(struct InseyeCursor*);
+  /**
+   * @brief TryReadGazeSegments for cursor.
+   */
+  LIB_EXPORT bool CALL_CONV TryReadCursorGazeSegments(
+      struct InseyeCursor*, struct InseyeGazeSegment* segments,
+      uint32_t capacity, uint32_t* count);
+  /**
+   * @brief PredictGaze for cursor, cursor has its own filters.
+   */
+  LIB_EXPORT bool CALL_CONV PredictCursorGaze(
+      struct InseyeCursor*, double target_time,
+      struct InseyeGazePrediction* prediction);
+  /**
+   * @brief WaitForEyeTrackerData for cursor.
+   */
+  LIB_EXPORT bool CALL_CONV WaitForCursorData(struct InseyeCursor*,
+                                              uint64_t timeout_ns);
+  /**
+   * @brief TryReadLastEyeTrackerData for cursor.
+   */
+  LIB_EXPORT bool CALL_CONV TryReadLastCursorData(
+      struct InseyeCursor*, struct InseyeEyeTrackerDataStruct*);
+  /**
+   * @brief TryReadEyeTrackerDataAt for cursor.
+   */
+  LIB_EXPORT bool CALL_CONV TryReadCursorDataAt(
+      struct InseyeCursor*, double time, enum InseyeTimeQueryMode mode,
+      struct InseyeEyeTrackerDataStruct* data_struct);
+  /**
+   * @brief ReadEyeTrackerDataRange for cursor.
+   */
+  LIB_EXPORT bool CALL_CONV ReadCursorDataRange(
+      struct InseyeCursor*, uint64_t begin_time, uint64_t end_time,
+      struct InseyeEyeTrackerDataStruct* data_structs, uint32_t capacity,
+      uint32_t* count);
+  /**
+   * @brief GetEyeTrackerReaderStatistics for cursor, counts only reads made
+   * with the cursor.
+   */
+  LIB_EXPORT bool CALL_CONV GetCursorReaderStatistics(
+      struct InseyeCursor*, struct InseyeReaderStatistics* statistics);
+  /**
+   * @brief Starts recording of all gaze data to file at file_path.
+   * Recorder connects to the service with its own reader and drains it on
+   * background thread into memory mapped file split into fixed size chunks.
+   * Every chunk header holds time of its first and last sample, so recording
+   * can be searched by time in logarithmic time. Samples are committed in
+   * batches, after crash of recording process the file holds every committed
+   * sample.
+   * @param pointer_address address of pointer which will hold created recorder
+   * @param file_path path of recording file, existing file is overwritten
+   * @param options recorder options or NULL for defaults
+   * @param timeout_ms maximum time of connecting to the service
+   * @returns Initialization status. Pointer at input address is only populated
+   * when function returns kSuccess.
+   */
+  LIB_EXPORT enum InseyeInitializationStatus CALL_CONV CreateEyeTrackerRecorder(
+      struct InseyeRecorder** pointer_address, const char* file_path,
+      const struct InseyeRecorderOptions* options, uint32_t timeout_ms);
+  /**
+   * @brief Stops recording, waits until all samples read so far are written
+   * to the file, frees recorder and zeroes pointer.
+   */
+  LIB_EXPORT void CALL_CONV
+  DestroyEyeTrackerRecorder(struct InseyeRecorder** pointer_address);
+  /**
+   * @brief Returns recorder state. When recorder is faulted error
+   * description is available through GetLastErrorDescription.
+   */
+  LIB_EXPORT enum InseyeRecorderState CALL_CONV
+  GetEyeTrackerRecorderState(struct InseyeRecorder*);
+  /**
+   * @brief Returns number of samples committed to recording file.
+   */
+  LIB_EXPORT uint64_t CALL_CONV
+  GetEyeTrackerRecorderSampleCount(struct InseyeRecorder*);
+  /**
+   * @brief Opens recording created with CreateEyeTrackerRecorder for reading.
+   * Samples committed after the call are not visible through returned handle.
+   * @param pointer_address address of pointer which will hold opened recording
+   * @returns Initialization status. Pointer at input address is only populated
+   * when function returns kSuccess.
+   */
+  LIB_EXPORT enum InseyeInitializationStatus CALL_CONV OpenEyeTrackerRecording(
+      struct InseyeRecording** pointer_address, const char* file_path);
+  /**
+   * @brief Closes recording and zeroes pointer.
+   */
+  LIB_EXPORT void CALL_CONV
+  CloseEyeTrackerRecording(struct InseyeRecording** pointer_address);
+  /**
+   * @brief Returns number of samples in recording.
+   */
+  LIB_EXPORT uint64_t CALL_CONV
+  GetEyeTrackerRecordingSampleCount(struct InseyeRecording*);
+  /**
+   * @brief Reads up to capacity samples starting at sample_position.
+   * @param count number of samples written to out_data
+   * @return true when at least one sample was read, otherwise false
+   */
+  LIB_EXPORT bool CALL_CONV ReadEyeTrackerRecordingData(
+      struct InseyeRecording*, uint64_t sample_position,
+      struct InseyeEyeTrackerDataStruct* out_data, uint32_t capacity,
+      uint32_t* count);
+  /**
+   * @brief Finds position of first sample with time not lower than time.
+   * Binary search over chunk headers and then samples of single chunk.
+   * @param time timestamp in milliseconds since Unix Epoch
+   * @param sample_position position of found sample
+   * @return true when such sample exists, otherwise false
+   */
+  LIB_EXPORT bool CALL_CONV SeekEyeTrackerRecording(struct InseyeRecording*,
+                                                    uint64_t time,
+                                                    uint64_t* sample_position);
+  /**
+   * @brief Returns last error description. It's thread local null terminated
+   * ANSI string up to 1024 bytes length.
+   * Do not free memory returned from this function.
+   * @return Address of first string character.
    */
   LIB_EXPORT char* CALL_CONV GetLastErrorDescription();
 #ifdef __cplusplus
@@ -249,6 +1291,23 @@ namespace inseye::c {
 namespace inseye {
   using GazeEvent = inseye::c::InseyeGazeEvent;
   using EyeTrackerDataStruct = inseye::c::InseyeEyeTrackerDataStruct;
+  using EyeTrackerDataColumns = inseye::c::InseyeEyeTrackerDataColumns;
+  using RecorderState = inseye::c::InseyeRecorderState;
+  using RecorderOptions = inseye::c::InseyeRecorderOptions;
+  using ReaderStatistics = inseye::c::InseyeReaderStatistics;
+  using ClockMapping = inseye::c::InseyeClockMapping;
+  using TimeQueryMode = inseye::c::InseyeTimeQueryMode;
+  using GazePrediction = inseye::c::InseyeGazePrediction;
+  using FilterType = inseye::c::InseyeFilterType;
+  using FilterStage = inseye::c::InseyeFilterStage;
+  using GazeSegmentType = inseye::c::InseyeGazeSegmentType;
+  using GazeSegmentFlags = inseye::c::InseyeGazeSegmentFlags;
+  using GazeSegment = inseye::c::InseyeGazeSegment;
+  using GazeClassifierOptions = inseye::c::InseyeGazeClassifierOptions;
+  using LeaseSpan = inseye::c::InseyeLeaseSpan;
+  using Lease = inseye::c::InseyeLease;
+  using ReconnectOptions = inseye::c::InseyeReconnectOptions;
+  using Allocator = inseye::c::InseyeAllocator;
   struct LIB_EXPORT Version : public inseye::c::InseyeVersion {
 
     bool operator==(const inseye::Version& other) const;
@@ -271,11 +1330,136 @@ namespace inseye {
 
   std::ostream& operator<<(std::ostream& os, GazeEvent event);
 
+  namespace internal {
+    struct GazeDataWatcher;
+  }
+
+  /**
+   * @brief Decides where coroutines suspended on gaze awaitables are resumed.
+   */
+  class Executor {
+   public:
+    virtual ~Executor() = default;
+    /**
+     * @brief Called on library watcher thread when awaited gaze data arrived
+     * (or awaited reader was destroyed). Must eventually resume continuation
+     * and should return quickly, e.g. by queueing it to job system.
+     */
+    virtual void Schedule(std::coroutine_handle<> continuation) noexcept = 0;
+  };
+
+  /**
+   * @brief Awaitable that suspends coroutine until reader has unread data.
+   * Suspended coroutines are tracked by single library watcher thread that
+   * sleeps on the service samples written counter, so any number of them
+   * waits without occupying threads. Coroutine is resumed on executor, or
+   * directly on watcher thread when executor is null. Reader must not be
+   * used by anything else while the coroutine waits on it, independent
+   * consumers should await their own cursors. Destroying the reader resumes
+   * its waiters with empty result, also those already scheduled on executor,
+   * and waits for resumed ones that read from it. Coroutine destroyed while
+   * suspended is forgotten by the watcher, but not after its continuation
+   * was scheduled on executor. The first suspension starts the watcher, it
+   * parks when nothing waits, so later suspensions don't allocate.
+   */
+  class LIB_EXPORT GazeDataAwaiter {
+   protected:
+    inseye::c::InseyeEyeTracker* tracker_;
+    inseye::c::InseyeCursor* cursor_;
+    Executor* executor_;
+    // address of suspended coroutine, coroutine_handle isn't exported type
+    void* continuation_ = nullptr;
+    bool cancelled_ = false;
+
+    friend struct internal::GazeDataWatcher;
+
+   public:
+    GazeDataAwaiter(inseye::c::InseyeEyeTracker* tracker,
+                    inseye::c::InseyeCursor* cursor,
+                    Executor* executor) noexcept;
+    /**
+     * @brief Removes waiter of coroutine destroyed while suspended.
+     */
+    ~GazeDataAwaiter();
+    [[nodiscard]] bool await_ready() const noexcept;
+    bool await_suspend(std::coroutine_handle<> continuation) noexcept;
+  };
+
+  class LIB_EXPORT NextSampleAwaiter : public GazeDataAwaiter {
+   public:
+    using GazeDataAwaiter::GazeDataAwaiter;
+    /**
+     * @return next sample or nothing when reader was destroyed or read
+     * failed
+     */
+    std::optional<EyeTrackerDataStruct> await_resume() noexcept;
+  };
+
+  class LIB_EXPORT NextBatchAwaiter : public GazeDataAwaiter {
+    EyeTrackerDataStruct* out_data_;
+    uint32_t capacity_;
+
+   public:
+    NextBatchAwaiter(inseye::c::InseyeEyeTracker* tracker,
+                     inseye::c::InseyeCursor* cursor, Executor* executor,
+                     std::span<EyeTrackerDataStruct> out_data) noexcept;
+    /**
+     * @return number of samples written to the front of out_data, zero when
+     * reader was destroyed or read failed
+     */
+    uint32_t await_resume() noexcept;
+  };
+
+  /**
+   * @brief Asynchronous generator of samples, reads samples in batches and
+   * hands them out one by one:
+   * while (auto sample = co_await stream.Next()) { ... }
+   */
+  class LIB_EXPORT SampleStream {
+    static constexpr uint32_t kBufferSize = 64;
+    inseye::c::InseyeEyeTracker* tracker_;
+    inseye::c::InseyeCursor* cursor_;
+    Executor* executor_;
+    EyeTrackerDataStruct buffer_[kBufferSize];
+    uint32_t position_ = 0;
+    uint32_t count_ = 0;
+
+   public:
+    class LIB_EXPORT NextAwaiter : public GazeDataAwaiter {
+      SampleStream* stream_;
+
+     public:
+      explicit NextAwaiter(SampleStream* stream) noexcept;
+      [[nodiscard]] bool await_ready() const noexcept;
+      /**
+       * @return next sample or nothing when reader was destroyed or read
+       * failed, stream ends then
+       */
+      std::optional<EyeTrackerDataStruct> await_resume() noexcept;
+    };
+
+    SampleStream(inseye::c::InseyeEyeTracker* tracker,
+                 inseye::c::InseyeCursor* cursor, Executor* executor) noexcept;
+    [[nodiscard]] NextAwaiter Next() noexcept;
+  };
+
+  class EyeTrackerCursor;
+
+  class EyeTrackerCreation;
+
+  class Subscription;
+
   class LIB_EXPORT EyeTracker final {
    private:
         inseye::c::InseyeEyeTracker*
         implementation_pointer_;
 
+    friend class EyeTrackerCursor;
+    friend class EyeTrackerCreation;
+    friend class Subscription;
+
+    explicit EyeTracker(inseye::c::InseyeEyeTracker* implementation) noexcept;
+
    public:
     EyeTracker() = delete;
     /**
@@ -315,6 +1499,40 @@ namespace inseye {
      * @return true when data was successfully read, otherwise false
      */
     bool TryReadNextEyeTrackerData(EyeTrackerDataStruct& out_data) noexcept;
+    /**
+     * @brief Reads up to out_data.size() unread samples in one call.
+     * @param out_data output span that will be filled from the beginning.
+     * @param count number of samples written to out_data
+     * @return true when at least one sample was read, otherwise false
+     */
+    bool TryReadEyeTrackerDataBatch(std::span<EyeTrackerDataStruct> out_data,
+                                    uint32_t& count) noexcept;
+    /**
+     * @brief Lends up to max_count unread samples without copying them, see
+     * AcquireEyeTrackerReadLease.
+     */
+    bool AcquireReadLease(uint32_t max_count, Lease& lease) noexcept;
+    /**
+     * @brief Ends lease, see ReleaseEyeTrackerReadLease.
+     * @return true when no leased sample was overwritten
+     */
+    bool ReleaseReadLease(const Lease& lease,
+                          uint32_t* overwritten_count = nullptr) noexcept;
+    /**
+     * @brief Reads up to capacity unread samples in one call and stores them
+     * as columns.
+     * @param columns destination arrays, each of at least capacity elements
+     * @param count number of samples written to every column
+     * @return true when at least one sample was read, otherwise false
+     */
+    bool ReadEyeTrackerDataColumns(const EyeTrackerDataColumns& columns,
+                                   uint32_t capacity, uint32_t& count) noexcept;
+    /**
+     * @brief Blocks calling thread until there is unread gaze data available or
+     * timeout elapses.
+     * @return true when unread data is available, false on timeout
+     */
+    bool WaitForEyeTrackerData(std::chrono::nanoseconds timeout) noexcept;
     /**
      * @brief Reads eye tracker data stored at current internal iterator position
      * (previously returned with TryReadNextEyeTrackerData or
@@ -327,6 +1545,376 @@ namespace inseye {
      * @return true when data was successfully read, otherwise false
      */
     bool TryReadLastEyeTrackerData(EyeTrackerDataStruct& out_data) const noexcept;
+    /**
+     * @brief Finds gaze at given time without changing internal iterator
+     * position, see TryReadEyeTrackerDataAt.
+     */
+    bool TryReadEyeTrackerDataAt(double time, TimeQueryMode mode,
+                                 EyeTrackerDataStruct& out_data) const noexcept;
+    /**
+     * @brief Copies samples with time in [begin_time, end_time) to front of
+     * out_data, see ReadEyeTrackerDataRange.
+     */
+    bool ReadEyeTrackerDataRange(uint64_t begin_time, uint64_t end_time,
+                                 std::span<EyeTrackerDataStruct> out_data,
+                                 uint32_t& count) const noexcept;
+    /**
+     * @brief Returns number of reads that were repeated because sample was
+     * overwritten by the service while it was being copied (torn read).
+     */
+    [[nodiscard]] uint64_t GetReadRetryCount() const noexcept;
+    /**
+     * @brief Copies reader statistics, see GetEyeTrackerReaderStatistics.
+     * @return false when library was built without reader statistics
+     */
+    bool GetReaderStatistics(ReaderStatistics& statistics) const noexcept;
+    /**
+     * @brief Copies clock mapping, see GetEyeTrackerClockMapping.
+     */
+    bool GetClockMapping(ClockMapping& mapping) const noexcept;
+    /**
+     * @brief Converts service sample time to steady clock, see
+     * ConvertEyeTrackerTimeToLocal.
+     */
+    bool ConvertEyeTrackerTimeToLocal(
+        uint64_t time,
+        std::chrono::steady_clock::time_point& local) const noexcept;
+    /**
+     * @brief Converts times.size() sample times into front of local with
+     * single mapping snapshot, see ConvertEyeTrackerTimesToLocal.
+     * @return false when local is smaller than times or no sample was read
+     */
+    bool ConvertEyeTrackerTimesToLocal(
+        std::span<const uint64_t> times,
+        std::span<std::chrono::steady_clock::time_point> local) const noexcept;
+    /**
+     * @brief Replaces filter chain, see SetEyeTrackerFilterChain.
+     * Throws std::runtime_error when stage is invalid.
+     */
+    void SetFilterChain(std::span<const FilterStage> stages);
+    /**
+     * @brief Reads up to filtered_data.size() samples into filtered_data and,
+     * unless raw_data is empty, into raw_data, see
+     * TryReadFilteredEyeTrackerDataBatch.
+     */
+    bool TryReadFilteredEyeTrackerDataBatch(
+        std::span<EyeTrackerDataStruct> raw_data,
+        std::span<EyeTrackerDataStruct> filtered_data,
+        uint32_t& count) noexcept;
+    /**
+     * @brief Starts classifying samples published from now on, see
+     * StartEyeTrackerGazeClassification.
+     * Throws std::runtime_error when option is invalid.
+     */
+    void StartGazeClassification(const GazeClassifierOptions& options = {});
+    void StopGazeClassification() noexcept;
+    /**
+     * @brief Copies up to segments.size() finished segments, see
+     * TryReadGazeSegments.
+     */
+    bool TryReadGazeSegments(std::span<GazeSegment> segments,
+                             uint32_t& count) noexcept;
+    /**
+     * @brief Switches reader to restarted service in background, see
+     * EnableEyeTrackerReconnect.
+     * Throws std::runtime_error when reconnect is already enabled or the
+     * thread can't be started.
+     */
+    void EnableReconnect(const ReconnectOptions& options = {});
+    void DisableReconnect() noexcept;
+    /**
+     * @brief Extrapolates gaze to target service time, see PredictGaze.
+     */
+    bool PredictGaze(double target_time, GazePrediction& prediction) noexcept;
+    /**
+     * @brief Extrapolates gaze to steady clock time, e.g. display time of the
+     * frame, converted to service time with current clock mapping.
+     * @return false when no sample was read yet
+     */
+    bool PredictGaze(std::chrono::steady_clock::time_point target_time,
+                     GazePrediction& prediction) noexcept;
+    /**
+     * @brief co_await returns next sample, suspending until it's published,
+     * see GazeDataAwaiter.
+     * @param executor where to resume, null resumes on library watcher thread
+     */
+    [[nodiscard]] NextSampleAwaiter NextSample(
+        Executor* executor = nullptr) noexcept;
+    /**
+     * @brief co_await reads up to out_data.size() samples, suspending until
+     * at least one is published, see GazeDataAwaiter.
+     */
+    [[nodiscard]] NextBatchAwaiter NextBatch(
+        std::span<EyeTrackerDataStruct> out_data,
+        Executor* executor = nullptr) noexcept;
+    /**
+     * @brief Returns asynchronous generator of samples, see SampleStream.
+     */
+    [[nodiscard]] SampleStream Samples(Executor* executor = nullptr) noexcept;
+  };
+
+  class LIB_EXPORT EyeTrackerCursor final {
+   private:
+    inseye::c::InseyeCursor* implementation_pointer_;
+
+   public:
+    EyeTrackerCursor() = delete;
+    /**
+     * @brief Creates independent read position over tracker's shared memory,
+     * see CreateEyeTrackerCursor.
+     */
+    explicit EyeTrackerCursor(const EyeTracker& tracker) {
+      inseye::c::InseyeCursor* ptr = nullptr;
+      if (CreateEyeTrackerCursor(tracker.implementation_pointer_, &ptr) !=
+          inseye::c::InseyeInitializationStatus::kSuccess) {
+        throw std::runtime_error(inseye::c::GetLastErrorDescription());
+      }
+      implementation_pointer_ = ptr;
+    }
+
+    EyeTrackerCursor(EyeTrackerCursor&) = delete;
+
+    EyeTrackerCursor(EyeTrackerCursor&&) noexcept;
+
+    ~EyeTrackerCursor() noexcept;
+
+    [[nodiscard]] bool IsGazeDataAvailable() const noexcept;
+
+    bool TryReadLatestEyeTrackerData(EyeTrackerDataStruct& out_data) noexcept;
+
+    bool TryReadNextEyeTrackerData(EyeTrackerDataStruct& out_data) noexcept;
+
+    bool TryReadEyeTrackerDataBatch(std::span<EyeTrackerDataStruct> out_data,
+                                    uint32_t& count) noexcept;
+
+    bool AcquireReadLease(uint32_t max_count, Lease& lease) noexcept;
+
+    bool ReleaseReadLease(const Lease& lease,
+                          uint32_t* overwritten_count = nullptr) noexcept;
+
+    bool ReadEyeTrackerDataColumns(const EyeTrackerDataColumns& columns,
+                                   uint32_t capacity, uint32_t& count) noexcept;
+
+    bool WaitForEyeTrackerData(std::chrono::nanoseconds timeout) noexcept;
+
+    bool TryReadLastEyeTrackerData(EyeTrackerDataStruct& out_data) const noexcept;
+
+    bool TryReadEyeTrackerDataAt(double time, TimeQueryMode mode,
+                                 EyeTrackerDataStruct& out_data) const noexcept;
+
+    bool ReadEyeTrackerDataRange(uint64_t begin_time, uint64_t end_time,
+                                 std::span<EyeTrackerDataStruct> out_data,
+                                 uint32_t& count) const noexcept;
+
+    void SetFilterChain(std::span<const FilterStage> stages);
+
+    bool TryReadFilteredEyeTrackerDataBatch(
+        std::span<EyeTrackerDataStruct> raw_data,
+        std::span<EyeTrackerDataStruct> filtered_data,
+        uint32_t& count) noexcept;
+
+    void StartGazeClassification(const GazeClassifierOptions& options = {});
+
+    void StopGazeClassification() noexcept;
+
+    bool TryReadGazeSegments(std::span<GazeSegment> segments,
+                             uint32_t& count) noexcept;
+
+    bool PredictGaze(double target_time, GazePrediction& prediction) noexcept;
+    /**
+     * @brief Copies statistics of reads made with this cursor.
+     * @return false when library was built without reader statistics
+     */
+    bool GetReaderStatistics(ReaderStatistics& statistics) const noexcept;
+    /**
+     * @brief co_await returns next sample, suspending until it's published,
+     * see GazeDataAwaiter.
+     * @param executor where to resume, null resumes on library watcher thread
+     */
+    [[nodiscard]] NextSampleAwaiter NextSample(
+        Executor* executor = nullptr) noexcept;
+    /**
+     * @brief co_await reads up to out_data.size() samples, suspending until
+     * at least one is published, see GazeDataAwaiter.
+     */
+    [[nodiscard]] NextBatchAwaiter NextBatch(
+        std::span<EyeTrackerDataStruct> out_data,
+        Executor* executor = nullptr) noexcept;
+    /**
+     * @brief Returns asynchronous generator of samples, see SampleStream.
+     */
+    [[nodiscard]] SampleStream Samples(Executor* executor = nullptr) noexcept;
+  };
+
+  using AsyncOperationState = inseye::c::InseyeAsyncOperationState;
+
+  class LIB_EXPORT EyeTrackerCreation final {
+   private:
+    inseye::c::InseyeAsyncOperation* implementation_pointer_;
+
+   public:
+    EyeTrackerCreation() = delete;
+    /**
+     * @brief Starts eye tracker reader creation on internal connecting thread,
+     * see CreateEyeTrackerReaderAsync.
+     */
+    explicit EyeTrackerCreation(int32_t timeout_ms) {
+      inseye::c::InseyeAsyncOperation* ptr = nullptr;
+      if (CreateEyeTrackerReaderAsync(&ptr, timeout_ms) !=
+          inseye::c::InseyeInitializationStatus::kSuccess) {
+        throw std::runtime_error(inseye::c::GetLastErrorDescription());
+      }
+      implementation_pointer_ = ptr;
+    }
+
+    EyeTrackerCreation(EyeTrackerCreation&) = delete;
+
+    EyeTrackerCreation(EyeTrackerCreation&&) noexcept;
+    /**
+     * @brief Cancels unfinished creation without waiting for it to stop.
+     */
+    ~EyeTrackerCreation() noexcept;
+
+    [[nodiscard]] AsyncOperationState GetState() const noexcept;
+    /**
+     * @brief Requests cancellation, see CancelAsyncOperation.
+     */
+    bool Cancel() noexcept;
+    /**
+     * @brief Blocks until creation is finished or timeout elapses.
+     * @return true when creation is finished
+     */
+    bool Wait(std::chrono::milliseconds timeout) noexcept;
+    /**
+     * @brief Takes created reader, throws std::runtime_error when creation
+     * hasn't finished, failed, was cancelled or reader was already taken.
+     */
+    EyeTracker GetResult();
+  };
+
+  using GazeDataBatch = inseye::c::InseyeGazeDataBatch;
+  using SubscriptionOptions = inseye::c::InseyeSubscriptionOptions;
+
+  class LIB_EXPORT Subscription final {
+   private:
+    inseye::c::InseyeSubscription* implementation_pointer_;
+    void* callable_;
+    void (*destroy_callable_)(void*);
+
+    template <typename Callable>
+    static void CALL_CONV Invoke(const inseye::c::InseyeGazeDataBatch* batch,
+                                 void* callable) {
+      (*static_cast<Callable*>(callable))(*batch);
+    }
+
+   public:
+    Subscription() = delete;
+    /**
+     * @brief Delivers tracker's samples to callable on dispatcher thread, see
+     * SubscribeEyeTrackerData. Callable is invoked with const GazeDataBatch&
+     * and is destroyed after the dispatcher stops.
+     */
+    template <typename Callable>
+    Subscription(const EyeTracker& tracker, Callable&& callable,
+                 const SubscriptionOptions& options = {}) {
+      using Stored = std::decay_t<Callable>;
+      auto stored = std::make_unique<Stored>(std::forward<Callable>(callable));
+      inseye::c::InseyeSubscription* ptr = nullptr;
+      if (SubscribeEyeTrackerData(tracker.implementation_pointer_,
+                                  &Invoke<Stored>, stored.get(), &options,
+                                  &ptr) !=
+          inseye::c::InseyeInitializationStatus::kSuccess) {
+        throw std::runtime_error(inseye::c::GetLastErrorDescription());
+      }
+      implementation_pointer_ = ptr;
+      callable_ = stored.release();
+      destroy_callable_ = [](void* callable) {
+        delete static_cast<Stored*>(callable);
+      };
+    }
+
+    Subscription(Subscription&) = delete;
+
+    Subscription(Subscription&&) noexcept;
+    /**
+     * @brief Stops dispatcher, see UnsubscribeEyeTrackerData.
+     */
+    ~Subscription() noexcept;
+  };
+
+  class LIB_EXPORT Recorder final {
+   private:
+    inseye::c::InseyeRecorder* implementation_pointer_;
+
+   public:
+    Recorder() = delete;
+    /**
+     * @brief Starts recording of all gaze data to file at file_path.
+     */
+    Recorder(const std::string& file_path, int32_t timeout_ms,
+             const RecorderOptions& options = {}) {
+      inseye::c::InseyeRecorder* ptr = nullptr;
+      if (CreateEyeTrackerRecorder(&ptr, file_path.c_str(), &options,
+                                   timeout_ms) !=
+          inseye::c::InseyeInitializationStatus::kSuccess) {
+        throw std::runtime_error(inseye::c::GetLastErrorDescription());
+      }
+      implementation_pointer_ = ptr;
+    }
+
+    Recorder(Recorder&) = delete;
+
+    Recorder(Recorder&&) noexcept;
+
+    /**
+     * @brief Stops recording and writes all samples read so far.
+     */
+    ~Recorder() noexcept;
+
+    [[nodiscard]] RecorderState GetState() const noexcept;
+    /**
+     * @brief Returns number of samples committed to recording file.
+     */
+    [[nodiscard]] uint64_t GetRecordedSampleCount() const noexcept;
+  };
+
+  class LIB_EXPORT Recording final {
+   private:
+    inseye::c::InseyeRecording* implementation_pointer_;
+
+   public:
+    Recording() = delete;
+    /**
+     * @brief Opens recording for reading.
+     */
+    explicit Recording(const std::string& file_path) {
+      inseye::c::InseyeRecording* ptr = nullptr;
+      if (OpenEyeTrackerRecording(&ptr, file_path.c_str()) !=
+          inseye::c::InseyeInitializationStatus::kSuccess) {
+        throw std::runtime_error(inseye::c::GetLastErrorDescription());
+      }
+      implementation_pointer_ = ptr;
+    }
+
+    Recording(Recording&) = delete;
+
+    Recording(Recording&&) noexcept;
+
+    ~Recording() noexcept;
+
+    [[nodiscard]] uint64_t GetSampleCount() const noexcept;
+    /**
+     * @brief Reads up to out_data.size() samples starting at sample_position.
+     * @return true when at least one sample was read, otherwise false
+     */
+    bool Read(uint64_t sample_position,
+              std::span<EyeTrackerDataStruct> out_data,
+              uint32_t& count) const noexcept;
+    /**
+     * @brief Finds position of first sample with time not lower than time.
+     * @return true when such sample exists, otherwise false
+     */
+    bool Seek(uint64_t time, uint64_t& sample_position) const noexcept;
   };
 } // namespace inseye
 #undef CALL_CONV
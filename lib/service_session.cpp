@@ -0,0 +1,111 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include "service_session.hpp"
+#include <mutex>
+#include <utility>
+#include "allocator.hpp"
+#include "errors.hpp"
+#include "version.hpp"
+
+using namespace inseye::internal;
+
+namespace {
+// Cache holds strong reference, so that readers destroyed and created again
+// (e.g. on scene reload) don't reconnect.
+std::mutex cache_mutex;
+std::shared_ptr<ServiceSession> cached_session;
+
+// Checks that the service behind cached session still serves the same ring.
+// Doesn't talk to the service, restarted service closes the connection.
+bool IsSessionCurrent(const ServiceSession& session) {
+  if (!session.named_pipe_communicator.IsConnected())
+    return false;
+  const auto mapped_version = read_swap_endianess_if_needed(
+      reinterpret_cast<const PackedVersion*>(session.in_memory_buffer.data()));
+  const auto& header_version = session.shared_memory_header.GetVersion();
+  return mapped_version.major == header_version.major &&
+         mapped_version.minor == header_version.minor &&
+         mapped_version.patch == header_version.patch;
+}
+
+std::shared_ptr<ServiceSession> CreateServiceSession(
+    const std::function<bool()>& is_cancellation_requested) {
+  auto named_pipe_communicator =
+      NamedPipeCommunicator::Create(is_cancellation_requested);
+  ThrowIfCancellationRequested(is_cancellation_requested);
+  auto service_info =
+      named_pipe_communicator.GetServiceInfo(is_cancellation_requested);
+  auto shared_memory_object =
+      SharedMemoryObject::Open(service_info.shared_buffer_path);
+  auto shared_memory_header = ReadHeaderInternal(shared_memory_object);
+  auto file_view =
+      shared_memory_object.Map(shared_memory_header.GetBufferSize());
+  return MakeShared<ServiceSession>(
+      std::move(service_info), shared_memory_header,
+      std::move(shared_memory_object), std::move(file_view),
+      std::move(named_pipe_communicator));
+}
+
+// Reuses cached session unless it's stale one or the service is gone,
+// otherwise connects again. The lock is held only to read and publish the
+// cache, so connecting to hung service doesn't block other threads.
+std::shared_ptr<ServiceSession> AcquireSessionOtherThan(
+    const std::shared_ptr<const ServiceSession>& stale,
+    const std::function<bool()>& is_cancellation_requested) {
+  std::shared_ptr<ServiceSession> candidate;
+  {
+    std::lock_guard lock(cache_mutex);
+    candidate = cached_session;
+  }
+  if (candidate != nullptr && candidate != stale &&
+      IsSessionCurrent(*candidate))
+    return candidate;
+  auto created = CreateServiceSession(is_cancellation_requested);
+  // declared before the lock together with created, so that session dropped
+  // below is destroyed after the lock is released
+  std::shared_ptr<ServiceSession> replaced;
+  std::lock_guard lock(cache_mutex);
+  if (cached_session != candidate && cached_session != nullptr &&
+      cached_session != stale && IsSessionCurrent(*cached_session))
+    return cached_session;  // other thread connected in the meantime
+  replaced = std::exchange(cached_session, created);
+  return created;
+}
+}  // namespace
+
+std::shared_ptr<ServiceSession> inseye::internal::AcquireServiceSession(
+    const std::function<bool()>& is_cancellation_requested) {
+  return AcquireSessionOtherThan(nullptr, is_cancellation_requested);
+}
+
+std::shared_ptr<ServiceSession> inseye::internal::ReplaceServiceSession(
+    const std::shared_ptr<const ServiceSession>& stale,
+    const std::function<bool()>& is_cancellation_requested) {
+  return AcquireSessionOtherThan(stale, is_cancellation_requested);
+}
+
+void inseye::internal::ReleaseServiceSession(
+    std::shared_ptr<const ServiceSession> session) noexcept {
+  std::shared_ptr<ServiceSession> released;
+  {
+    std::lock_guard lock(cache_mutex);
+    // readers and cursors take their references only under the cache lock or
+    // from other reader, so the count can't grow while it's held
+    if (session != nullptr && session == cached_session &&
+        session.use_count() == 2)
+      released = std::move(cached_session);
+  }
+}
+
+void inseye::internal::ReleaseCachedServiceSession() noexcept {
+  std::shared_ptr<ServiceSession> released;
+  {
+    std::lock_guard lock(cache_mutex);
+    released = std::move(cached_session);
+  }
+}
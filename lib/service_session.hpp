@@ -0,0 +1,74 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#ifndef REMOTE_CONNECTOR_LIB_SERVICE_SESSION_HPP
+#define REMOTE_CONNECTOR_LIB_SERVICE_SESSION_HPP
+#include <functional>
+#include <memory>
+#include "clock_model.hpp"
+#include "named_pipe_communicator.hpp"
+#include "shared_memory_header.hpp"
+#include "transport.hpp"
+
+namespace inseye::internal {
+
+/**
+ * @brief Connection to the service and mapping of its gaze ring, shared by
+ * every reader and cursor created while the service stays the same. Released
+ * together with the last of them. Only the clock model is touched while
+ * reading.
+ */
+struct ServiceSession {
+  ServiceInfo service_info;
+  SharedMemoryHeader shared_memory_header;
+  SharedMemoryObject shared_memory_object;
+  SharedMemoryView in_memory_buffer;
+  // connection checks don't change the session
+  mutable NamedPipeCommunicator named_pipe_communicator;
+  // estimate of the service clock fed by every reader of the session
+  mutable ClockModel clock_model{};
+};
+
+/**
+ * @brief Returns process wide session, connecting to the service and mapping
+ * the ring only when there is no cached session or the cached one is stale.
+ * Cached session is reused without talking to the service while its
+ * connection is open and mapped header still holds the same version. Broken
+ * connection or different version replaces the cached session, readers of the
+ * old one keep it until they are destroyed. Cache lock isn't held while
+ * checking or connecting, so hung service blocks only the calling thread and
+ * no longer than service response timeout.
+ * Throws InitializationException or NamedPipeException on failure.
+ */
+std::shared_ptr<ServiceSession> AcquireServiceSession(
+    const std::function<bool()>& is_cancellation_requested);
+
+/**
+ * @brief Returns session of the service that replaced the one behind stale
+ * session. Cached session other than stale one is reused when it's current,
+ * otherwise the service is connected to again and the new session is cached.
+ * Throws InitializationException or NamedPipeException on failure.
+ */
+std::shared_ptr<ServiceSession> ReplaceServiceSession(
+    const std::shared_ptr<const ServiceSession>& stale,
+    const std::function<bool()>& is_cancellation_requested);
+
+/**
+ * @brief Drops reference to the session and removes it from the cache when
+ * nobody else uses it, so that connection and mapping are freed right away.
+ */
+void ReleaseServiceSession(
+    std::shared_ptr<const ServiceSession> session) noexcept;
+
+/**
+ * @brief Drops cache reference to the session, next AcquireServiceSession
+ * connects again.
+ */
+void ReleaseCachedServiceSession() noexcept;
+
+}  // namespace inseye::internal
+#endif  //REMOTE_CONNECTOR_LIB_SERVICE_SESSION_HPP
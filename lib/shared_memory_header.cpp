@@ -7,9 +7,9 @@
 // All other rights reserved.
 
 #include "shared_memory_header.hpp"
-#include <windows.h>
+#include <atomic>
+#include <cstddef>
 #include <sstream>
-#include <utility>
 #include "endianess_helpers.hpp"
 #include "errors.hpp"
 #include "remote_connector.h"
@@ -17,7 +17,7 @@
 
 using namespace inseye::internal;
 constexpr PackedVersion lowest_supported = {0, 0, 1};
-constexpr PackedVersion highest_supported = {1, 0, 0};
+constexpr PackedVersion highest_supported = {2, 0, 0};
 const inseye::c::InseyeVersion inseye::c::kLowestSupportedServiceVersion = {
     lowest_supported.major, lowest_supported.minor, lowest_supported.patch
 };
@@ -32,146 +32,152 @@ const inseye::Version inseye::highestSupportedServiceVersion = {
     highest_supported.major, highest_supported.minor, highest_supported.patch
 };
 
-#pragma pack(push, 1)
-struct InMemoryV1 {
-  InMemoryV1() = delete;
-  PackedVersion version;
-  uint32_t header_size;
-  uint32_t buffer_size;
-  uint32_t sample_size;
-  volatile uint32_t samples_written;
-};
-#pragma pack(pop)
-
-class SharedMemoryHeaderV1 final : SharedMemoryHeader {
-  std::unique_ptr<InMemoryV1, std::function<void (InMemoryV1*)>> header_memory_;
-  const inseye::Version version_;
-  const uint32_t header_size_;
-  const uint32_t sample_size_;
-  const uint32_t buffer_size_;
-  const uint32_t total_samples_count_;
-
-public:
-  static constexpr inseye::Version minimumVersion = {
-      lowest_supported.major, lowest_supported.minor, lowest_supported.patch
-  };
-  static constexpr inseye::Version maximumVersion = {
-      highest_supported.major, highest_supported.minor, highest_supported.patch
-  };
-
-  SharedMemoryHeaderV1(
-      std::unique_ptr<InMemoryV1, std::function<void (InMemoryV1*)>> memory,
-      const inseye::Version &version,
-      uint32_t header_size,
-      uint32_t sample_size,
-      uint32_t buffer_size,
-      uint32_t total_samples_count);
-
-  [[nodiscard]] const inseye::Version& GetVersion() const override;
-
-  [[nodiscard]] uint32_t ReadSamplesWrittenCount() const override;
-
-  [[nodiscard]] const uint32_t& GetHeaderSize() const override;
-
-  [[nodiscard]] const uint32_t& GetDataSampleSize() const override;
-
-  [[nodiscard]] const uint32_t& GetSampleCount() const override;
-  [[nodiscard]] const uint32_t& GetBufferSize() const override;
 
-  ~SharedMemoryHeaderV1() override;
-
-};
+SharedMemoryHeader::SharedMemoryHeader(const inseye::Version& version,
+                                       const uint32_t header_size,
+                                       const uint32_t sample_size,
+                                       const uint32_t buffer_size,
+                                       const uint32_t samples_written_offset,
+                                       const uint32_t sequence_offset)
+    : version_(version),
+      header_size_(header_size),
+      sample_size_(sample_size),
+      buffer_size_(buffer_size),
+      sample_count_((buffer_size - header_size) / sample_size),
+      samples_written_offset_(samples_written_offset),
+      sequence_offset_(sequence_offset) {}
+
+RingState SharedMemoryHeader::MakeRingState(
+    const SharedMemoryView& buffer) const {
+  const bool power_of_two = (sample_count_ & (sample_count_ - 1)) == 0;
+  return {
+      buffer.data() + header_size_,
+      reinterpret_cast<const uint32_t*>(buffer.data() +
+                                        samples_written_offset_),
+      header_size_,
+      sample_size_,
+      sample_count_,
+      buffer_size_,
+      power_of_two ? sample_count_ - 1 : 0,
+      sequence_offset_};
+}
 
+namespace {
+void ThrowIfRingTooSmall(uint32_t header_size, uint32_t sample_size,
+                         uint32_t buffer_size) {
+  // read protocol requires at least two slots, see remote_connector.cpp
+  if (sample_size == 0 || header_size > buffer_size ||
+      (buffer_size - header_size) / sample_size < 2) {
+    ThrowInitialization(
+        "Invalid shared memory header, ring buffer must hold at least two "
+        "samples.",
+        inseye::c::InseyeInitializationStatus::kFailedToMapSharedResources);
+  }
+}
 
-SharedMemoryHeaderV1* createSharedMemoryHeaderV1(HANDLE shared_memory_handle, const inseye::Version& version) {
-  auto mapped_memory = std::unique_ptr<
-    InMemoryV1, std::function<void (InMemoryV1*)>>(
-      static_cast<InMemoryV1*>(MapViewOfFile(shared_memory_handle,
-                                             FILE_MAP_READ, 0, 0,
-                                             sizeof(InMemoryV1))),
-      [](const InMemoryV1* cleaned) -> void {
-        UnmapViewOfFile(cleaned);
-      });
+SharedMemoryHeader createSharedMemoryHeaderV1(
+    const SharedMemoryObject& shared_memory_object,
+    const inseye::Version& version) {
+  const auto header_view = shared_memory_object.Map(sizeof(InMemoryV1));
+  auto mapped_memory = reinterpret_cast<const InMemoryV1*>(header_view.data());
   auto buffer_size =
       read_swap_endianess_if_needed<uint32_t>(&mapped_memory->buffer_size);
   auto header_size =
       read_swap_endianess_if_needed<uint32_t>(&mapped_memory->header_size);
   auto sample_size =
       read_swap_endianess_if_needed<uint32_t>(&mapped_memory->sample_size);
-  return new SharedMemoryHeaderV1(std::move(mapped_memory), version,
-      header_size,
-      sample_size,
-      buffer_size,
-      (buffer_size - header_size) / sample_size);
+  // samples written counter is read through mapping of whole buffer so it
+  // must lie inside of the header
+  if (header_size < sizeof(InMemoryV1)) {
+    ThrowInitialization(
+        "Invalid shared memory header, header is smaller than its fields.",
+        inseye::c::InseyeInitializationStatus::kFailedToMapSharedResources);
+  }
+  ThrowIfRingTooSmall(header_size, sample_size, buffer_size);
+  return {version, header_size, sample_size, buffer_size,
+          offsetof(InMemoryV1, samples_written)};
 }
 
-SharedMemoryHeaderV1::~SharedMemoryHeaderV1() = default;
-
-const inseye::Version& SharedMemoryHeaderV1::GetVersion() const {
-  return version_;
+SharedMemoryHeader createSharedMemoryHeaderV2(
+    const SharedMemoryObject& shared_memory_object,
+    const inseye::Version& version) {
+  const auto header_view = shared_memory_object.Map(sizeof(InMemoryV2));
+  auto mapped_memory = reinterpret_cast<const InMemoryV2*>(header_view.data());
+  auto buffer_size =
+      read_swap_endianess_if_needed<uint32_t>(&mapped_memory->buffer_size);
+  auto header_size =
+      read_swap_endianess_if_needed<uint32_t>(&mapped_memory->header_size);
+  auto sample_size =
+      read_swap_endianess_if_needed<uint32_t>(&mapped_memory->sample_size);
+  if (header_size < sizeof(InMemoryV2) || header_size % kCacheLineSize != 0) {
+    ThrowInitialization(
+        "Invalid shared memory header, header must hold its fields and end "
+        "on cache line boundary.",
+        inseye::c::InseyeInitializationStatus::kFailedToMapSharedResources);
+  }
+  if (sample_size < kSequenceStampOffsetV2 + sizeof(uint32_t) ||
+      sample_size % kSlotAlignmentV2 != 0) {
+    ThrowInitialization(
+        "Invalid shared memory header, sample slot must hold sample with "
+        "sequence stamp and be multiple of 32 bytes.",
+        inseye::c::InseyeInitializationStatus::kFailedToMapSharedResources);
+  }
+  ThrowIfRingTooSmall(header_size, sample_size, buffer_size);
+  return {version,
+          header_size,
+          sample_size,
+          buffer_size,
+          offsetof(InMemoryV2, samples_written),
+          kSequenceStampOffsetV2};
 }
 
-SharedMemoryHeaderV1::SharedMemoryHeaderV1(
-    std::unique_ptr<InMemoryV1, std::function<void (InMemoryV1*)>> memory,
-    const inseye::Version &version,
-    const uint32_t header_size,
-    const uint32_t sample_size,
-    const uint32_t buffer_size,
-    const uint32_t total_samples_count
-    ) : header_memory_(std::move(memory)), version_(version),
-        header_size_(header_size), sample_size_(sample_size),
-        buffer_size_(buffer_size), total_samples_count_(total_samples_count) {}
+struct HeaderLayout {
+  // layout is used from this major version up to the next entry, minor and
+  // patch versions never change layout
+  uint32_t lowest_major;
+  SharedMemoryHeader (*create)(const SharedMemoryObject& shared_memory_object,
+                               const inseye::Version& version);
+};
+
+// ordered by major version
+const HeaderLayout header_layouts[] = {
+    {lowest_supported.major, createSharedMemoryHeaderV1},
+    {2, createSharedMemoryHeaderV2},
+};
+}  // namespace
 
-SharedMemoryHeader* inseye::internal::ReadHeaderInternal(
-    HANDLE share_file_handle) {
+SharedMemoryHeader inseye::internal::ReadHeaderInternal(
+    const SharedMemoryObject& shared_memory_object) {
   // map as little memory as required
-  auto memory = static_cast<LPBYTE>(MapViewOfFile(
-      share_file_handle,
-      FILE_MAP_READ,
-      0, 0, sizeof(PackedVersion)));
-  // check header version
-  const PackedVersion packedVersion = read_swap_endianess_if_needed(reinterpret_cast<PackedVersion*>(memory));
+  PackedVersion packedVersion{};
+  {
+    const auto memory = shared_memory_object.Map(sizeof(PackedVersion));
+    // check header version
+    packedVersion = read_swap_endianess_if_needed(
+        reinterpret_cast<const PackedVersion*>(memory.data()));
+  }
   const Version headerVersion = {
       packedVersion.major, packedVersion.minor, packedVersion.patch
   };
-  UnmapViewOfFile(memory);
-  if (headerVersion < SharedMemoryHeaderV1::minimumVersion) {
+  if (headerVersion < inseye::lowestSupportedServiceVersion) {
     std::stringstream ss;
     ss << "Library doesn't support service in version: " << headerVersion <<
-        "lowest supported version is: " <<
+        ", lowest supported version is: " <<
         inseye::lowestSupportedServiceVersion;
     ThrowInitialization(
         ss.str(), inseye::c::InseyeInitializationStatus::kServiceVersionToLow);
   }
-  if (headerVersion < SharedMemoryHeaderV1::minimumVersion && headerVersion >=
-      SharedMemoryHeaderV1::maximumVersion) {
+  if (headerVersion.major > inseye::highestSupportedServiceVersion.major) {
     std::stringstream ss;
     ss << "Library doesn't support service in version: " << headerVersion <<
-        ", highest  supported version is: " <<
-        inseye::highestSupportedServiceVersion;
+        ", highest supported major version is: " <<
+        inseye::highestSupportedServiceVersion.major;
     ThrowInitialization(
         ss.str(), inseye::c::InseyeInitializationStatus::kServiceVersionToHigh);
   }
-  return reinterpret_cast<SharedMemoryHeader*>(createSharedMemoryHeaderV1(share_file_handle, headerVersion));
-}
-
-uint32_t SharedMemoryHeaderV1::ReadSamplesWrittenCount() const {
-  auto samples_written = header_memory_->samples_written;
-  return read_swap_endianess_if_needed<decltype(samples_written)>(&samples_written);
-}
-
-const uint32_t& SharedMemoryHeaderV1::GetHeaderSize() const {
-  return header_size_;
+  const HeaderLayout* layout = header_layouts;
+  for (const auto& candidate : header_layouts)
+    if (headerVersion.major >= candidate.lowest_major)
+      layout = &candidate;
+  return layout->create(shared_memory_object, headerVersion);
 }
-
-const uint32_t& SharedMemoryHeaderV1::GetDataSampleSize() const {
-  return sample_size_;
-}
-
-const uint32_t& SharedMemoryHeaderV1::GetSampleCount() const {
-  return total_samples_count_;
-}
-
-const uint32_t& SharedMemoryHeaderV1::GetBufferSize() const {
-  return buffer_size_;
-}
\ No newline at end of file
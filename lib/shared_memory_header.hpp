@@ -8,22 +8,151 @@
 
 #ifndef SHARED_MEMORY_HEADER_HPP
 #define SHARED_MEMORY_HEADER_HPP
-#include "windows.h"
+#include <atomic>
+#include <cstddef>
+#include "endianess_helpers.hpp"
+#include "eye_tracker_data_struct.hpp"
 #include "remote_connector.h"
+#include "transport.hpp"
+#include "version.hpp"
 
 namespace inseye::internal {
-    class  SharedMemoryHeader {
+#pragma pack(push, 1)
+    // Shared memory header in version 1.x, ring of samples follows the header.
+    struct InMemoryV1 {
+        InMemoryV1() = delete;
+        PackedVersion version;
+        uint32_t header_size;
+        uint32_t buffer_size;
+        uint32_t sample_size;
+        // written by service with release semantics after the sample is stored,
+        // read with acquire semantics through std::atomic_ref
+        uint32_t samples_written;
+    };
+#pragma pack(pop)
+    static_assert(offsetof(InMemoryV1, samples_written) %
+                          std::atomic_ref<uint32_t>::required_alignment ==
+                      0,
+                  "samples_written must be naturally aligned for atomic access");
+
+    // Shared memory header in version 2.x. Samples written counter, the only
+    // header field service keeps writing, has cache line of its own. Ring of
+    // slots starts at header_size (multiple of 64) and every slot takes
+    // sample_size bytes (multiple of 32), so slots never straddle cache lines.
+    // Slot holds packed sample followed by sequence stamp: index of the sample
+    // stored in the slot, 0 while the slot is being rewritten.
+    struct InMemoryV2 {
+        InMemoryV2() = delete;
+        PackedVersion version;
+        uint32_t header_size;
+        uint32_t buffer_size;
+        uint32_t sample_size;
+        alignas(64) uint32_t samples_written;
+        std::byte samples_written_line_padding[60];
+    };
+    static_assert(offsetof(InMemoryV2, samples_written) == 64 &&
+                      sizeof(InMemoryV2) == 128,
+                  "samples_written must fill cache line of its own");
+    constexpr uint32_t kSlotAlignmentV2 = 32;
+    constexpr uint32_t kCacheLineSize = 64;
+    constexpr uint32_t kSequenceStampOffsetV2 = sizeof(EyeTrackerDataStruct);
+
+    /**
+     * @brief Ring buffer geometry and addresses used on every read, packed in
+     * single cache line so that read path doesn't chase pointers.
+     */
+    struct alignas(64) RingState {
+        // first ring slot
+        const std::byte* samples = nullptr;
+        // samples written counter in shared memory, stored in LIB_ENDIAN
+        const uint32_t* samples_written = nullptr;
+        uint32_t header_size = 0;
+        uint32_t sample_size = 0;
+        uint32_t sample_count = 0;
+        uint32_t buffer_size = 0;
+        // sample_count - 1 when sample_count is power of two, otherwise 0
+        uint32_t slot_mask = 0;
+        // offset of sequence stamp in slot, 0 for layouts without stamps
+        // (sample time is stored there)
+        uint32_t sequence_offset = 0;
+
+        [[nodiscard]] uint32_t SlotOf(uint32_t sample_index) const noexcept {
+            return slot_mask != 0 ? sample_index & slot_mask
+                                  : sample_index % sample_count;
+        }
+
+        [[nodiscard]] const std::byte* SampleAddress(uint32_t sample_index) const noexcept {
+            return samples + static_cast<size_t>(SlotOf(sample_index)) * sample_size;
+        }
+
+        [[nodiscard]] uint32_t LoadSamplesWritten() const noexcept {
+            // mapping is read only, atomic_ref only performs loads through it
+            const uint32_t samples_written_count =
+                std::atomic_ref<uint32_t>(*const_cast<uint32_t*>(samples_written))
+                    .load(std::memory_order_acquire);
+            return read_swap_endianess_if_needed<uint32_t>(&samples_written_count);
+        }
+
+        [[nodiscard]] bool HasSequenceStamps() const noexcept {
+            return sequence_offset != 0;
+        }
+
+        /**
+         * @brief Loads index of the sample stored in slot, 0 while the slot is
+         * being rewritten. Layout must have sequence stamps.
+         */
+        [[nodiscard]] uint32_t LoadSequenceStamp(const std::byte* slot,
+                                                 std::memory_order order) const noexcept {
+            const uint32_t stamp =
+                std::atomic_ref<uint32_t>(*const_cast<uint32_t*>(
+                    reinterpret_cast<const uint32_t*>(slot + sequence_offset)))
+                    .load(order);
+            return read_swap_endianess_if_needed<uint32_t>(&stamp);
+        }
+    };
+    static_assert(sizeof(RingState) == 64, "Ring state must fill single cache line");
+
+    /**
+     * @brief Validated shared memory header. Read once on reader creation,
+     * layout differences between header versions end here.
+     */
+    class SharedMemoryHeader {
+        Version version_;
+        uint32_t header_size_;
+        uint32_t sample_size_;
+        uint32_t buffer_size_;
+        uint32_t sample_count_;
+        // offset of samples written counter from the beginning of the mapping
+        uint32_t samples_written_offset_;
+        // offset of sequence stamp in slot, 0 when slots have none
+        uint32_t sequence_offset_;
+
     public:
-        virtual ~SharedMemoryHeader() = default;
-        [[nodiscard]] virtual const Version & GetVersion() const = 0;
-        [[nodiscard]] virtual uint32_t ReadSamplesWrittenCount() const = 0;
-        [[nodiscard]] virtual const uint32_t & GetHeaderSize() const = 0;
-        [[nodiscard]] virtual const uint32_t & GetDataSampleSize() const = 0;
-        [[nodiscard]] virtual const uint32_t & GetSampleCount() const = 0;
-        [[nodiscard]] virtual const uint32_t & GetBufferSize() const = 0;
+        SharedMemoryHeader(const Version& version, uint32_t header_size,
+                           uint32_t sample_size, uint32_t buffer_size,
+                           uint32_t samples_written_offset,
+                           uint32_t sequence_offset = 0);
+
+        [[nodiscard]] const Version& GetVersion() const { return version_; }
+        [[nodiscard]] uint32_t GetHeaderSize() const { return header_size_; }
+        [[nodiscard]] uint32_t GetDataSampleSize() const { return sample_size_; }
+        [[nodiscard]] uint32_t GetSampleCount() const { return sample_count_; }
+        [[nodiscard]] uint32_t GetBufferSize() const { return buffer_size_; }
+        [[nodiscard]] bool HasSequenceStamps() const { return sequence_offset_ != 0; }
+        /**
+         * @brief Creates read path state for mapping of whole buffer
+         * (at least GetBufferSize() bytes).
+         */
+        [[nodiscard]] RingState MakeRingState(const SharedMemoryView& buffer) const;
     };
 
-    SharedMemoryHeader * ReadHeaderInternal(HANDLE share_file_handle);
+    /**
+     * @brief Reads and validates header of shared memory object, layout is
+     * selected by header version.
+     * Throws InitializationException when version is not supported or header
+     * is malformed.
+     */
+    SharedMemoryHeader ReadHeaderInternal(const SharedMemoryObject & shared_memory_object);
 }
 
 
@@ -0,0 +1,199 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "allocator.hpp"
+#include "errors.hpp"
+#include "reader_internal.hpp"
+#include "remote_connector.h"
+#include "transport.hpp"
+
+constexpr uint32_t default_subscription_batch_size = 64;
+// longest sleep between checks of stop request
+constexpr auto dispatcher_wait_slice = std::chrono::milliseconds(10);
+
+struct inseye::c::InseyeSubscription {
+  inseye::c::InseyeCursor* cursor = nullptr;
+  inseye::c::InseyeGazeDataCallback callback = nullptr;
+  void* user_data = nullptr;
+  std::chrono::microseconds max_latency{};
+  inseye::c::InseyeSubscriptionOptions options{};
+  // batch buffer, allocated once so the dispatcher doesn't allocate
+  std::vector<inseye::c::InseyeEyeTrackerDataStruct,
+              inseye::internal::Allocator<inseye::c::InseyeEyeTrackerDataStruct>>
+      batch;
+  std::atomic<bool> stop_requested = false;
+  std::thread thread;
+
+  ~InseyeSubscription() { inseye::c::DestroyEyeTrackerCursor(&cursor); }
+};
+
+namespace {
+using clock_type = std::chrono::steady_clock;
+
+void Deliver(inseye::c::InseyeSubscription& subscription, uint32_t count,
+             uint32_t dropped) {
+  const inseye::c::InseyeGazeDataBatch batch{subscription.batch.data(), count,
+                                             dropped};
+  subscription.callback(&batch, subscription.user_data);
+}
+
+uint64_t ToWaitNanoseconds(clock_type::duration duration) {
+  return static_cast<uint64_t>((std::max)(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(),
+      std::chrono::nanoseconds::rep{0}));
+}
+
+// Batch collects samples until it's full or its oldest sample waited for
+// max_latency. Overrun splits the batch, samples before the gap are delivered
+// first and the next batch carries number of dropped samples.
+void Dispatch(inseye::c::InseyeSubscription& subscription) {
+  auto& cursor = *subscription.cursor;
+  const auto capacity = static_cast<uint32_t>(subscription.batch.size());
+  auto* const samples = subscription.batch.data();
+  uint32_t filled = 0;
+  uint32_t batch_dropped = 0;
+  auto batch_deadline = clock_type::now();
+  while (!subscription.stop_requested.load(std::memory_order_relaxed)) {
+    if (filled == 0 &&
+        !inseye::c::WaitForCursorData(&cursor,
+                                      ToWaitNanoseconds(dispatcher_wait_slice)))
+      continue;
+    uint32_t count = 0, dropped = 0;
+    if (inseye::internal::TryReadCursorDataBatch(cursor, samples + filled,
+                                                 capacity - filled, count,
+                                                 dropped)) {
+      if (dropped != 0 && filled != 0) {
+        Deliver(subscription, filled, batch_dropped);
+        std::memmove(samples, samples + filled, count * sizeof(*samples));
+        filled = 0;
+      }
+      if (filled == 0) {
+        batch_dropped = dropped;
+        batch_deadline = clock_type::now() + subscription.max_latency;
+      }
+      filled += count;
+    }
+    if (filled == 0)
+      continue;
+    const auto now = clock_type::now();
+    if (filled == capacity || now >= batch_deadline) {
+      Deliver(subscription, filled, batch_dropped);
+      filled = 0;
+      continue;
+    }
+    inseye::c::WaitForCursorData(
+        &cursor, ToWaitNanoseconds((std::min)(
+                     batch_deadline - now,
+                     clock_type::duration(dispatcher_wait_slice))));
+  }
+  if (filled != 0)
+    Deliver(subscription, filled, batch_dropped);
+}
+
+void RunDispatcher(inseye::c::InseyeSubscription& subscription,
+                   std::promise<std::string>& started) {
+  try {
+    inseye::internal::ConfigureCurrentThread(
+        subscription.options.cpu_affinity_mask,
+        subscription.options.realtime_priority);
+  } catch (const InitializationException&) {
+    // ThrowInitialization stored description in this thread's buffer
+    started.set_value(inseye::c::GetLastErrorDescription());
+    return;
+  }
+  started.set_value({});
+  Dispatch(subscription);
+}
+}  // namespace
+
+inseye::c::InseyeInitializationStatus inseye::c::SubscribeEyeTrackerData(
+    struct inseye::c::InseyeEyeTracker* tracker,
+    inseye::c::InseyeGazeDataCallback callback, void* user_data,
+    const struct inseye::c::InseyeSubscriptionOptions* options,
+    struct inseye::c::InseyeSubscription** pptr) {
+  if (tracker == nullptr || callback == nullptr || pptr == nullptr) {
+    WriteErrorMessage(
+        "Eye tracker reader, callback and subscription address are required.");
+    return inseye::c::InseyeInitializationStatus::kFailure;
+  }
+  inseye::internal::UniquePtr<inseye::c::InseyeSubscription> subscription;
+  try {
+    subscription =
+        inseye::internal::MakeUnique<inseye::c::InseyeSubscription>();
+    subscription->callback = callback;
+    subscription->user_data = user_data;
+    if (options != nullptr)
+      subscription->options = *options;
+    subscription->max_latency =
+        std::chrono::microseconds(subscription->options.max_latency_us);
+    const uint32_t batch_size = subscription->options.max_batch_size == 0
+                                    ? default_subscription_batch_size
+                                    : subscription->options.max_batch_size;
+    subscription->batch.resize(batch_size);
+  } catch (const std::bad_alloc&) {
+    WriteErrorMessage("Failed to allocate subscription.");
+    return inseye::c::InseyeInitializationStatus::kFailure;
+  }
+  const auto status =
+      inseye::c::CreateEyeTrackerCursor(tracker, &subscription->cursor);
+  if (status != inseye::c::InseyeInitializationStatus::kSuccess)
+    return status;
+  std::promise<std::string> started;
+  try {
+    subscription->thread =
+        std::thread(RunDispatcher, std::ref(*subscription), std::ref(started));
+  } catch (const std::system_error& error) {
+    WriteErrorMessage(error.what());
+    return inseye::c::InseyeInitializationStatus::kInternalError;
+  } catch (const std::bad_alloc&) {
+    WriteErrorMessage("Failed to allocate dispatcher thread.");
+    return inseye::c::InseyeInitializationStatus::kFailure;
+  }
+  const auto error_message = started.get_future().get();
+  if (!error_message.empty()) {
+    subscription->thread.join();
+    WriteErrorMessage(error_message);
+    return inseye::c::InseyeInitializationStatus::kFailure;
+  }
+  *pptr = subscription.release();
+  return inseye::c::InseyeInitializationStatus::kSuccess;
+}
+
+void inseye::c::UnsubscribeEyeTrackerData(
+    struct inseye::c::InseyeSubscription** pptr) {
+  if (pptr == nullptr || *pptr == nullptr)
+    return;
+  (*pptr)->stop_requested.store(true, std::memory_order_relaxed);
+  if ((*pptr)->thread.joinable())
+    (*pptr)->thread.join();
+  inseye::internal::Delete(*pptr);
+  *pptr = nullptr;
+}
+
+inseye::Subscription::Subscription(Subscription&& other) noexcept
+    : implementation_pointer_(other.implementation_pointer_),
+      callable_(other.callable_),
+      destroy_callable_(other.destroy_callable_) {
+  other.implementation_pointer_ = nullptr;
+  other.callable_ = nullptr;
+}
+
+inseye::Subscription::~Subscription() noexcept {
+  inseye::c::UnsubscribeEyeTrackerData(&implementation_pointer_);
+  if (callable_ != nullptr)
+    destroy_callable_(callable_);
+}
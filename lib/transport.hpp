@@ -0,0 +1,154 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#ifndef REMOTE_CONNECTOR_LIB_TRANSPORT_HPP
+#define REMOTE_CONNECTOR_LIB_TRANSPORT_HPP
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Platform abstraction over everything the library needs from the operating
+// system to talk to desktop service:
+// - message oriented connection used for the handshake
+//   (Windows named pipe / Linux AF_UNIX SOCK_SEQPACKET socket),
+// - read only access to named shared memory holding gaze ring buffer
+//   (Windows file mapping / POSIX shm_open + mmap),
+// - waiting for a change of a word in shared memory
+//   (Linux futex / Windows short sleep),
+// - scheduling of library owned threads.
+// Implementations live in transport_win32.cpp and transport_posix.cpp.
+namespace inseye::internal {
+
+#if defined(_WIN32)
+using NativeHandle = void*;
+#else
+using NativeHandle = int;
+#endif
+
+/**
+ * @brief Name of desktop service endpoint. INSEYE_SERVICE_ENDPOINT environment
+ * variable replaces it, so that tests can run simulator next to the service.
+ */
+std::string ServiceEndpointName();
+
+// How often waits for the service check their cancellation function.
+constexpr std::chrono::milliseconds service_wait_cancellation_interval{10};
+
+class ServiceConnection {
+  NativeHandle handle_;
+  explicit ServiceConnection(NativeHandle handle) noexcept;
+
+ public:
+  /**
+   * @brief Connects to desktop service endpoint.
+   * Throws InitializationException on failure.
+   */
+  static ServiceConnection Connect(
+      const std::function<bool()>& should_cancel_function);
+  /**
+   * @brief Checks if desktop service endpoint exists without connecting to it.
+   */
+  static bool EndpointExists();
+  ServiceConnection(const ServiceConnection&) = delete;
+  ServiceConnection& operator=(const ServiceConnection&) = delete;
+  ServiceConnection(ServiceConnection&& other) noexcept;
+  ServiceConnection& operator=(ServiceConnection&& other) noexcept;
+  ~ServiceConnection();
+  /**
+   * @brief Sends single message, waiting for the service no longer than until
+   * deadline or cancellation.
+   * Throws InitializationException when cancelled.
+   * @return true when whole message was sent
+   */
+  bool Write(const std::byte* data, size_t size,
+             std::chrono::steady_clock::time_point deadline,
+             const std::function<bool()>& should_cancel_function);
+  /**
+   * @brief Receives single message, waiting for the service no longer than
+   * until deadline or cancellation.
+   * Throws NamedPipeException on failure, timeout or when message doesn't fit
+   * in destination buffer and InitializationException when cancelled.
+   * @return number of bytes written to destination
+   */
+  size_t Read(std::byte* destination, size_t capacity,
+              std::chrono::steady_clock::time_point deadline,
+              const std::function<bool()>& should_cancel_function);
+  /**
+   * @brief Checks without blocking and without consuming messages whether
+   * the service still holds its end of the connection.
+   */
+  bool IsPeerConnected() noexcept;
+};
+
+class SharedMemoryView {
+  const std::byte* data_ = nullptr;
+  size_t size_ = 0;
+
+ public:
+  SharedMemoryView() noexcept = default;
+  SharedMemoryView(const std::byte* data, size_t size) noexcept;
+  SharedMemoryView(const SharedMemoryView&) = delete;
+  SharedMemoryView& operator=(const SharedMemoryView&) = delete;
+  SharedMemoryView(SharedMemoryView&& other) noexcept;
+  SharedMemoryView& operator=(SharedMemoryView&& other) noexcept;
+  ~SharedMemoryView();
+  [[nodiscard]] const std::byte* data() const noexcept { return data_; }
+  [[nodiscard]] size_t size() const noexcept { return size_; }
+};
+
+class SharedMemoryObject {
+  NativeHandle handle_;
+  explicit SharedMemoryObject(NativeHandle handle) noexcept;
+
+ public:
+  /**
+   * @brief Opens named shared memory object for reading.
+   * Throws InitializationException on failure.
+   */
+  static SharedMemoryObject Open(const std::string& name);
+  SharedMemoryObject(const SharedMemoryObject&) = delete;
+  SharedMemoryObject& operator=(const SharedMemoryObject&) = delete;
+  SharedMemoryObject(SharedMemoryObject&& other) noexcept;
+  SharedMemoryObject& operator=(SharedMemoryObject&& other) noexcept;
+  ~SharedMemoryObject();
+  /**
+   * @brief Maps first size bytes of shared memory object as read only.
+   * Throws InitializationException on failure.
+   */
+  [[nodiscard]] SharedMemoryView Map(size_t size) const;
+};
+
+enum class SharedValueWaitResult {
+  kWokenUp,       // writer explicitly woke up waiting threads
+  kValueChanged,  // value differed from expected or wait was interrupted
+  kTimeout
+};
+
+/**
+ * @brief Blocks calling thread until value at address may have changed from
+ * expected or until timeout elapses.
+ * On Linux waits on shared futex, so writer that calls FUTEX_WAKE on the
+ * address after publishing wakes the waiter immediately. On Windows there is
+ * no cross process address wait, the function sleeps for at most 1 ms.
+ */
+SharedValueWaitResult WaitForSharedValueChange(
+    const uint32_t* address, uint32_t expected,
+    std::chrono::nanoseconds timeout) noexcept;
+
+/**
+ * @brief Pins calling thread to CPUs set in affinity_mask (bit n is CPU n,
+ * 0 leaves affinity unchanged) and, when realtime_priority is not 0, raises
+ * its priority: SCHED_FIFO with given priority on Linux, time critical thread
+ * priority on Windows.
+ * Throws InitializationException on failure.
+ */
+void ConfigureCurrentThread(uint64_t affinity_mask, int32_t realtime_priority);
+
+}  // namespace inseye::internal
+#endif  //REMOTE_CONNECTOR_LIB_TRANSPORT_HPP
@@ -0,0 +1,329 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include "transport.hpp"
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <utility>
+#include "errors.hpp"
+#include "named_pipe_communicator.hpp"
+
+using namespace inseye::internal;
+
+constexpr NativeHandle invalid_handle = -1;
+
+std::string inseye::internal::ServiceEndpointName() {
+  const char* endpoint = std::getenv("INSEYE_SERVICE_ENDPOINT");
+  return endpoint != nullptr && endpoint[0] != '\0' ? endpoint
+                                                     : "inseye.desktop-service";
+}
+
+// Socket lives in Linux abstract namespace so, like Windows named pipe, it
+// disappears together with the service process and needs no filesystem access.
+sockaddr_un ServiceSocketAddress(socklen_t& length) {
+  const auto name = ServiceEndpointName();
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  const auto name_length =
+      (std::min)(name.size(), sizeof(address.sun_path) - 1);
+  // leading '\0' in sun_path selects abstract namespace
+  std::memcpy(address.sun_path + 1, name.data(), name_length);
+  length = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + 1 +
+                                  name_length);
+  return address;
+}
+
+std::string ErrnoDescription(int error) {
+  return std::format("errno={} ({})", error, std::strerror(error));
+}
+
+ServiceConnection::ServiceConnection(NativeHandle handle) noexcept
+    : handle_(handle) {}
+
+ServiceConnection::ServiceConnection(ServiceConnection&& other) noexcept
+    : handle_(std::exchange(other.handle_, invalid_handle)) {}
+
+ServiceConnection& ServiceConnection::operator=(
+    ServiceConnection&& other) noexcept {
+  std::swap(handle_, other.handle_);
+  return *this;
+}
+
+ServiceConnection::~ServiceConnection() {
+  if (handle_ != invalid_handle)
+    close(handle_);
+}
+
+ServiceConnection ServiceConnection::Connect(
+    const std::function<bool()>& should_cancel_function) {
+  // non-blocking, so that connect fails right away when the service doesn't
+  // accept connections instead of waiting for it
+  ServiceConnection connection(
+      socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK, 0));
+  if (connection.handle_ == invalid_handle) {
+    ThrowInitialization(
+        std::format("Failed to create socket, {}", ErrnoDescription(errno)),
+        inseye::c::InseyeInitializationStatus::kInsFailedToInitializeNamedPipe);
+  }
+  socklen_t address_length = 0;
+  const auto address = ServiceSocketAddress(address_length);
+  int result;
+  do {
+    result = connect(connection.handle_,
+                     reinterpret_cast<const sockaddr*>(&address),
+                     address_length);
+  } while (result != 0 && errno == EINTR);
+  const int error = errno;
+  ThrowIfCancellationRequested(should_cancel_function);
+  if (result != 0) {
+    if (error == EAGAIN)
+      ThrowInitialization("All desktop service connections are busy.",
+                          inseye::c::InseyeInitializationStatus::
+                              kInsAllServiceNamedPipesAreBusy);
+    ThrowInitialization(
+        std::format("Failed to connect to service socket, {}",
+                    ErrnoDescription(error)),
+        inseye::c::InseyeInitializationStatus::kInsFailedToInitializeNamedPipe);
+  }
+  return connection;
+}
+
+bool ServiceConnection::EndpointExists() {
+  // abstract sockets are listed in /proc/net/unix with '@' instead of '\0'
+  std::ifstream sockets("/proc/net/unix");
+  std::string expected = "@";
+  expected += ServiceEndpointName();
+  std::string line;
+  while (std::getline(sockets, line)) {
+    if (line.size() >= expected.size() &&
+        line.compare(line.size() - expected.size(), expected.size(),
+                     expected) == 0 &&
+        (line.size() == expected.size() ||
+         line[line.size() - expected.size() - 1] == ' '))
+      return true;
+  }
+  return false;
+}
+
+// Waits until socket is ready for events, false when deadline passes first.
+// Errors and hang up count as ready, following send or recv reports them.
+bool WaitForSocket(int handle, short events,
+                   std::chrono::steady_clock::time_point deadline,
+                   const std::function<bool()>& should_cancel_function) {
+  while (true) {
+    ThrowIfCancellationRequested(should_cancel_function);
+    const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0)
+      return false;
+    pollfd descriptor{handle, events, 0};
+    const int ready = poll(
+        &descriptor, 1,
+        static_cast<int>(
+            (std::min)(remaining, service_wait_cancellation_interval).count()));
+    if (ready > 0 || (ready < 0 && errno != EINTR))
+      return true;
+  }
+}
+
+bool ServiceConnection::Write(
+    const std::byte* data, size_t size,
+    std::chrono::steady_clock::time_point deadline,
+    const std::function<bool()>& should_cancel_function) {
+  ssize_t sent;
+  while (true) {
+    sent = send(handle_, data, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (sent >= 0 || (errno != EINTR && errno != EAGAIN &&
+                      errno != EWOULDBLOCK))
+      break;
+    if (errno != EINTR && !WaitForSocket(handle_, POLLOUT, deadline,
+                                        should_cancel_function))
+      return false;
+  }
+  return sent >= 0 && static_cast<size_t>(sent) == size;
+}
+
+size_t ServiceConnection::Read(
+    std::byte* destination, size_t capacity,
+    std::chrono::steady_clock::time_point deadline,
+    const std::function<bool()>& should_cancel_function) {
+  ssize_t received;
+  while (true) {
+    // MSG_TRUNC makes recv return real message length, the part that doesn't
+    // fit is discarded by the kernel so there is nothing to drain
+    received =
+        recv(handle_, destination, capacity, MSG_TRUNC | MSG_DONTWAIT);
+    if (received >= 0 || (errno != EINTR && errno != EAGAIN &&
+                          errno != EWOULDBLOCK))
+      break;
+    if (errno != EINTR && !WaitForSocket(handle_, POLLIN, deadline,
+                                        should_cancel_function))
+      throw NamedPipeException("NP:: Service didn't respond in time.\n");
+  }
+  if (received < 0)
+    throw NamedPipeException(std::format("NP:: Failed to read message. {}\n",
+                                         ErrnoDescription(errno)));
+  if (received == 0)
+    throw NamedPipeException("NP:: Connection closed by server");
+  if (static_cast<size_t>(received) > capacity)
+    throw NamedPipeException(std::format(
+        "NP:: Failed to read message. Message too long ({} bytes)\n",
+        received));
+  return static_cast<size_t>(received);
+}
+
+bool ServiceConnection::IsPeerConnected() noexcept {
+  pollfd descriptor{handle_, POLLIN, 0};
+  int ready;
+  do {
+    ready = poll(&descriptor, 1, 0);
+  } while (ready < 0 && errno == EINTR);
+  if (ready < 0 || (descriptor.revents & (POLLHUP | POLLERR | POLLNVAL)) != 0)
+    return false;
+  if ((descriptor.revents & POLLIN) == 0)
+    return true;
+  // readable socket is either pending message or orderly shutdown
+  std::byte message;
+  ssize_t received;
+  do {
+    received =
+        recv(handle_, &message, sizeof(message), MSG_PEEK | MSG_DONTWAIT);
+  } while (received < 0 && errno == EINTR);
+  return received > 0 ||
+         (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+}
+
+SharedMemoryView::SharedMemoryView(const std::byte* data, size_t size) noexcept
+    : data_(data), size_(size) {}
+
+SharedMemoryView::SharedMemoryView(SharedMemoryView&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+SharedMemoryView& SharedMemoryView::operator=(
+    SharedMemoryView&& other) noexcept {
+  std::swap(data_, other.data_);
+  std::swap(size_, other.size_);
+  return *this;
+}
+
+SharedMemoryView::~SharedMemoryView() {
+  if (data_ != nullptr)
+    munmap(const_cast<std::byte*>(data_), size_);
+}
+
+SharedMemoryObject::SharedMemoryObject(NativeHandle handle) noexcept
+    : handle_(handle) {}
+
+SharedMemoryObject::SharedMemoryObject(SharedMemoryObject&& other) noexcept
+    : handle_(std::exchange(other.handle_, invalid_handle)) {}
+
+SharedMemoryObject& SharedMemoryObject::operator=(
+    SharedMemoryObject&& other) noexcept {
+  std::swap(handle_, other.handle_);
+  return *this;
+}
+
+SharedMemoryObject::~SharedMemoryObject() {
+  if (handle_ != invalid_handle)
+    close(handle_);
+}
+
+SharedMemoryObject SharedMemoryObject::Open(const std::string& name) {
+  // POSIX shared memory object names must start with single slash
+  const std::string object_name =
+      (!name.empty() && name.front() == '/') ? name : "/" + name;
+  SharedMemoryObject object(shm_open(object_name.c_str(), O_RDONLY, 0));
+  if (object.handle_ == invalid_handle) {
+    ThrowInitialization(
+        std::format("Could not open shared memory object '{}', {}.\n",
+                    object_name, ErrnoDescription(errno)),
+        inseye::c::InseyeInitializationStatus::kFailedToAccessSharedResources);
+  }
+  return object;
+}
+
+SharedMemoryView SharedMemoryObject::Map(size_t size) const {
+  // mapping past the end of shared memory object would end with SIGBUS on
+  // first access instead of error here
+  struct stat object_stat {};
+  if (fstat(handle_, &object_stat) != 0 ||
+      static_cast<size_t>(object_stat.st_size) < size) {
+    ThrowInitialization(
+        std::format("Shared memory object is smaller than requested view "
+                    "({} < {}).",
+                    static_cast<int64_t>(object_stat.st_size), size),
+        inseye::c::InseyeInitializationStatus::kFailedToMapSharedResources);
+  }
+  auto memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, handle_, 0);
+  if (memory == MAP_FAILED) {
+    ThrowInitialization(
+        std::format("Could not map view of file ({}).",
+                    ErrnoDescription(errno)),
+        inseye::c::InseyeInitializationStatus::kFailedToMapSharedResources);
+  }
+  return {static_cast<const std::byte*>(memory), size};
+}
+
+SharedValueWaitResult inseye::internal::WaitForSharedValueChange(
+    const uint32_t* address, uint32_t expected,
+    std::chrono::nanoseconds timeout) noexcept {
+  const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+  const timespec relative_timeout{
+      static_cast<time_t>(seconds.count()),
+      static_cast<long>((timeout - seconds).count())};
+  // not FUTEX_PRIVATE_FLAG, the word lives in memory shared with the service
+  if (syscall(SYS_futex, address, FUTEX_WAIT, expected, &relative_timeout,
+              nullptr, 0) == 0)
+    return SharedValueWaitResult::kWokenUp;
+  return errno == ETIMEDOUT ? SharedValueWaitResult::kTimeout
+                            : SharedValueWaitResult::kValueChanged;
+}
+
+void inseye::internal::ConfigureCurrentThread(uint64_t affinity_mask,
+                                              int32_t realtime_priority) {
+  if (affinity_mask != 0) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (int cpu = 0; cpu < 64; ++cpu)
+      if ((affinity_mask >> cpu) & 1)
+        CPU_SET(cpu, &cpu_set);
+    // pthread functions return error instead of setting errno
+    const int error =
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    if (error != 0)
+      ThrowInitialization(
+          std::format("Failed to set thread affinity, {}",
+                      ErrnoDescription(error)),
+          inseye::c::InseyeInitializationStatus::kFailure);
+  }
+  if (realtime_priority != 0) {
+    const sched_param parameters{.sched_priority = realtime_priority};
+    const int error =
+        pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters);
+    if (error != 0)
+      ThrowInitialization(
+          std::format("Failed to set SCHED_FIFO priority {}, {}",
+                      realtime_priority, ErrnoDescription(error)),
+          inseye::c::InseyeInitializationStatus::kFailure);
+  }
+}
@@ -0,0 +1,299 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include "transport.hpp"
+#include <windows.h>
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <format>
+#include <utility>
+#include "errors.hpp"
+#include "named_pipe_communicator.hpp"
+
+using namespace inseye::internal;
+
+std::string inseye::internal::ServiceEndpointName() {
+  std::array<char, 256> endpoint{};
+  const auto length = GetEnvironmentVariableA(
+      "INSEYE_SERVICE_ENDPOINT", endpoint.data(),
+      static_cast<DWORD>(endpoint.size()));
+  if (length == 0 || length >= endpoint.size())
+    return "inseye.desktop-service";
+  return {endpoint.data(), length};
+}
+
+std::string NamedPipeName() {
+  return "\\\\.\\pipe\\" + ServiceEndpointName();
+}
+
+bool NamedPipeExists(const std::filesystem::path& pipePath) {
+  std::wstring pipeName = pipePath;
+  if ((pipeName.size() < 10) ||
+      (pipeName.compare(0, 9, L"\\\\.\\pipe\\") != 0) ||
+      (pipeName.find(L'\\', 9) != std::string::npos)) {
+    // This can't be a pipe, so it also can't exist
+    return false;
+  }
+  pipeName.erase(0, 9);
+  WIN32_FIND_DATAW fd;
+  HANDLE hFind = FindFirstFileW(L"\\\\.\\pipe\\*", &fd);
+  do {
+    if (pipeName == fd.cFileName) {
+      FindClose(hFind);
+      return true;
+    }
+  } while (FindNextFileW(hFind, &fd));
+  FindClose(hFind);
+  return false;
+}
+
+ServiceConnection::ServiceConnection(NativeHandle handle) noexcept
+    : handle_(handle) {}
+
+ServiceConnection::ServiceConnection(ServiceConnection&& other) noexcept
+    : handle_(std::exchange(other.handle_, INVALID_HANDLE_VALUE)) {}
+
+ServiceConnection& ServiceConnection::operator=(
+    ServiceConnection&& other) noexcept {
+  std::swap(handle_, other.handle_);
+  return *this;
+}
+
+ServiceConnection::~ServiceConnection() {
+  if (handle_ != INVALID_HANDLE_VALUE)
+    CloseHandle(handle_);
+}
+
+ServiceConnection ServiceConnection::Connect(
+    const std::function<bool()>& should_cancel_function) {
+  ServiceConnection connection(
+      CreateFileA(NamedPipeName().c_str(),      // lpFileName
+                 GENERIC_READ | GENERIC_WRITE,  // dwDesiredAccess
+                 0,                             //dwShareMode
+                 nullptr,                       //lpSecurityAttributes
+                 OPEN_EXISTING,                 // dwCreatin\disposition
+                 FILE_FLAG_OVERLAPPED,          // dwFlagsAndAttributes
+                 nullptr                        // hTemplateFile
+                 ));
+  ThrowIfCancellationRequested(should_cancel_function);
+  if (connection.handle_ == INVALID_HANDLE_VALUE) {
+    auto gle = GetLastError();
+    if (gle == ERROR_PIPE_BUSY)
+      ThrowInitialization("All desktop pipe instances are busy.",
+                          inseye::c::InseyeInitializationStatus::
+                              kInsAllServiceNamedPipesAreBusy);
+    ThrowInitialization(
+        std::format("Invalid named pipe handle, GLE={0}", gle),
+        inseye::c::InseyeInitializationStatus::kInsFailedToInitializeNamedPipe);
+  }
+  //  if (!SetNamedPipeHandleState(pipe_handle.get(), &pipe_mode, nullptr, nullptr))
+  //    throw_initialization(std::format("Failed to configure pipe, GLE={}", GetLastError()),
+  //                         inseye::c::InseyeInitializationStatus::kInternalError);
+  return connection;
+}
+
+bool ServiceConnection::EndpointExists() {
+  return NamedPipeExists(NamedPipeName());
+}
+
+// Manual reset event of single overlapped operation.
+class OverlappedOperation {
+ public:
+  OVERLAPPED overlapped{};
+  OverlappedOperation() {
+    overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+  }
+  OverlappedOperation(const OverlappedOperation&) = delete;
+  ~OverlappedOperation() {
+    if (overlapped.hEvent != nullptr)
+      CloseHandle(overlapped.hEvent);
+  }
+};
+
+// Waits for operation started on the pipe with ReadFile or WriteFile and
+// cancels it when deadline passes or cancellation is requested first.
+// Returns ERROR_SUCCESS or error of the operation.
+DWORD FinishOverlapped(HANDLE handle, OverlappedOperation& operation,
+                       BOOL completed,
+                       std::chrono::steady_clock::time_point deadline,
+                       const std::function<bool()>& should_cancel_function,
+                       DWORD& bytes_transferred) {
+  if (!completed) {
+    const auto error = GetLastError();
+    if (error != ERROR_IO_PENDING)
+      return error;
+    while (true) {
+      const bool cancelled = should_cancel_function();
+      const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+          deadline - std::chrono::steady_clock::now());
+      if (cancelled || remaining.count() <= 0) {
+        CancelIoEx(handle, &operation.overlapped);
+        // the operation must be over before OVERLAPPED goes out of scope
+        GetOverlappedResult(handle, &operation.overlapped, &bytes_transferred,
+                            TRUE);
+        if (cancelled)
+          ThrowInitialization(
+              "Cancelled", inseye::c::InseyeInitializationStatus::kCancelled);
+        return ERROR_TIMEOUT;
+      }
+      const auto timeout =
+          (std::min)(remaining, service_wait_cancellation_interval);
+      if (WaitForSingleObject(operation.overlapped.hEvent,
+                              static_cast<DWORD>(timeout.count())) ==
+          WAIT_OBJECT_0)
+        break;
+    }
+  }
+  if (!GetOverlappedResult(handle, &operation.overlapped, &bytes_transferred,
+                           FALSE))
+    return GetLastError();
+  return ERROR_SUCCESS;
+}
+
+bool ServiceConnection::Write(
+    const std::byte* data, size_t size,
+    std::chrono::steady_clock::time_point deadline,
+    const std::function<bool()>& should_cancel_function) {
+  OverlappedOperation operation;
+  if (operation.overlapped.hEvent == nullptr)
+    return false;
+  DWORD bytes_written = 0;
+  const auto completed = WriteFile(handle_, (LPCVOID)data, (DWORD)size,
+                                   nullptr, &operation.overlapped);
+  return FinishOverlapped(handle_, operation, completed, deadline,
+                          should_cancel_function,
+                          bytes_written) == ERROR_SUCCESS &&
+         bytes_written == size;
+}
+
+size_t ServiceConnection::Read(
+    std::byte* destination, size_t capacity,
+    std::chrono::steady_clock::time_point deadline,
+    const std::function<bool()>& should_cancel_function) {
+  DWORD bytes_read = 0;
+  DWORD error;
+  {
+    OverlappedOperation operation;
+    if (operation.overlapped.hEvent == nullptr)
+      throw NamedPipeException(std::format(
+          "NP:: Failed to create event, GLE={}\n", GetLastError()));
+    const auto completed = ReadFile(handle_, destination, (DWORD)capacity,
+                                    nullptr, &operation.overlapped);
+    error = FinishOverlapped(handle_, operation, completed, deadline,
+                             should_cancel_function, bytes_read);
+  }
+  if (error == ERROR_TIMEOUT)
+    throw NamedPipeException("NP:: Service didn't respond in time.\n");
+  if (error != ERROR_SUCCESS) {
+    auto drained = error;
+    while (drained == ERROR_MORE_DATA) {  // drain the pipe
+      OverlappedOperation operation;
+      if (operation.overlapped.hEvent == nullptr)
+        break;
+      const auto completed = ReadFile(handle_, destination, (DWORD)capacity,
+                                      nullptr, &operation.overlapped);
+      drained = FinishOverlapped(handle_, operation, completed, deadline,
+                                 should_cancel_function, bytes_read);
+    }
+    throw NamedPipeException(
+        std::format("NP:: Failed to read message. GLE={}\n", error));
+  }
+  return bytes_read;
+}
+
+bool ServiceConnection::IsPeerConnected() noexcept {
+  // fails with ERROR_BROKEN_PIPE once the server closes its end
+  return PeekNamedPipe(handle_, nullptr, 0, nullptr, nullptr, nullptr) != 0;
+}
+
+SharedMemoryView::SharedMemoryView(const std::byte* data, size_t size) noexcept
+    : data_(data), size_(size) {}
+
+SharedMemoryView::SharedMemoryView(SharedMemoryView&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+SharedMemoryView& SharedMemoryView::operator=(
+    SharedMemoryView&& other) noexcept {
+  std::swap(data_, other.data_);
+  std::swap(size_, other.size_);
+  return *this;
+}
+
+SharedMemoryView::~SharedMemoryView() {
+  if (data_ != nullptr)
+    UnmapViewOfFile(data_);
+}
+
+SharedMemoryObject::SharedMemoryObject(NativeHandle handle) noexcept
+    : handle_(handle) {}
+
+SharedMemoryObject::SharedMemoryObject(SharedMemoryObject&& other) noexcept
+    : handle_(std::exchange(other.handle_, nullptr)) {}
+
+SharedMemoryObject& SharedMemoryObject::operator=(
+    SharedMemoryObject&& other) noexcept {
+  std::swap(handle_, other.handle_);
+  return *this;
+}
+
+SharedMemoryObject::~SharedMemoryObject() {
+  if (handle_ != nullptr)
+    CloseHandle(handle_);
+}
+
+SharedMemoryObject SharedMemoryObject::Open(const std::string& name) {
+  SharedMemoryObject object(OpenFileMapping(FILE_MAP_READ,  // use paging file
+                                            FALSE, name.c_str()));
+  if (object.handle_ == nullptr) {
+    ThrowInitialization(
+        std::format("Could not open file mapping object, GLE={}.\n",
+                    GetLastError()),
+        inseye::c::InseyeInitializationStatus::kFailedToAccessSharedResources);
+  }
+  return object;
+}
+
+SharedMemoryView SharedMemoryObject::Map(size_t size) const {
+  auto memory = MapViewOfFile(handle_,        // handle to map object
+                              FILE_MAP_READ,  // read/write permission
+                              0, 0, size);
+  if (memory == nullptr) {
+    ThrowInitialization(
+        std::format("Could not map view of file ({}).", GetLastError()),
+        inseye::c::InseyeInitializationStatus::kFailedToMapSharedResources);
+  }
+  return {static_cast<const std::byte*>(memory), size};
+}
+
+SharedValueWaitResult inseye::internal::WaitForSharedValueChange(
+    const uint32_t* address, uint32_t expected,
+    std::chrono::nanoseconds timeout) noexcept {
+  // WaitOnAddress works only inside single process
+  if (*reinterpret_cast<const volatile uint32_t*>(address) != expected)
+    return SharedValueWaitResult::kValueChanged;
+  Sleep(timeout >= std::chrono::milliseconds(1) ? 1 : 0);
+  return SharedValueWaitResult::kTimeout;
+}
+
+void inseye::internal::ConfigureCurrentThread(uint64_t affinity_mask,
+                                              int32_t realtime_priority) {
+  if (affinity_mask != 0 &&
+      SetThreadAffinityMask(GetCurrentThread(),
+                            static_cast<DWORD_PTR>(affinity_mask)) == 0) {
+    ThrowInitialization(
+        std::format("Failed to set thread affinity, GLE={}", GetLastError()),
+        inseye::c::InseyeInitializationStatus::kFailure);
+  }
+  if (realtime_priority != 0 &&
+      !SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)) {
+    ThrowInitialization(
+        std::format("Failed to raise thread priority, GLE={}", GetLastError()),
+        inseye::c::InseyeInitializationStatus::kFailure);
+  }
+}
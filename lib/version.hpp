@@ -8,6 +8,7 @@
 
 #ifndef VERSION_HPP
 #define VERSION_HPP
+#include <cstddef>
 #include <cstdint>
 #include "endianess_helpers.hpp"
 
@@ -20,5 +21,22 @@ namespace inseye::internal {
         uint32_t patch;
     };
 #pragma pack(pop)
+
+    inline PackedVersion read_swap_endianess_if_needed(const PackedVersion* arg) {
+        const auto bytes = reinterpret_cast<const std::byte*>(arg);
+        return {
+            read_swap_endianess_if_needed(reinterpret_cast<const uint32_t*>(bytes + offsetof(PackedVersion, major))),
+            read_swap_endianess_if_needed(reinterpret_cast<const uint32_t*>(bytes + offsetof(PackedVersion, minor))),
+            read_swap_endianess_if_needed(reinterpret_cast<const uint32_t*>(bytes + offsetof(PackedVersion, patch)))
+        };
+    }
+
+    inline void write_swap_endianess_if_needed(PackedVersion* destination, const PackedVersion* source) {
+        const auto bytes = reinterpret_cast<std::byte*>(destination);
+        const uint32_t major = source->major, minor = source->minor, patch = source->patch;
+        write_swap_endianess_if_needed(reinterpret_cast<uint32_t*>(bytes + offsetof(PackedVersion, major)), &major);
+        write_swap_endianess_if_needed(reinterpret_cast<uint32_t*>(bytes + offsetof(PackedVersion, minor)), &minor);
+        write_swap_endianess_if_needed(reinterpret_cast<uint32_t*>(bytes + offsetof(PackedVersion, patch)), &patch);
+    }
 }
 #endif //VERSION_HPP
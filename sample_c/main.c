@@ -7,12 +7,16 @@
 // All other rights reserved.
 
 #include <stdio.h>
+#if defined(_WIN32)
 #include <Windows.h>
+#else
+#include <signal.h>
+#endif
 #include "remote_connector.h"
 
 volatile static bool run = true;
 
-
+#if defined(_WIN32)
 BOOL WINAPI CtrlHandler(DWORD fdwCtrlType)
 {
   switch (fdwCtrlType)
@@ -28,10 +32,17 @@ BOOL WINAPI CtrlHandler(DWORD fdwCtrlType)
       return FALSE;
   }
 }
+#else
+void CtrlHandler(int signal)
+{
+  (void)signal;
+  run = false;
+}
+#endif
 
 void print_data(struct InseyeEyeTrackerDataStruct*eye_tracker_data) {
   printf("Successfully read data\n");
-  printf("Time: %llu\n", eye_tracker_data->time);
+  printf("Time: %llu\n", (unsigned long long)eye_tracker_data->time);
   printf("Left X: %f\n", eye_tracker_data->left_eye_x);
   printf("Left Y: %f\n", eye_tracker_data->left_eye_y);
   printf("Right X: %f\n", eye_tracker_data->right_eye_x);
@@ -50,13 +61,18 @@ int main() {
   }
   printf("Reader successfully initialized.\n");
   struct InseyeEyeTrackerDataStruct eyeTrackerData;
+#if defined(_WIN32)
   SetConsoleCtrlHandler(CtrlHandler, TRUE);
+#else
+  signal(SIGINT, CtrlHandler);
+  signal(SIGTERM, CtrlHandler);
+#endif
   while (run) {
     if (TryReadLatestEyeTrackerData(reader_ptr, &eyeTrackerData)) {
       print_data(&eyeTrackerData);
     } else {
       printf("Failed to read data\n");
-      Sleep(5000);
+      WaitForEyeTrackerData(reader_ptr, 5000000000ull);
     }
     printf("\n");
   }
@@ -9,11 +9,16 @@
 #include <iostream>
 #include <chrono>
 #include <thread>
+#if defined(_WIN32)
 #include "windows.h"
+#else
+#include <csignal>
+#endif
 #include "remote_connector.h"
 
-static bool run = true;
+static volatile bool run = true;
 
+#if defined(_WIN32)
 BOOL WINAPI CtrlHandler(DWORD fdwCtrlType)
 {
   switch (fdwCtrlType)
@@ -29,6 +34,12 @@ BOOL WINAPI CtrlHandler(DWORD fdwCtrlType)
       return FALSE;
   }
 }
+#else
+void CtrlHandler(int)
+{
+  run = false;
+}
+#endif
 
 template<typename T>
 void print_data(T & eye_tracker_data) {
@@ -46,13 +57,18 @@ int main(int argc, char *argv[]) {
   try {
     inseye::EyeTracker reader(-1);
     inseye::EyeTrackerDataStruct eyeTrackerData;
+#if defined(_WIN32)
     SetConsoleCtrlHandler(CtrlHandler, TRUE);
+#else
+    std::signal(SIGINT, CtrlHandler);
+    std::signal(SIGTERM, CtrlHandler);
+#endif
     while (run) {
       if (reader.TryReadNextEyeTrackerData(eyeTrackerData)) {
         print_data(eyeTrackerData);
       } else {
         std::cout << "Failed to read data";
-        std::this_thread::sleep_for(5s);
+        reader.WaitForEyeTrackerData(5s);
       }
       std::cout << std::endl;
     }
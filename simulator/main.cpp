@@ -0,0 +1,132 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <thread>
+#include "service_simulator.hpp"
+
+using namespace inseye::simulator;
+
+static std::atomic<bool> run = true;
+
+void StopHandler(int) {
+  run = false;
+}
+
+void PrintUsage(const char* program) {
+  std::printf(
+      "Usage: %s [options]\n"
+      "Simulates desktop service: creates shared ring buffer, answers\n"
+      "handshake and writes generated gaze samples until interrupted.\n\n"
+      "  --rate <hz>                sample rate, 60 - 20000 (default 1000)\n"
+      "  --ring <samples>           ring slots, at least 2 (default 4096)\n"
+      "  --jitter <fraction>        publish delay as fraction of sample "
+      "period, 0 - 1 (default 0)\n"
+      "  --blink-rate <hz>          mean blinks per second (default 0.3)\n"
+      "  --saccade-rate <hz>        mean saccades per second (default 3)\n"
+      "  --overrun-interval <ms>    force ring overrun every interval "
+      "(default 0 - never)\n"
+      "  --duration <s>             stop after given time (default 0 - run "
+      "until interrupted)\n"
+      "  --seed <value>             random seed (default 1)\n"
+      "  --layout <1|2>             shared memory layout, 2 reports service "
+      "version 2.0.0 (default 1)\n"
+      "  --no-wake                  don't wake readers after publish\n",
+      program);
+}
+
+// Parses command line into options, returns false on invalid input.
+bool ParseArguments(int argc, char** argv, SimulatorOptions& options,
+                    double& duration_s) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string argument = argv[i];
+    if (argument == "--no-wake") {
+      options.wake_readers = false;
+      continue;
+    }
+    if (i + 1 == argc)
+      return false;
+    const char* value = argv[++i];
+    char* end = nullptr;
+    const double number = std::strtod(value, &end);
+    if (end == value || *end != '\0' || number < 0)
+      return false;
+    if (argument == "--rate")
+      options.sample_rate_hz = static_cast<uint32_t>(number);
+    else if (argument == "--ring")
+      options.ring_sample_count = static_cast<uint32_t>(number);
+    else if (argument == "--jitter")
+      options.jitter = number;
+    else if (argument == "--blink-rate")
+      options.blink_rate_hz = number;
+    else if (argument == "--saccade-rate")
+      options.saccade_rate_hz = number;
+    else if (argument == "--overrun-interval")
+      options.overrun_interval_ms = static_cast<uint32_t>(number);
+    else if (argument == "--duration")
+      duration_s = number;
+    else if (argument == "--seed")
+      options.seed = static_cast<uint32_t>(number);
+    else if (argument == "--layout" && (number == 1 || number == 2))
+      options.version = {static_cast<uint32_t>(number), 0, 0};
+    else
+      return false;
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  SimulatorOptions options;
+  double duration_s = 0;
+  if (!ParseArguments(argc, argv, options, duration_s)) {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  std::signal(SIGINT, StopHandler);
+  std::signal(SIGTERM, StopHandler);
+  try {
+    ServiceSimulator simulator(options);
+    std::printf("Serving %u Hz into %u sample ring '%s'\n",
+                options.sample_rate_hz, options.ring_sample_count,
+                simulator.SharedMemoryName().c_str());
+    simulator.Start();
+    const auto start = std::chrono::steady_clock::now();
+    auto last_report = start;
+    uint32_t last_written = 0;
+    while (run) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      const auto now = std::chrono::steady_clock::now();
+      if (duration_s > 0 &&
+          std::chrono::duration<double>(now - start).count() >= duration_s)
+        break;
+      if (now - last_report < std::chrono::seconds(1))
+        continue;
+      const uint32_t written = simulator.SamplesWritten();
+      std::printf("%10u samples written, %8.0f samples/s, %llu overruns\n",
+                  written,
+                  (written - last_written) /
+                      std::chrono::duration<double>(now - last_report).count(),
+                  static_cast<unsigned long long>(simulator.OverrunCount()));
+      std::fflush(stdout);
+      last_report = now;
+      last_written = written;
+    }
+    simulator.Stop();
+    std::printf("Stopped after %u samples\n", simulator.SamplesWritten());
+  } catch (const std::exception& exception) {
+    std::fprintf(stderr, "%s\n", exception.what());
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,311 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include "service_simulator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include "endianess_helpers.hpp"
+#include "eye_tracker_data_struct.hpp"
+#include "shared_memory_header.hpp"
+
+using namespace inseye::simulator;
+using inseye::internal::InMemoryV1;
+using inseye::internal::InMemoryV2;
+using inseye::internal::PackedVersion;
+using inseye::internal::read_swap_endianess_if_needed;
+using inseye::internal::write_swap_endianess_if_needed;
+
+// NamedPipeMessageType in named_pipe_communicator.cpp
+constexpr uint32_t service_info_request = 0;
+constexpr uint32_t service_info_response = 1;
+// ServiceInfoResponse: message type, packed version, null terminated path
+constexpr size_t response_version_offset = sizeof(uint32_t);
+constexpr size_t response_path_offset =
+    response_version_offset + sizeof(PackedVersion);
+
+
+// gaze model, angles in radians
+constexpr float gaze_range = 0.35f;
+constexpr float fixation_noise = 0.0015f;
+constexpr float eye_separation = 0.06f;
+constexpr double saccade_velocity = 7.0;
+constexpr double blink_duration_s = 0.15;
+
+namespace {
+// fields preceding samples written are the same in both layouts
+static_assert(offsetof(InMemoryV1, header_size) ==
+                  offsetof(InMemoryV2, header_size) &&
+              offsetof(InMemoryV1, buffer_size) ==
+                  offsetof(InMemoryV2, buffer_size) &&
+              offsetof(InMemoryV1, sample_size) ==
+                  offsetof(InMemoryV2, sample_size));
+
+bool UsesLayoutV2(const SimulatorOptions& options) {
+  return options.version.major >= 2;
+}
+
+uint32_t HeaderSize(const SimulatorOptions& options) {
+  return UsesLayoutV2(options) ? sizeof(InMemoryV2) : sizeof(InMemoryV1);
+}
+
+uint32_t SampleSize(const SimulatorOptions& options) {
+  return UsesLayoutV2(options) ? inseye::internal::kSlotAlignmentV2
+                               : sizeof(inseye::internal::EyeTrackerDataStruct);
+}
+
+template <typename T>
+void WriteHeaderField(std::byte* header, size_t offset, const T& value) {
+  write_swap_endianess_if_needed<T>(reinterpret_cast<T*>(header + offset),
+                                    &value);
+}
+
+const SimulatorOptions& Validate(const SimulatorOptions& options) {
+  if (options.sample_rate_hz < kMinimumSampleRate ||
+      options.sample_rate_hz > kMaximumSampleRate)
+    throw std::invalid_argument("Sample rate must be between 60 and 20000 Hz");
+  if (options.ring_sample_count < 2 ||
+      options.ring_sample_count >
+          (std::numeric_limits<uint32_t>::max() - HeaderSize(options)) /
+              SampleSize(options))
+    throw std::invalid_argument("Ring must hold at least 2 samples and fit "
+                                "in 4 GiB");
+  if (!(options.jitter >= 0.0 && options.jitter <= 1.0))
+    throw std::invalid_argument("Jitter must be between 0 and 1");
+  if (!(options.blink_rate_hz >= 0.0) || !(options.saccade_rate_hz >= 0.0))
+    throw std::invalid_argument("Event rates must not be negative");
+  return options;
+}
+}  // namespace
+
+GazeModel::GazeModel(const SimulatorOptions& options)
+    : random_(options.seed),
+      sample_period_s_(1.0 / options.sample_rate_hz),
+      saccade_probability_(options.saccade_rate_hz * sample_period_s_),
+      blink_probability_(options.blink_rate_hz * sample_period_s_) {}
+
+inseye::EyeTrackerDataStruct GazeModel::Next(uint64_t time_ms) {
+  std::uniform_real_distribution<double> chance(0.0, 1.0);
+  if (blink_samples_left_ == 0 && chance(random_) < blink_probability_)
+    blink_samples_left_ = static_cast<uint32_t>(
+        std::max(1.0, std::round(blink_duration_s / sample_period_s_)));
+  if (saccade_samples_left_ == 0 && chance(random_) < saccade_probability_) {
+    std::uniform_real_distribution<float> target(-gaze_range, gaze_range);
+    target_x_ = target(random_);
+    target_y_ = target(random_);
+    const double amplitude = std::hypot(target_x_ - x_, target_y_ - y_);
+    saccade_samples_left_ = static_cast<uint32_t>(std::max(
+        1.0, std::ceil(amplitude / saccade_velocity / sample_period_s_)));
+    step_x_ = (target_x_ - x_) / static_cast<float>(saccade_samples_left_);
+    step_y_ = (target_y_ - y_) / static_cast<float>(saccade_samples_left_);
+  }
+  auto event = inseye::GazeEvent::kInsGazeNone;
+  if (saccade_samples_left_ > 0) {
+    event = inseye::GazeEvent::kInsGazeSaccade;
+    if (--saccade_samples_left_ == 0) {
+      x_ = target_x_;
+      y_ = target_y_;
+    } else {
+      x_ += step_x_;
+      y_ += step_y_;
+    }
+  }
+  if (blink_samples_left_ > 0) {
+    // eyes are not visible, last position is held
+    --blink_samples_left_;
+    return {time_ms,
+            x_ + eye_separation / 2,
+            y_,
+            x_ - eye_separation / 2,
+            y_,
+            inseye::GazeEvent::kInsGazeBlinkBoth};
+  }
+  std::normal_distribution<float> noise(0.0f, fixation_noise);
+  return {time_ms,
+          x_ + eye_separation / 2 + noise(random_),
+          y_ + noise(random_),
+          x_ - eye_separation / 2 + noise(random_),
+          y_ + noise(random_),
+          event};
+}
+
+ServiceSimulator::ServiceSimulator(const SimulatorOptions& options)
+    : options_(Validate(options)),
+      header_size_(HeaderSize(options_)),
+      sample_size_(SampleSize(options_)),
+      sequence_offset_(UsesLayoutV2(options_)
+                           ? inseye::internal::kSequenceStampOffsetV2
+                           : 0),
+      memory_(header_size_ +
+              size_t{options_.ring_sample_count} * sample_size_),
+      samples_(memory_.data() + header_size_),
+      samples_written_counter_(reinterpret_cast<uint32_t*>(
+          memory_.data() + (UsesLayoutV2(options_)
+                                ? offsetof(InMemoryV2, samples_written)
+                                : offsetof(InMemoryV1, samples_written)))),
+      wake_readers_(options_.wake_readers),
+      gaze_model_(options_) {
+  std::byte* header = memory_.data();
+  write_swap_endianess_if_needed(
+      reinterpret_cast<PackedVersion*>(header + offsetof(InMemoryV1, version)),
+      &options_.version);
+  WriteHeaderField(header, offsetof(InMemoryV1, header_size), header_size_);
+  WriteHeaderField(header, offsetof(InMemoryV1, buffer_size),
+                   static_cast<uint32_t>(memory_.size()));
+  WriteHeaderField(header, offsetof(InMemoryV1, sample_size), sample_size_);
+  *samples_written_counter_ = 0;
+  handshake_server_.emplace([this](const std::byte* request,
+                                   size_t request_size, std::byte* response) {
+    return Respond(request, request_size, response);
+  });
+}
+
+ServiceSimulator::~ServiceSimulator() {
+  Stop();
+}
+
+size_t ServiceSimulator::Respond(const std::byte* request, size_t request_size,
+                                 std::byte* response) const {
+  if (request_size < sizeof(uint32_t) ||
+      read_swap_endianess_if_needed(
+          reinterpret_cast<const uint32_t*>(request)) != service_info_request)
+    return 0;
+  const std::string& path = memory_.name();
+  if (response_path_offset + path.size() + 1 > kMaximumMessageSize)
+    return 0;
+  WriteHeaderField(response, 0, service_info_response);
+  write_swap_endianess_if_needed(
+      reinterpret_cast<PackedVersion*>(response + response_version_offset),
+      &options_.version);
+  std::memcpy(response + response_path_offset, path.c_str(), path.size() + 1);
+  return response_path_offset + path.size() + 1;
+}
+
+void ServiceSimulator::Start() {
+  if (generator_thread_.joinable())
+    return;
+  stop_requested_ = false;
+  generator_thread_ = std::thread(&ServiceSimulator::Generate, this);
+}
+
+void ServiceSimulator::Stop() {
+  {
+    std::lock_guard lock(mutex_);
+    stop_requested_ = true;
+  }
+  stop_condition_.notify_all();
+  if (generator_thread_.joinable())
+    generator_thread_.join();
+}
+
+void ServiceSimulator::Generate() {
+  using clock_type = std::chrono::steady_clock;
+  const std::chrono::duration<double> period(1.0 / options_.sample_rate_hz);
+  const double period_ms =
+      std::chrono::duration<double, std::milli>(period).count();
+  const double start_time_ms =
+      std::chrono::duration<double, std::milli>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count();
+  const auto start = clock_type::now();
+  const auto overrun_interval =
+      std::chrono::milliseconds(options_.overrun_interval_ms);
+  std::mt19937 random(options_.seed + 1);
+  std::uniform_real_distribution<double> jitter(0.0, options_.jitter);
+  // sample n is due n sample periods after start, delayed by jitter
+  auto due_time = [&](uint64_t sample) {
+    return start + std::chrono::duration_cast<clock_type::duration>(
+                       period * (static_cast<double>(sample) + jitter(random)));
+  };
+  uint64_t generated = 0;
+  auto next_due = due_time(0);
+  auto next_overrun = start + overrun_interval;
+  std::unique_lock lock(mutex_);
+  while (!stop_requested_) {
+    const auto now = clock_type::now();
+    uint32_t pending = 0;
+    // catch up with everything that became due, single publish for all
+    while (next_due <= now) {
+      const auto time_ms = static_cast<uint64_t>(
+          start_time_ms + period_ms * static_cast<double>(generated));
+      Store(samples_written_ + pending + 1, gaze_model_.Next(time_ms));
+      ++pending;
+      next_due = due_time(++generated);
+    }
+    if (pending > 0)
+      PublishStored(pending);
+    auto wake_up = next_due;
+    if (options_.overrun_interval_ms != 0 && now >= next_overrun) {
+      // nothing is published until whole ring and one more sample are due,
+      // readers lose samples unless they read them during the burst
+      wake_up = now + std::chrono::duration_cast<clock_type::duration>(
+                          period * (options_.ring_sample_count + 1.0));
+      next_overrun = wake_up + overrun_interval;
+      overrun_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    stop_condition_.wait_until(lock, wake_up, [this] { return stop_requested_; });
+  }
+}
+
+void ServiceSimulator::Store(uint32_t sample_index,
+                             const inseye::EyeTrackerDataStruct& sample) {
+  // sample with index n (counted from 1) is stored in slot n % sample_count
+  const uint32_t slot = sample_index % options_.ring_sample_count;
+  if (sequence_offset_ != 0) {
+    // readers holding previous sample of the slot see it is being rewritten
+    StoreSequenceStamp(slot, 0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+  inseye::internal::writeDataSample(samples_ + size_t{slot} * sample_size_,
+                                    sample);
+  if (sequence_offset_ != 0)
+    StoreSequenceStamp(slot, sample_index, std::memory_order_release);
+}
+
+void ServiceSimulator::StoreSequenceStamp(uint32_t slot, uint32_t sample_index,
+                                          std::memory_order order) {
+  uint32_t stamp;
+  write_swap_endianess_if_needed(&stamp, &sample_index);
+  std::atomic_ref<uint32_t>(*reinterpret_cast<uint32_t*>(
+                                samples_ + size_t{slot} * sample_size_ +
+                                sequence_offset_))
+      .store(stamp, order);
+}
+
+void ServiceSimulator::Write(const inseye::EyeTrackerDataStruct& sample) {
+  Store(samples_written_ + 1, sample);
+  PublishStored(1);
+}
+
+void ServiceSimulator::Publish(uint32_t count) {
+  if (sequence_offset_ != 0) {
+    // replayed content is unchanged, only the stamps move on
+    for (uint32_t i = 1; i <= count; ++i)
+      StoreSequenceStamp((samples_written_ + i) % options_.ring_sample_count,
+                         samples_written_ + i, std::memory_order_release);
+  }
+  PublishStored(count);
+}
+
+void ServiceSimulator::PublishStored(uint32_t count) {
+  samples_written_ += count;
+  uint32_t counter;
+  write_swap_endianess_if_needed(&counter, &samples_written_);
+  std::atomic_ref<uint32_t>(*samples_written_counter_)
+      .store(counter, std::memory_order_release);
+  if (wake_readers_.load(std::memory_order_relaxed))
+    WakeSharedValueWaiters(samples_written_counter_);
+}
+
+uint32_t ServiceSimulator::SamplesWritten() const noexcept {
+  const uint32_t counter = std::atomic_ref<uint32_t>(*samples_written_counter_)
+                               .load(std::memory_order_acquire);
+  return read_swap_endianess_if_needed(&counter);
+}
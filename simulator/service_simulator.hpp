@@ -0,0 +1,158 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#ifndef REMOTE_CONNECTOR_SIMULATOR_SERVICE_SIMULATOR_HPP
+#define REMOTE_CONNECTOR_SIMULATOR_SERVICE_SIMULATOR_HPP
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include "remote_connector.h"
+#include "simulator_platform.hpp"
+#include "version.hpp"
+
+// Stand-in for desktop service that speaks the real protocol: shared ring
+// buffer in InMemoryV1 or InMemoryV2 layout and ServiceInfoRequest handshake
+// on the service endpoint. Lets readers be exercised and load tested without
+// hardware.
+namespace inseye::simulator {
+
+constexpr uint32_t kMinimumSampleRate = 60;
+constexpr uint32_t kMaximumSampleRate = 20000;
+
+struct SimulatorOptions {
+  // samples generated per second, kMinimumSampleRate - kMaximumSampleRate
+  uint32_t sample_rate_hz = 1000;
+  // ring slots, at least 2
+  uint32_t ring_sample_count = 4096;
+  // each sample is published up to jitter * sample period late, 0 - 1
+  double jitter = 0.0;
+  // mean number of blinks (kInsGazeBlinkBoth) per second
+  double blink_rate_hz = 0.3;
+  // mean number of saccades (kInsGazeSaccade) per second
+  double saccade_rate_hz = 3.0;
+  // every overrun_interval_ms publishing stalls until ring_sample_count + 1
+  // samples are due and then publishes them at once, 0 disables overruns
+  uint32_t overrun_interval_ms = 0;
+  // wake readers blocked in WaitForEyeTrackerData after every publish
+  bool wake_readers = true;
+  // service version reported in handshake and stored in shared memory header,
+  // 2.x selects InMemoryV2 layout
+  inseye::internal::PackedVersion version = {1, 0, 0};
+  uint32_t seed = 1;
+};
+
+/**
+ * @brief Produces plausible gaze: fixations with small noise, linear
+ * saccades between random targets and blinks holding last position.
+ */
+class GazeModel {
+  std::mt19937 random_;
+  double sample_period_s_;
+  double saccade_probability_;
+  double blink_probability_;
+  float x_ = 0, y_ = 0;
+  float target_x_ = 0, target_y_ = 0;
+  float step_x_ = 0, step_y_ = 0;
+  uint32_t saccade_samples_left_ = 0;
+  uint32_t blink_samples_left_ = 0;
+
+ public:
+  explicit GazeModel(const SimulatorOptions& options);
+  /**
+   * @brief Advances model by single sample period.
+   */
+  inseye::EyeTrackerDataStruct Next(uint64_t time_ms);
+};
+
+class ServiceSimulator {
+  SimulatorOptions options_;
+  uint32_t header_size_;
+  uint32_t sample_size_;
+  // offset of sequence stamp in slot, 0 when layout has none
+  uint32_t sequence_offset_;
+  WritableSharedMemory memory_;
+  std::byte* samples_;
+  uint32_t* samples_written_counter_;
+  // samples written by this process, counter in shared memory is LIB_ENDIAN
+  uint32_t samples_written_ = 0;
+  std::atomic<bool> wake_readers_;
+  GazeModel gaze_model_;
+  std::atomic<uint64_t> overrun_count_ = 0;
+  std::mutex mutex_;
+  std::condition_variable stop_condition_;
+  bool stop_requested_ = false;
+  std::thread generator_thread_;
+  // last member, started once shared memory header is complete
+  std::optional<HandshakeServer> handshake_server_;
+
+  size_t Respond(const std::byte* request, size_t request_size,
+                 std::byte* response) const;
+  void Generate();
+  void Store(uint32_t sample_index, const inseye::EyeTrackerDataStruct& sample);
+  void StoreSequenceStamp(uint32_t slot, uint32_t sample_index,
+                          std::memory_order order);
+  // publishes count stored samples
+  void PublishStored(uint32_t count);
+
+ public:
+  /**
+   * @brief Creates shared ring and starts answering handshake, samples are
+   * generated only after Start.
+   * Throws std::invalid_argument for invalid options and std::runtime_error
+   * when system resources can't be created.
+   */
+  explicit ServiceSimulator(const SimulatorOptions& options);
+  ServiceSimulator(const ServiceSimulator&) = delete;
+  ServiceSimulator& operator=(const ServiceSimulator&) = delete;
+  ~ServiceSimulator();
+
+  /**
+   * @brief Starts generating samples at configured rate on background thread.
+   */
+  void Start();
+  /**
+   * @brief Stops generator thread, ring and handshake stay available.
+   */
+  void Stop();
+
+  /**
+   * @brief Writes next sample to the ring and publishes it.
+   * Must not be called while generator thread is running.
+   */
+  void Write(const inseye::EyeTrackerDataStruct& sample);
+  /**
+   * @brief Advances samples written counter without touching sample memory,
+   * in InMemoryV2 layout sequence stamps of the slots are updated.
+   * Used to replay already written ring content.
+   * Must not be called while generator thread is running.
+   */
+  void Publish(uint32_t count);
+  /**
+   * @brief Enables or disables waking up readers after publish, disabled
+   * wake up mimics service that doesn't support it.
+   */
+  void SetWakeReaders(bool enabled) noexcept {
+    wake_readers_.store(enabled, std::memory_order_relaxed);
+  }
+  [[nodiscard]] uint32_t SamplesWritten() const noexcept;
+  [[nodiscard]] uint32_t SampleCount() const noexcept {
+    return options_.ring_sample_count;
+  }
+  [[nodiscard]] uint64_t OverrunCount() const noexcept {
+    return overrun_count_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] const std::string& SharedMemoryName() const noexcept {
+    return memory_.name();
+  }
+};
+
+}  // namespace inseye::simulator
+#endif  //REMOTE_CONNECTOR_SIMULATOR_SERVICE_SIMULATOR_HPP
@@ -0,0 +1,104 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#ifndef REMOTE_CONNECTOR_SIMULATOR_SIMULATOR_PLATFORM_HPP
+#define REMOTE_CONNECTOR_SIMULATOR_SIMULATOR_PLATFORM_HPP
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+// Service side counterpart of lib/transport.hpp: writable named shared memory,
+// waking readers blocked on shared word and the handshake endpoint.
+// Implementations live in simulator_platform_win32.cpp and
+// simulator_platform_posix.cpp, errors are reported with std::runtime_error.
+namespace inseye::simulator {
+
+constexpr size_t kMaximumMessageSize = 1024;
+
+/**
+ * @brief Name of the handshake endpoint, INSEYE_SERVICE_ENDPOINT environment
+ * variable replaces it. Must match ServiceEndpointName in lib/transport.hpp.
+ */
+std::string ServiceEndpointName();
+
+/**
+ * @brief Named shared memory object created and owned by the simulator.
+ */
+class WritableSharedMemory {
+  std::string name_;
+  std::byte* data_ = nullptr;
+  size_t size_ = 0;
+#if defined(_WIN32)
+  void* handle_ = nullptr;
+#else
+  int handle_ = -1;
+#endif
+
+ public:
+  /**
+   * @brief Creates zero filled shared memory object with name unique to
+   * this process and maps all of it.
+   */
+  explicit WritableSharedMemory(size_t size);
+  WritableSharedMemory(const WritableSharedMemory&) = delete;
+  WritableSharedMemory& operator=(const WritableSharedMemory&) = delete;
+  ~WritableSharedMemory();
+  /**
+   * @brief Name under which readers open the object, sent in handshake.
+   */
+  [[nodiscard]] const std::string& name() const noexcept { return name_; }
+  [[nodiscard]] std::byte* data() const noexcept { return data_; }
+  [[nodiscard]] size_t size() const noexcept { return size_; }
+};
+
+/**
+ * @brief Wakes all readers blocked in WaitForSharedValueChange on address.
+ * No-op on platforms where readers poll.
+ */
+void WakeSharedValueWaiters(uint32_t* address) noexcept;
+
+/**
+ * @brief Serves handshake endpoint on background thread until destroyed.
+ * Every client may send any number of requests over its connection.
+ */
+class HandshakeServer {
+ public:
+  /**
+   * @brief Writes response to the request into response buffer of
+   * kMaximumMessageSize bytes.
+   * @return response size, 0 drops the connection
+   */
+  using Responder = std::function<size_t(
+      const std::byte* request, size_t request_size, std::byte* response)>;
+
+ private:
+  Responder responder_;
+#if defined(_WIN32)
+  void* stop_event_ = nullptr;
+#else
+  int listen_socket_ = -1;
+  int stop_pipe_[2] = {-1, -1};
+#endif
+  std::thread server_thread_;
+
+  void Serve();
+
+ public:
+  /**
+   * @brief Claims service endpoint, fails when desktop service (or another
+   * simulator) is already running.
+   */
+  explicit HandshakeServer(Responder responder);
+  HandshakeServer(const HandshakeServer&) = delete;
+  HandshakeServer& operator=(const HandshakeServer&) = delete;
+  ~HandshakeServer();
+};
+
+}  // namespace inseye::simulator
+#endif  //REMOTE_CONNECTOR_SIMULATOR_SIMULATOR_PLATFORM_HPP
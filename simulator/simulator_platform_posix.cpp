@@ -0,0 +1,127 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include "simulator_platform.hpp"
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+using namespace inseye::simulator;
+
+std::string inseye::simulator::ServiceEndpointName() {
+  const char* endpoint = std::getenv("INSEYE_SERVICE_ENDPOINT");
+  return endpoint != nullptr && endpoint[0] != '\0' ? endpoint
+                                                     : "inseye.desktop-service";
+}
+
+WritableSharedMemory::WritableSharedMemory(size_t size)
+    : name_("/inseye_simulator_" + std::to_string(getpid())), size_(size) {
+  handle_ = shm_open(name_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+  if (handle_ < 0 || ftruncate(handle_, static_cast<off_t>(size_)) != 0)
+    throw std::runtime_error("Failed to create shared memory object " + name_);
+  void* memory =
+      mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, handle_, 0);
+  if (memory == MAP_FAILED) {
+    close(handle_);
+    shm_unlink(name_.c_str());
+    throw std::runtime_error("Failed to map shared memory object " + name_);
+  }
+  data_ = static_cast<std::byte*>(memory);
+}
+
+WritableSharedMemory::~WritableSharedMemory() {
+  munmap(data_, size_);
+  close(handle_);
+  // readers that already mapped the object keep their mapping
+  shm_unlink(name_.c_str());
+}
+
+void inseye::simulator::WakeSharedValueWaiters(uint32_t* address) noexcept {
+  // not FUTEX_PRIVATE_FLAG, waiters live in other processes
+  syscall(SYS_futex, address, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+HandshakeServer::HandshakeServer(Responder responder)
+    : responder_(std::move(responder)) {
+  listen_socket_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  // must match ServiceSocketAddress in transport_posix.cpp
+  const auto name = ServiceEndpointName();
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  const auto name_length =
+      (std::min)(name.size(), sizeof(address.sun_path) - 1);
+  std::memcpy(address.sun_path + 1, name.data(), name_length);
+  const auto address_length = static_cast<socklen_t>(
+      offsetof(sockaddr_un, sun_path) + 1 + name_length);
+  if (listen_socket_ < 0 ||
+      bind(listen_socket_, reinterpret_cast<const sockaddr*>(&address),
+           address_length) != 0 ||
+      listen(listen_socket_, 16) != 0) {
+    if (listen_socket_ >= 0)
+      close(listen_socket_);
+    throw std::runtime_error(
+        "Failed to bind service socket, is desktop service running?");
+  }
+  if (pipe2(stop_pipe_, O_CLOEXEC) != 0) {
+    close(listen_socket_);
+    throw std::runtime_error("Failed to create pipe");
+  }
+  server_thread_ = std::thread(&HandshakeServer::Serve, this);
+}
+
+HandshakeServer::~HandshakeServer() {
+  close(stop_pipe_[1]);  // wakes up server thread
+  server_thread_.join();
+  close(stop_pipe_[0]);
+  close(listen_socket_);
+}
+
+void HandshakeServer::Serve() {
+  std::vector<pollfd> descriptors{{stop_pipe_[0], POLLIN, 0},
+                                  {listen_socket_, POLLIN, 0}};
+  std::array<std::byte, kMaximumMessageSize> request{};
+  std::array<std::byte, kMaximumMessageSize> response{};
+  while (poll(descriptors.data(), descriptors.size(), -1) >= 0) {
+    if (descriptors[0].revents != 0)
+      break;
+    if (descriptors[1].revents & POLLIN) {
+      const int client = accept4(listen_socket_, nullptr, nullptr, SOCK_CLOEXEC);
+      if (client >= 0)
+        descriptors.push_back({client, POLLIN, 0});
+    }
+    for (size_t i = 2; i < descriptors.size(); ++i) {
+      if (descriptors[i].revents == 0)
+        continue;
+      const ssize_t received =
+          recv(descriptors[i].fd, request.data(), request.size(), 0);
+      size_t response_size = 0;
+      if (received > 0)
+        response_size = responder_(request.data(),
+                                   static_cast<size_t>(received),
+                                   response.data());
+      if (response_size == 0 || send(descriptors[i].fd, response.data(),
+                                     response_size, MSG_NOSIGNAL) <= 0) {
+        close(descriptors[i].fd);
+        descriptors.erase(descriptors.begin() + static_cast<ptrdiff_t>(i--));
+      }
+    }
+  }
+  for (size_t i = 2; i < descriptors.size(); ++i)
+    close(descriptors[i].fd);
+}
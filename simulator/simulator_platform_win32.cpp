@@ -0,0 +1,181 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#include "simulator_platform.hpp"
+#include <windows.h>
+#include <array>
+#include <format>
+#include <stdexcept>
+#include <vector>
+
+using namespace inseye::simulator;
+
+std::string inseye::simulator::ServiceEndpointName() {
+  std::array<char, 256> endpoint{};
+  const auto length = GetEnvironmentVariableA(
+      "INSEYE_SERVICE_ENDPOINT", endpoint.data(),
+      static_cast<DWORD>(endpoint.size()));
+  if (length == 0 || length >= endpoint.size())
+    return "inseye.desktop-service";
+  return {endpoint.data(), length};
+}
+
+namespace {
+// must match transport_win32.cpp
+std::string NamedPipeName() {
+  return "\\\\.\\pipe\\" + ServiceEndpointName();
+}
+
+// Waits for overlapped operation to finish or stop event to be signaled,
+// operation is cancelled in the latter case.
+bool AwaitOverlapped(HANDLE pipe, OVERLAPPED& overlapped, HANDLE stop_event,
+                     DWORD& transferred) {
+  const std::array<HANDLE, 2> handles{overlapped.hEvent, stop_event};
+  if (WaitForMultipleObjects(static_cast<DWORD>(handles.size()),
+                             handles.data(), FALSE,
+                             INFINITE) != WAIT_OBJECT_0) {
+    CancelIo(pipe);
+    GetOverlappedResult(pipe, &overlapped, &transferred, TRUE);
+    return false;
+  }
+  return GetOverlappedResult(pipe, &overlapped, &transferred, FALSE) != FALSE;
+}
+
+void ServeClient(HANDLE pipe, HANDLE stop_event,
+                 const HandshakeServer::Responder& responder) {
+  OVERLAPPED overlapped{};
+  overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+  std::array<std::byte, kMaximumMessageSize> request{};
+  std::array<std::byte, kMaximumMessageSize> response{};
+  while (true) {
+    DWORD transferred = 0;
+    ResetEvent(overlapped.hEvent);
+    if (!ReadFile(pipe, request.data(), static_cast<DWORD>(request.size()),
+                  nullptr, &overlapped) &&
+        GetLastError() != ERROR_IO_PENDING)
+      break;
+    if (!AwaitOverlapped(pipe, overlapped, stop_event, transferred) ||
+        transferred == 0)
+      break;
+    const size_t response_size =
+        responder(request.data(), transferred, response.data());
+    if (response_size == 0)
+      break;
+    ResetEvent(overlapped.hEvent);
+    if (!WriteFile(pipe, response.data(), static_cast<DWORD>(response_size),
+                   nullptr, &overlapped) &&
+        GetLastError() != ERROR_IO_PENDING)
+      break;
+    if (!AwaitOverlapped(pipe, overlapped, stop_event, transferred))
+      break;
+  }
+  CloseHandle(overlapped.hEvent);
+  DisconnectNamedPipe(pipe);
+  CloseHandle(pipe);
+}
+
+HANDLE CreatePipeInstance() {
+  return CreateNamedPipeA(
+      NamedPipeName().c_str(), PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED,
+      PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT,
+      PIPE_UNLIMITED_INSTANCES, kMaximumMessageSize, kMaximumMessageSize, 0,
+      nullptr);
+}
+}  // namespace
+
+WritableSharedMemory::WritableSharedMemory(size_t size)
+    : name_(std::format("inseye_simulator_{}", GetCurrentProcessId())),
+      size_(size) {
+  const auto size64 = static_cast<uint64_t>(size);
+  handle_ = CreateFileMappingA(INVALID_HANDLE_VALUE,  // use paging file
+                               nullptr, PAGE_READWRITE,
+                               static_cast<DWORD>(size64 >> 32),
+                               static_cast<DWORD>(size64), name_.c_str());
+  if (handle_ == nullptr)
+    throw std::runtime_error(std::format(
+        "Failed to create shared memory object {}, GLE={}", name_,
+        GetLastError()));
+  data_ = static_cast<std::byte*>(
+      MapViewOfFile(handle_, FILE_MAP_ALL_ACCESS, 0, 0, size_));
+  if (data_ == nullptr) {
+    CloseHandle(handle_);
+    throw std::runtime_error(std::format(
+        "Failed to map shared memory object {}, GLE={}", name_,
+        GetLastError()));
+  }
+}
+
+WritableSharedMemory::~WritableSharedMemory() {
+  UnmapViewOfFile(data_);
+  CloseHandle(handle_);
+}
+
+void inseye::simulator::WakeSharedValueWaiters(uint32_t*) noexcept {
+  // readers on Windows poll the counter, see WaitForSharedValueChange
+}
+
+HandshakeServer::HandshakeServer(Responder responder)
+    : responder_(std::move(responder)) {
+  // first instance fails when the pipe already belongs to other process
+  HANDLE probe = CreateNamedPipeA(
+      NamedPipeName().c_str(),
+      PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+      PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT,
+      PIPE_UNLIMITED_INSTANCES, kMaximumMessageSize, kMaximumMessageSize, 0,
+      nullptr);
+  if (probe == INVALID_HANDLE_VALUE)
+    throw std::runtime_error(
+        "Failed to create service pipe, is desktop service running?");
+  CloseHandle(probe);
+  stop_event_ = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+  if (stop_event_ == nullptr)
+    throw std::runtime_error("Failed to create event");
+  server_thread_ = std::thread(&HandshakeServer::Serve, this);
+}
+
+HandshakeServer::~HandshakeServer() {
+  SetEvent(stop_event_);
+  server_thread_.join();
+  CloseHandle(stop_event_);
+}
+
+void HandshakeServer::Serve() {
+  std::vector<std::thread> clients;
+  OVERLAPPED overlapped{};
+  overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+  while (true) {
+    HANDLE pipe = CreatePipeInstance();
+    if (pipe == INVALID_HANDLE_VALUE)
+      break;
+    ResetEvent(overlapped.hEvent);
+    bool connected = ConnectNamedPipe(pipe, &overlapped) != FALSE;
+    if (!connected) {
+      DWORD transferred = 0;
+      switch (GetLastError()) {
+        case ERROR_PIPE_CONNECTED:
+          connected = true;
+          break;
+        case ERROR_IO_PENDING:
+          connected =
+              AwaitOverlapped(pipe, overlapped, stop_event_, transferred);
+          break;
+        default:
+          break;
+      }
+    }
+    if (!connected) {
+      CloseHandle(pipe);
+      if (WaitForSingleObject(stop_event_, 0) == WAIT_OBJECT_0)
+        break;
+      continue;
+    }
+    clients.emplace_back(ServeClient, pipe, stop_event_, std::cref(responder_));
+  }
+  CloseHandle(overlapped.hEvent);
+  for (auto& client : clients)
+    client.join();
+}
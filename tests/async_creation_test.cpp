@@ -0,0 +1,87 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+// Asynchronous reader creation completes with working reader, cancellation
+// either stops the operation or comes after it already completed, and
+// destroying unfinished operation doesn't wait for it.
+
+#include <chrono>
+#include <thread>
+#include "test_support.hpp"
+
+using namespace inseye::test;
+
+namespace {
+constexpr uint32_t iterations = 40;
+
+void CheckCompletion(inseye::simulator::ServiceSimulator& service) {
+  // cold creation, the one that talks to the service
+  inseye::c::ReleaseServiceConnectionCache();
+  inseye::c::InseyeAsyncOperation* operation = nullptr;
+  if (!INSEYE_EXPECT(inseye::c::CreateEyeTrackerReaderAsync(&operation, 1000) ==
+                     inseye::c::InseyeInitializationStatus::kSuccess))
+    return;
+  INSEYE_EXPECT(inseye::c::WaitForAsyncOperation(operation, 1000));
+  INSEYE_EXPECT(inseye::c::GetAsyncOperationState(operation) ==
+                inseye::c::kInsCompleted);
+  inseye::c::InseyeEyeTracker* tracker = nullptr;
+  if (INSEYE_EXPECT(
+          inseye::c::GetEyeTrackerReaderAsyncResult(operation, &tracker) ==
+          inseye::c::InseyeInitializationStatus::kSuccess)) {
+    inseye::EyeTrackerDataStruct sample{};
+    while (inseye::c::TryReadNextEyeTrackerData(tracker, &sample)) {}
+    uint64_t time = service.SamplesWritten() + 1;
+    const uint64_t first = time;
+    WriteStressSamples(service, time, 1);
+    INSEYE_EXPECT(inseye::c::TryReadNextEyeTrackerData(tracker, &sample) &&
+                  sample.time == first);
+    inseye::c::DestroyEyeTrackerReader(&tracker);
+  }
+  inseye::c::DestroyAsyncOperation(&operation);
+  INSEYE_EXPECT(operation == nullptr);
+}
+
+void CheckCancellation() {
+  inseye::c::ReleaseServiceConnectionCache();
+  inseye::c::InseyeAsyncOperation* operation = nullptr;
+  if (!INSEYE_EXPECT(inseye::c::CreateEyeTrackerReaderAsync(&operation, 1000) ==
+                     inseye::c::InseyeInitializationStatus::kSuccess))
+    return;
+  // cancellation may come after the reader was already created
+  const bool pending = inseye::c::CancelAsyncOperation(operation);
+  INSEYE_EXPECT(inseye::c::WaitForAsyncOperation(operation, 1000));
+  const auto state = inseye::c::GetAsyncOperationState(operation);
+  INSEYE_EXPECT(pending ? state == inseye::c::kInsAsyncCancelled
+                        : state == inseye::c::kInsCompleted);
+  inseye::c::DestroyAsyncOperation(&operation);
+}
+
+void CheckAbandonment() {
+  inseye::c::ReleaseServiceConnectionCache();
+  inseye::c::InseyeAsyncOperation* operation = nullptr;
+  if (!INSEYE_EXPECT(inseye::c::CreateEyeTrackerReaderAsync(&operation, 1000) ==
+                     inseye::c::InseyeInitializationStatus::kSuccess))
+    return;
+  // unfinished operation frees itself when its thread stops
+  inseye::c::DestroyAsyncOperation(&operation);
+  INSEYE_EXPECT(operation == nullptr);
+}
+}  // namespace
+
+int main() {
+  auto service = StartSimulator({.ring_sample_count = 64});
+  if (!service)
+    return kSkipped;
+  for (uint32_t i = 0; i < iterations; ++i) {
+    CheckCompletion(*service);
+    CheckCancellation();
+    CheckAbandonment();
+  }
+  // abandoned operations finish against live service, not during exit
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  return ExitCode();
+}
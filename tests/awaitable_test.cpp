@@ -0,0 +1,157 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+// Coroutines suspended on their own cursors get every published sample from
+// the library watcher thread and are resumed with empty result when their
+// cursors are destroyed. Coroutine destroyed while suspended is forgotten by
+// the watcher.
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <thread>
+#include <vector>
+#include "test_support.hpp"
+
+using namespace inseye::test;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+constexpr uint32_t iterations = 500;
+constexpr uint32_t consumer_count = 8;
+constexpr auto resume_timeout = std::chrono::seconds(2);
+
+// Coroutine that starts at once and frees itself when it ends.
+struct DetachedTask {
+  struct promise_type {
+    DetachedTask get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+// Coroutine that starts at once and is destroyed with its task.
+struct OwnedTask {
+  struct promise_type {
+    OwnedTask get_return_object() noexcept {
+      return {std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+
+  std::coroutine_handle<promise_type> handle;
+
+  OwnedTask(std::coroutine_handle<promise_type> handle) noexcept
+      : handle(handle) {}
+  OwnedTask(const OwnedTask&) = delete;
+  OwnedTask& operator=(const OwnedTask&) = delete;
+  ~OwnedTask() { handle.destroy(); }
+};
+
+OwnedTask AwaitOneSample(inseye::EyeTrackerCursor& cursor,
+                         std::atomic<uint32_t>& resumed) {
+  co_await cursor.NextSample();
+  resumed.fetch_add(1);
+}
+
+struct AwaitingConsumers {
+  std::atomic<uint64_t> consumed = 0;
+  std::atomic<uint64_t> unexpected = 0;
+  std::atomic<uint32_t> finished = 0;
+
+  void OnSample(const inseye::EyeTrackerDataStruct& sample,
+                uint64_t& next_time) {
+    if (sample.time != next_time++ || !IsStressSampleIntact(sample))
+      unexpected.fetch_add(1, std::memory_order_relaxed);
+    consumed.fetch_add(1, std::memory_order_release);
+  }
+};
+
+DetachedTask AwaitNextSamples(inseye::EyeTrackerCursor& cursor,
+                              AwaitingConsumers& consumers) {
+  uint64_t next_time = 1;
+  while (const auto sample = co_await cursor.NextSample())
+    consumers.OnSample(*sample, next_time);
+  consumers.finished.fetch_add(1);
+}
+
+DetachedTask AwaitSampleStream(inseye::EyeTrackerCursor& cursor,
+                               AwaitingConsumers& consumers) {
+  uint64_t next_time = 1;
+  auto stream = cursor.Samples();
+  while (const auto sample = co_await stream.Next())
+    consumers.OnSample(*sample, next_time);
+  consumers.finished.fetch_add(1);
+}
+
+template <typename Condition>
+bool WaitUntil(Condition&& condition) {
+  const auto deadline = clock_type::now() + resume_timeout;
+  while (!condition()) {
+    if (clock_type::now() > deadline)
+      return false;
+    std::this_thread::yield();
+  }
+  return true;
+}
+}  // namespace
+
+int main() {
+  auto service = StartSimulator({});
+  if (!service)
+    return kSkipped;
+  inseye::EyeTracker tracker(1000);
+  std::vector<inseye::EyeTrackerCursor> cursors;
+  cursors.reserve(consumer_count);
+  AwaitingConsumers consumers;
+  for (uint32_t i = 0; i < consumer_count; ++i) {
+    cursors.emplace_back(tracker);
+    if (i % 2 == 0)
+      AwaitNextSamples(cursors.back(), consumers);
+    else
+      AwaitSampleStream(cursors.back(), consumers);
+  }
+  uint64_t time = 1;
+  for (uint32_t i = 1; i <= iterations; ++i) {
+    WriteStressSamples(*service, time, 1);
+    if (!INSEYE_EXPECT(WaitUntil([&] {
+          return consumers.consumed.load(std::memory_order_acquire) >=
+                 static_cast<uint64_t>(i) * consumer_count;
+        })))
+      break;
+  }
+  INSEYE_EXPECT(consumers.consumed.load() ==
+                static_cast<uint64_t>(iterations) * consumer_count);
+  INSEYE_EXPECT(consumers.unexpected.load() == 0);
+  // coroutines get back to suspension right after counting the sample
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  cursors.clear();
+  INSEYE_EXPECT(
+      WaitUntil([&] { return consumers.finished.load() == consumer_count; }));
+
+  // destroyed suspended coroutines are never resumed, the one left is
+  inseye::EyeTrackerCursor cursor(tracker);
+  inseye::EyeTrackerDataStruct sample{};
+  while (cursor.TryReadNextEyeTrackerData(sample)) {}
+  std::atomic<uint32_t> resumed = 0;
+  {
+    const OwnedTask first = AwaitOneSample(cursor, resumed);
+    const OwnedTask second = AwaitOneSample(cursor, resumed);
+  }
+  const OwnedTask kept = AwaitOneSample(cursor, resumed);
+  WriteStressSamples(*service, time, 1);
+  INSEYE_EXPECT(WaitUntil([&] { return resumed.load() != 0; }));
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  INSEYE_EXPECT(resumed.load() == 1);
+  return ExitCode();
+}
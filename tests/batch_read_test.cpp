@@ -0,0 +1,92 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+// Batch and columnar reads return the same samples as single reads, also when
+// the copy wraps around the end of the ring.
+
+#include <algorithm>
+#include <array>
+#include <vector>
+#include "test_support.hpp"
+
+using namespace inseye::test;
+
+namespace {
+constexpr uint32_t ring_sample_count = 64;
+constexpr uint32_t samples_per_round = 50;
+constexpr uint32_t capacity = 16;
+
+std::vector<inseye::EyeTrackerDataStruct> ReadSingle(
+    inseye::EyeTracker& tracker) {
+  std::vector<inseye::EyeTrackerDataStruct> samples;
+  inseye::EyeTrackerDataStruct sample{};
+  while (tracker.TryReadNextEyeTrackerData(sample))
+    samples.push_back(sample);
+  return samples;
+}
+
+std::vector<inseye::EyeTrackerDataStruct> ReadBatches(
+    inseye::EyeTracker& tracker) {
+  std::vector<inseye::EyeTrackerDataStruct> samples;
+  std::array<inseye::EyeTrackerDataStruct, capacity> buffer{};
+  uint32_t count = 0;
+  while (tracker.TryReadEyeTrackerDataBatch(buffer, count))
+    samples.insert(samples.end(), buffer.begin(), buffer.begin() + count);
+  return samples;
+}
+
+std::vector<inseye::EyeTrackerDataStruct> ReadColumns(
+    inseye::EyeTracker& tracker) {
+  std::vector<inseye::EyeTrackerDataStruct> samples;
+  std::array<uint64_t, capacity> time{};
+  std::array<float, 4 * capacity> positions{};
+  std::array<inseye::GazeEvent, capacity> gaze_events{};
+  const inseye::EyeTrackerDataColumns columns{
+      time.data(),
+      positions.data(),
+      positions.data() + capacity,
+      positions.data() + 2 * capacity,
+      positions.data() + 3 * capacity,
+      gaze_events.data()};
+  uint32_t count = 0;
+  while (tracker.ReadEyeTrackerDataColumns(columns, capacity, count))
+    for (uint32_t i = 0; i < count; ++i)
+      samples.push_back({time[i], columns.left_eye_x[i],
+                         columns.left_eye_y[i], columns.right_eye_x[i],
+                         columns.right_eye_y[i], gaze_events[i]});
+  return samples;
+}
+
+bool AreSameSamples(const std::vector<inseye::EyeTrackerDataStruct>& a,
+                    const std::vector<inseye::EyeTrackerDataStruct>& b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(), IsSameSample);
+}
+}  // namespace
+
+int main() {
+  auto service = StartSimulator({.ring_sample_count = ring_sample_count});
+  if (!service)
+    return kSkipped;
+  inseye::EyeTracker single(1000), batched(1000), columnar(1000);
+  ReadSingle(single);
+  ReadBatches(batched);
+  ReadColumns(columnar);
+  uint64_t time = 1;
+  // rounds after the first one wrap around the end of the ring
+  for (int round = 0; round < 4; ++round) {
+    const uint64_t first = time;
+    WriteStressSamples(*service, time, samples_per_round);
+    const auto expected = ReadSingle(single);
+    INSEYE_EXPECT(expected.size() == samples_per_round);
+    INSEYE_EXPECT(!expected.empty() && expected.front().time == first);
+    INSEYE_EXPECT(std::all_of(expected.begin(), expected.end(),
+                              IsStressSampleIntact));
+    INSEYE_EXPECT(AreSameSamples(ReadBatches(batched), expected));
+    INSEYE_EXPECT(AreSameSamples(ReadColumns(columnar), expected));
+  }
+  return ExitCode();
+}
@@ -0,0 +1,101 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+// Every columns decoder kernel supported by this machine decodes the same
+// values as readDataSample, for counts that leave kernel tails, for column
+// offsets and for packed (InMemoryV1) and slotted (InMemoryV2) samples.
+
+#include <cstring>
+#include <vector>
+#include "columns_decoder.hpp"
+#include "eye_tracker_data_struct.hpp"
+#include "test_support.hpp"
+
+using namespace inseye::test;
+using inseye::internal::ColumnsDecoderKernel;
+
+namespace {
+constexpr uint32_t sample_count = 1000;
+constexpr size_t column_offset = 3;
+
+std::vector<std::byte> MakeSamples(size_t sample_size) {
+  std::vector<std::byte> samples(sample_count * sample_size);
+  for (uint32_t i = 0; i < sample_count; ++i) {
+    const auto value = static_cast<float>(i);
+    // every eighth sample carries event value from newer service
+    const inseye::internal::EyeTrackerDataStruct sample{
+        i, value, -value, value * 0.5f, -value * 0.5f,
+        static_cast<uint32_t>(i % 8 == 7 ? 1000 : i % 7)};
+    std::memcpy(samples.data() + i * sample_size, &sample, sizeof(sample));
+  }
+  return samples;
+}
+
+struct Columns {
+  std::vector<uint64_t> time;
+  std::vector<float> left_eye_x, left_eye_y, right_eye_x, right_eye_y;
+  std::vector<inseye::GazeEvent> gaze_event;
+
+  explicit Columns(size_t size)
+      : time(size),
+        left_eye_x(size),
+        left_eye_y(size),
+        right_eye_x(size),
+        right_eye_y(size),
+        gaze_event(size) {}
+
+  inseye::EyeTrackerDataColumns View() {
+    return {time.data(),        left_eye_x.data(),  left_eye_y.data(),
+            right_eye_x.data(), right_eye_y.data(), gaze_event.data()};
+  }
+};
+
+// Columns at [column_offset, column_offset + count) hold first count samples.
+bool MatchesReference(const Columns& columns, const std::byte* samples,
+                      size_t sample_size, uint32_t count) {
+  for (uint32_t i = 0; i < count; ++i) {
+    inseye::EyeTrackerDataStruct expected{};
+    inseye::internal::readDataSample(samples + i * sample_size, expected);
+    const size_t n = column_offset + i;
+    if (columns.time[n] != expected.time ||
+        columns.left_eye_x[n] != expected.left_eye_x ||
+        columns.left_eye_y[n] != expected.left_eye_y ||
+        columns.right_eye_x[n] != expected.right_eye_x ||
+        columns.right_eye_y[n] != expected.right_eye_y ||
+        columns.gaze_event[n] != expected.gaze_event)
+      return false;
+  }
+  return true;
+}
+}  // namespace
+
+int main() {
+  for (const auto kernel :
+       {ColumnsDecoderKernel::kScalar, ColumnsDecoderKernel::kSse41,
+        ColumnsDecoderKernel::kAvx2}) {
+    if (!inseye::internal::IsColumnsDecoderKernelSupported(kernel)) {
+      std::printf("Kernel %s not supported\n",
+                  inseye::internal::ToString(kernel));
+      continue;
+    }
+    for (const size_t sample_size :
+         {sizeof(inseye::internal::EyeTrackerDataStruct), size_t{32}}) {
+      const auto samples = MakeSamples(sample_size);
+      for (const uint32_t count : {1u, 7u, 8u, 9u, 31u, 33u, sample_count}) {
+        Columns columns(column_offset + count);
+        inseye::internal::DecodeSampleColumns(kernel, samples.data(),
+                                              sample_size, count,
+                                              columns.View(), column_offset);
+        if (!INSEYE_EXPECT(
+                MatchesReference(columns, samples.data(), sample_size, count)))
+          std::printf("  kernel %s, sample size %zu, count %u\n",
+                      inseye::internal::ToString(kernel), sample_size, count);
+      }
+    }
+  }
+  return ExitCode();
+}
@@ -0,0 +1,80 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+// Cursors keep independent read positions over mapping of one reader: four
+// consumers draining at different paces each read every sample in order, also
+// after the reader that created them is destroyed.
+
+#include <vector>
+#include "test_support.hpp"
+
+using namespace inseye::test;
+
+namespace {
+constexpr uint32_t consumer_count = 4;
+constexpr uint32_t rounds = 200;
+constexpr uint32_t samples_per_round = 64;
+
+struct Consumer {
+  inseye::c::InseyeCursor* cursor = nullptr;
+  uint64_t next_time = 1;
+  uint64_t unexpected = 0;
+};
+
+void Drain(Consumer& consumer,
+           std::vector<inseye::EyeTrackerDataStruct>& buffer) {
+  uint32_t count = 0;
+  while (inseye::c::TryReadCursorDataBatch(
+      consumer.cursor, buffer.data(), static_cast<uint32_t>(buffer.size()),
+      &count))
+    for (uint32_t i = 0; i < count; ++i)
+      consumer.unexpected += buffer[i].time == consumer.next_time++ &&
+                                     IsStressSampleIntact(buffer[i])
+                                 ? 0
+                                 : 1;
+}
+}  // namespace
+
+int main() {
+  auto service = StartSimulator({.wake_readers = false});
+  if (!service)
+    return kSkipped;
+  inseye::c::InseyeEyeTracker* tracker = nullptr;
+  if (!INSEYE_EXPECT(inseye::c::CreateEyeTrackerReader(&tracker, 1000) ==
+                     inseye::c::InseyeInitializationStatus::kSuccess))
+    return ExitCode();
+  std::vector<Consumer> consumers(consumer_count);
+  for (auto& consumer : consumers)
+    INSEYE_EXPECT(inseye::c::CreateEyeTrackerCursor(tracker, &consumer.cursor) ==
+                  inseye::c::InseyeInitializationStatus::kSuccess);
+  // the reader is not needed for cursors to keep reading
+  inseye::c::DestroyEyeTrackerReader(&tracker);
+  std::vector<inseye::EyeTrackerDataStruct> buffer(samples_per_round *
+                                                   consumer_count);
+  uint64_t time = 1;
+  for (uint32_t round = 1; round <= rounds; ++round) {
+    WriteStressSamples(*service, time, samples_per_round);
+    // consumer i drains every (i + 1)-th round
+    for (uint32_t i = 0; i < consumer_count; ++i)
+      if (round % (i + 1) == 0)
+        Drain(consumers[i], buffer);
+  }
+  for (auto& consumer : consumers) {
+    Drain(consumer, buffer);
+    INSEYE_EXPECT(consumer.unexpected == 0);
+    INSEYE_EXPECT(consumer.next_time == time);
+    // statistics are missing when built with INSEYE_READER_STATISTICS=OFF
+    inseye::ReaderStatistics statistics{};
+    if (inseye::c::GetCursorReaderStatistics(consumer.cursor, &statistics)) {
+      INSEYE_EXPECT(statistics.samples_delivered ==
+                    rounds * samples_per_round);
+      INSEYE_EXPECT(statistics.samples_dropped == 0);
+    }
+    inseye::c::DestroyEyeTrackerCursor(&consumer.cursor);
+  }
+  return ExitCode();
+}
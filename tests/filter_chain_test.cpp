@@ -0,0 +1,107 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+// Smooth pursuit with fixation noise and single sample spikes is read through
+// filter chains. Raw samples returned next to filtered ones must be untouched
+// and every chain must bring gaze closer to the noiseless one than raw
+// samples are.
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <span>
+#include <utility>
+#include <vector>
+#include "test_support.hpp"
+
+using namespace inseye::test;
+
+namespace {
+constexpr uint32_t sample_count = 8192;
+constexpr uint32_t warm_up = 256;
+constexpr uint32_t spike_period = 97;
+}  // namespace
+
+int main() {
+  auto service = StartSimulator({});
+  if (!service)
+    return kSkipped;
+  using inseye::FilterType;
+  const std::pair<const char*, std::vector<inseye::FilterStage>> chains[] = {
+      {"ema", {{.type = FilterType::kInsFilterExponentialMovingAverage,
+                .alpha = 0.2f}}},
+      {"one_euro", {{.type = FilterType::kInsFilterOneEuro,
+                     .min_cutoff_hz = 5.0f,
+                     .beta = 10.0f}}},
+      {"median_5", {{.type = FilterType::kInsFilterMedian, .window = 5}}},
+      {"outlier_median_one_euro",
+       {{.type = FilterType::kInsFilterOutlierRejection,
+         .max_jump = 0.02f,
+         .max_rejected = 2},
+        {.type = FilterType::kInsFilterMedian, .window = 3},
+        {.type = FilterType::kInsFilterOneEuro,
+         .min_cutoff_hz = 5.0f,
+         .beta = 10.0f}}}};
+  std::mt19937 generator(11);
+  std::normal_distribution<float> noise(0.0f, 0.0015f);
+  std::vector<inseye::EyeTrackerDataStruct> truth(sample_count),
+      noisy(sample_count);
+  for (uint32_t i = 0; i < sample_count; ++i) {
+    const double phase = static_cast<double>(i % 2000) / 2000.0 * 2.0 *
+                         3.14159265358979323846;
+    const auto x = static_cast<float>(0.2 * std::cos(phase));
+    const auto y = static_cast<float>(0.2 * std::sin(phase));
+    truth[i] = {i, x + 0.03f, y, x - 0.03f, y,
+                inseye::GazeEvent::kInsGazeNone};
+    noisy[i] = truth[i];
+    noisy[i].left_eye_x += noise(generator);
+    noisy[i].left_eye_y += noise(generator);
+    noisy[i].right_eye_x += noise(generator);
+    noisy[i].right_eye_y += noise(generator);
+    if (i % spike_period == 0)
+      noisy[i].left_eye_x += 0.1f;
+  }
+  const auto rms_error = [&](const std::vector<inseye::EyeTrackerDataStruct>&
+                                 samples) {
+    double sum = 0;
+    for (uint32_t i = warm_up; i < sample_count; ++i) {
+      const double dx = samples[i].left_eye_x - truth[i].left_eye_x;
+      const double dy = samples[i].left_eye_y - truth[i].left_eye_y;
+      sum += dx * dx + dy * dy;
+    }
+    return std::sqrt(sum / (sample_count - warm_up));
+  };
+  const double raw_error = rms_error(noisy);
+  for (const auto& [name, stages] : chains) {
+    inseye::EyeTracker tracker(1000);
+    inseye::EyeTrackerDataStruct sample{};
+    while (tracker.TryReadNextEyeTrackerData(sample)) {}
+    tracker.SetFilterChain(stages);
+    std::vector<inseye::EyeTrackerDataStruct> raw(sample_count),
+        filtered(sample_count);
+    uint32_t read = 0, count = 0;
+    for (uint32_t i = 0; i < sample_count; ++i) {
+      service->Write(noisy[i]);
+      if (i % 512 == 511 || i + 1 == sample_count)
+        while (tracker.TryReadFilteredEyeTrackerDataBatch(
+            std::span(raw).subspan(read), std::span(filtered).subspan(read),
+            count))
+          read += count;
+    }
+    const double filtered_error = rms_error(filtered);
+    std::printf("%s: raw error %.5f, filtered error %.5f\n", name, raw_error,
+                filtered_error);
+    INSEYE_EXPECT(read == sample_count);
+    INSEYE_EXPECT(std::equal(raw.begin(), raw.end(), noisy.begin(),
+                             noisy.end(), IsSameSample));
+    INSEYE_EXPECT(std::equal(
+        filtered.begin(), filtered.end(), noisy.begin(), noisy.end(),
+        [](const auto& a, const auto& b) { return a.time == b.time; }));
+    INSEYE_EXPECT(filtered_error < raw_error);
+  }
+  return ExitCode();
+}
@@ -0,0 +1,68 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+// Shared memory header major version selects ring layout, services of supported
+// versions are read in their layout and the others are refused with status
+// telling which bound they broke.
+
+#include <array>
+#include "test_support.hpp"
+
+using namespace inseye::test;
+
+namespace {
+using Status = inseye::c::InseyeInitializationStatus;
+
+struct VersionCase {
+  inseye::internal::PackedVersion version;
+  Status expected_status;
+};
+
+bool CheckVersion(const VersionCase& version_case) {
+  const auto& version = version_case.version;
+  auto service = StartSimulator({.ring_sample_count = 64, .version = version});
+  if (!service)
+    return false;
+  uint64_t time = 1;
+  WriteStressSamples(*service, time, 100);
+  inseye::c::InseyeEyeTracker* tracker = nullptr;
+  const auto status = inseye::c::CreateEyeTrackerReader(&tracker, 1000);
+  if (!INSEYE_EXPECT(status == version_case.expected_status))
+    std::printf("  service %u.%u.%u: %s\n", version.major, version.minor,
+                version.patch, inseye::c::GetLastErrorDescription());
+  if (status != Status::kSuccess)
+    return true;
+  inseye::EyeTrackerDataStruct sample{};
+  INSEYE_EXPECT(inseye::c::TryReadLatestEyeTrackerData(tracker, &sample));
+  INSEYE_EXPECT(sample.time == time - 1 && IsStressSampleIntact(sample));
+  WriteStressSamples(*service, time, 10);
+  uint32_t read = 0;
+  while (inseye::c::TryReadNextEyeTrackerData(tracker, &sample) &&
+         IsStressSampleIntact(sample))
+    ++read;
+  INSEYE_EXPECT(read == 10);
+  inseye::c::DestroyEyeTrackerReader(&tracker);
+  return true;
+}
+}  // namespace
+
+int main() {
+  const std::array cases = {
+      VersionCase{{0, 0, 0}, Status::kServiceVersionToLow},
+      VersionCase{{0, 0, 1}, Status::kSuccess},
+      VersionCase{{1, 0, 0}, Status::kSuccess},
+      VersionCase{{1, 5, 2}, Status::kSuccess},
+      VersionCase{{2, 0, 0}, Status::kSuccess},
+      // newer minor and patch versions of supported major keep its layout
+      VersionCase{{2, 3, 1}, Status::kSuccess},
+      VersionCase{{3, 0, 0}, Status::kServiceVersionToHigh},
+  };
+  for (const auto& version_case : cases)
+    if (!CheckVersion(version_case))
+      return kSkipped;
+  return ExitCode();
+}
@@ -0,0 +1,667 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+// Checks that reads, waits and batches of initialized readers don't allocate.
+// Global operator new and delete (and malloc family on glibc) are replaced
+// with counting versions that count only while the calling thread is armed.
+// Every checked call runs armed, samples are published between them disarmed.
+// Exits with failure when any checked call allocated.
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <thread>
+#include "remote_connector.h"
+#include "service_simulator.hpp"
+#include "test_support.hpp"
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+#define INSEYE_COUNT_MALLOC 1
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* pointer);
+}
+#else
+#define INSEYE_COUNT_MALLOC 0
+#endif
+
+using namespace inseye::simulator;
+
+namespace {
+thread_local bool armed = false;
+std::atomic<uint64_t> armed_allocation_count = 0;
+std::atomic<size_t> last_armed_allocation_size = 0;
+
+void CountAllocation(size_t size) noexcept {
+  if (!armed)
+    return;
+  armed_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  last_armed_allocation_size.store(size, std::memory_order_relaxed);
+}
+
+void* AllocateCounted(size_t size, size_t alignment) noexcept {
+  CountAllocation(size);
+  if (size == 0)
+    size = 1;
+#if INSEYE_COUNT_MALLOC
+  return alignment <= alignof(std::max_align_t)
+             ? __libc_malloc(size)
+             : __libc_memalign(alignment, size);
+#elif defined(_MSC_VER)
+  return _aligned_malloc(size, (std::max)(alignment, alignof(std::max_align_t)));
+#else
+  if (alignment <= alignof(std::max_align_t))
+    return std::malloc(size);
+  return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+void FreeCounted(void* pointer) noexcept {
+#if INSEYE_COUNT_MALLOC
+  __libc_free(pointer);
+#elif defined(_MSC_VER)
+  _aligned_free(pointer);
+#else
+  std::free(pointer);
+#endif
+}
+
+void* AllocateOrThrow(size_t size, size_t alignment) {
+  void* pointer = AllocateCounted(size, alignment);
+  if (pointer == nullptr)
+    throw std::bad_alloc();
+  return pointer;
+}
+}  // namespace
+
+void* operator new(size_t size) {
+  return AllocateOrThrow(size, alignof(std::max_align_t));
+}
+void* operator new[](size_t size) {
+  return AllocateOrThrow(size, alignof(std::max_align_t));
+}
+void* operator new(size_t size, std::align_val_t alignment) {
+  return AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+  return AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return AllocateCounted(size, alignof(std::max_align_t));
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return AllocateCounted(size, alignof(std::max_align_t));
+}
+void* operator new(size_t size, std::align_val_t alignment,
+                   const std::nothrow_t&) noexcept {
+  return AllocateCounted(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept {
+  return AllocateCounted(size, static_cast<size_t>(alignment));
+}
+void operator delete(void* pointer) noexcept { FreeCounted(pointer); }
+void operator delete[](void* pointer) noexcept { FreeCounted(pointer); }
+void operator delete(void* pointer, size_t) noexcept { FreeCounted(pointer); }
+void operator delete[](void* pointer, size_t) noexcept {
+  FreeCounted(pointer);
+}
+void operator delete(void* pointer, std::align_val_t) noexcept {
+  FreeCounted(pointer);
+}
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+  FreeCounted(pointer);
+}
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept {
+  FreeCounted(pointer);
+}
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept {
+  FreeCounted(pointer);
+}
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+  FreeCounted(pointer);
+}
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+  FreeCounted(pointer);
+}
+void operator delete(void* pointer, std::align_val_t,
+                     const std::nothrow_t&) noexcept {
+  FreeCounted(pointer);
+}
+void operator delete[](void* pointer, std::align_val_t,
+                       const std::nothrow_t&) noexcept {
+  FreeCounted(pointer);
+}
+
+#if INSEYE_COUNT_MALLOC
+// allocations of C code and of the standard library made without operator
+// new, e.g. by std::thread or iostreams
+extern "C" {
+void* malloc(size_t size) {
+  CountAllocation(size);
+  return __libc_malloc(size);
+}
+void* calloc(size_t count, size_t size) {
+  CountAllocation(count * size);
+  return __libc_calloc(count, size);
+}
+void* realloc(void* pointer, size_t size) {
+  CountAllocation(size);
+  return __libc_realloc(pointer, size);
+}
+void* aligned_alloc(size_t alignment, size_t size) {
+  CountAllocation(size);
+  return __libc_memalign(alignment, size);
+}
+void* memalign(size_t alignment, size_t size) {
+  CountAllocation(size);
+  return __libc_memalign(alignment, size);
+}
+int posix_memalign(void** pointer, size_t alignment, size_t size) {
+  CountAllocation(size);
+  *pointer = __libc_memalign(alignment, size);
+  return *pointer != nullptr ? 0 : ENOMEM;
+}
+void free(void* pointer) { __libc_free(pointer); }
+}
+#endif
+
+namespace {
+constexpr uint32_t ring_sample_count = 4096;
+constexpr uint32_t batch_capacity = 64;
+constexpr auto restart_timeout = std::chrono::seconds(10);
+
+// counts allocations the library makes through InseyeAllocator
+struct CountingAllocator {
+  std::atomic<uint64_t> allocation_count = 0;
+  std::atomic<uint64_t> live_count = 0;
+
+  static void* Allocate(size_t size, size_t alignment, void* user_data) {
+    auto& self = *static_cast<CountingAllocator*>(user_data);
+    self.allocation_count.fetch_add(1, std::memory_order_relaxed);
+    self.live_count.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size, std::align_val_t(alignment), std::nothrow);
+  }
+  static void Deallocate(void* pointer, size_t, size_t alignment,
+                         void* user_data) {
+    auto& self = *static_cast<CountingAllocator*>(user_data);
+    self.live_count.fetch_sub(1, std::memory_order_relaxed);
+    ::operator delete(pointer, std::align_val_t(alignment));
+  }
+};
+
+class Checker {
+  uint32_t failed_ = 0;
+  uint32_t checked_ = 0;
+
+ public:
+  // Runs call armed and reports its allocations.
+  template <typename Call>
+  void Check(const char* name, Call&& call) {
+    const uint64_t before =
+        armed_allocation_count.load(std::memory_order_relaxed);
+    armed = true;
+    call();
+    armed = false;
+    const uint64_t allocations =
+        armed_allocation_count.load(std::memory_order_relaxed) - before;
+    ++checked_;
+    if (allocations == 0)
+      return;
+    ++failed_;
+    std::printf("%s: %llu allocations, last of %zu bytes\n", name,
+                static_cast<unsigned long long>(allocations),
+                last_armed_allocation_size.load(std::memory_order_relaxed));
+  }
+  [[nodiscard]] uint32_t Failed() const noexcept { return failed_; }
+  [[nodiscard]] uint32_t Checked() const noexcept { return checked_; }
+};
+
+// Coroutine with frame in static storage, awaiting allocates nothing itself.
+// Coroutines that may overlap use different slots.
+template <int Slot>
+struct StaticTask {
+  struct promise_type {
+    static void* operator new(size_t size) noexcept {
+      alignas(std::max_align_t) static std::byte frame[1024];
+      return size <= sizeof(frame) ? frame : nullptr;
+    }
+    static void operator delete(void*) noexcept {}
+    static StaticTask get_return_object_on_allocation_failure() noexcept {
+      return {};
+    }
+    StaticTask get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+StaticTask<0> AwaitNextSample(inseye::EyeTracker& tracker,
+                              std::atomic<bool>& resumed) {
+  auto sample = co_await tracker.NextSample();
+  (void)sample;
+  resumed.store(true, std::memory_order_release);
+}
+
+// result is 1 when sample was read, 0 when the await ended empty
+StaticTask<1> AwaitCursorSample(inseye::EyeTrackerCursor& cursor,
+                                inseye::Executor* executor,
+                                std::atomic<int>& result) {
+  auto sample = co_await cursor.NextSample(executor);
+  result.store(sample.has_value() ? 1 : 0, std::memory_order_release);
+}
+
+// Holds scheduled continuations until RunAll.
+class DeferredExecutor final : public inseye::Executor {
+  std::mutex mutex_;
+  std::array<std::coroutine_handle<>, 4> queue_{};
+  size_t size_ = 0;
+
+ public:
+  std::atomic<bool> scheduled = false;
+
+  void Schedule(std::coroutine_handle<> continuation) noexcept override {
+    {
+      std::lock_guard lock(mutex_);
+      if (size_ == queue_.size())
+        std::terminate();
+      queue_[size_++] = continuation;
+    }
+    scheduled.store(true, std::memory_order_release);
+  }
+  void RunAll() noexcept {
+    std::unique_lock lock(mutex_);
+    while (size_ != 0) {
+      const auto continuation = queue_[--size_];
+      lock.unlock();
+      continuation.resume();
+      lock.lock();
+    }
+  }
+};
+
+void Publish(ServiceSimulator& service, uint64_t& time, uint32_t count) {
+  for (uint32_t i = 0; i < count; ++i, ++time) {
+    const float position = static_cast<float>(time % 1000) * 1e-3f;
+    service.Write({time, position, position, -position, -position,
+                   inseye::GazeEvent::kInsGazeNone});
+  }
+}
+
+bool WaitUntil(const std::atomic<bool>& flag) {
+  const auto start = std::chrono::steady_clock::now();
+  while (!flag.load(std::memory_order_acquire)) {
+    if (std::chrono::steady_clock::now() - start > restart_timeout)
+      return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+}  // namespace
+
+int main() {
+  // the counter must see allocations, otherwise every check passes
+  static int* volatile allocated = nullptr;
+  armed = true;
+  allocated = new int(0);
+  armed = false;
+  delete allocated;
+  if (armed_allocation_count.load() != 1) {
+    std::printf("Allocation interposer doesn't count allocations.\n");
+    return EXIT_FAILURE;
+  }
+
+  CountingAllocator counting_allocator;
+  const inseye::Allocator allocator{CountingAllocator::Allocate,
+                                    CountingAllocator::Deallocate,
+                                    &counting_allocator};
+  if (inseye::c::SetLibraryAllocator(&allocator) !=
+      inseye::c::InseyeInitializationStatus::kSuccess) {
+    std::printf("SetLibraryAllocator failed: %s\n",
+                inseye::c::GetLastErrorDescription());
+    return EXIT_FAILURE;
+  }
+
+  std::optional<ServiceSimulator> service;
+  try {
+    service.emplace(SimulatorOptions{.ring_sample_count = ring_sample_count});
+  } catch (const std::exception& exception) {
+    std::printf("Service simulator can't start: %s\n", exception.what());
+    return inseye::test::kSkipped;
+  }
+  Checker checker;
+  uint64_t time = 1;
+  Publish(*service, time, ring_sample_count / 2);
+
+  {
+    // initialization, allocates
+    inseye::EyeTracker tracker(1000);
+    inseye::EyeTrackerCursor cursor(tracker);
+    inseye::c::InseyeEyeTracker* c_tracker = nullptr;
+    inseye::c::InseyeCursor* c_cursor = nullptr;
+    if (inseye::c::CreateEyeTrackerReader(&c_tracker, 1000) !=
+            inseye::c::InseyeInitializationStatus::kSuccess ||
+        inseye::c::CreateEyeTrackerCursor(c_tracker, &c_cursor) !=
+            inseye::c::InseyeInitializationStatus::kSuccess) {
+      std::printf("Reader creation failed: %s\n",
+                  inseye::c::GetLastErrorDescription());
+      return EXIT_FAILURE;
+    }
+    const std::array<inseye::FilterStage, 3> stages{
+        inseye::FilterStage{.type = inseye::c::kInsFilterMedian,
+                            .window = 5},
+        inseye::FilterStage{.type = inseye::c::kInsFilterOneEuro,
+                            .min_cutoff_hz = 1.0f,
+                            .beta = 0.5f},
+        inseye::FilterStage{.type = inseye::c::kInsFilterExponentialMovingAverage,
+                            .alpha = 0.5f}};
+    tracker.SetFilterChain(stages);
+    cursor.SetFilterChain(stages);
+    tracker.StartGazeClassification();
+    cursor.StartGazeClassification();
+    tracker.EnableReconnect({.check_interval_ms = 10});
+    if (inseye::c::SetEyeTrackerFilterChain(c_tracker, stages.data(),
+                                            stages.size()) !=
+            inseye::c::InseyeInitializationStatus::kSuccess ||
+        inseye::c::SetCursorFilterChain(c_cursor, stages.data(),
+                                        stages.size()) !=
+            inseye::c::InseyeInitializationStatus::kSuccess ||
+        inseye::c::StartEyeTrackerGazeClassification(c_tracker, nullptr) !=
+            inseye::c::InseyeInitializationStatus::kSuccess ||
+        inseye::c::StartCursorGazeClassification(c_cursor, nullptr) !=
+            inseye::c::InseyeInitializationStatus::kSuccess ||
+        inseye::c::EnableEyeTrackerReconnect(c_tracker, nullptr) !=
+            inseye::c::InseyeInitializationStatus::kSuccess) {
+      std::printf("Reader setup failed: %s\n",
+                  inseye::c::GetLastErrorDescription());
+      return EXIT_FAILURE;
+    }
+    if (counting_allocator.allocation_count.load() == 0) {
+      std::printf("Library objects were not allocated with InseyeAllocator.\n");
+      return EXIT_FAILURE;
+    }
+    // the first suspension starts the watcher thread
+    std::array<inseye::EyeTrackerDataStruct, batch_capacity> samples{};
+    uint32_t count = 0;
+    while (tracker.TryReadEyeTrackerDataBatch(samples, count)) {}
+    std::atomic<bool> resumed = false;
+    AwaitNextSample(tracker, resumed);
+    Publish(*service, time, 1);
+    if (!WaitUntil(resumed)) {
+      std::printf("Awaiting coroutine was not resumed.\n");
+      return EXIT_FAILURE;
+    }
+
+    std::array<inseye::EyeTrackerDataStruct, batch_capacity> raw_samples{};
+    std::array<inseye::GazeSegment, batch_capacity> segments{};
+    std::array<uint64_t, batch_capacity> times{};
+    std::array<float, batch_capacity> left_x{}, left_y{}, right_x{}, right_y{};
+    std::array<inseye::GazeEvent, batch_capacity> events{};
+    std::array<int64_t, batch_capacity> local_times{};
+    std::array<std::chrono::steady_clock::time_point, batch_capacity>
+        local_time_points{};
+    const inseye::EyeTrackerDataColumns columns{
+        times.data(),   left_x.data(),  left_y.data(),
+        right_x.data(), right_y.data(), events.data()};
+    inseye::EyeTrackerDataStruct sample{};
+    inseye::GazePrediction prediction{};
+    inseye::ClockMapping mapping{};
+    inseye::Lease lease{};
+    int64_t local_time = 0;
+    auto* const statistics = new inseye::ReaderStatistics{};
+
+    // checks every read, wait and batch of C and C++ API, called again after
+    // the readers switched to restarted service
+    const auto check_reads = [&](const char* round) {
+      const auto check = [&](const char* name, auto&& call) {
+        char label[128];
+        std::snprintf(label, sizeof(label), "%s %s", round, name);
+        Publish(*service, time, 8);
+        checker.Check(label, call);
+      };
+      // C API reader
+      check("IsGazeDataAvailable",
+            [&] { inseye::c::IsGazeDataAvailable(c_tracker); });
+      check("TryReadNextEyeTrackerData", [&] {
+        inseye::c::TryReadNextEyeTrackerData(c_tracker, &sample);
+      });
+      check("TryReadLatestEyeTrackerData", [&] {
+        inseye::c::TryReadLatestEyeTrackerData(c_tracker, &sample);
+      });
+      check("TryReadEyeTrackerDataBatch", [&] {
+        inseye::c::TryReadEyeTrackerDataBatch(c_tracker, samples.data(),
+                                              batch_capacity, &count);
+      });
+      check("ReadEyeTrackerDataColumns", [&] {
+        inseye::c::ReadEyeTrackerDataColumns(c_tracker, &columns,
+                                             batch_capacity, &count);
+      });
+      check("Acquire/ReleaseEyeTrackerReadLease", [&] {
+        if (inseye::c::AcquireEyeTrackerReadLease(c_tracker, batch_capacity,
+                                                  &lease))
+          inseye::c::ReleaseEyeTrackerReadLease(c_tracker, &lease, nullptr);
+      });
+      check("WaitForEyeTrackerData", [&] {
+        inseye::c::WaitForEyeTrackerData(c_tracker, 1000000);
+        inseye::c::TryReadEyeTrackerDataBatch(c_tracker, samples.data(),
+                                              batch_capacity, &count);
+        inseye::c::WaitForEyeTrackerData(c_tracker, 1000000);
+      });
+      check("TryReadLastEyeTrackerData", [&] {
+        inseye::c::TryReadLastEyeTrackerData(c_tracker, &sample);
+      });
+      check("TryReadEyeTrackerDataAt", [&] {
+        inseye::c::TryReadEyeTrackerDataAt(
+            c_tracker, static_cast<double>(time) - 10.5,
+            inseye::c::kInsTimeQueryInterpolate, &sample);
+      });
+      check("ReadEyeTrackerDataRange", [&] {
+        inseye::c::ReadEyeTrackerDataRange(c_tracker, time - 32, time,
+                                           samples.data(), batch_capacity,
+                                           &count);
+      });
+      check("TryReadFilteredEyeTrackerDataBatch", [&] {
+        inseye::c::TryReadFilteredEyeTrackerDataBatch(
+            c_tracker, raw_samples.data(), samples.data(), batch_capacity,
+            &count);
+      });
+      check("TryReadGazeSegments", [&] {
+        inseye::c::TryReadGazeSegments(c_tracker, segments.data(),
+                                       batch_capacity, &count);
+      });
+      check("PredictGaze", [&] {
+        inseye::c::PredictGaze(c_tracker, static_cast<double>(time) + 10,
+                               &prediction);
+      });
+      check("GetEyeTrackerReaderStatistics", [&] {
+        inseye::c::GetEyeTrackerReadRetryCount(c_tracker);
+        inseye::c::GetEyeTrackerReaderStatistics(c_tracker, statistics);
+      });
+      check("ConvertEyeTrackerTimesToLocal", [&] {
+        inseye::c::GetEyeTrackerClockMapping(c_tracker, &mapping);
+        inseye::c::ConvertEyeTrackerTimeToLocal(c_tracker, time, &local_time);
+        inseye::c::ConvertEyeTrackerTimesToLocal(
+            c_tracker, times.data(), local_times.data(), batch_capacity);
+      });
+      // C API cursor
+      check("TryReadNextCursorData", [&] {
+        inseye::c::IsCursorGazeDataAvailable(c_cursor);
+        inseye::c::TryReadNextCursorData(c_cursor, &sample);
+        inseye::c::TryReadLatestCursorData(c_cursor, &sample);
+        inseye::c::TryReadLastCursorData(c_cursor, &sample);
+      });
+      check("TryReadCursorDataBatch", [&] {
+        inseye::c::TryReadCursorDataBatch(c_cursor, samples.data(),
+                                          batch_capacity, &count);
+        inseye::c::ReadCursorDataColumns(c_cursor, &columns, batch_capacity,
+                                         &count);
+        inseye::c::TryReadFilteredCursorDataBatch(
+            c_cursor, nullptr, samples.data(), batch_capacity, &count);
+      });
+      check("Acquire/ReleaseCursorReadLease", [&] {
+        if (inseye::c::AcquireCursorReadLease(c_cursor, batch_capacity,
+                                              &lease))
+          inseye::c::ReleaseCursorReadLease(c_cursor, &lease, nullptr);
+      });
+      check("WaitForCursorData", [&] {
+        inseye::c::WaitForCursorData(c_cursor, 1000000);
+      });
+      check("TryReadCursorDataAt", [&] {
+        inseye::c::TryReadCursorDataAt(c_cursor, static_cast<double>(time) - 3,
+                                       inseye::c::kInsTimeQueryNearest,
+                                       &sample);
+        inseye::c::ReadCursorDataRange(c_cursor, time - 32, time,
+                                       samples.data(), batch_capacity, &count);
+      });
+      check("TryReadCursorGazeSegments", [&] {
+        inseye::c::TryReadCursorGazeSegments(c_cursor, segments.data(),
+                                             batch_capacity, &count);
+        inseye::c::PredictCursorGaze(c_cursor, static_cast<double>(time),
+                                     &prediction);
+        inseye::c::GetCursorReaderStatistics(c_cursor, statistics);
+      });
+      // C++ API
+      check("EyeTracker reads", [&] {
+        (void)tracker.IsGazeDataAvailable();
+        tracker.TryReadNextEyeTrackerData(sample);
+        tracker.TryReadLatestEyeTrackerData(sample);
+        tracker.TryReadLastEyeTrackerData(sample);
+        tracker.TryReadEyeTrackerDataAt(static_cast<double>(time) - 2.5,
+                                        inseye::c::kInsTimeQueryInterpolate,
+                                        sample);
+      });
+      check("EyeTracker batches", [&] {
+        tracker.TryReadEyeTrackerDataBatch(samples, count);
+        tracker.ReadEyeTrackerDataColumns(columns, batch_capacity, count);
+        tracker.ReadEyeTrackerDataRange(time - 32, time, samples, count);
+        tracker.TryReadFilteredEyeTrackerDataBatch(raw_samples, samples,
+                                                   count);
+        if (tracker.AcquireReadLease(batch_capacity, lease))
+          tracker.ReleaseReadLease(lease);
+      });
+      check("EyeTracker WaitForEyeTrackerData", [&] {
+        tracker.WaitForEyeTrackerData(std::chrono::milliseconds(1));
+      });
+      check("EyeTracker segments, prediction and clock", [&] {
+        tracker.TryReadGazeSegments(segments, count);
+        tracker.PredictGaze(static_cast<double>(time) + 5, prediction);
+        tracker.PredictGaze(std::chrono::steady_clock::now(), prediction);
+        tracker.GetReaderStatistics(*statistics);
+        tracker.GetClockMapping(mapping);
+        tracker.ConvertEyeTrackerTimesToLocal(times, local_time_points);
+      });
+      check("EyeTrackerCursor reads", [&] {
+        cursor.TryReadNextEyeTrackerData(sample);
+        cursor.TryReadEyeTrackerDataBatch(samples, count);
+        cursor.TryReadFilteredEyeTrackerDataBatch(raw_samples, samples, count);
+        cursor.WaitForEyeTrackerData(std::chrono::milliseconds(1));
+        cursor.TryReadGazeSegments(segments, count);
+        cursor.PredictGaze(static_cast<double>(time), prediction);
+      });
+      check("co_await NextSample", [&] {
+        resumed.store(false, std::memory_order_relaxed);
+        while (tracker.TryReadEyeTrackerDataBatch(samples, count)) {}
+        AwaitNextSample(tracker, resumed);
+      });
+      Publish(*service, time, 1);
+      if (!WaitUntil(resumed)) {
+        std::printf("Awaiting coroutine was not resumed.\n");
+        std::exit(EXIT_FAILURE);
+      }
+    };
+
+    check_reads("initial");
+
+    // reads that adopt restarted service swap rings in place
+    service.reset();
+    service.emplace(SimulatorOptions{.ring_sample_count = ring_sample_count});
+    time += 1000000;
+    std::atomic<bool> switched = false;
+    const auto restart = std::chrono::steady_clock::now();
+    while (!switched.load(std::memory_order_relaxed) &&
+           std::chrono::steady_clock::now() - restart < restart_timeout) {
+      Publish(*service, time, 1);
+      checker.Check("reads adopting restarted service", [&] {
+        while (inseye::c::TryReadNextEyeTrackerData(c_tracker, &sample))
+          if (sample.time >= time - 1)
+            switched.store(true, std::memory_order_relaxed);
+        inseye::c::TryReadCursorDataBatch(c_cursor, samples.data(),
+                                          batch_capacity, &count);
+        tracker.TryReadEyeTrackerDataBatch(samples, count);
+        cursor.TryReadEyeTrackerDataBatch(samples, count);
+      });
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (!switched.load(std::memory_order_relaxed)) {
+      std::printf("Readers didn't switch to restarted service.\n");
+      return EXIT_FAILURE;
+    }
+    check_reads("after restart");
+
+    // cursor destroyed after watcher handed its waiter to executor, but before
+    // the continuation ran, must resume it empty instead of reading from it
+    {
+      DeferredExecutor executor;
+      std::optional<inseye::EyeTrackerCursor> deferred_cursor(std::in_place,
+                                                              tracker);
+      while (deferred_cursor->TryReadEyeTrackerDataBatch(samples, count)) {}
+      std::atomic<int> result = -1;
+      AwaitCursorSample(*deferred_cursor, &executor, result);
+      Publish(*service, time, 1);
+      if (!WaitUntil(executor.scheduled)) {
+        std::printf("Awaiting coroutine was not scheduled.\n");
+        return EXIT_FAILURE;
+      }
+      deferred_cursor.reset();
+      executor.RunAll();
+      if (result.load(std::memory_order_acquire) != 0) {
+        std::printf("Scheduled continuation read from destroyed cursor.\n");
+        return EXIT_FAILURE;
+      }
+    }
+
+    delete statistics;
+    inseye::c::DestroyEyeTrackerCursor(&c_cursor);
+    inseye::c::DestroyEyeTrackerReader(&c_tracker);
+  }
+  inseye::c::ReleaseServiceConnectionCache();
+  service.reset();
+  // watcher thread drops session of the last waiter when it parks
+  const auto destroyed = std::chrono::steady_clock::now();
+  while (counting_allocator.live_count.load() != 0 &&
+         std::chrono::steady_clock::now() - destroyed < restart_timeout)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  if (counting_allocator.live_count.load() != 0) {
+    std::printf("%llu library allocations outlived readers.\n",
+                static_cast<unsigned long long>(
+                    counting_allocator.live_count.load()));
+    return EXIT_FAILURE;
+  }
+  if (inseye::c::SetLibraryAllocator(nullptr) !=
+      inseye::c::InseyeInitializationStatus::kSuccess) {
+    std::printf("Default allocator was not restored: %s\n",
+                inseye::c::GetLastErrorDescription());
+    return EXIT_FAILURE;
+  }
+  std::printf("%u of %u read, wait and batch checks allocated\n",
+              checker.Failed(), checker.Checked());
+  return checker.Failed() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
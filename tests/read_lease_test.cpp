@@ -0,0 +1,82 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+// Read leases lend unread samples in order, split in two spans where they wrap
+// around the end of the ring, move the read position past them and report
+// samples the service overwrote while the lease was held.
+
+#include <vector>
+#include "test_support.hpp"
+
+using namespace inseye::test;
+
+namespace {
+constexpr uint32_t ring_sample_count = 64;
+
+std::vector<inseye::EyeTrackerDataStruct> DecodeLease(
+    const inseye::Lease& lease) {
+  std::vector<inseye::EyeTrackerDataStruct> samples;
+  for (const auto& span : lease.spans)
+    for (uint32_t i = 0; i < span.count; ++i)
+      samples.push_back(
+          DecodeLeasedSample(static_cast<const std::byte*>(span.data) +
+                             size_t{i} * lease.sample_size));
+  return samples;
+}
+
+bool IsSequence(const std::vector<inseye::EyeTrackerDataStruct>& samples,
+                uint64_t first_time) {
+  for (size_t i = 0; i < samples.size(); ++i)
+    if (samples[i].time != first_time + i || !IsStressSampleIntact(samples[i]))
+      return false;
+  return true;
+}
+
+bool CheckLeases(uint32_t layout) {
+  auto service = StartSimulator(
+      {.ring_sample_count = ring_sample_count, .version = {layout, 0, 0}});
+  if (!service)
+    return false;
+  inseye::EyeTracker tracker(1000);
+  inseye::EyeTrackerDataStruct sample{};
+  while (tracker.TryReadNextEyeTrackerData(sample)) {}
+  uint64_t time = 1;
+  // the second round wraps around the end of the ring
+  for (int round = 0; round < 2; ++round) {
+    const uint64_t first = time;
+    WriteStressSamples(*service, time, 50);
+    inseye::Lease lease{};
+    INSEYE_EXPECT(tracker.AcquireReadLease(ring_sample_count, lease));
+    INSEYE_EXPECT(lease.count == 50);
+    INSEYE_EXPECT(lease.spans[0].count + lease.spans[1].count == lease.count);
+    INSEYE_EXPECT((round == 1) == (lease.spans[1].count != 0));
+    INSEYE_EXPECT(IsSequence(DecodeLease(lease), first));
+    uint32_t overwritten = 1;
+    INSEYE_EXPECT(tracker.ReleaseReadLease(lease, &overwritten));
+    INSEYE_EXPECT(overwritten == 0);
+    // leased samples are consumed
+    INSEYE_EXPECT(!tracker.TryReadNextEyeTrackerData(sample));
+  }
+
+  // service laps the ring while the lease is held
+  WriteStressSamples(*service, time, 16);
+  inseye::Lease lease{};
+  INSEYE_EXPECT(tracker.AcquireReadLease(16, lease));
+  WriteStressSamples(*service, time, ring_sample_count);
+  uint32_t overwritten = 0;
+  INSEYE_EXPECT(!tracker.ReleaseReadLease(lease, &overwritten));
+  INSEYE_EXPECT(overwritten == lease.count);
+  return true;
+}
+}  // namespace
+
+int main() {
+  for (const uint32_t layout : {1u, 2u})
+    if (!CheckLeases(layout))
+      return kSkipped;
+  return ExitCode();
+}
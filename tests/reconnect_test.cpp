@@ -0,0 +1,112 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+// Service restarts under reader with reconnect enabled: reader, its cursor and
+// time queries switch to the new ring, no sample of the old ring is read after
+// the switch and the first new sample is flagged. Service that only pauses
+// for longer than stall timeout keeps its ring.
+
+#include <array>
+#include <chrono>
+#include <thread>
+#include "test_support.hpp"
+
+using namespace inseye::test;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+constexpr uint32_t ring_sample_count = 1024;
+constexpr uint64_t restarted_time = 1000000;
+constexpr auto restart_timeout = std::chrono::seconds(10);
+
+struct SwitchCheck {
+  bool switched = false;
+  uint32_t stale_samples = 0;
+  uint32_t unflagged_switches = 0;
+};
+
+template <typename Reader>
+void ReadAfterRestart(Reader& reader, SwitchCheck& check) {
+  inseye::EyeTrackerDataStruct read{};
+  while (reader.TryReadNextEyeTrackerData(read)) {
+    const bool flagged =
+        (read.gaze_event & inseye::c::kInsGazeDiscontinuity) != 0;
+    if (read.time < restarted_time) {
+      // the old ring was drained before restart
+      ++check.stale_samples;
+    } else if (!check.switched) {
+      check.switched = true;
+      check.unflagged_switches += flagged ? 0 : 1;
+    }
+  }
+}
+}  // namespace
+
+int main() {
+  auto service = StartSimulator({.ring_sample_count = ring_sample_count});
+  if (!service)
+    return kSkipped;
+  uint64_t time = 1;
+  WriteStressSamples(*service, time, ring_sample_count / 2);
+  inseye::EyeTracker tracker(1000);
+  tracker.EnableReconnect({.check_interval_ms = 10});
+  inseye::EyeTrackerCursor cursor(tracker);
+  // only queries by time, never moves its read position
+  inseye::EyeTrackerCursor query_cursor(tracker);
+  inseye::EyeTrackerDataStruct sample{};
+  while (tracker.TryReadNextEyeTrackerData(sample)) {}
+  while (cursor.TryReadNextEyeTrackerData(sample)) {}
+
+  // new service is started right away on the same endpoint
+  service.reset();
+  auto restarted = StartSimulator({.ring_sample_count = ring_sample_count});
+  if (!INSEYE_EXPECT(restarted.has_value()))
+    return ExitCode();
+  time = restarted_time;
+  SwitchCheck tracker_check, cursor_check;
+  const auto restart = clock_type::now();
+  while ((!tracker_check.switched || !cursor_check.switched) &&
+         clock_type::now() - restart < restart_timeout) {
+    WriteStressSamples(*restarted, time, 1);
+    ReadAfterRestart(tracker, tracker_check);
+    ReadAfterRestart(cursor, cursor_check);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  for (const auto& check : {tracker_check, cursor_check}) {
+    INSEYE_EXPECT(check.switched);
+    INSEYE_EXPECT(check.stale_samples == 0);
+    INSEYE_EXPECT(check.unflagged_switches == 0);
+  }
+  inseye::EyeTrackerDataStruct queried{};
+  INSEYE_EXPECT(query_cursor.TryReadEyeTrackerDataAt(
+                    static_cast<double>(time - 1),
+                    inseye::TimeQueryMode::kInsTimeQueryNearest, queried) &&
+                queried.time == time - 1);
+  std::array<inseye::EyeTrackerDataStruct, 4> range{};
+  uint32_t range_count = 0;
+  INSEYE_EXPECT(query_cursor.ReadEyeTrackerDataRange(restarted_time, time,
+                                                     range, range_count) &&
+                range[0].time == restarted_time);
+
+  // service that only pauses for longer than stall timeout keeps its ring
+  constexpr uint32_t resumed_count = 100;
+  tracker.DisableReconnect();
+  tracker.EnableReconnect({.stall_timeout_ms = 20, .check_interval_ms = 5});
+  while (tracker.TryReadNextEyeTrackerData(sample)) {}
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  const uint64_t resumed_time = time;
+  WriteStressSamples(*restarted, time, resumed_count);
+  uint32_t resumed_read = 0, resumed_flagged = 0;
+  while (tracker.TryReadNextEyeTrackerData(sample)) {
+    resumed_read += sample.time == resumed_time + resumed_read ? 1 : 0;
+    if ((sample.gaze_event & inseye::c::kInsGazeDiscontinuity) != 0)
+      ++resumed_flagged;
+  }
+  INSEYE_EXPECT(resumed_read == resumed_count);
+  INSEYE_EXPECT(resumed_flagged == 0);
+  return ExitCode();
+}
@@ -0,0 +1,91 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+// Recorder drains every sample service writes into file made of small chunks,
+// recording reads them back intact and in order and seek finds the first
+// sample not older than any time.
+
+#include <chrono>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include "test_support.hpp"
+
+using namespace inseye::test;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+constexpr uint32_t chunk_size = 64 * 1024;
+constexpr uint32_t sample_count = 20000;
+constexpr uint32_t samples_per_write = 100;
+constexpr auto drain_timeout = std::chrono::seconds(5);
+
+bool CheckRecording(uint32_t layout) {
+  auto service = StartSimulator({.version = {layout, 0, 0}});
+  if (!service)
+    return false;
+  const auto path =
+      (std::filesystem::temp_directory_path() /
+       ("inseye_recorder_test_" +
+        std::to_string(clock_type::now().time_since_epoch().count()) + ".rec"))
+          .string();
+  uint64_t time = 1;
+  {
+    inseye::Recorder recorder(path, 1000, {chunk_size});
+    while (time <= sample_count) {
+      WriteStressSamples(*service, time, samples_per_write);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const auto deadline = clock_type::now() + drain_timeout;
+    while (recorder.GetRecordedSampleCount() < sample_count &&
+           clock_type::now() < deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    INSEYE_EXPECT(recorder.GetState() ==
+                  inseye::RecorderState::kInsRecorderRunning);
+  }
+
+  {
+    inseye::Recording recording(path);
+    INSEYE_EXPECT(recording.GetSampleCount() == sample_count);
+    std::vector<inseye::EyeTrackerDataStruct> samples(
+        recording.GetSampleCount());
+    uint32_t count = 0;
+    for (uint64_t position = 0;
+         recording.Read(position, std::span(samples).subspan(position), count);
+         position += count) {}
+    uint64_t broken = 0;
+    for (uint64_t i = 0; i < samples.size(); ++i)
+      broken += samples[i].time == i + 1 && IsStressSampleIntact(samples[i])
+                    ? 0
+                    : 1;
+    INSEYE_EXPECT(broken == 0);
+
+    uint64_t wrong_seeks = 0;
+    for (uint64_t seek_time = 1; seek_time <= samples.size(); ++seek_time) {
+      uint64_t position = 0;
+      wrong_seeks += recording.Seek(seek_time, position) &&
+                             position == seek_time - 1
+                         ? 0
+                         : 1;
+    }
+    INSEYE_EXPECT(wrong_seeks == 0);
+    uint64_t position = 0;
+    INSEYE_EXPECT(!recording.Seek(sample_count + 1, position));
+  }
+  std::filesystem::remove(path);
+  return true;
+}
+}  // namespace
+
+int main() {
+  for (const uint32_t layout : {1u, 2u})
+    if (!CheckRecording(layout))
+      return kSkipped;
+  return ExitCode();
+}
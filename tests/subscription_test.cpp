@@ -0,0 +1,80 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+// Dispatcher delivers published samples in order, and when callback stalls
+// while the service laps the ring it notifies the overrun so that every
+// sample is either delivered or counted as dropped.
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "test_support.hpp"
+
+using namespace inseye::test;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+constexpr uint32_t ring_sample_count = 256;
+constexpr uint32_t iterations = 500;
+constexpr auto delivery_timeout = std::chrono::seconds(2);
+}  // namespace
+
+int main() {
+  auto service = StartSimulator({.ring_sample_count = ring_sample_count});
+  if (!service)
+    return kSkipped;
+  uint64_t time = 1;
+  uint64_t next_time = 1, unexpected = 0, overrun_batches = 0;
+  std::atomic<uint64_t> accounted = 0;
+  std::atomic<bool> stall = false, stalled = false;
+  auto wait_for_accounted = [&](uint64_t expected) {
+    const auto deadline = clock_type::now() + delivery_timeout;
+    while (accounted.load(std::memory_order_acquire) < expected &&
+           clock_type::now() < deadline)
+      std::this_thread::yield();
+  };
+  {
+    inseye::EyeTracker tracker(1000);
+    inseye::Subscription subscription(
+        tracker, [&](const inseye::GazeDataBatch& batch) {
+          if (batch.dropped_samples != 0)
+            ++overrun_batches;
+          next_time += batch.dropped_samples;
+          for (uint32_t i = 0; i < batch.count; ++i)
+            unexpected += batch.samples[i].time == next_time++ &&
+                                  IsStressSampleIntact(batch.samples[i])
+                              ? 0
+                              : 1;
+          stalled.store(stall.load(), std::memory_order_relaxed);
+          while (stall.load())
+            std::this_thread::yield();
+          accounted.fetch_add(batch.dropped_samples + batch.count,
+                              std::memory_order_release);
+        });
+    for (uint32_t i = 0; i < iterations; ++i) {
+      WriteStressSamples(*service, time, 1 + i % 8);
+      wait_for_accounted(time - 1);
+    }
+    INSEYE_EXPECT(accounted.load() == time - 1);
+    INSEYE_EXPECT(overrun_batches == 0);
+
+    // stall callback on one sample, then lap the ring three times
+    stall = true;
+    WriteStressSamples(*service, time, 1);
+    const auto deadline = clock_type::now() + delivery_timeout;
+    while (!stalled.load() && clock_type::now() < deadline)
+      std::this_thread::yield();
+    WriteStressSamples(*service, time, 3 * ring_sample_count);
+    stall = false;
+    wait_for_accounted(time - 1);
+  }
+  INSEYE_EXPECT(accounted.load() == time - 1);
+  INSEYE_EXPECT(overrun_batches != 0);
+  INSEYE_EXPECT(unexpected == 0);
+  INSEYE_EXPECT(next_time == time);
+  return ExitCode();
+}
@@ -0,0 +1,106 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+#ifndef REMOTE_CONNECTOR_TESTS_TEST_SUPPORT_HPP
+#define REMOTE_CONNECTOR_TESTS_TEST_SUPPORT_HPP
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <optional>
+#include <utility>
+#include "remote_connector.h"
+#include "service_simulator.hpp"
+
+// Failed expectations are printed and counted, test executable returns
+// ExitCode() from main. Every test runs against in-process service simulator
+// on endpoint of its own (INSEYE_SERVICE_ENDPOINT set by ctest).
+namespace inseye::test {
+
+// exit code ctest reports as skipped (SKIP_RETURN_CODE)
+constexpr int kSkipped = 77;
+
+inline uint32_t failed_expectations = 0;
+
+inline bool Expect(bool condition, const char* expression, const char* file,
+                   int line) {
+  if (!condition) {
+    ++failed_expectations;
+    std::printf("%s:%d: expected %s\n", file, line, expression);
+  }
+  return condition;
+}
+
+inline int ExitCode() {
+  if (failed_expectations == 0)
+    return EXIT_SUCCESS;
+  std::printf("%u expectations failed\n", failed_expectations);
+  return EXIT_FAILURE;
+}
+
+/**
+ * @brief Starts simulator, empty when it can't claim the service endpoint.
+ */
+inline std::optional<inseye::simulator::ServiceSimulator> StartSimulator(
+    const inseye::simulator::SimulatorOptions& options) {
+  try {
+    return std::optional<inseye::simulator::ServiceSimulator>(std::in_place,
+                                                              options);
+  } catch (const std::exception& exception) {
+    std::printf("Service simulator can't start: %s\n", exception.what());
+    return std::nullopt;
+  }
+}
+
+// Every field of stress sample is derived from its time, so sample mixed from
+// two writes is detected.
+inline inseye::EyeTrackerDataStruct MakeStressSample(uint64_t index) {
+  const auto value = static_cast<float>(index % 65536);
+  return {index, value, -value, value * 0.5f, value * 2.0f,
+          static_cast<inseye::GazeEvent>(index % 7)};
+}
+
+inline bool IsStressSampleIntact(const inseye::EyeTrackerDataStruct& sample) {
+  const auto expected = MakeStressSample(sample.time);
+  return sample.left_eye_x == expected.left_eye_x &&
+         sample.left_eye_y == expected.left_eye_y &&
+         sample.right_eye_x == expected.right_eye_x &&
+         sample.right_eye_y == expected.right_eye_y &&
+         sample.gaze_event == expected.gaze_event;
+}
+
+inline bool IsSameSample(const inseye::EyeTrackerDataStruct& a,
+                         const inseye::EyeTrackerDataStruct& b) {
+  return a.time == b.time && a.left_eye_x == b.left_eye_x &&
+         a.left_eye_y == b.left_eye_y && a.right_eye_x == b.right_eye_x &&
+         a.right_eye_y == b.right_eye_y && a.gaze_event == b.gaze_event;
+}
+
+// Leased sample in service layout, packed fields in little endian.
+inline inseye::EyeTrackerDataStruct DecodeLeasedSample(
+    const std::byte* source) {
+  inseye::EyeTrackerDataStruct sample{};
+  std::memcpy(&sample.time, source, sizeof(sample.time));
+  std::memcpy(&sample.left_eye_x, source + 8, 4 * sizeof(float));
+  std::memcpy(&sample.gaze_event, source + 24, sizeof(sample.gaze_event));
+  return sample;
+}
+
+// Writes stress samples with times [time, time + count) and advances time.
+inline void WriteStressSamples(inseye::simulator::ServiceSimulator& service,
+                               uint64_t& time, uint32_t count) {
+  for (uint32_t i = 0; i < count; ++i)
+    service.Write(MakeStressSample(time++));
+}
+
+}  // namespace inseye::test
+
+#define INSEYE_EXPECT(condition) \
+  ::inseye::test::Expect((condition), #condition, __FILE__, __LINE__)
+
+#endif  //REMOTE_CONNECTOR_TESTS_TEST_SUPPORT_HPP
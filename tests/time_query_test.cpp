@@ -0,0 +1,88 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+// Queries by time agree with ring content: nearest sample, interpolation
+// between neighbours and ranges anywhere among intact samples, and no answer
+// for time older than the oldest intact sample.
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "test_support.hpp"
+
+using namespace inseye::test;
+
+namespace {
+constexpr uint32_t ring_sample_count = 1024;
+constexpr uint32_t iterations = 20000;
+constexpr uint64_t service_epoch_ms = 1'700'000'000'000;
+constexpr uint32_t range_length_ms = 64;
+}  // namespace
+
+int main() {
+  auto service = StartSimulator({.ring_sample_count = ring_sample_count});
+  if (!service)
+    return kSkipped;
+  const uint32_t written = 2 * service->SampleCount();
+  for (uint32_t i = 0; i < written; ++i) {
+    const auto position = static_cast<float>(i);
+    service->Write({service_epoch_ms + i, position, -position, position,
+                    -position, inseye::GazeEvent::kInsGazeNone});
+  }
+  // OldestIntactSampleIndex of the written ring, counted from 0
+  const uint32_t oldest = written - (service->SampleCount() - 1);
+  inseye::EyeTracker tracker(1000);
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> offset_ms(oldest, written - 1);
+  inseye::EyeTrackerDataStruct sample{};
+  uint32_t nearest_mismatches = 0, interpolated_mismatches = 0,
+           range_mismatches = 0;
+  for (uint32_t i = 0; i < iterations; ++i) {
+    const double query =
+        static_cast<double>(service_epoch_ms) + offset_ms(generator);
+    // offset as the reader sees it, after rounding of query time
+    const double offset = query - static_cast<double>(service_epoch_ms);
+    // halfway between two samples the older one is the nearest
+    nearest_mismatches +=
+        tracker.TryReadEyeTrackerDataAt(
+            query, inseye::TimeQueryMode::kInsTimeQueryNearest, sample) &&
+                sample.left_eye_x == std::ceil(offset - 0.5)
+            ? 0
+            : 1;
+    interpolated_mismatches +=
+        tracker.TryReadEyeTrackerDataAt(
+            query, inseye::TimeQueryMode::kInsTimeQueryInterpolate, sample) &&
+                std::abs(sample.left_eye_x - offset) < 1e-2
+            ? 0
+            : 1;
+  }
+  INSEYE_EXPECT(nearest_mismatches == 0);
+  INSEYE_EXPECT(interpolated_mismatches == 0);
+  // time older than the oldest intact sample has no answer
+  INSEYE_EXPECT(!tracker.TryReadEyeTrackerDataAt(
+      static_cast<double>(service_epoch_ms + oldest) - 1.0,
+      inseye::TimeQueryMode::kInsTimeQueryNearest, sample));
+
+  std::vector<inseye::EyeTrackerDataStruct> range(range_length_ms);
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < iterations / 10; ++i) {
+    uint64_t begin = service_epoch_ms +
+                     static_cast<uint64_t>(offset_ms(generator)) -
+                     range_length_ms;
+    begin = (std::max)(begin, service_epoch_ms + oldest);
+    range_mismatches += tracker.ReadEyeTrackerDataRange(
+                            begin, begin + range_length_ms, range, count) &&
+                                count == range_length_ms &&
+                                range.front().time == begin &&
+                                range.back().time == begin + count - 1
+                            ? 0
+                            : 1;
+  }
+  INSEYE_EXPECT(range_mismatches == 0);
+  return ExitCode();
+}
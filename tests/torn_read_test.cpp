@@ -0,0 +1,104 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+// Writer laps small ring at given rate (0 - as fast as possible) while reader
+// alternates single reads, batch reads and leases, every sample read must be
+// intact and newer than the previous one. Leased samples are copied out while
+// the lease is held and only those the release confirms are checked.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "test_support.hpp"
+
+using namespace inseye::test;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+constexpr uint32_t ring_sample_count = 16;
+constexpr auto stress_duration = std::chrono::seconds(1);
+
+bool RunStress(uint32_t write_rate_hz, uint32_t layout) {
+  auto service = StartSimulator(
+      {.ring_sample_count = ring_sample_count, .version = {layout, 0, 0}});
+  if (!service)
+    return false;
+  service->SetWakeReaders(false);
+  inseye::EyeTracker tracker(1000);
+  std::atomic<bool> running = true;
+  std::thread writer([&] {
+    const auto interval =
+        write_rate_hz == 0 ? clock_type::duration::zero()
+                           : std::chrono::duration_cast<clock_type::duration>(
+                                 std::chrono::duration<double>(
+                                     1.0 / write_rate_hz));
+    auto next_write = clock_type::now();
+    while (running.load(std::memory_order_relaxed)) {
+      service->Write(MakeStressSample(service->SamplesWritten() + 1));
+      next_write += interval;
+      while (clock_type::now() < next_write) {}
+    }
+  });
+  uint64_t samples_read = 0, torn_samples = 0, out_of_order = 0,
+           last_time = 0;
+  auto check = [&](const inseye::EyeTrackerDataStruct& sample) {
+    ++samples_read;
+    torn_samples += IsStressSampleIntact(sample) ? 0 : 1;
+    out_of_order += sample.time > last_time ? 0 : 1;
+    last_time = sample.time;
+  };
+  std::array<inseye::EyeTrackerDataStruct, 8> buffer{};
+  const auto start = clock_type::now();
+  while (clock_type::now() - start < stress_duration) {
+    inseye::EyeTrackerDataStruct sample{};
+    if (tracker.TryReadNextEyeTrackerData(sample))
+      check(sample);
+    // rereads the same sample, checked only for tearing
+    if (tracker.TryReadLastEyeTrackerData(sample))
+      torn_samples += IsStressSampleIntact(sample) ? 0 : 1;
+    uint32_t count = 0;
+    if (tracker.TryReadEyeTrackerDataBatch(buffer, count))
+      for (uint32_t i = 0; i < count; ++i)
+        check(buffer[i]);
+    inseye::Lease lease{};
+    if (tracker.AcquireReadLease(buffer.size(), lease)) {
+      uint32_t leased = 0;
+      for (const auto& span : lease.spans)
+        for (uint32_t i = 0; i < span.count; ++i)
+          buffer[leased++] = DecodeLeasedSample(
+              static_cast<const std::byte*>(span.data) +
+              size_t{i} * lease.sample_size);
+      uint32_t overwritten = 0;
+      tracker.ReleaseReadLease(lease, &overwritten);
+      for (uint32_t i = overwritten; i < leased; ++i)
+        check(buffer[i]);
+    }
+  }
+  running = false;
+  writer.join();
+  std::printf("v%u %u Hz: %llu read, %llu torn, %llu out of order, %llu "
+              "retries\n",
+              layout, write_rate_hz,
+              static_cast<unsigned long long>(samples_read),
+              static_cast<unsigned long long>(torn_samples),
+              static_cast<unsigned long long>(out_of_order),
+              static_cast<unsigned long long>(tracker.GetReadRetryCount()));
+  INSEYE_EXPECT(samples_read != 0);
+  INSEYE_EXPECT(torn_samples == 0);
+  INSEYE_EXPECT(out_of_order == 0);
+  return true;
+}
+}  // namespace
+
+int main() {
+  for (const uint32_t layout : {1u, 2u})
+    for (const uint32_t write_rate_hz : {20000u, 0u})
+      if (!RunStress(write_rate_hz, layout))
+        return kSkipped;
+  return ExitCode();
+}
@@ -0,0 +1,77 @@
+//
+// Copyright (c) Inseye Inc. 2024.
+//
+// This file is part of Inseye Software Development Kit subject to Inseye SDK License
+// See  https://github.com/Inseye/Licenses/blob/master/SDKLicense.txt.
+// All other rights reserved.
+
+// Reader blocked in WaitForEyeTrackerData gets every sample writer thread
+// publishes at random intervals, woken up by the service (doorbell) or by
+// polling. Wake up latency p99 must stay below bound generous enough for
+// loaded machine, both ways of waking are expected far below it.
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include "test_support.hpp"
+
+using namespace inseye::test;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+constexpr int sample_count = 1000;
+constexpr double p99_bound_us = 50000;
+
+void CheckWakeUps(inseye::simulator::ServiceSimulator& service,
+                  bool wake_readers) {
+  inseye::EyeTracker tracker(1000);
+  service.SetWakeReaders(wake_readers);
+  inseye::EyeTrackerDataStruct sample{};
+  while (tracker.TryReadNextEyeTrackerData(sample)) {}
+  std::thread writer([&service] {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> interval_us(200, 500);
+    for (int i = 0; i < sample_count; ++i) {
+      std::this_thread::sleep_for(
+          std::chrono::microseconds(interval_us(generator)));
+      const auto stamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             clock_type::now().time_since_epoch())
+                             .count();
+      service.Write({static_cast<uint64_t>(stamp), 0, 0, 0, 0,
+                     inseye::GazeEvent::kInsGazeNone});
+    }
+  });
+  std::vector<double> latencies_us;
+  latencies_us.reserve(sample_count);
+  while (static_cast<int>(latencies_us.size()) < sample_count &&
+         tracker.WaitForEyeTrackerData(std::chrono::seconds(1))) {
+    while (tracker.TryReadNextEyeTrackerData(sample)) {
+      const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           clock_type::now().time_since_epoch())
+                           .count();
+      latencies_us.push_back(
+          static_cast<double>(now - static_cast<int64_t>(sample.time)) /
+          1000.0);
+    }
+  }
+  writer.join();
+  INSEYE_EXPECT(static_cast<int>(latencies_us.size()) == sample_count);
+  if (latencies_us.empty())
+    return;
+  std::sort(latencies_us.begin(), latencies_us.end());
+  const double p99 = latencies_us[latencies_us.size() * 99 / 100];
+  std::printf("%s p99 %.1f us\n", wake_readers ? "doorbell" : "polling", p99);
+  INSEYE_EXPECT(p99 < p99_bound_us);
+}
+}  // namespace
+
+int main() {
+  auto service = StartSimulator({});
+  if (!service)
+    return kSkipped;
+  CheckWakeUps(*service, true);
+  CheckWakeUps(*service, false);
+  return ExitCode();
+}